@@ -0,0 +1,796 @@
+// apps/bench/main.cpp
+// Headless benchmark harness for Sentient-Splat SLAM
+// Loads scenes, replays a scripted camera path in a hidden window and
+// reports load, CPU and GPU frame times as JSON or CSV
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/Camera.hpp"
+#include "core/CameraPath.hpp"
+#include "core/Profiler.hpp"
+#include "core/ThreadPool.hpp"
+#include "render/CpuRasterizer.hpp"
+#include "render/RenderTarget.hpp"
+#include "render/Renderer.hpp"
+#include "scene/IndexRebuilder.hpp"
+#include "scene/LodHierarchy.hpp"
+#include "scene/MapCompactor.hpp"
+#include "scene/Scene.hpp"
+#include "scene/SceneIO.hpp"
+#include "scene/SceneUpdates.hpp"
+
+namespace {
+
+using ordered_json = nlohmann::ordered_json;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<std::string> scenes;
+    std::vector<size_t> generate;          // synthetic scene sizes
+    std::string path_file;                 // empty: orbit fitted to each scene
+    std::string out_file;                  // empty: stdout
+    bool csv = false;
+    int frames = 600;
+    int warmup = 30;
+    int width = 1280;
+    int height = 720;
+    const char* sort = nullptr;            // none / cpu / gpu; renderer default otherwise
+    const char* backend = nullptr;         // quads / tiles; renderer default otherwise
+    bool culling = true;
+    bool lod = true;
+    bool occlusion = false;                // Hi-Z occlusion culling (quad backend)
+    float dynamic_res_ms = 0.f;            // dynamic resolution target GPU time; 0 disables it
+    bool compact = false;                  // draw with GaussianInstanceCompact records
+    bool compact_map = false;              // run MapCompactor on each scene before timing
+    int generate_sh = 0;                   // SH degree given to synthetic scenes
+    int max_sh_degree = sss::kMaxShDegree;
+    bool sh_half = false;
+    float map_hz = 0.f;                    // synthetic mapping thread rate; 0 disables it
+    size_t map_batch = 10000;              // gaussians moved per mapping batch
+    int readback_width = 0;                // offscreen tracking render per frame; 0 disables it
+    int readback_height = 0;
+    bool cpu_reference = false;            // compare the last readback with a CPU render
+};
+
+struct FrameSample {
+    double cpu_ms = 0.0;     // begin_frame + render_scene submission
+    double gpu_ms = 0.0;     // GPU timestamps around the same work
+    double frame_ms = 0.0;   // wall time including glFinish
+    size_t visible = 0;
+    float render_scale = 1.f;   // dynamic resolution scale the frame was drawn at
+    size_t map_batches = 0;  // mapping batches applied at the start of the frame
+    int readback_latency = -1;   // frames from request to arrival of the readback completed this frame
+};
+
+struct BenchResult {
+    std::string name;
+    size_t gaussians = 0;
+    double load_ms = 0.0;
+    std::vector<FrameSample> frames;
+    std::vector<sss::Profiler::PassStats> passes;
+    uint64_t readbacks_dropped = 0;
+    double cpu_reference_ms = -1.0;      // CPU render of the last readback's pose; < 0 if not run
+    sss::CompactionStats compaction;     // with --compact-map
+    double cpu_reference_color_rmse = 0.0;
+    double cpu_reference_depth_rmse = 0.0;
+};
+
+void print_usage() {
+    std::fprintf(stderr,
+                 "Usage: bench [options] [scene ...]\n"
+                 "  --frames N          timed frames per scene (default 600)\n"
+                 "  --warmup N          untimed frames before timing (default 30)\n"
+                 "  --size WxH          framebuffer size (default 1280x720)\n"
+                 "  --path FILE         camera path JSON (default: orbit fitted to each scene)\n"
+                 "  --generate N[,N..]  also bench synthetic scenes of N gaussians\n"
+                 "  --sort none|cpu|gpu depth sort mode (default: renderer's choice)\n"
+                 "  --backend quads|tiles rasterization backend (default: renderer's choice)\n"
+                 "  --no-cull           disable frustum culling (and with it LOD)\n"
+                 "  --no-lod            disable the LOD cut\n"
+                 "  --occlusion         enable Hi-Z occlusion culling (quad backend)\n"
+                 "  --dynamic-res MS    scale the render resolution to keep GPU time near MS\n"
+                 "  --compact           use the 32-byte compact instance format\n"
+                 "  --compact-map       prune and merge redundant gaussians before timing\n"
+                 "  --generate-sh D     give synthetic scenes random SH up to degree D (default 0)\n"
+                 "  --sh-degree N       cap the SH degree drawn (default 3)\n"
+                 "  --sh-half           store SH coefficients as half floats\n"
+                 "  --map-hz HZ         run a synthetic mapping thread publishing edits at HZ\n"
+                 "  --map-batch N       gaussians moved per mapping batch (default 10000)\n"
+                 "  --readback WxH      also render each frame offscreen at WxH and read it back\n"
+                 "  --cpu-reference     compare the last readback with the CPU rasterizer\n"
+                 "  --format json|csv   output format (default json)\n"
+                 "  --out FILE          write results to FILE instead of stdout\n"
+                 "With no scenes and no --generate, runs every file in assets/test_scenes\n"
+                 "plus synthetic scenes of 100k and 1M gaussians.\n");
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--frames") {
+            opt.frames = std::max(1, std::atoi(value()));
+        } else if (arg == "--warmup") {
+            opt.warmup = std::max(0, std::atoi(value()));
+        } else if (arg == "--size") {
+            if (std::sscanf(value(), "%dx%d", &opt.width, &opt.height) != 2 || opt.width <= 0 || opt.height <= 0) {
+                throw std::runtime_error("--size expects WxH");
+            }
+        } else if (arg == "--path") {
+            opt.path_file = value();
+        } else if (arg == "--generate") {
+            std::string list = value();
+            size_t pos = 0;
+            while (pos < list.size()) {
+                const size_t comma = std::min(list.find(',', pos), list.size());
+                opt.generate.push_back((size_t)std::strtoull(list.substr(pos, comma - pos).c_str(), nullptr, 10));
+                pos = comma + 1;
+            }
+        } else if (arg == "--sort") {
+            opt.sort = value();
+        } else if (arg == "--backend") {
+            opt.backend = value();
+        } else if (arg == "--no-cull") {
+            opt.culling = false;
+        } else if (arg == "--no-lod") {
+            opt.lod = false;
+        } else if (arg == "--occlusion") {
+            opt.occlusion = true;
+        } else if (arg == "--dynamic-res") {
+            opt.dynamic_res_ms = std::max(0.f, (float)std::atof(value()));
+        } else if (arg == "--compact-map") {
+            opt.compact_map = true;
+        } else if (arg == "--compact") {
+            opt.compact = true;
+        } else if (arg == "--generate-sh") {
+            opt.generate_sh = std::clamp(std::atoi(value()), 0, sss::kMaxShDegree);
+        } else if (arg == "--sh-degree") {
+            opt.max_sh_degree = std::atoi(value());
+        } else if (arg == "--sh-half") {
+            opt.sh_half = true;
+        } else if (arg == "--map-hz") {
+            opt.map_hz = std::max(0.f, (float)std::atof(value()));
+        } else if (arg == "--map-batch") {
+            opt.map_batch = (size_t)std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--readback") {
+            if (std::sscanf(value(), "%dx%d", &opt.readback_width, &opt.readback_height) != 2 ||
+                opt.readback_width <= 0 || opt.readback_height <= 0) {
+                throw std::runtime_error("--readback expects WxH");
+            }
+        } else if (arg == "--cpu-reference") {
+            opt.cpu_reference = true;
+        } else if (arg == "--format") {
+            const std::string format = value();
+            if (format != "json" && format != "csv") {
+                throw std::runtime_error("--format expects json or csv");
+            }
+            opt.csv = format == "csv";
+        } else if (arg == "--out") {
+            opt.out_file = value();
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::runtime_error("unknown option " + arg);
+        } else {
+            opt.scenes.push_back(arg);
+        }
+    }
+
+    if (opt.cpu_reference && opt.readback_width == 0) {
+        throw std::runtime_error("--cpu-reference needs --readback");
+    }
+    if (opt.scenes.empty() && opt.generate.empty()) {
+        const std::filesystem::path dir = "assets/test_scenes";
+        if (std::filesystem::is_directory(dir)) {
+            for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+                const std::string ext = entry.path().extension().string();
+                if (entry.is_regular_file() && (ext == ".json" || ext == ".sss" || ext == ".ply")) {
+                    opt.scenes.push_back(entry.path().generic_string());
+                }
+            }
+            std::sort(opt.scenes.begin(), opt.scenes.end());
+        }
+        opt.generate = {100000, 1000000};
+    }
+    return true;
+}
+
+// Deterministic random numbers. std:: distributions differ between standard
+// libraries, so only mt19937's raw output (which is specified) is used
+struct Random {
+    std::mt19937 engine;
+
+    explicit Random(uint32_t seed) : engine(seed) {}
+
+    float unit() { return (float)(engine() >> 8) * (1.0f / 16777216.0f); }    // [0, 1)
+    float centered() { return 2.f * unit() - 1.f; }                           // [-1, 1)
+    // [0, n) for n < 2^32, by multiply-shift
+    size_t below(size_t n) { return (size_t)(((uint64_t)engine() * n) >> 32); }
+    float normal() {
+        // Box-Muller
+        const float u = std::max(unit(), 1e-7f);
+        const float v = unit();
+        return std::sqrt(-2.f * std::log(u)) * std::cos(2.f * glm::pi<float>() * v);
+    }
+    glm::vec3 unit3() {
+        const float x = unit(), y = unit(), z = unit();
+        return glm::vec3(x, y, z);
+    }
+    glm::vec3 normal3() {
+        const float x = normal(), y = normal(), z = normal();
+        return glm::vec3(x, y, z);
+    }
+};
+
+// Clustered synthetic scene with constant density, so sizes are comparable;
+// seeded by the count for reproducibility
+sss::Scene generate_scene(size_t count, int sh_degree) {
+    Random rng((uint32_t)count);
+    const float extent = 2.f * std::cbrt((float)count / 1000.f);
+
+    const size_t clusters = std::max<size_t>(1, count / 2000);
+    std::vector<glm::vec3> centers(clusters);
+    std::vector<glm::vec3> tints(clusters);
+    for (size_t c = 0; c < clusters; ++c) {
+        const float x = rng.centered(), y = rng.centered(), z = rng.centered();
+        centers[c] = glm::vec3(x, y * 0.25f, z) * extent;
+        tints[c] = rng.unit3();
+    }
+
+    std::vector<sss::Gaussian3D> gaussians(count);
+    const float cluster_radius = extent / std::cbrt((float)clusters);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t c = i % clusters;
+        sss::Gaussian3D& g = gaussians[i];
+        g.mean = centers[c] + rng.normal3() * (0.3f * cluster_radius);
+        const float s = 0.01f + 0.04f * rng.unit();
+        const glm::vec3 aspect = rng.unit3();
+        g.scale = glm::vec3(s, s * (0.5f + aspect.y), s * (0.5f + aspect.z));
+        const float qw = rng.centered(), qx = rng.centered(), qy = rng.centered(), qz = rng.centered();
+        g.rotation = glm::normalize(glm::quat(qw, qx, qy, qz));
+        g.opacity = 0.3f + 0.7f * rng.unit();
+        g.color = glm::clamp(tints[c] + rng.normal3() * 0.1f, 0.f, 1.f);
+    }
+
+    sss::Scene scene;
+    scene.set_gaussians(gaussians);
+    if (sh_degree > 0) {
+        // Small view-dependent tints, as a trained capture would have
+        scene.set_sh_layout(sh_degree, sss::ShPrecision::Float);
+        glm::vec3 sh[15];
+        const size_t coefficients = sss::sh_coefficient_count(sh_degree);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t k = 0; k < coefficients; ++k) {
+                sh[k] = rng.normal3() * 0.1f;
+            }
+            scene.set_sh(i, sh, coefficients);
+        }
+    }
+    scene.build_lod_hierarchy(&sss::ThreadPool::shared());
+    return scene;
+}
+
+// Orbit around the scene's bounds, or the user's path
+sss::CameraPath make_path(const Options& opt, const sss::Scene& scene, sss::Camera& camera) {
+    glm::vec3 lo(0.f), hi(0.f);
+    const std::vector<glm::vec3>& means = scene.means();
+    if (!means.empty()) {
+        lo = hi = means[0];
+        for (const glm::vec3& m : means) {
+            lo = glm::min(lo, m);
+            hi = glm::max(hi, m);
+        }
+    }
+    const float radius = std::max(0.5f * glm::length(hi - lo), 1.f);
+    camera.zfar = std::max(camera.zfar, 4.f * radius);
+
+    if (!opt.path_file.empty()) {
+        return sss::CameraPath::load(opt.path_file);
+    }
+    return sss::CameraPath::orbit(0.5f * (lo + hi), 1.5f * radius, 0.4f * radius, 10.f);
+}
+
+// Stand-in for a SLAM mapper: at a fixed rate, nudges random gaussians and
+// inserts a few new ones, working from its own copy of the means so it
+// never reads the render thread's scene. Edits name gaussians by their
+// stable IDs, which differ from slots once the scene has been compacted.
+class SyntheticMapper {
+public:
+    SyntheticMapper(const Options& opt, const sss::Scene& scene, sss::SceneUpdateQueue& queue)
+        : m_queue(queue), m_hz(opt.map_hz), m_batch(opt.map_batch), m_means(scene.means()) {
+        m_gaussians.reserve(m_means.size());
+        m_ids.reserve(m_means.size());
+        for (size_t i = 0; i < m_means.size(); ++i) {
+            m_gaussians.push_back(scene.gaussian(i));
+            m_ids.push_back(scene.id_of(i));
+        }
+        m_queue.reset(scene.id_count());
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ~SyntheticMapper() {
+        m_stop = true;
+        m_thread.join();
+    }
+
+private:
+    sss::SceneUpdateQueue& m_queue;
+    float m_hz;
+    size_t m_batch;
+    std::vector<glm::vec3> m_means;
+    std::vector<sss::Gaussian3D> m_gaussians;
+    std::vector<uint32_t> m_ids;   // parallel to m_gaussians
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+
+    void run() {
+        Random rng(7);
+        const auto period = std::chrono::duration<double>(1.0 / m_hz);
+        auto next = Clock::now();
+        while (!m_stop && !m_gaussians.empty()) {
+            sss::SceneUpdate update;
+            for (size_t i = 0; i < m_batch; ++i) {
+                const size_t index = rng.below(m_gaussians.size());
+                sss::Gaussian3D& g = m_gaussians[index];
+                g.mean = m_means[index] + 0.01f * rng.normal3();
+                update.update(m_ids[index], g);
+            }
+            for (size_t i = 0; i < m_batch / 16; ++i) {
+                update.inserted.push_back(m_gaussians[rng.below(m_gaussians.size())]);
+            }
+            const std::vector<sss::Gaussian3D> inserted = update.inserted;
+            const size_t first = m_queue.publish(std::move(update));
+            for (size_t i = 0; i < inserted.size(); ++i) {
+                m_gaussians.push_back(inserted[i]);
+                m_means.push_back(inserted[i].mean);
+                m_ids.push_back((uint32_t)(first + i));
+            }
+
+            next += std::chrono::duration_cast<Clock::duration>(period);
+            std::this_thread::sleep_until(next);
+        }
+    }
+};
+
+// Render the readback's pose with CpuRasterizer and measure how far the GPU
+// image is from it. The GPU's LOD cut changes the image, so this is only a
+// like-for-like check with --no-lod.
+void compare_with_cpu(const sss::Renderer& renderer, const sss::Scene& scene, const glm::mat4& view,
+                      const glm::mat4& projection, const sss::RenderReadback& readback, BenchResult& result) {
+    sss::CpuRasterizer rasterizer;
+    sss::RasterImage image;
+    const auto start = Clock::now();
+    rasterizer.render(scene, view, projection, readback.width, readback.height, image, renderer.max_sh_degree(),
+                      &sss::ThreadPool::shared());
+    result.cpu_reference_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const size_t pixels = (size_t)readback.width * readback.height;
+    double color_error = 0.0;
+    for (size_t i = 0; i < readback.color.size(); ++i) {
+        const double d = readback.color[i] / 255.0 - std::clamp(image.color[i], 0.f, 1.f);
+        color_error += d * d;
+    }
+    double depth_error = 0.0;
+    for (size_t i = 0; i < readback.depth.size(); ++i) {
+        const double d = readback.depth[i] - image.depth[i];
+        depth_error += d * d;
+    }
+    result.cpu_reference_color_rmse = readback.color.empty() ? 0.0 : std::sqrt(color_error / (double)(pixels * 4));
+    result.cpu_reference_depth_rmse = readback.depth.empty() ? 0.0 : std::sqrt(depth_error / (double)pixels);
+}
+
+BenchResult run_scene(const Options& opt, GLFWwindow* window, sss::Renderer& renderer,
+                      const std::string& name, sss::Scene scene, double load_ms) {
+    BenchResult result;
+    result.name = name;
+    if (opt.compact_map) {
+        // Compaction leaves the index and LOD hierarchy stale; rebuild them
+        // over what is left, through the viewer's path, before timing starts
+        const bool lod = scene.lod_hierarchy() != nullptr;
+        sss::MapCompactor compactor;
+        compactor.start(scene);
+        result.compaction = compactor.commit(scene);
+        if (lod) {
+            sss::IndexRebuilder rebuilder;
+            rebuilder.start(scene);
+            rebuilder.commit(scene);
+        }
+    }
+    result.gaussians = scene.gaussian_count();
+    result.load_ms = load_ms;
+
+    sss::Camera camera;
+    const sss::CameraPath path = make_path(opt, scene, camera);
+    const float aspect = renderer.aspect_ratio();
+
+    // Two timestamps per timed frame, read back once the run is over
+    std::vector<GLuint> queries(2 * (size_t)opt.frames);
+    glGenQueries((GLsizei)queries.size(), queries.data());
+
+    sss::SceneUpdateQueue updates;
+    sss::IndexRebuilder rebuilder;
+    std::vector<sss::DirtyRange> update_ranges;
+    std::unique_ptr<SyntheticMapper> mapper;
+    if (opt.map_hz > 0.f) {
+        mapper = std::make_unique<SyntheticMapper>(opt, scene, updates);
+    }
+
+    // Stand-in for tracking: the same pose rendered at sensor size and read
+    // back asynchronously, as the tracker would compare it with a frame
+    std::unique_ptr<sss::RenderTarget> target;
+    sss::RenderReadback readback;
+    std::vector<int> request_frames;   // by ticket
+    std::vector<glm::mat4> request_views;
+    std::vector<glm::mat4> request_projections;
+    if (opt.readback_width > 0) {
+        target = std::make_unique<sss::RenderTarget>(opt.readback_width, opt.readback_height);
+    }
+
+    const int total = opt.warmup + opt.frames;
+    result.frames.resize((size_t)opt.frames);
+    for (int f = 0; f < total; ++f) {
+        // Frames map to path time, so every run sees the same poses
+        const int timed = f - opt.warmup;
+        const float t = timed < 0 ? 0.f : path.duration() * (float)timed / (float)std::max(opt.frames - 1, 1);
+        path.apply(t, camera);
+
+        sss::Profiler::instance().new_frame();
+        const auto frame_start = Clock::now();
+        if (timed >= 0) {
+            glQueryCounter(queries[2 * (size_t)timed], GL_TIMESTAMP);
+        }
+        const size_t map_batches = updates.apply(scene, update_ranges);
+        if (map_batches > 0) {
+            renderer.upload_instance_ranges(scene, update_ranges);
+        }
+        // As the viewer does while mapping
+        if (rebuilder.ready()) {
+            rebuilder.commit(scene);
+        }
+        if (mapper && !rebuilder.pending() && sss::IndexRebuilder::needed(scene)) {
+            rebuilder.start(scene);
+        }
+        renderer.begin_frame();
+        renderer.render_scene(scene, camera.view(), camera.projection(aspect));
+        int readback_latency = -1;
+        if (target) {
+            const float target_aspect = (float)target->width() / (float)target->height();
+            const glm::mat4 target_projection = camera.projection(target_aspect);
+            renderer.render_scene(scene, camera.view(), target_projection, *target);
+            if (const uint64_t ticket = target->request_readback()) {
+                request_frames.resize(ticket + 1);
+                request_frames[ticket] = f;
+                request_views.resize(ticket + 1);
+                request_views[ticket] = camera.view();
+                request_projections.resize(ticket + 1);
+                request_projections[ticket] = target_projection;
+            }
+            while (target->poll_readback(readback)) {
+                readback_latency = f - request_frames[readback.ticket];
+            }
+        }
+        if (timed >= 0) {
+            glQueryCounter(queries[2 * (size_t)timed + 1], GL_TIMESTAMP);
+        }
+        const auto submitted = Clock::now();
+        glfwSwapBuffers(window);
+        glFinish();
+        const auto frame_end = Clock::now();
+
+        if (timed >= 0) {
+            FrameSample& sample = result.frames[(size_t)timed];
+            sample.cpu_ms = std::chrono::duration<double, std::milli>(submitted - frame_start).count();
+            sample.frame_ms = std::chrono::duration<double, std::milli>(frame_end - frame_start).count();
+            sample.visible = renderer.visible_count();
+            sample.render_scale = renderer.render_scale();
+            sample.map_batches = map_batches;
+            sample.readback_latency = readback_latency;
+        }
+        glfwPollEvents();
+    }
+    mapper.reset();
+
+    for (int f = 0; f < opt.frames; ++f) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(queries[2 * (size_t)f], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(queries[2 * (size_t)f + 1], GL_QUERY_RESULT, &end);
+        result.frames[(size_t)f].gpu_ms = (double)(end - begin) * 1e-6;
+    }
+    glDeleteQueries((GLsizei)queries.size(), queries.data());
+    if (target) {
+        result.readbacks_dropped = target->readbacks_dropped();
+    }
+    if (target && opt.cpu_reference) {
+        // Everything is finished, so the last readback is ready
+        while (target->poll_readback(readback)) {
+        }
+        if (readback.ticket != 0) {
+            compare_with_cpu(renderer, scene, request_views[readback.ticket], request_projections[readback.ticket],
+                             readback, result);
+        }
+    }
+
+    result.passes = sss::Profiler::instance().passes();
+    return result;
+}
+
+ordered_json summarize(std::vector<double> values) {
+    ordered_json j;
+    if (values.empty()) {
+        return j;
+    }
+    std::sort(values.begin(), values.end());
+    auto at = [&](double q) { return values[std::min(values.size() - 1, (size_t)(q * (double)(values.size() - 1) + 0.5))]; };
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    j["mean"] = sum / (double)values.size();
+    j["min"] = values.front();
+    j["p50"] = at(0.50);
+    j["p90"] = at(0.90);
+    j["p99"] = at(0.99);
+    j["max"] = values.back();
+    return j;
+}
+
+void write_json(std::ostream& out, const Options& opt, const sss::Renderer& renderer,
+                const std::vector<BenchResult>& results) {
+    ordered_json root;
+    root["renderer"] = (const char*)glGetString(GL_RENDERER);
+    root["gl_version"] = (const char*)glGetString(GL_VERSION);
+    root["width"] = opt.width;
+    root["height"] = opt.height;
+    root["frames"] = opt.frames;
+    root["warmup"] = opt.warmup;
+    root["path"] = opt.path_file.empty() ? "orbit" : opt.path_file;
+    root["backend"] = sss::render_backend_name(renderer.backend());
+    root["sorting"] = sss::sort_mode_name(renderer.sort_mode());
+    root["instances"] = sss::instance_format_name(opt.compact ? sss::InstanceFormat::Compact : sss::InstanceFormat::Full);
+    root["max_sh_degree"] = renderer.max_sh_degree();
+    root["sh_precision"] = sss::sh_precision_name(opt.sh_half ? sss::ShPrecision::Half : sss::ShPrecision::Float);
+    root["culling"] = opt.culling;
+    root["lod"] = opt.lod;
+    root["occlusion"] = renderer.occlusion_enabled();
+    if (renderer.dynamic_resolution()) {
+        root["dynamic_resolution_ms"] = renderer.target_frame_ms();
+    }
+    root["upload_ring"] = renderer.upload_ring().persistent() ? "persistent" : "orphaned";
+    root["upload_stalls"] = renderer.upload_ring().stalls();
+    root["map_hz"] = opt.map_hz;
+    root["map_batch"] = opt.map_batch;
+    if (opt.readback_width > 0) {
+        root["readback"] = std::to_string(opt.readback_width) + "x" + std::to_string(opt.readback_height);
+    }
+
+    ordered_json scenes = ordered_json::array();
+    for (const BenchResult& r : results) {
+        std::vector<double> cpu, gpu, frame, visible, render_scale;
+        size_t map_batches = 0;
+        std::vector<double> readback_latency;
+        for (const FrameSample& s : r.frames) {
+            if (s.readback_latency >= 0) {
+                readback_latency.push_back((double)s.readback_latency);
+            }
+            cpu.push_back(s.cpu_ms);
+            gpu.push_back(s.gpu_ms);
+            frame.push_back(s.frame_ms);
+            visible.push_back((double)s.visible);
+            render_scale.push_back((double)s.render_scale);
+            map_batches += s.map_batches;
+        }
+
+        ordered_json j;
+        j["scene"] = r.name;
+        j["gaussians"] = r.gaussians;
+        j["load_ms"] = r.load_ms;
+        if (opt.compact_map) {
+            j["compaction"] = {{"before", r.compaction.before},
+                               {"pruned", r.compaction.pruned},
+                               {"merged", r.compaction.merged},
+                               {"ms", r.compaction.plan_ms + r.compaction.commit_ms}};
+        }
+        j["cpu_ms"] = summarize(cpu);
+        j["gpu_ms"] = summarize(gpu);
+        j["frame_ms"] = summarize(frame);
+        j["visible"] = summarize(visible);
+        if (opt.dynamic_res_ms > 0.f) {
+            j["render_scale"] = summarize(render_scale);
+        }
+        if (opt.map_hz > 0.f) {
+            j["map_batches"] = map_batches;
+        }
+        if (opt.readback_width > 0) {
+            j["readbacks"] = readback_latency.size();
+            j["readbacks_dropped"] = r.readbacks_dropped;
+            j["readback_latency_frames"] = summarize(readback_latency);
+        }
+        if (r.cpu_reference_ms >= 0.0) {
+            j["cpu_reference"] = {{"ms", r.cpu_reference_ms},
+                                  {"color_rmse", r.cpu_reference_color_rmse},
+                                  {"depth_rmse", r.cpu_reference_depth_rmse}};
+        }
+
+        // Profiler statistics cover its last Profiler::kHistory frames
+        ordered_json passes = ordered_json::array();
+        for (const sss::Profiler::PassStats& p : r.passes) {
+            passes.push_back({{"name", p.name},
+                              {"domain", p.domain == sss::Profiler::Domain::Gpu ? "gpu" : "cpu"},
+                              {"p50_ms", p.p50_ms},
+                              {"p99_ms", p.p99_ms}});
+        }
+        j["passes"] = passes;
+
+        ordered_json per_frame = ordered_json::array();
+        for (const FrameSample& s : r.frames) {
+            per_frame.push_back({s.cpu_ms, s.gpu_ms, s.frame_ms, s.visible});
+        }
+        j["per_frame_columns"] = {"cpu_ms", "gpu_ms", "frame_ms", "visible"};
+        j["per_frame"] = per_frame;
+        scenes.push_back(j);
+    }
+    root["scenes"] = scenes;
+    out << root.dump(2) << "\n";
+}
+
+void write_csv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "scene,gaussians,load_ms,frame,cpu_ms,gpu_ms,frame_ms,visible\n";
+    char line[512];
+    for (const BenchResult& r : results) {
+        for (size_t f = 0; f < r.frames.size(); ++f) {
+            const FrameSample& s = r.frames[f];
+            std::snprintf(line, sizeof(line), "%s,%zu,%.3f,%zu,%.4f,%.4f,%.4f,%zu\n", r.name.c_str(), r.gaussians,
+                          r.load_ms, f, s.cpu_ms, s.gpu_ms, s.frame_ms, s.visible);
+            out << line;
+        }
+    }
+}
+
+GLFWwindow* create_hidden_context(int width, int height) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    const int gl_versions[][2] = {{4, 3}, {3, 3}};
+    for (const auto& version : gl_versions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+        if (GLFWwindow* window = glfwCreateWindow(width, height, "bench", nullptr, nullptr)) {
+            return window;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        if (!parse_options(argc, argv, opt)) {
+            print_usage();
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "[Bench] %s\n", e.what());
+        print_usage();
+        return 1;
+    }
+
+    if (!glfwInit()) {
+        std::fprintf(stderr, "[Bench] Failed to initialize GLFW\n");
+        return 1;
+    }
+    GLFWwindow* window = create_hidden_context(opt.width, opt.height);
+    if (!window) {
+        std::fprintf(stderr, "[Bench] Failed to create an offscreen GL context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);   // never pace to the display
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::fprintf(stderr, "[Bench] Failed to load OpenGL via GLAD\n");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    int status = 0;
+    std::vector<BenchResult> results;
+    {
+        int fbw = opt.width, fbh = opt.height;
+        glfwGetFramebufferSize(window, &fbw, &fbh);
+        sss::Renderer renderer;
+        renderer.init(fbw, fbh);
+        renderer.set_culling(opt.culling);
+        renderer.set_lod(opt.lod);
+        renderer.set_occlusion(opt.occlusion);
+        if (opt.dynamic_res_ms > 0.f) {
+            renderer.set_dynamic_resolution(true);
+            renderer.set_target_frame_ms(opt.dynamic_res_ms);
+        }
+        renderer.set_max_sh_degree(opt.max_sh_degree);
+        if (opt.sort) {
+            const std::string sort = opt.sort;
+            renderer.set_sort_mode(sort == "gpu" ? sss::SortMode::Gpu
+                                   : sort == "cpu" ? sss::SortMode::Cpu
+                                                   : sss::SortMode::None);
+        }
+        if (opt.backend) {
+            renderer.set_backend(std::string(opt.backend) == "tiles" ? sss::RenderBackend::Tiles
+                                                                     : sss::RenderBackend::Quads);
+        }
+        std::fprintf(stderr, "[Bench] %s, backend: %s, sorting: %s\n", (const char*)glGetString(GL_RENDERER),
+                     sss::render_backend_name(renderer.backend()), sss::sort_mode_name(renderer.sort_mode()));
+
+        // One renderer serves every scene; each arrives fully dirty, so it is
+        // uploaded from scratch
+        auto bench = [&](const std::string& name, sss::Scene scene, double load_ms) {
+            scene.set_instance_format(opt.compact ? sss::InstanceFormat::Compact : sss::InstanceFormat::Full);
+            scene.set_sh_precision(opt.sh_half ? sss::ShPrecision::Half : sss::ShPrecision::Float);
+            std::fprintf(stderr, "[Bench] %s: %zu gaussians, loaded in %.0f ms\n", name.c_str(),
+                         scene.gaussian_count(), load_ms);
+            results.push_back(run_scene(opt, window, renderer, name, std::move(scene), load_ms));
+        };
+
+        for (const std::string& path : opt.scenes) {
+            try {
+                const auto start = Clock::now();
+                sss::Scene scene = sss::SceneIO::load_scene(path);
+                const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                bench(path, std::move(scene), ms);
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "[Bench] Skipping %s: %s\n", path.c_str(), e.what());
+                status = 1;
+            }
+        }
+        for (size_t count : opt.generate) {
+            const auto start = Clock::now();
+            sss::Scene scene = generate_scene(count, opt.generate_sh);
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            bench("generated:" + std::to_string(count), std::move(scene), ms);
+        }
+
+        if (opt.out_file.empty()) {
+            opt.csv ? write_csv(std::cout, results) : write_json(std::cout, opt, renderer, results);
+        } else {
+            std::ofstream out(opt.out_file);
+            if (!out) {
+                std::fprintf(stderr, "[Bench] Failed to open %s\n", opt.out_file.c_str());
+                status = 1;
+            } else {
+                opt.csv ? write_csv(out, results) : write_json(out, opt, renderer, results);
+            }
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return status;
+}
@@ -3,13 +3,69 @@
 // Entry point that initializes and runs the application
 
 #include <src/viewer/App.hpp>
+#include <src/core/FramePacer.hpp>
+#include <src/render/Renderer.hpp>
+#include <src/scene/SceneIO.hpp>
+#include <src/scene/TileSet.hpp>
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char** argv) {
-    // Determine scene path from command line
+    // Scene path, presentation mode and instance/SH options from the command line:
+    //   viewer [scene] [--vsync | --uncapped | --fps N] [--compact] [--sh-degree N] [--sh-half]
+    //          [--vram-budget MB] [--dataset DIR]
+    //   viewer scene --write-tiles DIR [--tile-size M]   (split a scene into a tile set and exit)
     std::string scene_path = "assets/test_scenes/grid_gaussians.json";
-    if (argc >= 2) {
-        scene_path = argv[1];
+    sss::PresentMode present_mode = sss::PresentMode::Vsync;
+    float target_fps = 60.f;
+    sss::InstanceFormat format = sss::InstanceFormat::Full;
+    sss::ShPrecision sh_precision = sss::ShPrecision::Float;
+    int max_sh_degree = sss::kMaxShDegree;
+    size_t vram_budget_mb = 1024;
+    std::string tiles_dir;
+    std::string dataset_dir;
+    float tile_size = 25.f;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--compact") == 0) {
+            format = sss::InstanceFormat::Compact;
+        } else if (std::strcmp(argv[i], "--sh-half") == 0) {
+            sh_precision = sss::ShPrecision::Half;
+        } else if (std::strcmp(argv[i], "--sh-degree") == 0 && i + 1 < argc) {
+            max_sh_degree = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--vram-budget") == 0 && i + 1 < argc) {
+            vram_budget_mb = (size_t)std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--dataset") == 0 && i + 1 < argc) {
+            dataset_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--write-tiles") == 0 && i + 1 < argc) {
+            tiles_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc) {
+            tile_size = (float)std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--vsync") == 0) {
+            present_mode = sss::PresentMode::Vsync;
+        } else if (std::strcmp(argv[i], "--uncapped") == 0) {
+            present_mode = sss::PresentMode::Uncapped;
+        } else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            present_mode = sss::PresentMode::Fixed;
+            target_fps = (float)std::atof(argv[++i]);
+        } else {
+            scene_path = argv[i];
+        }
+    }
+
+    if (!tiles_dir.empty()) {
+        try {
+            sss::Scene scene = sss::SceneIO::load_scene(scene_path);
+            scene.set_instance_format(format);
+            const sss::TileSet tiles = sss::TileSet::write(scene, tiles_dir, tile_size);
+            std::fprintf(stdout, "Wrote %zu gaussians in %zu tiles to %s\n", tiles.gaussian_count(),
+                         tiles.tiles.size(), tiles_dir.c_str());
+            return 0;
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "Failed to write tiles: %s\n", e.what());
+            return 1;
+        }
     }
 
     // Create and initialize application
@@ -18,14 +74,25 @@ int main(int argc, char** argv) {
         std::fprintf(stderr, "Failed to initialize application\n");
         return 1;
     }
+    app.pacer().set_mode(present_mode);
+    app.pacer().set_target_fps(target_fps);
+    app.renderer().set_max_sh_degree(max_sh_degree);
+    app.set_vram_budget(vram_budget_mb << 20);
 
     // Load the scene
-    if (!app.load_scene(scene_path)) {
+    if (!app.load_scene(scene_path, format, sh_precision)) {
         std::fprintf(stderr, "Failed to load scene: %s\n", scene_path.c_str());
         app.shutdown();
         return 1;
     }
 
+    // Play an RGB-D dataset alongside the scene
+    if (!dataset_dir.empty() && !app.open_dataset(dataset_dir)) {
+        std::fprintf(stderr, "Failed to open dataset: %s\n", dataset_dir.c_str());
+        app.shutdown();
+        return 1;
+    }
+
     // Run the main loop
     app.run();
 
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+Convert a JSON scene (gaussian3d_v1 or the position/color grid format) to the
+binary .sss scene format read by SceneIO::load_scene_binary.
+
+Layout (little-endian, see src/scene/SceneFormat.hpp):
+  header (40 bytes):
+    char[4]  magic          "SSS\\0"
+    u32      version        1
+    u32      header_size    40
+    u32      stride         64, or 32 with --compact (bytes per record)
+    u64      count
+    u64      payload_offset 64
+    u32      flags          bit 0: --compact, bit 1: --sh-half, bits 8-9: SH degree
+    u32      reserved       0
+  zero padding up to payload_offset
+  count x GaussianInstanceGPU records (16 float32):
+    mean.xyz, opacity | quat.xyzw | scale.xyz, color.r | color.g, color.b, 0, 0
+  or, with --compact, count x GaussianInstanceCompact records (32 bytes):
+    mean.xyz (f32) | scale.xy (f16), scale.z (f16), 0 (u16)
+    | rotation (u32, smallest three) | rgba8 color, opacity | 0 (u32)
+  if any gaussian has an "sh" array (higher SH bands, flat RGB):
+    zero padding up to a multiple of 64
+    count x SH record: the bands as float32 (or float16 with --sh-half),
+    zero-padded to a multiple of 16 bytes
+
+Missing fields get the same defaults as the JSON loader.
+"""
+
+import argparse
+import json
+import math
+import struct
+from pathlib import Path
+
+MAGIC = b"SSS\0"
+VERSION = 1
+HEADER = struct.Struct("<4sIIIQQII")
+RECORD = struct.Struct("<16f")
+COMPACT_RECORD = struct.Struct("<3f3eHIII")
+FLAG_COMPACT = 1
+FLAG_SH_HALF = 2
+SH_DEGREE_SHIFT = 8
+PAYLOAD_ALIGN = 64
+
+
+def vec(item, key, n, default):
+    v = item.get(key)
+    if isinstance(v, list) and len(v) >= n:
+        return [float(x) for x in v[:n]]
+    return default
+
+
+def read_gaussian(item):
+    if "color" not in item:
+        raise SystemExit("Gaussian missing 'color' field")
+
+    mean = vec(item, "mean", 3, None) or vec(item, "position", 3, [0.0, 0.0, 0.0])
+    scale = vec(item, "scale", 3, [1.0, 1.0, 1.0])
+    rotation = vec(item, "rotation", 4, [0.0, 0.0, 0.0, 1.0])
+    opacity = float(item.get("opacity", 1.0))
+    color = vec(item, "color", 3, None)
+    return mean, scale, rotation, opacity, color
+
+
+def pack_rotation(q) -> int:
+    """Smallest-three encoding matching pack_gaussian_compact in Scene.cpp."""
+    n = math.sqrt(sum(c * c for c in q)) or 1.0
+    q = [c / n for c in q]
+    largest = max(range(4), key=lambda i: abs(q[i]))
+    sign = -1.0 if q[largest] < 0.0 else 1.0
+    bits = largest << 30
+    shift = 0
+    for i in range(4):
+        if i == largest:
+            continue
+        v = min(max(sign * q[i] * math.sqrt(2.0) * 0.5 + 0.5, 0.0), 1.0)
+        bits |= int(round(v * 1023.0)) << shift
+        shift += 10
+    return bits
+
+
+def unorm8(v: float) -> int:
+    return int(round(min(max(v, 0.0), 1.0) * 255.0))
+
+
+def pack_gaussian_compact(item) -> bytes:
+    mean, scale, rotation, opacity, (r, g, b) = read_gaussian(item)
+    rgba = unorm8(r) | unorm8(g) << 8 | unorm8(b) << 16 | unorm8(opacity) << 24
+    return COMPACT_RECORD.pack(
+        mean[0], mean[1], mean[2],
+        scale[0], scale[1], scale[2], 0,
+        pack_rotation(rotation), rgba, 0,
+    )
+
+
+def pack_gaussian(item) -> bytes:
+    mean, scale, (qx, qy, qz, qw), opacity, (r, g, b) = read_gaussian(item)
+
+    return RECORD.pack(
+        mean[0], mean[1], mean[2], opacity,
+        qx, qy, qz, qw,
+        scale[0], scale[1], scale[2], r,
+        g, b, 0.0, 0.0,
+    )
+
+
+def sh_degree_for(values: int) -> int:
+    coefficients = values // 3
+    degree = 0
+    while (degree + 1) ** 2 - 1 < coefficients:
+        degree += 1
+    return min(degree, 3)
+
+
+def pack_sh(item, degree: int, half: bool) -> bytes:
+    values = 3 * ((degree + 1) ** 2 - 1)
+    sh = [float(x) for x in item.get("sh", [])[:values]]
+    sh += [0.0] * (values - len(sh))
+    words = (values + 1) // 2 if half else values
+    words = (words + 3) // 4 * 4
+    if half:
+        return struct.pack(f"<{2 * words}e", *(sh + [0.0] * (2 * words - values)))
+    return struct.pack(f"<{words}f", *(sh + [0.0] * (words - values)))
+
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("input", type=str, help="input JSON scene")
+    ap.add_argument("--out", type=str, default=None, help="output .sss path (default: input with .sss suffix)")
+    ap.add_argument("--compact", action="store_true", help="write 32-byte quantized records")
+    ap.add_argument("--sh-half", action="store_true", help="store SH coefficients as float16")
+    args = ap.parse_args()
+
+    in_path = Path(args.input)
+    out_path = Path(args.out) if args.out else in_path.with_suffix(".sss")
+
+    scene = json.loads(in_path.read_text(encoding="utf-8"))
+    gaussians = scene.get("gaussians")
+    if not isinstance(gaussians, list):
+        raise SystemExit(f"JSON missing 'gaussians' array: {in_path}")
+
+    payload_offset = (HEADER.size + PAYLOAD_ALIGN - 1) // PAYLOAD_ALIGN * PAYLOAD_ALIGN
+
+    record = COMPACT_RECORD if args.compact else RECORD
+    pack = pack_gaussian_compact if args.compact else pack_gaussian
+    flags = FLAG_COMPACT if args.compact else 0
+    sh_degree = max((sh_degree_for(len(g.get("sh", []))) for g in gaussians), default=0)
+    if sh_degree > 0:
+        flags |= sh_degree << SH_DEGREE_SHIFT
+        flags |= FLAG_SH_HALF if args.sh_half else 0
+
+    out_path.parent.mkdir(parents=True, exist_ok=True)
+    with out_path.open("wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, HEADER.size, record.size,
+                            len(gaussians), payload_offset, flags, 0))
+        f.write(b"\0" * (payload_offset - HEADER.size))
+        for item in gaussians:
+            f.write(pack(item))
+        if sh_degree > 0:
+            end = payload_offset + len(gaussians) * record.size
+            f.write(b"\0" * (-end % PAYLOAD_ALIGN))
+            for item in gaussians:
+                f.write(pack_sh(item, sh_degree, args.sh_half))
+
+    print(f"Wrote {len(gaussians)} gaussians to {out_path}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,18 @@
+# scripts/run_bench.ps1
+$ErrorActionPreference = "Stop"
+
+$Root = Resolve-Path (Join-Path $PSScriptRoot "..")
+$Build = Join-Path $Root "build"
+
+$Exe = Join-Path $Build "apps\bench\Release\bench.exe"
+if (-not (Test-Path $Exe)) {
+  $Exe = Join-Path $Build "apps\bench\Debug\bench.exe"
+}
+
+if (-not (Test-Path $Exe)) {
+  throw "bench.exe not found. Build first with scripts\build.ps1."
+}
+
+# Test scenes plus generated sizes, results as JSON next to the build
+Set-Location $Root
+& $Exe --out (Join-Path $Build "bench_results.json") @args
@@ -0,0 +1,82 @@
+#include "CameraPath.hpp"
+#include "Camera.hpp"
+#include <glm/gtc/constants.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace sss {
+
+CameraPath::CameraPath(std::vector<Keyframe> keyframes) : m_keyframes(std::move(keyframes)) {
+    std::stable_sort(m_keyframes.begin(), m_keyframes.end(),
+                     [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+}
+
+CameraPath CameraPath::load(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file) {
+        throw std::runtime_error("Failed to open camera path: " + filepath);
+    }
+
+    std::vector<Keyframe> keyframes;
+    try {
+        const nlohmann::json doc = nlohmann::json::parse(file);
+        for (const nlohmann::json& k : doc.at("keyframes")) {
+            Keyframe key;
+            key.time = k.at("t").get<float>();
+            const nlohmann::json& p = k.at("position");
+            key.position = glm::vec3(p.at(0).get<float>(), p.at(1).get<float>(), p.at(2).get<float>());
+            key.yaw = k.value("yaw", -90.f);
+            key.pitch = k.value("pitch", 0.f);
+            keyframes.push_back(key);
+        }
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("Invalid camera path " + filepath + ": " + e.what());
+    }
+    if (keyframes.empty()) {
+        throw std::runtime_error("Camera path has no keyframes: " + filepath);
+    }
+    return CameraPath(std::move(keyframes));
+}
+
+CameraPath CameraPath::orbit(const glm::vec3& center, float radius, float height, float duration, int steps) {
+    steps = std::max(steps, 2);
+    const float pitch = -glm::degrees(std::atan2(height, radius));
+
+    std::vector<Keyframe> keyframes;
+    keyframes.reserve((size_t)steps + 1);
+    for (int i = 0; i <= steps; ++i) {
+        const float u = (float)i / (float)steps;
+        const float angle = u * 2.f * glm::pi<float>();
+        Keyframe key;
+        key.time = u * duration;
+        key.position = center + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+        // Facing the center; yaw keeps increasing so interpolation never wraps
+        key.yaw = glm::degrees(angle) + 180.f;
+        key.pitch = pitch;
+        keyframes.push_back(key);
+    }
+    return CameraPath(std::move(keyframes));
+}
+
+void CameraPath::apply(float t, Camera& camera) const {
+    if (m_keyframes.empty()) {
+        return;
+    }
+    // First keyframe after t; poses before the first or after the last one clamp
+    const auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), t,
+                                       [](float time, const Keyframe& k) { return time < k.time; });
+    const Keyframe& a = next == m_keyframes.begin() ? *next : *(next - 1);
+    const Keyframe& b = next == m_keyframes.end() ? a : *next;
+
+    const float span = b.time - a.time;
+    const float u = span > 0.f ? std::clamp((t - a.time) / span, 0.f, 1.f) : 0.f;
+    camera.position = glm::mix(a.position, b.position, u);
+    camera.yaw = a.yaw + (b.yaw - a.yaw) * u;
+    camera.pitch = a.pitch + (b.pitch - a.pitch) * u;
+}
+
+}  // namespace sss
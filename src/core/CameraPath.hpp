@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace sss {
+
+class Camera;
+
+/**
+ * Scripted camera motion: keyframes of Camera::position, yaw and pitch,
+ * interpolated linearly in time. Used to replay identical fly-throughs,
+ * e.g. in the bench harness.
+ */
+class CameraPath {
+public:
+    struct Keyframe {
+        float time = 0.f;   // seconds from the start of the path
+        glm::vec3 position{0.f};
+        float yaw = -90.f;  // degrees, as in Camera
+        float pitch = 0.f;
+    };
+
+    CameraPath() = default;
+    explicit CameraPath(std::vector<Keyframe> keyframes);
+
+    /**
+     * Load keyframes from JSON:
+     * { "keyframes": [ { "t": s, "position": [x,y,z], "yaw": deg, "pitch": deg } ] }
+     * Keyframes are sorted by time.
+     *
+     * @throws std::runtime_error if the file cannot be read or is malformed
+     */
+    static CameraPath load(const std::string& filepath);
+
+    /**
+     * One full circle of `steps` keyframes around `center` at `radius`,
+     * `height` above it, always looking at the center.
+     */
+    static CameraPath orbit(const glm::vec3& center, float radius, float height, float duration, int steps = 16);
+
+    bool empty() const { return m_keyframes.empty(); }
+    float duration() const { return m_keyframes.empty() ? 0.f : m_keyframes.back().time; }
+    const std::vector<Keyframe>& keyframes() const { return m_keyframes; }
+
+    /**
+     * Set the camera pose at time `t`, clamped to the path's range.
+     */
+    void apply(float t, Camera& camera) const;
+
+private:
+    std::vector<Keyframe> m_keyframes;
+};
+
+}  // namespace sss
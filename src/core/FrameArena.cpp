@@ -0,0 +1,84 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+
+namespace sss {
+
+namespace {
+
+constexpr size_t kBlockAlignment = 64;   // cache line
+
+}  // namespace
+
+FrameArena::FrameArena(size_t initial_bytes, std::pmr::memory_resource* upstream) : m_upstream(upstream) {
+    add_block(std::max<size_t>(initial_bytes, kBlockAlignment));
+}
+
+FrameArena::~FrameArena() {
+    release_blocks();
+}
+
+void FrameArena::reset() {
+    // Coalesce an overflowed chain into one block that fits the peak
+    if (m_blocks.size() > 1) {
+        const size_t size = m_capacity;
+        release_blocks();
+        add_block(size);
+    }
+    m_offset = 0;
+    m_used = 0;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    auto align = [alignment](const Block& block, size_t offset) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        return (size_t)(((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+    };
+    size_t offset = align(m_blocks.back(), m_offset);
+    if (offset + bytes > m_blocks.back().size) {
+        add_block(std::max(bytes + alignment, m_blocks.back().size * 2));
+        offset = align(m_blocks.back(), 0);
+    }
+    m_used += offset - m_offset + bytes;
+    m_offset = offset + bytes;
+    m_high_water = std::max(m_high_water, m_used);
+    return m_blocks.back().data + offset;
+}
+
+void FrameArena::add_block(size_t bytes) {
+    Block block;
+    block.size = bytes;
+    block.data = static_cast<std::byte*>(m_upstream->allocate(bytes, kBlockAlignment));
+    m_blocks.push_back(block);
+    m_capacity += bytes;
+    m_offset = 0;
+    ++m_upstream_allocations;
+}
+
+void FrameArena::release_blocks() {
+    for (const Block& block : m_blocks) {
+        m_upstream->deallocate(block.data, block.size, kBlockAlignment);
+    }
+    m_blocks.clear();
+    m_capacity = 0;
+}
+
+FrameAllocator::FrameAllocator(size_t initial_bytes) : m_arenas{FrameArena(initial_bytes), FrameArena(initial_bytes)} {}
+
+void FrameAllocator::begin_frame() {
+    ++m_frame;
+    current().reset();
+}
+
+FrameArenaStats FrameAllocator::stats() const {
+    const FrameArena& current = m_arenas[m_frame & 1];
+    const FrameArena& previous = m_arenas[(m_frame + 1) & 1];
+    FrameArenaStats s;
+    s.used = current.used();
+    s.last_frame = previous.used();
+    s.high_water = std::max(current.high_water(), previous.high_water());
+    s.capacity = current.capacity() + previous.capacity();
+    s.upstream_allocations = current.upstream_allocations() + previous.upstream_allocations();
+    return s;
+}
+
+}  // namespace sss
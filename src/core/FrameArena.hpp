@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace sss {
+
+/**
+ * Linear allocator for memory that lives for one frame, usable as a
+ * std::pmr::memory_resource (e.g. for std::pmr::vector).
+ *
+ * Allocation bumps a pointer; deallocation does nothing; reset() frees
+ * everything at once. When a frame outgrows the arena, it chains a larger
+ * block from the upstream resource, and the next reset() replaces the
+ * chain with a single block that fits the high-water mark. After a few
+ * frames, a steady workload makes no upstream allocations at all.
+ *
+ * Not thread-safe: one thread allocates from an arena at a time.
+ */
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kDefaultBlockBytes = size_t(1) << 20;
+
+    explicit FrameArena(size_t initial_bytes = kDefaultBlockBytes,
+                        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * Release every allocation made since the last reset().
+     */
+    void reset();
+
+    size_t used() const { return m_used; }                 // bytes handed out since reset()
+    size_t high_water() const { return m_high_water; }     // most used between two resets
+    size_t capacity() const { return m_capacity; }         // bytes held from upstream
+    size_t blocks() const { return m_blocks.size(); }
+    uint64_t upstream_allocations() const { return m_upstream_allocations; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Block {
+        std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    std::pmr::memory_resource* m_upstream;
+    std::vector<Block> m_blocks;   // the last one is being filled
+    size_t m_offset = 0;           // into the last block
+    size_t m_used = 0;
+    size_t m_high_water = 0;
+    size_t m_capacity = 0;
+    uint64_t m_upstream_allocations = 0;
+
+    void add_block(size_t bytes);
+    void release_blocks();
+};
+
+/**
+ * Snapshot of a FrameAllocator, for display.
+ */
+struct FrameArenaStats {
+    size_t used = 0;          // this frame so far
+    size_t last_frame = 0;    // the frame before
+    size_t high_water = 0;    // most any frame has used
+    size_t capacity = 0;      // held by both arenas
+    uint64_t upstream_allocations = 0;
+};
+
+/**
+ * Two FrameArenas used on alternate frames. begin_frame() resets the
+ * arena of two frames ago, so memory from frame N remains valid while
+ * frame N + 1 is built. That covers work that overlaps the next frame,
+ * e.g. a mapping thread reading the last frame's output.
+ */
+class FrameAllocator {
+public:
+    explicit FrameAllocator(size_t initial_bytes = FrameArena::kDefaultBlockBytes);
+
+    void begin_frame();
+
+    FrameArena& current() { return m_arenas[m_frame & 1]; }
+    FrameArena& previous() { return m_arenas[(m_frame + 1) & 1]; }
+
+    FrameArenaStats stats() const;
+
+private:
+    FrameArena m_arenas[2];
+    uint64_t m_frame = 0;
+};
+
+}  // namespace sss
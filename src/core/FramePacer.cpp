@@ -0,0 +1,115 @@
+#include "FramePacer.hpp"
+#include "Time.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace sss {
+
+namespace {
+
+// Exponential smoothing for the overlay readouts
+float smooth(float current, double sample) {
+    return current == 0.f ? (float)sample : 0.9f * current + 0.1f * (float)sample;
+}
+
+}  // namespace
+
+const char* present_mode_name(PresentMode mode) {
+    switch (mode) {
+        case PresentMode::Vsync: return "vsync";
+        case PresentMode::Uncapped: return "uncapped";
+        case PresentMode::Fixed: return "fixed";
+    }
+    return "unknown";
+}
+
+void FramePacer::set_mode(PresentMode mode) {
+    if (mode != m_mode) {
+        m_mode = mode;
+        m_have_deadline = false;
+        m_latency_ms = m_work_ms = m_idle_ms = 0.f;
+    }
+}
+
+void FramePacer::set_target_fps(float fps) {
+    m_target_fps = std::clamp(fps, 1.f, 1000.f);
+    m_have_deadline = false;
+}
+
+void FramePacer::set_refresh_rate(float hz) {
+    if (hz > 0.f) {
+        m_refresh_hz = hz;
+    }
+}
+
+void FramePacer::wait() {
+    if (m_mode != PresentMode::Fixed) {
+        m_idle_ms = 0.f;
+        return;
+    }
+
+    const double period = 1.0 / (double)m_target_fps;
+    const double start = Time::now();
+    if (!m_have_deadline) {
+        m_deadline = start;
+        m_have_deadline = true;
+    }
+
+    // Deadlines advance by whole periods so the average rate is exact; a
+    // frame that overran by more than a period restarts the schedule rather
+    // than rushing several frames out to catch up
+    if (start > m_deadline + period) {
+        m_deadline = start;
+    }
+    precise_wait_until(m_deadline);
+    m_deadline += period;
+
+    m_idle_ms = smooth(m_idle_ms, 1000.0 * (Time::now() - start));
+}
+
+void FramePacer::precise_wait_until(double deadline) {
+    for (;;) {
+        const double remaining = 1000.0 * (deadline - Time::now());
+        if (remaining <= m_sleep_mean + 2.0 * std::sqrt(m_sleep_var)) {
+            break;
+        }
+
+        const double before = Time::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const double slept = 1000.0 * (Time::now() - before);
+
+        // Running average over all samples at first, then over roughly the
+        // last hundred, so a change in timer resolution is picked up
+        m_sleep_count = std::min(m_sleep_count + 1, 100L);
+        const double alpha = 1.0 / (double)m_sleep_count;
+        const double delta = slept - m_sleep_mean;
+        m_sleep_mean += alpha * delta;
+        m_sleep_var = (1.0 - alpha) * (m_sleep_var + alpha * delta * delta);
+    }
+
+    while (Time::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::mark_input() {
+    m_input = Time::now();
+    m_have_input = true;
+}
+
+void FramePacer::mark_presented() {
+    if (!m_have_input) {
+        return;
+    }
+    m_have_input = false;
+
+    const double work = 1000.0 * (Time::now() - m_input);
+    const double refresh = 1000.0 / (double)m_refresh_hz;
+    const double scanout = m_mode == PresentMode::Vsync ? refresh : 0.5 * refresh;
+    m_work_ms = smooth(m_work_ms, work);
+    m_latency_ms = smooth(m_latency_ms, work + scanout);
+}
+
+}  // namespace sss
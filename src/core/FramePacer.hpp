@@ -0,0 +1,113 @@
+#pragma once
+
+namespace sss {
+
+/**
+ * How finished frames are presented.
+ */
+enum class PresentMode {
+    Vsync,      // swap interval 1; the display refresh paces the loop
+    Uncapped,   // swap interval 0; render as fast as possible
+    Fixed       // swap interval 0; the pacer holds a target frame rate
+};
+
+const char* present_mode_name(PresentMode mode);
+
+/**
+ * Frame scheduler for the main loop.
+ *
+ * Each frame runs wait() -> poll input -> mark_input() -> update/render ->
+ * swap -> mark_presented(). In PresentMode::Fixed, wait() blocks until the
+ * next frame deadline, coarse-sleeping while well ahead and spinning the
+ * last stretch, so deadlines are hit to within tens of microseconds when the
+ * OS sleep is coarse (~1 ms on Linux, up to ~15 ms on Windows). Waiting
+ * before input is sampled, rather than after the swap, keeps the idle time
+ * out of the input-to-photon path.
+ *
+ * Latency is estimated per frame as input sample -> swap returned, plus the
+ * average scanout delay: half a refresh when swaps are immediate, a full
+ * refresh under vsync, where the image waits for the next vblank. Neither
+ * driver frame queuing nor display processing is visible from here, so this
+ * is a lower bound.
+ *
+ * Times come from Time::now(). The pacer only decides; the caller applies
+ * swap_interval() to the context.
+ */
+class FramePacer {
+public:
+    void set_mode(PresentMode mode);
+    PresentMode mode() const { return m_mode; }
+
+    /**
+     * Frame rate held in PresentMode::Fixed, clamped to [1, 1000].
+     */
+    void set_target_fps(float fps);
+    float target_fps() const { return m_target_fps; }
+
+    /**
+     * Display refresh rate used by the latency estimate (Hz).
+     */
+    void set_refresh_rate(float hz);
+    float refresh_rate() const { return m_refresh_hz; }
+
+    /**
+     * Swap interval the mode needs: 1 for vsync, 0 otherwise.
+     */
+    int swap_interval() const { return m_mode == PresentMode::Vsync ? 1 : 0; }
+
+    /**
+     * Block until the next frame is due (no-op unless PresentMode::Fixed).
+     */
+    void wait();
+
+    /**
+     * Input for this frame has just been sampled.
+     */
+    void mark_input();
+
+    /**
+     * The swap for this frame has returned.
+     */
+    void mark_presented();
+
+    /**
+     * Smoothed input-to-photon estimate (ms).
+     */
+    float latency_ms() const { return m_latency_ms; }
+
+    /**
+     * Smoothed time from input to swap return (ms): the loop's own work,
+     * including any blocking inside the swap.
+     */
+    float work_ms() const { return m_work_ms; }
+
+    /**
+     * Smoothed time spent in wait() per frame (ms).
+     */
+    float idle_ms() const { return m_idle_ms; }
+
+private:
+    // Sleep in 1 ms requests until the remaining time falls under the
+    // typical cost of one of them, then spin
+    void precise_wait_until(double deadline);
+
+    PresentMode m_mode = PresentMode::Vsync;
+    float m_target_fps = 60.f;
+    float m_refresh_hz = 60.f;
+
+    double m_deadline = 0.0;   // Time::now() seconds
+    double m_input = 0.0;
+    bool m_have_deadline = false;
+    bool m_have_input = false;
+
+    // Running mean/variance of how long a 1 ms sleep actually takes (ms)
+    double m_sleep_mean = 1.0;
+    double m_sleep_var = 0.0;
+    long m_sleep_count = 1;
+
+    float m_latency_ms = 0.f;
+    float m_work_ms = 0.f;
+    float m_idle_ms = 0.f;
+};
+
+}  // namespace sss
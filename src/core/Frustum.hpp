@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace sss {
+
+/**
+ * View frustum as six inward-facing planes (xyz = unit normal, w = offset),
+ * in the order left, right, bottom, top, near, far. A point p is inside a
+ * plane when dot(plane.xyz, p) + plane.w >= 0.
+ */
+struct Frustum {
+    glm::vec4 planes[6];
+
+    /**
+     * Extract world-space planes from projection * view (Gribb & Hartmann),
+     * for OpenGL clip space (-w <= x, y, z <= w).
+     */
+    static Frustum from_matrix(const glm::mat4& view_projection) {
+        const glm::mat4& m = view_projection;
+        // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const glm::vec4 r0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        const glm::vec4 r1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        const glm::vec4 r2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        const glm::vec4 r3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        Frustum f;
+        f.planes[0] = r3 + r0;
+        f.planes[1] = r3 - r0;
+        f.planes[2] = r3 + r1;
+        f.planes[3] = r3 - r1;
+        f.planes[4] = r3 + r2;
+        f.planes[5] = r3 - r2;
+        for (glm::vec4& p : f.planes) {
+            const float len = glm::length(glm::vec3(p));
+            if (len > 0.f) {
+                p /= len;
+            }
+        }
+        return f;
+    }
+
+    /**
+     * True unless the sphere lies entirely outside some plane.
+     */
+    bool intersects_sphere(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& p : planes) {
+            if (glm::dot(glm::vec3(p), center) + p.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Classify an axis-aligned box: -1 outside, 0 intersecting, 1 fully inside.
+     */
+    int classify_box(const glm::vec3& lo, const glm::vec3& hi) const {
+        int result = 1;
+        for (const glm::vec4& p : planes) {
+            // Box corners furthest along and against the plane normal
+            const glm::vec3 far_corner(p.x >= 0.f ? hi.x : lo.x, p.y >= 0.f ? hi.y : lo.y, p.z >= 0.f ? hi.z : lo.z);
+            const glm::vec3 near_corner(p.x >= 0.f ? lo.x : hi.x, p.y >= 0.f ? lo.y : hi.y, p.z >= 0.f ? lo.z : hi.z);
+            if (glm::dot(glm::vec3(p), far_corner) + p.w < 0.f) {
+                return -1;
+            }
+            if (glm::dot(glm::vec3(p), near_corner) + p.w < 0.f) {
+                result = 0;
+            }
+        }
+        return result;
+    }
+};
+
+}  // namespace sss
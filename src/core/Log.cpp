@@ -1,12 +1,263 @@
 #include <src/core/Log.hpp>
+#include <src/core/Time.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdio>
-#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace sss {
 
+namespace {
+
+// Longest a queued message waits for the sink while the backlog is small
+constexpr auto kSinkIdleInterval = std::chrono::milliseconds(5);
+
+// Queued messages at which a producer wakes the sink early
+constexpr uint64_t kWakeBacklog = Log::kRingSlots / 4;
+
+struct Record {
+    // Slot n may be written once this equals n and read once it equals
+    // n + 1; the sink sets it to n + kRingSlots when done
+    std::atomic<uint64_t> sequence{0};
+    Log::Level level = Log::Level::Info;
+    uint32_t thread = 0;
+    double time = 0.0;
+    char text[Log::kMessageBytes];
+};
+
+const char* level_name(Log::Level level) {
+    switch (level) {
+        case Log::Level::Debug:   return "DEBUG";
+        case Log::Level::Info:    return "INFO";
+        case Log::Level::Warning: return "WARN";
+        case Log::Level::Error:   return "ERROR";
+        default:                  return "UNKNOWN";
+    }
+}
+
+// Small per-thread number for the output, in order of first message
+uint32_t thread_number() {
+    static std::atomic<uint32_t> next{0};
+    thread_local const uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+class Sink {
+public:
+    Sink() : m_records(std::make_unique<Record[]>(Log::kRingSlots)) {
+        for (size_t i = 0; i < Log::kRingSlots; ++i) {
+            m_records[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_running.store(true, std::memory_order_release);
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ~Sink() { stop(); }
+
+    void stop() {
+        std::lock_guard<std::mutex> control(m_control);
+        if (!m_thread.joinable()) {
+            return;
+        }
+        // Sequentially consistent with m_pushing in push(): a push either
+        // sees the flag down and writes synchronously, or is counted here
+        m_running.store(false);
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_wake.notify_one();
+        }
+        m_thread.join();
+        while (m_pushing.load() != 0) {
+            std::this_thread::yield();
+        }
+        // Every claimed slot is published now
+        while (m_dequeue != m_enqueue.load(std::memory_order_acquire)) {
+            if (drain() == 0) {
+                std::this_thread::yield();
+            }
+        }
+        drain();   // reports drops even when nothing was queued
+    }
+
+    bool running() const { return m_running.load(std::memory_order_acquire); }
+
+    void push(Log::Level level, const char* fmt, va_list args) {
+        m_pushing.fetch_add(1);
+        if (!m_running.load()) {
+            m_pushing.fetch_sub(1, std::memory_order_release);
+            write_now(level, fmt, args);
+            return;
+        }
+        uint64_t pos = m_enqueue.load(std::memory_order_relaxed);
+        Record* record = nullptr;
+        for (;;) {
+            record = &m_records[pos % Log::kRingSlots];
+            const uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+            if (sequence == pos) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (sequence < pos) {
+                // The sink hasn't freed this slot yet: the ring is full.
+                // Warnings and errors are written now, out of order, rather
+                // than lost; the rest is dropped
+                m_pushing.fetch_sub(1, std::memory_order_release);
+                wake();
+                if (level >= Log::Level::Warning) {
+                    write_now(level, fmt, args);
+                } else {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                return;
+            } else {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+        record->level = level;
+        record->thread = thread_number();
+        record->time = Time::now();
+        std::vsnprintf(record->text, sizeof(record->text), fmt, args);
+        record->sequence.store(pos + 1, std::memory_order_release);
+        m_pushing.fetch_sub(1, std::memory_order_release);
+        if (pos + 1 - m_written.load(std::memory_order_relaxed) >= kWakeBacklog) {
+            wake();
+        }
+    }
+
+    void flush() {
+        const uint64_t target = m_enqueue.load(std::memory_order_acquire);
+        if (m_written.load() >= target) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake_pending.store(true, std::memory_order_relaxed);
+        m_wake.notify_one();
+        // Sequentially consistent with m_written in drain(): either the
+        // predicate sees the write or the sink sees a flush waiting
+        m_flushing.fetch_add(1);
+        m_flushed.wait(lock, [&]() { return m_written.load() >= target; });
+        m_flushing.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<Record[]> m_records;
+    alignas(64) std::atomic<uint64_t> m_enqueue{0};
+    alignas(64) std::atomic<uint64_t> m_written{0};   // messages the sink has written
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint32_t> m_pushing{0};    // pushes between the flag check and publishing
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+    std::mutex m_control;   // start and stop only
+
+    // Wakes the sink early and the threads waiting in flush()
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    std::atomic<bool> m_wake_pending{false};
+    std::atomic<uint32_t> m_flushing{0};
+
+    // Sink thread only
+    uint64_t m_dequeue = 0;
+    uint64_t m_reported_dropped = 0;
+    char m_batch[16 * 1024];
+
+    void run() {
+        while (running()) {
+            drain();
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            m_wake.wait_for(lock, kSinkIdleInterval, [this]() {
+                return m_wake_pending.load(std::memory_order_relaxed) || !running();
+            });
+            m_wake_pending.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Called by producers; only the first since the sink last woke locks
+    void wake() {
+        if (m_wake_pending.load(std::memory_order_relaxed) ||
+            m_wake_pending.exchange(true, std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_wake.notify_one();
+    }
+
+    // Write every message published in order so far, in batches of whole
+    // lines; returns how many there were
+    size_t drain() {
+        size_t count = 0;
+        size_t used = 0;
+        for (;;) {
+            Record& record = m_records[m_dequeue % Log::kRingSlots];
+            if (record.sequence.load(std::memory_order_acquire) != m_dequeue + 1) {
+                break;
+            }
+            if (sizeof(m_batch) - used < Log::kMessageBytes + 64) {
+                std::fwrite(m_batch, 1, used, stderr);
+                used = 0;
+            }
+            const int n = std::snprintf(m_batch + used, sizeof(m_batch) - used, "[%10.4f] [%s] [T%u] %s\n",
+                                        record.time, level_name(record.level), record.thread, record.text);
+            used += n > 0 ? (size_t)n : 0;
+            record.sequence.store(m_dequeue + Log::kRingSlots, std::memory_order_release);
+            ++m_dequeue;
+            ++count;
+        }
+        // Say where messages went missing
+        const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_reported_dropped && sizeof(m_batch) - used >= 64) {
+            const int n = std::snprintf(m_batch + used, sizeof(m_batch) - used,
+                                        "[%10.4f] [WARN] [Log] %llu messages dropped, ring full\n", Time::now(),
+                                        (unsigned long long)(dropped - m_reported_dropped));
+            used += n > 0 ? (size_t)n : 0;
+            m_reported_dropped = dropped;
+        }
+        if (used > 0) {
+            std::fwrite(m_batch, 1, used, stderr);
+            std::fflush(stderr);
+            m_written.fetch_add(count);
+            if (m_flushing.load() != 0) {
+                std::lock_guard<std::mutex> lock(m_wake_mutex);
+                m_flushed.notify_all();
+            }
+        }
+        return count;
+    }
+
+    static void write_now(Log::Level level, const char* fmt, va_list args) {
+        char text[Log::kMessageBytes];
+        std::vsnprintf(text, sizeof(text), fmt, args);
+        std::fprintf(stderr, "[%10.4f] [%s] [T%u] %s\n", Time::now(), level_name(level), thread_number(), text);
+    }
+};
+
+Sink& sink() {
+    static Sink instance;
+    return instance;
+}
+
+}  // namespace
+
 void Log::init() {
-    // Could add file logging or other setup here
+    sink();
+}
+
+void Log::shutdown() {
+    sink().stop();
+}
+
+void Log::flush() {
+    sink().flush();
+}
+
+uint64_t Log::dropped() {
+    return sink().dropped();
 }
 
 void Log::debug(const char* fmt, ...) {
@@ -38,19 +289,11 @@ void Log::error(const char* fmt, ...) {
 }
 
 void Log::log(Level level, const char* fmt, va_list args) {
-    std::fprintf(stderr, "[%s] ", level_to_string(level));
-    std::vfprintf(stderr, fmt, args);
-    std::fprintf(stderr, "\n");
+    sink().push(level, fmt, args);
 }
 
 const char* Log::level_to_string(Level level) {
-    switch (level) {
-        case Level::Debug:   return "DEBUG";
-        case Level::Info:    return "INFO";
-        case Level::Warning: return "WARN";
-        case Level::Error:   return "ERROR";
-        default:             return "UNKNOWN";
-    }
+    return level_name(level);
 }
 
 }  // namespace sss
@@ -1,10 +1,46 @@
 #pragma once
 
-#include <cstdio>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+// Levels for SSS_LOG_LEVEL: SSS_LOG_* calls below it compile to nothing and
+// don't evaluate their arguments. Defaults to DEBUG, or INFO with NDEBUG.
+#define SSS_LOG_LEVEL_DEBUG 0
+#define SSS_LOG_LEVEL_INFO 1
+#define SSS_LOG_LEVEL_WARNING 2
+#define SSS_LOG_LEVEL_ERROR 3
+#define SSS_LOG_LEVEL_OFF 4
+
+#ifndef SSS_LOG_LEVEL
+#ifdef NDEBUG
+#define SSS_LOG_LEVEL SSS_LOG_LEVEL_INFO
+#else
+#define SSS_LOG_LEVEL SSS_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SSS_PRINTF_FORMAT(fmt_index, first_arg) __attribute__((format(printf, fmt_index, first_arg)))
+#else
+#define SSS_PRINTF_FORMAT(fmt_index, first_arg)
+#endif
+
 namespace sss {
 
+/**
+ * Asynchronous logger, safe to call from any thread at any rate.
+ *
+ * A message is formatted on the calling thread straight into a slot of a
+ * fixed ring, claimed with one CAS (a bounded lock-free MPSC queue), and
+ * stamped with Time::now() and the thread's number. A sink thread writes
+ * queued messages to stderr in batches, so callers never contend on the
+ * stderr lock or wait on the terminal. The sink wakes every few
+ * milliseconds, or as soon as a quarter of the ring is queued. If the ring
+ * is full, warnings and errors are written synchronously and debug and
+ * info messages are dropped and counted, so the caller never blocks.
+ */
 class Log {
 public:
     enum class Level {
@@ -14,12 +50,32 @@ public:
         Error
     };
 
+    static constexpr size_t kRingSlots = 1024;
+    static constexpr size_t kMessageBytes = 240;   // longer messages are truncated
+
+    /**
+     * Start the sink thread; the first message also starts it.
+     */
     static void init();
-    
-    static void debug(const char* fmt, ...);
-    static void info(const char* fmt, ...);
-    static void warning(const char* fmt, ...);
-    static void error(const char* fmt, ...);
+
+    /**
+     * Write out everything queued and stop the sink thread. Later messages
+     * are written synchronously.
+     */
+    static void shutdown();
+
+    /**
+     * Block until every message queued so far has been written.
+     */
+    static void flush();
+
+    // Debug and info messages lost to a full ring
+    static uint64_t dropped();
+
+    static void debug(const char* fmt, ...) SSS_PRINTF_FORMAT(1, 2);
+    static void info(const char* fmt, ...) SSS_PRINTF_FORMAT(1, 2);
+    static void warning(const char* fmt, ...) SSS_PRINTF_FORMAT(1, 2);
+    static void error(const char* fmt, ...) SSS_PRINTF_FORMAT(1, 2);
 
 private:
     static void log(Level level, const char* fmt, va_list args);
@@ -28,8 +84,32 @@ private:
 
 }  // namespace sss
 
-// Convenience macros
+// Convenience macros. A disabled level is still type-checked but never
+// evaluated, so it costs nothing and leaves no unused variables behind.
+#define SSS_LOG_DISCARD(fn, ...)       \
+    do {                               \
+        if (false) {                   \
+            sss::Log::fn(__VA_ARGS__); \
+        }                              \
+    } while (0)
+
+#if SSS_LOG_LEVEL <= SSS_LOG_LEVEL_DEBUG
 #define SSS_LOG_DEBUG(...) sss::Log::debug(__VA_ARGS__)
+#else
+#define SSS_LOG_DEBUG(...) SSS_LOG_DISCARD(debug, __VA_ARGS__)
+#endif
+#if SSS_LOG_LEVEL <= SSS_LOG_LEVEL_INFO
 #define SSS_LOG_INFO(...) sss::Log::info(__VA_ARGS__)
+#else
+#define SSS_LOG_INFO(...) SSS_LOG_DISCARD(info, __VA_ARGS__)
+#endif
+#if SSS_LOG_LEVEL <= SSS_LOG_LEVEL_WARNING
 #define SSS_LOG_WARN(...) sss::Log::warning(__VA_ARGS__)
+#else
+#define SSS_LOG_WARN(...) SSS_LOG_DISCARD(warning, __VA_ARGS__)
+#endif
+#if SSS_LOG_LEVEL <= SSS_LOG_LEVEL_ERROR
 #define SSS_LOG_ERROR(...) sss::Log::error(__VA_ARGS__)
+#else
+#define SSS_LOG_ERROR(...) SSS_LOG_DISCARD(error, __VA_ARGS__)
+#endif
@@ -0,0 +1,147 @@
+#include "MappedFile.hpp"
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sss {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& filepath) {
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to stat file: " + filepath);
+    }
+    m_file = file;
+    m_size = (size_t)size.QuadPart;
+    if (m_size == 0) {
+        return;   // nothing to map; data() stays null
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        throw std::runtime_error("Failed to map file: " + filepath);
+    }
+    m_mapping = mapping;
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        close();
+        throw std::runtime_error("Failed to map file: " + filepath);
+    }
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle((HANDLE)m_mapping);
+    }
+    if (m_file) {
+        CloseHandle((HANDLE)m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_file(std::exchange(other.m_file, nullptr)),
+      m_mapping(std::exchange(other.m_mapping, nullptr)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+    }
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath) {
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + filepath);
+    }
+    m_size = (size_t)st.st_size;
+    if (m_size == 0) {
+        ::close(fd);
+        return;   // nothing to map; data() stays null
+    }
+
+    void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // the mapping keeps its own reference
+    if (p == MAP_FAILED) {
+        m_size = 0;
+        throw std::runtime_error("Failed to map file: " + filepath);
+    }
+    ::madvise(p, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(p);
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+}  // namespace sss
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sss {
+
+/**
+ * Read-only memory mapping of a whole file.
+ * Pages are faulted in from the OS page cache on first touch, so large
+ * files can be consumed without an intermediate read buffer.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * Map a file; throws std::runtime_error if it cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool is_open() const { return m_data != nullptr; }
+
+    void close();
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;      // HANDLE
+    void* m_mapping = nullptr;   // HANDLE
+#endif
+};
+
+}  // namespace sss
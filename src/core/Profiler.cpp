@@ -0,0 +1,88 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace sss {
+
+namespace {
+
+// Sample at quantile q of values (reordered in place)
+float percentile(std::vector<float>& values, float q) {
+    if (values.empty()) {
+        return 0.f;
+    }
+    const size_t k = std::min(values.size() - 1, (size_t)(q * (float)(values.size() - 1) + 0.5f));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+}  // namespace
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+uint32_t Profiler::pass_id(const char* name, Domain domain) {
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        if (m_passes[i].domain == domain && std::strcmp(m_passes[i].name, name) == 0) {
+            return (uint32_t)i;
+        }
+    }
+    if (m_passes.size() == kMaxPasses) {
+        return kMaxPasses;
+    }
+    Pass pass;
+    pass.name = name;
+    pass.domain = domain;
+    m_passes.push_back(pass);
+    return (uint32_t)(m_passes.size() - 1);
+}
+
+void Profiler::new_frame() {
+    const auto now = std::chrono::steady_clock::now();
+    if (!enabled()) {
+        m_frame_start = now;
+        return;
+    }
+
+    if (m_frame_start != std::chrono::steady_clock::time_point{}) {
+        // Close the frame that just ended
+        const size_t slot = m_frames % kHistory;
+        m_frame_history[slot] = std::chrono::duration<float, std::milli>(now - m_frame_start).count();
+        for (size_t i = 0; i < m_passes.size(); ++i) {
+            m_passes[i].history[slot] = m_current[i];
+        }
+        ++m_frames;
+        update_stats();
+    }
+    m_current.fill(0.f);
+    m_frame_start = now;
+}
+
+void Profiler::update_stats() {
+    const size_t count = std::min(m_frames, kHistory);
+    const size_t oldest = m_frames - count;
+
+    m_frame_plot.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_frame_plot[i] = m_frame_history[(oldest + i) % kHistory];
+    }
+    m_scratch.assign(m_frame_plot.begin(), m_frame_plot.end());
+    m_frame_p50 = percentile(m_scratch, 0.50f);
+    m_frame_p99 = percentile(m_scratch, 0.99f);
+
+    m_stats.resize(m_passes.size());
+    for (size_t p = 0; p < m_passes.size(); ++p) {
+        const Pass& pass = m_passes[p];
+        m_scratch.assign(pass.history.begin(), pass.history.begin() + count);
+        PassStats& stats = m_stats[p];
+        stats.name = pass.name;
+        stats.domain = pass.domain;
+        stats.last_ms = pass.history[(m_frames - 1) % kHistory];
+        stats.p50_ms = percentile(m_scratch, 0.50f);
+        stats.p99_ms = percentile(m_scratch, 0.99f);
+    }
+}
+
+}  // namespace sss
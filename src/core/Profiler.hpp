@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Instrumentation is compiled in unless the build defines SSS_PROFILER=0;
+// with it off the scope macros expand to nothing
+#ifndef SSS_PROFILER
+#define SSS_PROFILER 1
+#endif
+
+namespace sss {
+
+/**
+ * Per-frame timing of named passes, for the debug overlay.
+ *
+ * CPU passes are timed by CpuScope (SSS_PROFILE_SCOPE); GPU passes are
+ * reported by GpuTimer, a few frames late, as its queries complete. Each
+ * pass keeps a ring of its per-frame totals over the last kHistory frames,
+ * from which the overlay reads p50/p99.
+ *
+ * Recording is main-thread only.
+ */
+class Profiler {
+public:
+    static constexpr size_t kHistory = 240;    // frames
+    static constexpr size_t kMaxPasses = 32;
+
+    enum class Domain {
+        Cpu,
+        Gpu
+    };
+
+    struct PassStats {
+        const char* name = nullptr;
+        Domain domain = Domain::Cpu;
+        float last_ms = 0.f;
+        float p50_ms = 0.f;
+        float p99_ms = 0.f;
+    };
+
+    static Profiler& instance();
+
+    /**
+     * Runtime switch; while disabled scopes record nothing.
+     */
+    void set_enabled(bool enabled) { m_enabled = enabled; }
+    bool enabled() const { return SSS_PROFILER && m_enabled; }
+
+    /**
+     * Close the current frame record and start the next one. Call once per
+     * frame, at the top of the loop.
+     */
+    void new_frame();
+
+    /**
+     * Id for a pass name; `name` must outlive the profiler (a literal).
+     * Returns kMaxPasses once the table is full.
+     */
+    uint32_t pass_id(const char* name, Domain domain);
+
+    /**
+     * Add `ms` to the pass's total for the current frame.
+     */
+    void record(uint32_t pass, double ms) {
+        if (pass < kMaxPasses) {
+            m_current[pass] += (float)ms;
+        }
+    }
+
+    /**
+     * Frame-to-frame times of the last frames, oldest first.
+     */
+    const std::vector<float>& frame_times() const { return m_frame_plot; }
+
+    float frame_p50() const { return m_frame_p50; }
+    float frame_p99() const { return m_frame_p99; }
+
+    /**
+     * Statistics of every registered pass, in registration order.
+     */
+    const std::vector<PassStats>& passes() const { return m_stats; }
+
+private:
+    struct Pass {
+        const char* name = nullptr;
+        Domain domain = Domain::Cpu;
+        std::array<float, kHistory> history{};
+    };
+
+    bool m_enabled = true;
+    size_t m_frames = 0;          // completed frame records
+    std::chrono::steady_clock::time_point m_frame_start{};
+
+    std::vector<Pass> m_passes;
+    std::array<float, kMaxPasses> m_current{};
+    std::array<float, kHistory> m_frame_history{};
+
+    // Derived once per frame for the overlay
+    std::vector<float> m_frame_plot;
+    float m_frame_p50 = 0.f;
+    float m_frame_p99 = 0.f;
+    std::vector<PassStats> m_stats;
+    std::vector<float> m_scratch;
+
+    void update_stats();
+};
+
+/**
+ * Times the enclosing C++ scope as a CPU pass.
+ */
+class CpuScope {
+public:
+    explicit CpuScope(uint32_t pass) {
+        if (Profiler::instance().enabled()) {
+            m_pass = pass;
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~CpuScope() {
+        if (m_pass != Profiler::kMaxPasses) {
+            const auto end = std::chrono::steady_clock::now();
+            Profiler::instance().record(m_pass, std::chrono::duration<double, std::milli>(end - m_start).count());
+        }
+    }
+
+    CpuScope(const CpuScope&) = delete;
+    CpuScope& operator=(const CpuScope&) = delete;
+
+private:
+    uint32_t m_pass = Profiler::kMaxPasses;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+}  // namespace sss
+
+#define SSS_PROFILE_CONCAT_(a, b) a##b
+#define SSS_PROFILE_CONCAT(a, b) SSS_PROFILE_CONCAT_(a, b)
+
+#if SSS_PROFILER
+// Time the rest of the enclosing scope as CPU pass `name` (a string literal)
+#define SSS_PROFILE_SCOPE(name)                                                                          \
+    static const uint32_t SSS_PROFILE_CONCAT(sss_pass_, __LINE__) =                                      \
+        ::sss::Profiler::instance().pass_id(name, ::sss::Profiler::Domain::Cpu);                        \
+    ::sss::CpuScope SSS_PROFILE_CONCAT(sss_scope_, __LINE__)(SSS_PROFILE_CONCAT(sss_pass_, __LINE__))
+#else
+#define SSS_PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,105 @@
+#include "RadixSort.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <array>
+
+namespace sss {
+
+namespace {
+
+constexpr size_t kRadix = 256;
+constexpr size_t kMinChunk = 1 << 16;   // below this, threading costs more than it saves
+
+using Histogram = std::array<uint32_t, kRadix>;
+
+}  // namespace
+
+void radix_sort_pairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values,
+                      std::vector<uint32_t>& scratch_keys, std::vector<uint32_t>& scratch_values,
+                      ThreadPool* pool) {
+    const size_t n = keys.size();
+    if (n < 2) {
+        return;
+    }
+    scratch_keys.resize(n);
+    scratch_values.resize(n);
+
+    // Fixed chunk partition so histogram and scatter see the same ranges,
+    // which is what keeps the sort stable across chunks
+    size_t chunk_count = 1;
+    if (pool && n >= 2 * kMinChunk) {
+        chunk_count = std::min(pool->thread_count() + 1, n / kMinChunk);
+    }
+    const size_t chunk_size = (n + chunk_count - 1) / chunk_count;
+    std::vector<Histogram> offsets(chunk_count);
+
+    auto for_each_chunk = [&](const auto& fn) {
+        if (chunk_count == 1) {
+            fn(0);
+            return;
+        }
+        pool->parallel_for(chunk_count, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                fn(c);
+            }
+        });
+    };
+
+    uint32_t* src_keys = keys.data();
+    uint32_t* src_values = values.data();
+    uint32_t* dst_keys = scratch_keys.data();
+    uint32_t* dst_values = scratch_values.data();
+
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        for_each_chunk([&](size_t c) {
+            Histogram& h = offsets[c];
+            h.fill(0);
+            const size_t end = std::min(n, (c + 1) * chunk_size);
+            for (size_t i = c * chunk_size; i < end; ++i) {
+                ++h[(src_keys[i] >> shift) & 0xFFu];
+            }
+        });
+
+        // Turn per-chunk counts into per-chunk output offsets (digit-major)
+        uint32_t running = 0;
+        bool trivial = false;
+        for (size_t d = 0; d < kRadix; ++d) {
+            uint32_t digit_total = 0;
+            for (size_t c = 0; c < chunk_count; ++c) {
+                const uint32_t count = offsets[c][d];
+                offsets[c][d] = running + digit_total;
+                digit_total += count;
+            }
+            if (digit_total == n) {
+                trivial = true;
+                break;
+            }
+            running += digit_total;
+        }
+        if (trivial) {
+            continue;   // every key shares this digit; the pass would be a copy
+        }
+
+        for_each_chunk([&](size_t c) {
+            Histogram& o = offsets[c];
+            const size_t end = std::min(n, (c + 1) * chunk_size);
+            for (size_t i = c * chunk_size; i < end; ++i) {
+                const uint32_t k = src_keys[i];
+                const uint32_t dst = o[(k >> shift) & 0xFFu]++;
+                dst_keys[dst] = k;
+                dst_values[dst] = src_values[i];
+            }
+        });
+
+        std::swap(src_keys, dst_keys);
+        std::swap(src_values, dst_values);
+    }
+
+    // An odd number of executed passes leaves the result in the scratch arrays
+    if (src_keys != keys.data()) {
+        keys.swap(scratch_keys);
+        values.swap(scratch_values);
+    }
+}
+
+}  // namespace sss
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace sss {
+
+class ThreadPool;
+
+/**
+ * Stable LSD radix sort of 32-bit (key, value) pairs, ascending by key.
+ * Four 8-bit passes; each pass histograms and scatters contiguous chunks
+ * on the pool. Passes whose digit is identical for every key are skipped.
+ *
+ * @param keys Keys to sort (sorted in place)
+ * @param values Payload permuted alongside the keys
+ * @param scratch_keys Reusable scratch, resized as needed
+ * @param scratch_values Reusable scratch, resized as needed
+ * @param pool Pool to run on; nullptr sorts on the calling thread
+ */
+void radix_sort_pairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values,
+                      std::vector<uint32_t>& scratch_keys, std::vector<uint32_t>& scratch_values,
+                      ThreadPool* pool);
+
+/**
+ * Map a float to a uint32 whose unsigned order matches the float order.
+ */
+inline uint32_t float_to_sortable_key(float f) {
+    const uint32_t u = std::bit_cast<uint32_t>(f);
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+}  // namespace sss
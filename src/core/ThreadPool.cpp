@@ -0,0 +1,112 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace sss {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    if (thread_count == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        thread_count = (hw > 1) ? hw - 1 : 1;
+    }
+
+    m_workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_workers.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& t : m_workers) {
+        t.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    min_chunk = std::max<size_t>(min_chunk, 1);
+    const size_t max_chunks = (count + min_chunk - 1) / min_chunk;
+    const size_t chunks = std::min(max_chunks, (thread_count() + 1) * 4);
+    if (chunks <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    // Shared with helper tasks, which may start after this call has returned
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+    const size_t chunk_size = (count + chunks - 1) / chunks;
+
+    // Helpers only touch `fn` while a chunk is outstanding, and the caller
+    // does not return before every claimed chunk has completed.
+    auto run_chunks = [state, &fn, count, chunk_size, chunks]() {
+        for (;;) {
+            const size_t c = state->next.fetch_add(1);
+            if (c >= chunks) {
+                return;
+            }
+            const size_t begin = c * chunk_size;
+            const size_t end = std::min(begin + chunk_size, count);
+            if (begin < end) {
+                fn(begin, end);
+            }
+            if (state->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(thread_count(), chunks - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue(run_chunks);
+    }
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->done.load() == chunks; });
+}
+
+}  // namespace sss
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sss {
+
+/**
+ * Fixed-size pool of worker threads shared by CPU-side passes
+ * (sorting, decoding, culling).
+ */
+class ThreadPool {
+public:
+    /**
+     * @param thread_count Number of workers; 0 picks hardware_concurrency - 1
+     */
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Process-wide pool, created on first use.
+     */
+    static ThreadPool& shared();
+
+    size_t thread_count() const { return m_workers.size(); }
+
+    /**
+     * Queue a task and get a future for its result.
+     */
+    template <typename F>
+    auto submit(F&& fn) -> std::future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    /**
+     * Run fn(begin, end) over [0, count) in chunks of at least min_chunk
+     * elements and block until every chunk is done. The calling thread
+     * takes chunks too, so nesting inside a pool task cannot deadlock.
+     */
+    void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+
+    void enqueue(std::function<void()> task);
+    void worker_loop();
+};
+
+}  // namespace sss
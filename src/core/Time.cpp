@@ -6,6 +6,7 @@ float Time::s_delta_time = 0.f;
 float Time::s_fps = 0.f;
 float Time::s_elapsed = 0.f;
 std::chrono::high_resolution_clock::time_point Time::s_last_time;
+const std::chrono::steady_clock::time_point Time::s_start = std::chrono::steady_clock::now();
 
 void Time::init() {
     s_last_time = std::chrono::high_resolution_clock::now();
@@ -27,4 +28,8 @@ void Time::tick() {
     s_elapsed += s_delta_time;
 }
 
+double Time::now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - s_start).count();
+}
+
 }  // namespace sss
@@ -31,11 +31,18 @@ public:
      */
     static float elapsed() { return s_elapsed; }
 
+    /**
+     * Seconds since program start, read from the clock rather than the
+     * last tick(); callable from any thread.
+     */
+    static double now();
+
 private:
     static float s_delta_time;
     static float s_fps;
     static float s_elapsed;
     static std::chrono::high_resolution_clock::time_point s_last_time;
+    static const std::chrono::steady_clock::time_point s_start;
 };
 
 }  // namespace sss
@@ -1,5 +1,8 @@
 #include "Buffers.hpp"
+#include "GLCaps.hpp"
+#include "../core/Log.hpp"
 #include <memory>
+#include <stdexcept>
 
 namespace sss {
 
@@ -43,6 +46,160 @@ void Buffer::unbind(GLenum target) const {
     glBindBuffer(target, 0);
 }
 
+// ============ TextureBuffer ============
+
+TextureBuffer::TextureBuffer() {
+    glGenTextures(1, &m_tex);
+}
+
+TextureBuffer::~TextureBuffer() {
+    if (m_tex != 0) {
+        glDeleteTextures(1, &m_tex);
+    }
+}
+
+void TextureBuffer::attach(const Buffer& buffer, GLenum internal_format) {
+    glBindTexture(GL_TEXTURE_BUFFER, m_tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, internal_format, buffer.handle());
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::bind(GLuint unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, m_tex);
+}
+
+// ============ UploadRing ============
+
+UploadRing::UploadRing(size_t region_bytes)
+    : m_buffer(std::make_unique<Buffer>()),
+      m_region_bytes((region_bytes + kAlignment - 1) / kAlignment * kAlignment),
+      m_persistent(GLCaps::buffer_storage()) {
+    m_buffer->bind(GL_COPY_READ_BUFFER);
+#if SSS_GL_HAS_BUFFER_STORAGE
+    if (m_persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr size = (GLsizeiptr)(kRegions * m_region_bytes);
+        glBufferStorage(GL_COPY_READ_BUFFER, size, nullptr, flags);
+        m_mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags));
+        if (!m_mapped) {
+            // Immutable storage can't be respecified; start over with a
+            // mutable store below
+            SSS_LOG_WARN("[UploadRing] Persistent mapping failed; falling back to orphaning");
+            m_persistent = false;
+            m_buffer = std::make_unique<Buffer>();
+            m_buffer->bind(GL_COPY_READ_BUFFER);
+        }
+    }
+#endif
+    if (!m_persistent) {
+        glBufferData(GL_COPY_READ_BUFFER, (GLsizeiptr)m_region_bytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+UploadRing::~UploadRing() {
+    for (GLsync& fence : m_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
+    if (m_mapped) {
+        m_buffer->bind(GL_COPY_READ_BUFFER);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+}
+
+void* UploadRing::allocate(size_t bytes) {
+    if (bytes > m_region_bytes) {
+        throw std::runtime_error("UploadRing allocation larger than a region");
+    }
+    if (m_region_ready && m_offset + bytes > m_region_bytes) {
+        submit();
+    }
+    if (!m_region_ready) {
+        begin_region();
+    }
+    uint8_t* base = m_persistent ? m_mapped + m_region * m_region_bytes : m_mapped;
+    void* ptr = base + m_offset;
+    m_offset += (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    return ptr;
+}
+
+void UploadRing::copy(const void* src, const Buffer& dst, size_t dst_offset, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    const uint8_t* base = m_persistent ? m_mapped + m_region * m_region_bytes : m_mapped;
+    const PendingCopy c{m_region * (m_persistent ? m_region_bytes : 0) +
+                            (size_t)(static_cast<const uint8_t*>(src) - base),
+                        dst.handle(), dst_offset, bytes};
+    m_bytes_uploaded += bytes;
+    if (m_persistent) {
+        // Coherent: the writes are visible to commands issued after them
+        issue(c);
+    } else {
+        m_pending.push_back(c);
+    }
+}
+
+void UploadRing::submit() {
+    if (!m_region_ready) {
+        return;
+    }
+    if (m_persistent) {
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_region = (m_region + 1) % kRegions;
+    } else {
+        m_buffer->bind(GL_COPY_READ_BUFFER);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        m_mapped = nullptr;
+        for (const PendingCopy& c : m_pending) {
+            issue(c);
+        }
+        m_pending.clear();
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_offset = 0;
+    m_region_ready = false;
+}
+
+void UploadRing::begin_region() {
+    if (m_persistent) {
+        if (GLsync fence = m_fences[m_region]) {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                ++m_stalls;
+                do {
+                    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);   // 1 ms
+                } while (status == GL_TIMEOUT_EXPIRED);
+            }
+            glDeleteSync(fence);
+            m_fences[m_region] = nullptr;
+        }
+    } else {
+        // Invalidating the whole buffer lets the driver hand out a fresh
+        // store while the GPU still reads the previous one
+        m_buffer->bind(GL_COPY_READ_BUFFER);
+        m_mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, (GLsizeiptr)m_region_bytes,
+                                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        if (!m_mapped) {
+            throw std::runtime_error("UploadRing: failed to map the staging buffer");
+        }
+    }
+    m_region_ready = true;
+}
+
+void UploadRing::issue(const PendingCopy& c) {
+    m_buffer->bind(GL_COPY_READ_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, c.dst);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)c.src_offset, (GLintptr)c.dst_offset,
+                        (GLsizeiptr)c.bytes);
+}
+
 // ============ QuadMesh ============
 
 QuadMesh::QuadMesh() 
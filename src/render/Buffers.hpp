@@ -1,6 +1,10 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <vector>
 
 namespace sss {
@@ -51,12 +55,153 @@ public:
         glBufferData(target, count * sizeof(T), data, usage);
     }
 
+    /**
+     * Reallocate the buffer store without initializing it.
+     */
+    void allocate(GLenum target, size_t size_bytes, GLenum usage = GL_DYNAMIC_DRAW) {
+        bind(target);
+        glBufferData(target, (GLsizeiptr)size_bytes, nullptr, usage);
+    }
+
+    /**
+     * Overwrite elements [first, first + count) of an already allocated store.
+     */
+    template <typename T>
+    void update_data(GLenum target, size_t first, const T* data, size_t count) {
+        bind(target);
+        glBufferSubData(target, (GLintptr)(first * sizeof(T)), (GLsizeiptr)(count * sizeof(T)), data);
+    }
+
     GLuint handle() const { return m_vbo; }
 
 private:
     GLuint m_vbo = 0;
 };
 
+/**
+ * Buffer texture view (GL_TEXTURE_BUFFER) over a Buffer's data store,
+ * so shaders can fetch buffer contents by index with texelFetch.
+ */
+class TextureBuffer {
+public:
+    TextureBuffer();
+    ~TextureBuffer();
+
+    TextureBuffer(const TextureBuffer&) = delete;
+    TextureBuffer& operator=(const TextureBuffer&) = delete;
+
+    /**
+     * Point the texture at a buffer's current data store.
+     * Call again after the buffer is reallocated.
+     */
+    void attach(const Buffer& buffer, GLenum internal_format);
+
+    void bind(GLuint unit) const;
+
+    GLuint handle() const { return m_tex; }
+
+private:
+    GLuint m_tex = 0;
+};
+
+/**
+ * Staging ring for streaming data into GPU buffers without blocking
+ * glBufferSubData calls on the render thread.
+ *
+ * Callers allocate() mapped staging memory, fill it (from any thread, e.g.
+ * pool workers writing packed records in place), then copy() it to its
+ * destination with a GPU-side buffer copy. submit() once per frame, before
+ * the destinations are drawn from.
+ *
+ * With buffer storage the ring is one persistently mapped, coherent store
+ * split into kRegions regions. Each submitted region is fenced and only
+ * reused once the GPU has consumed it, so the CPU normally runs up to two
+ * frames ahead without waiting. Otherwise (GL 3.3) a single region is
+ * mapped with GL_MAP_INVALIDATE_BUFFER_BIT on first use, orphaning the
+ * previous store, and its copies are issued when submit() unmaps it.
+ */
+class UploadRing {
+public:
+    static constexpr size_t kRegions = 3;
+    static constexpr size_t kAlignment = 16;
+
+    /**
+     * @param region_bytes Staging memory per region; also the largest
+     *        single allocation
+     */
+    explicit UploadRing(size_t region_bytes = size_t(16) << 20);
+    ~UploadRing();
+
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    /**
+     * Reserve `bytes` (at most region_bytes()) of staging memory, aligned
+     * to kAlignment. Submits the current region first if it is full, and
+     * waits for the next region's fence if the GPU is still reading it.
+     * Render thread only. Copy each allocation before making the next
+     * one, which may submit the region it came from.
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * Copy `bytes` of an allocation to `dst` at byte offset `dst_offset`.
+     * The allocation must be fully written. Render thread only.
+     */
+    void copy(const void* src, const Buffer& dst, size_t dst_offset, size_t bytes);
+
+    /**
+     * Stage and copy elements [first, first + count) of `dst`, splitting
+     * the data into region-sized pieces.
+     */
+    template <typename T>
+    void upload(const Buffer& dst, size_t first, const T* data, size_t count) {
+        const size_t per_piece = m_region_bytes / sizeof(T);
+        for (size_t done = 0; done < count; done += per_piece) {
+            const size_t n = count - done < per_piece ? count - done : per_piece;
+            void* staging = allocate(n * sizeof(T));
+            std::memcpy(staging, data + done, n * sizeof(T));
+            copy(staging, dst, (first + done) * sizeof(T), n * sizeof(T));
+        }
+    }
+
+    /**
+     * Issue the current region's copies and fence it. Call before drawing
+     * from buffers written this frame.
+     */
+    void submit();
+
+    bool persistent() const { return m_persistent; }
+    size_t region_bytes() const { return m_region_bytes; }
+
+    // Totals since creation
+    uint64_t bytes_uploaded() const { return m_bytes_uploaded; }
+    uint64_t stalls() const { return m_stalls; }   // allocations that had to wait for the GPU
+
+private:
+    struct PendingCopy {
+        size_t src_offset;
+        GLuint dst;
+        size_t dst_offset;
+        size_t bytes;
+    };
+
+    std::unique_ptr<Buffer> m_buffer;
+    uint8_t* m_mapped = nullptr;         // whole ring (persistent) or the mapped region (orphaning)
+    size_t m_region_bytes = 0;
+    bool m_persistent = false;
+    size_t m_region = 0;                 // region being filled
+    size_t m_offset = 0;                 // next free byte within it
+    bool m_region_ready = false;         // its fence has been waited on / it is mapped
+    GLsync m_fences[kRegions] = {};
+    std::vector<PendingCopy> m_pending;  // orphaning: copies held until unmap
+    uint64_t m_bytes_uploaded = 0;
+    uint64_t m_stalls = 0;
+
+    void begin_region();
+    void issue(const PendingCopy& c);
+};
+
 /**
  * Quad mesh for rendering gaussians (2 triangles, 6 vertices).
  */
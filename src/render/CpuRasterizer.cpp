@@ -0,0 +1,396 @@
+#include "CpuRasterizer.hpp"
+#include "../core/RadixSort.hpp"
+#include "../core/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SSS_RASTER_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace sss {
+
+namespace {
+
+constexpr size_t kPreprocessChunk = 4096;   // splats per preprocess task
+constexpr int kTilePixels = CpuRasterizer::kTileSize * CpuRasterizer::kTileSize;
+constexpr int kDoneCheck = 32;               // splats between whole-tile saturation checks
+constexpr float kMaxAlpha = 0.99f;
+constexpr float kMinAlpha = 1.f / 255.f;
+constexpr float kMinTransmittance = 0.0001f;
+
+// project_covariance from SplatGlsl: EWA projection of a world covariance
+// to a 2D pixel covariance (a, b, c), with the low-pass dilation
+glm::vec3 project_covariance(const glm::vec3& cam, const glm::mat3& sigma, const glm::mat4& view,
+                             const glm::mat4& proj, const glm::vec2& viewport) {
+    const float tz = -cam.z;
+    const glm::vec2 focal = 0.5f * viewport * glm::vec2(proj[0][0], proj[1][1]);
+    const float limit_x = 1.3f / proj[0][0];
+    const float limit_y = 1.3f / proj[1][1];
+    const float tx = std::clamp(cam.x / tz, -limit_x, limit_x) * tz;
+    const float ty = std::clamp(cam.y / tz, -limit_y, limit_y) * tz;
+    const glm::mat3 J(glm::vec3(focal.x / tz, 0.f, 0.f),
+                      glm::vec3(0.f, focal.y / tz, 0.f),
+                      glm::vec3(focal.x * tx / (tz * tz), focal.y * ty / (tz * tz), 0.f));
+    const glm::mat3 T = J * glm::mat3(view);
+    const glm::mat3 cov = T * sigma * glm::transpose(T);
+    return glm::vec3(cov[0][0] + 0.3f, cov[0][1], cov[1][1] + 0.3f);
+}
+
+// eval_sh from SplatGlsl: base color plus bands 1..degree seen along `d`
+glm::vec3 eval_sh(const glm::vec3& base, const glm::vec3* sh, int degree, const glm::vec3& d) {
+    const float x = d.x, y = d.y, z = d.z;
+    glm::vec3 color = base - sh[0] * (0.48860251f * y) + sh[1] * (0.48860251f * z) - sh[2] * (0.48860251f * x);
+    if (degree > 1) {
+        const float xx = x * x, yy = y * y, zz = z * z;
+        color += sh[3] * (1.09254843f * x * y) - sh[4] * (1.09254843f * y * z) +
+                 sh[5] * (0.31539157f * (2.f * zz - xx - yy)) - sh[6] * (1.09254843f * x * z) +
+                 sh[7] * (0.54627422f * (xx - yy));
+        if (degree > 2) {
+            color += sh[8] * (-0.59004359f * y * (3.f * xx - yy)) + sh[9] * (2.89061144f * x * y * z) -
+                     sh[10] * (0.45704580f * y * (4.f * zz - xx - yy)) +
+                     sh[11] * (0.37317633f * z * (2.f * zz - 3.f * xx - 3.f * yy)) -
+                     sh[12] * (0.45704580f * x * (4.f * zz - xx - yy)) + sh[13] * (1.44530572f * z * (xx - yy)) -
+                     sh[14] * (0.59004359f * x * (xx - 3.f * yy));
+        }
+    }
+    return glm::max(color, glm::vec3(0.f));
+}
+
+// Per-pixel blend state of one tile, row-major from its bottom-left pixel
+struct TileState {
+    alignas(16) float T[kTilePixels];
+    alignas(16) float r[kTilePixels];
+    alignas(16) float g[kTilePixels];
+    alignas(16) float b[kTilePixels];
+    alignas(16) float d[kTilePixels];
+    alignas(16) float done[kTilePixels];   // all bits set once saturated
+};
+
+#if SSS_RASTER_SSE
+
+// exp for x <= 0 (Cephes polynomial, about 1 ulp); underflows to 0
+inline __m128 exp_ps(__m128 x) {
+    x = _mm_max_ps(x, _mm_set1_ps(-87.3f));
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504f)), _mm_set1_ps(0.5f));
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    fx = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, fx), _mm_set1_ps(1.f)));   // floor
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), _mm_add_ps(x, _mm_set1_ps(1.f)));
+
+    const __m128i n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(n));
+}
+
+// Blend one splat into the tile, four pixels at a time
+void blend_splat(TileState& st, float sx, float sy, const glm::vec3& conic, float opacity, const glm::vec3& color,
+                 float depth, float x0, float y0) {
+    const __m128 ca = _mm_set1_ps(conic.x);
+    const __m128 cb = _mm_set1_ps(conic.y);
+    const __m128 cc = _mm_set1_ps(conic.z);
+    const __m128 op = _mm_set1_ps(opacity);
+    const __m128 cr = _mm_set1_ps(color.r);
+    const __m128 cg = _mm_set1_ps(color.g);
+    const __m128 cbl = _mm_set1_ps(color.b);
+    const __m128 cd = _mm_set1_ps(depth);
+    const __m128 half = _mm_set1_ps(-0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 max_alpha = _mm_set1_ps(kMaxAlpha);
+    const __m128 min_alpha = _mm_set1_ps(kMinAlpha);
+    const __m128 min_t = _mm_set1_ps(kMinTransmittance);
+    const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+    for (int y = 0; y < CpuRasterizer::kTileSize; ++y) {
+        const float dyf = sy - (y0 + (float)y + 0.5f);
+        const __m128 dy = _mm_set1_ps(dyf);
+        const __m128 dyy = _mm_mul_ps(cc, _mm_set1_ps(dyf * dyf));
+        for (int x = 0; x < CpuRasterizer::kTileSize; x += 4) {
+            const int p = y * CpuRasterizer::kTileSize + x;
+            const __m128 dx = _mm_sub_ps(_mm_set1_ps(sx - x0 - (float)x), lane);
+            __m128 power = _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(ca, _mm_mul_ps(dx, dx)), dyy));
+            power = _mm_sub_ps(power, _mm_mul_ps(cb, _mm_mul_ps(dx, dy)));
+            const __m128 inside = _mm_cmple_ps(power, zero);
+            const __m128 alpha = _mm_min_ps(max_alpha, _mm_mul_ps(op, exp_ps(_mm_min_ps(power, zero))));
+            const __m128 done = _mm_load_ps(st.done + p);
+            const __m128 valid = _mm_andnot_ps(done, _mm_and_ps(inside, _mm_cmpge_ps(alpha, min_alpha)));
+            if (_mm_movemask_ps(valid) == 0) {
+                continue;
+            }
+
+            const __m128 T = _mm_load_ps(st.T + p);
+            const __m128 next_T = _mm_mul_ps(T, _mm_sub_ps(one, alpha));
+            const __m128 saturated = _mm_and_ps(valid, _mm_cmplt_ps(next_T, min_t));
+            const __m128 contrib = _mm_andnot_ps(saturated, valid);
+            const __m128 w = _mm_and_ps(contrib, _mm_mul_ps(alpha, T));
+
+            _mm_store_ps(st.r + p, _mm_add_ps(_mm_load_ps(st.r + p), _mm_mul_ps(w, cr)));
+            _mm_store_ps(st.g + p, _mm_add_ps(_mm_load_ps(st.g + p), _mm_mul_ps(w, cg)));
+            _mm_store_ps(st.b + p, _mm_add_ps(_mm_load_ps(st.b + p), _mm_mul_ps(w, cbl)));
+            _mm_store_ps(st.d + p, _mm_add_ps(_mm_load_ps(st.d + p), _mm_mul_ps(w, cd)));
+            _mm_store_ps(st.T + p, _mm_or_ps(_mm_and_ps(contrib, next_T), _mm_andnot_ps(contrib, T)));
+            _mm_store_ps(st.done + p, _mm_or_ps(done, saturated));
+        }
+    }
+}
+
+bool tile_saturated(const TileState& st) {
+    __m128 all = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < kTilePixels; p += 4) {
+        all = _mm_and_ps(all, _mm_load_ps(st.done + p));
+    }
+    return _mm_movemask_ps(all) == 0xF;
+}
+
+#else
+
+void blend_splat(TileState& st, float sx, float sy, const glm::vec3& conic, float opacity, const glm::vec3& color,
+                 float depth, float x0, float y0) {
+    for (int y = 0; y < CpuRasterizer::kTileSize; ++y) {
+        const float dy = sy - (y0 + (float)y + 0.5f);
+        for (int x = 0; x < CpuRasterizer::kTileSize; ++x) {
+            const int p = y * CpuRasterizer::kTileSize + x;
+            if (st.done[p] != 0.f) {
+                continue;
+            }
+            const float dx = sx - (x0 + (float)x + 0.5f);
+            const float power = -0.5f * (conic.x * dx * dx + conic.z * dy * dy) - conic.y * dx * dy;
+            if (power > 0.f) {
+                continue;
+            }
+            const float alpha = std::min(kMaxAlpha, opacity * std::exp(power));
+            if (alpha < kMinAlpha) {
+                continue;
+            }
+            const float next_T = st.T[p] * (1.f - alpha);
+            if (next_T < kMinTransmittance) {
+                st.done[p] = 1.f;
+                continue;
+            }
+            const float w = alpha * st.T[p];
+            st.r[p] += w * color.r;
+            st.g[p] += w * color.g;
+            st.b[p] += w * color.b;
+            st.d[p] += w * depth;
+            st.T[p] = next_T;
+        }
+    }
+}
+
+bool tile_saturated(const TileState& st) {
+    return std::all_of(st.done, st.done + kTilePixels, [](float d) { return d != 0.f; });
+}
+
+#endif
+
+}  // namespace
+
+const char* CpuRasterizer::simd_name() {
+#if SSS_RASTER_SSE
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+void CpuRasterizer::render(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width,
+                           int height, RasterImage& out, int max_sh_degree, ThreadPool* pool) {
+    out.width = std::max(width, 0);
+    out.height = std::max(height, 0);
+    out.color.assign((size_t)out.width * out.height * 4, 0.f);
+    out.depth.assign((size_t)out.width * out.height, 0.f);
+    m_tile_splats.clear();
+    if (out.width == 0 || out.height == 0) {
+        return;
+    }
+
+    const uint32_t tiles_x = (uint32_t)((width + kTileSize - 1) / kTileSize);
+    const uint32_t tiles_y = (uint32_t)((height + kTileSize - 1) / kTileSize);
+    preprocess(scene, view, projection, width, height, std::clamp(max_sh_degree, 0, scene.sh_degree()), pool);
+    bin(tiles_x, tiles_y);
+
+    // Threads claim tiles one by one, heaviest first, until none are left
+    std::atomic<size_t> next{0};
+    auto run = [&]() {
+        for (size_t k = next.fetch_add(1); k < m_tile_order.size(); k = next.fetch_add(1)) {
+            blend_tile(m_tile_order[k], tiles_x, out);
+        }
+    };
+    if (pool && m_tile_order.size() > 1) {
+        pool->parallel_for(pool->thread_count() + 1, 1, [&](size_t, size_t) { run(); });
+    } else {
+        run();
+    }
+}
+
+void CpuRasterizer::preprocess(const Scene& scene, const glm::mat4& view, const glm::mat4& projection, int width,
+                               int height, int sh_degree, ThreadPool* pool) {
+    const size_t n = scene.gaussian_count();
+    m_splats.resize(n);
+
+    const glm::vec2 viewport((float)width, (float)height);
+    const glm::vec2 tiles((float)((width + kTileSize - 1) / kTileSize), (float)((height + kTileSize - 1) / kTileSize));
+    const glm::vec3 eye = -(glm::transpose(glm::mat3(view)) * glm::vec3(view[3]));
+    const size_t sh_count = sh_degree > 0 ? sh_coefficient_count(scene.sh_degree()) : 0;
+
+    auto project = [&](size_t begin, size_t end) {
+        glm::vec3 sh[15];
+        for (size_t i = begin; i < end; ++i) {
+            Splat& s = m_splats[i];
+            s.tile_lo[0] = s.tile_hi[0] = 0;
+
+            const float opacity = scene.opacities()[i];
+            const float k = std::min(std::sqrt(2.f * std::log(std::max(opacity * 255.f, 1.f))), 3.f);
+            const glm::vec3& mean = scene.means()[i];
+            const glm::vec4 cam = view * glm::vec4(mean, 1.f);
+            const glm::vec4 clip = projection * cam;
+            if (clip.w <= 0.f || k <= 0.f || std::abs(clip.z) > clip.w) {
+                continue;
+            }
+
+            // Sigma = R S S^T R^T, as pack_covariance
+            glm::mat3 m = glm::mat3_cast(glm::normalize(scene.rotations()[i]));
+            const glm::vec3& scale = scene.scales()[i];
+            m[0] *= scale.x;
+            m[1] *= scale.y;
+            m[2] *= scale.z;
+            const glm::vec3 cov = project_covariance(glm::vec3(cam), m * glm::transpose(m), view, projection, viewport);
+            const float det = cov.x * cov.z - cov.y * cov.y;
+            if (det <= 0.f) {
+                continue;
+            }
+
+            // Touched tiles of the k-sigma extent, clamped before the int
+            // conversion
+            const glm::vec2 px = (glm::vec2(clip.x, clip.y) / clip.w * 0.5f + glm::vec2(0.5f)) * viewport;
+            const float ex = k * std::sqrt(cov.x);
+            const float ey = k * std::sqrt(cov.z);
+            const float lo_x = std::clamp(std::floor((px.x - ex) / (float)kTileSize), 0.f, tiles.x);
+            const float lo_y = std::clamp(std::floor((px.y - ey) / (float)kTileSize), 0.f, tiles.y);
+            const float hi_x = std::clamp(std::floor((px.x + ex) / (float)kTileSize) + 1.f, 0.f, tiles.x);
+            const float hi_y = std::clamp(std::floor((px.y + ey) / (float)kTileSize) + 1.f, 0.f, tiles.y);
+            if (lo_x >= hi_x || lo_y >= hi_y) {
+                continue;
+            }
+
+            glm::vec3 color = scene.colors()[i];
+            if (sh_count > 0) {
+                scene.get_sh(i, sh);
+                color = eval_sh(color, sh, sh_degree, glm::normalize(mean - eye));
+            }
+
+            s.pixel = px;
+            s.conic = glm::vec3(cov.z / det, -cov.y / det, cov.x / det);
+            s.opacity = opacity;
+            s.color = color;
+            s.depth = -cam.z;
+            s.tile_lo[0] = (uint16_t)lo_x;
+            s.tile_lo[1] = (uint16_t)lo_y;
+            s.tile_hi[0] = (uint16_t)hi_x;
+            s.tile_hi[1] = (uint16_t)hi_y;
+        }
+    };
+    if (pool) {
+        pool->parallel_for(n, kPreprocessChunk, project);
+    } else {
+        project(0, n);
+    }
+
+    // Visible splats, near first
+    m_keys.clear();
+    m_order.clear();
+    for (size_t i = 0; i < n; ++i) {
+        if (m_splats[i].tile_hi[0] > m_splats[i].tile_lo[0]) {
+            m_keys.push_back(float_to_sortable_key(m_splats[i].depth));
+            m_order.push_back((uint32_t)i);
+        }
+    }
+    radix_sort_pairs(m_keys, m_order, m_scratch_keys, m_scratch_values, pool);
+}
+
+void CpuRasterizer::bin(uint32_t tiles_x, uint32_t tiles_y) {
+    // Count, scan, then fill in depth order so each tile's list is sorted
+    const size_t tiles = (size_t)tiles_x * tiles_y;
+    m_tile_offsets.assign(tiles + 1, 0);
+    for (uint32_t i : m_order) {
+        const Splat& s = m_splats[i];
+        for (uint32_t ty = s.tile_lo[1]; ty < s.tile_hi[1]; ++ty) {
+            for (uint32_t tx = s.tile_lo[0]; tx < s.tile_hi[0]; ++tx) {
+                ++m_tile_offsets[ty * tiles_x + tx + 1];
+            }
+        }
+    }
+    std::partial_sum(m_tile_offsets.begin(), m_tile_offsets.end(), m_tile_offsets.begin());
+
+    m_tile_splats.resize(m_tile_offsets[tiles]);
+    m_tile_cursor.assign(m_tile_offsets.begin(), m_tile_offsets.end() - 1);
+    for (uint32_t i : m_order) {
+        const Splat& s = m_splats[i];
+        for (uint32_t ty = s.tile_lo[1]; ty < s.tile_hi[1]; ++ty) {
+            for (uint32_t tx = s.tile_lo[0]; tx < s.tile_hi[0]; ++tx) {
+                m_tile_splats[m_tile_cursor[ty * tiles_x + tx]++] = i;
+            }
+        }
+    }
+
+    m_tile_order.clear();
+    for (uint32_t t = 0; t < tiles; ++t) {
+        if (m_tile_offsets[t + 1] > m_tile_offsets[t]) {
+            m_tile_order.push_back(t);
+        }
+    }
+    std::sort(m_tile_order.begin(), m_tile_order.end(), [&](uint32_t a, uint32_t b) {
+        const uint32_t ca = m_tile_offsets[a + 1] - m_tile_offsets[a];
+        const uint32_t cb = m_tile_offsets[b + 1] - m_tile_offsets[b];
+        return ca != cb ? ca > cb : a < b;
+    });
+}
+
+void CpuRasterizer::blend_tile(uint32_t tile, uint32_t tiles_x, RasterImage& out) const {
+    TileState st;
+    std::fill(std::begin(st.T), std::end(st.T), 1.f);
+    std::fill(std::begin(st.r), std::end(st.r), 0.f);
+    std::fill(std::begin(st.g), std::end(st.g), 0.f);
+    std::fill(std::begin(st.b), std::end(st.b), 0.f);
+    std::fill(std::begin(st.d), std::end(st.d), 0.f);
+    std::fill(std::begin(st.done), std::end(st.done), 0.f);
+
+    const int x0 = (int)(tile % tiles_x) * kTileSize;
+    const int y0 = (int)(tile / tiles_x) * kTileSize;
+    const uint32_t begin = m_tile_offsets[tile];
+    const uint32_t end = m_tile_offsets[tile + 1];
+    for (uint32_t j = begin; j < end; ++j) {
+        if ((j - begin) % kDoneCheck == 0 && j > begin && tile_saturated(st)) {
+            break;
+        }
+        const Splat& s = m_splats[m_tile_splats[j]];
+        blend_splat(st, s.pixel.x, s.pixel.y, s.conic, s.opacity, s.color, s.depth, (float)x0, (float)y0);
+    }
+
+    const int w = std::min(kTileSize, out.width - x0);
+    const int h = std::min(kTileSize, out.height - y0);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const int p = y * kTileSize + x;
+            const size_t pixel = (size_t)(y0 + y) * out.width + (x0 + x);
+            out.color[pixel * 4 + 0] = st.r[p];
+            out.color[pixel * 4 + 1] = st.g[p];
+            out.color[pixel * 4 + 2] = st.b[p];
+            out.color[pixel * 4 + 3] = 1.f - st.T[p];
+            out.depth[pixel] = st.d[p];
+        }
+    }
+}
+
+}  // namespace sss
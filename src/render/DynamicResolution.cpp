@@ -0,0 +1,188 @@
+#include "DynamicResolution.hpp"
+#include "RenderTarget.hpp"
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sss {
+
+namespace {
+
+// One triangle over the viewport; the target's color is premultiplied
+const char* kUpsampleVertexSrc = R"(
+#version 330 core
+out vec2 vUv;
+
+void main() {
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUv = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+const char* kUpsampleFragmentSrc = R"(
+#version 330 core
+in vec2 vUv;
+uniform sampler2D uColor;
+out vec4 FragColor;
+
+void main() {
+    FragColor = texture(uColor, vUv);
+}
+)";
+
+}  // namespace
+
+float ResolutionGovernor::update(double gpu_ms, double target_ms) {
+    if (gpu_ms <= 0.0 || target_ms <= 0.0) {
+        return m_scale;
+    }
+    // Positive with headroom, negative over budget
+    double error = std::log(target_ms / gpu_ms);
+    if (std::abs(error) < std::log1p((double)kDeadband)) {
+        error = 0.0;
+    }
+    double step = kKi * error;
+    if (m_history >= 1) {
+        step += kKp * (error - m_error[0]);
+    }
+    if (m_history >= 2) {
+        step += kKd * (error - 2.0 * m_error[0] + m_error[1]);
+    }
+    m_error[1] = m_error[0];
+    m_error[0] = error;
+    m_history = std::min(m_history + 1, 2);
+
+    // The step is in log pixel fraction, twice the log scale
+    const double log_scale = std::log((double)m_scale) + 0.5 * step;
+    m_scale = std::clamp((float)std::exp(log_scale), m_min_scale, m_max_scale);
+    return m_scale;
+}
+
+void ResolutionGovernor::reset(float scale) {
+    m_scale = std::clamp(scale, m_min_scale, m_max_scale);
+    m_error[0] = m_error[1] = 0.0;
+    m_history = 0;
+}
+
+void ResolutionGovernor::set_range(float min_scale, float max_scale) {
+    m_min_scale = std::clamp(min_scale, 0.1f, 1.f);
+    m_max_scale = std::clamp(max_scale, m_min_scale, 1.f);
+    m_scale = std::clamp(m_scale, m_min_scale, m_max_scale);
+}
+
+DynamicResolution::DynamicResolution() = default;
+
+DynamicResolution::~DynamicResolution() {
+    for (QuerySlot& slot : m_queries) {
+        if (slot.begin != 0) {
+            glDeleteQueries(1, &slot.begin);
+            glDeleteQueries(1, &slot.end);
+        }
+    }
+    if (m_vao != 0) {
+        glDeleteVertexArrays(1, &m_vao);
+    }
+}
+
+void DynamicResolution::init(ShaderCache& shaders) {
+    m_program = shaders.program({"resolution_upsample", kUpsampleVertexSrc, kUpsampleFragmentSrc});
+    if (m_vao == 0) {
+        glGenVertexArrays(1, &m_vao);
+        for (QuerySlot& slot : m_queries) {
+            glGenQueries(1, &slot.begin);
+            glGenQueries(1, &slot.end);
+        }
+    }
+}
+
+void DynamicResolution::set_target_ms(float ms) {
+    m_target_ms = std::max(ms, 1.f);
+}
+
+int DynamicResolution::render_width() const {
+    return m_target ? m_target->width() : 0;
+}
+
+int DynamicResolution::render_height() const {
+    return m_target ? m_target->height() : 0;
+}
+
+void DynamicResolution::reset() {
+    m_governor.reset();
+    for (QuerySlot& slot : m_queries) {
+        slot.issued = false;   // measured at the old scale
+    }
+    m_gpu_ms = 0.0;
+}
+
+void DynamicResolution::collect(QuerySlot& slot) {
+    if (!slot.issued) {
+        return;
+    }
+    GLint available = 0;
+    glGetQueryObjectiv(slot.end, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;   // reissued below; this frame goes unmeasured
+    }
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(slot.begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(slot.end, GL_QUERY_RESULT, &end);
+    m_gpu_ms = (double)(end - begin) * 1e-6;
+    m_governor.update(m_gpu_ms, m_target_ms);
+}
+
+RenderTarget& DynamicResolution::begin(int width, int height) {
+    QuerySlot& slot = m_queries[m_frame % kQuerySlots];
+    collect(slot);
+
+    // Whole steps of the scale, so the target only changes size on real moves
+    const float scale = std::round(m_governor.scale() / kScaleStep) * kScaleStep;
+    const int w = std::max(1, (int)std::lround((float)width * scale));
+    const int h = std::max(1, (int)std::lround((float)height * scale));
+    bool created = false;
+    if (!m_target) {
+        m_target = std::make_unique<RenderTarget>(w, h, kAttachColor);
+        created = true;
+    } else if (w != m_target->width() || h != m_target->height()) {
+        m_target->resize(w, h);
+        created = true;
+    }
+    if (created) {
+        // Upsampled with bilinear filtering
+        glBindTexture(GL_TEXTURE_2D, m_target->color_texture());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glQueryCounter(slot.begin, GL_TIMESTAMP);
+    return *m_target;
+}
+
+void DynamicResolution::end(int width, int height) {
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(m_program);
+    glUniform1i(Shader::get_uniform_location(m_program, "uColor"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_target->color_texture());
+    glBindVertexArray(m_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glDisable(GL_BLEND);
+
+    QuerySlot& slot = m_queries[m_frame % kQuerySlots];
+    glQueryCounter(slot.end, GL_TIMESTAMP);
+    slot.issued = true;
+    ++m_frame;
+}
+
+}  // namespace sss
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sss {
+
+class RenderTarget;
+class ShaderCache;
+
+/**
+ * PID controller from measured GPU time to render scale.
+ *
+ * Fragment cost follows the pixel count, so the controller works on the
+ * log of the pixel fraction (scale squared) against the log of
+ * target / measured time: the same relative overshoot moves the scale by
+ * the same step at any resolution. It is the velocity form, so clamping
+ * the scale is all the anti-windup it needs. Errors within kDeadband
+ * leave the scale alone, so a frame time near the target doesn't make it
+ * hunt.
+ */
+class ResolutionGovernor {
+public:
+    static constexpr float kDeadband = 0.05f;   // relative frame time error ignored
+    static constexpr float kKp = 0.30f;
+    static constexpr float kKi = 0.15f;
+    static constexpr float kKd = 0.05f;
+
+    /**
+     * Feed one measurement; returns the new scale.
+     */
+    float update(double gpu_ms, double target_ms);
+
+    float scale() const { return m_scale; }
+
+    /**
+     * Start over at `scale`, forgetting past errors.
+     */
+    void reset(float scale = 1.f);
+
+    float min_scale() const { return m_min_scale; }
+    float max_scale() const { return m_max_scale; }
+    void set_range(float min_scale, float max_scale);
+
+private:
+    float m_scale = 1.f;
+    float m_min_scale = 0.5f;
+    float m_max_scale = 1.f;
+    double m_error[2] = {0.0, 0.0};   // previous two, newest first
+    int m_history = 0;                // of them valid
+};
+
+/**
+ * Dynamic resolution for the on-screen view: the scene is rendered into a
+ * RenderTarget at a fraction of the viewport and upsampled over the
+ * window with bilinear filtering, so what is drawn after it (the UI)
+ * stays at native resolution.
+ *
+ * The GPU time from begin() to the end of the upsample is measured with a
+ * ring of timestamp queries, read back kQuerySlots - 1 frames later and
+ * only once available, so it never waits on the GPU. Each measurement
+ * feeds a ResolutionGovernor steering toward the target time. The target
+ * size follows the scale in steps of kScaleStep, so small corrections
+ * don't reallocate it every frame.
+ */
+class DynamicResolution {
+public:
+    static constexpr size_t kQuerySlots = 4;
+    static constexpr float kScaleStep = 1.f / 32.f;
+    static constexpr float kDefaultTargetMs = 12.f;   // leaves room for the UI at 60 Hz
+
+    DynamicResolution();
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    /**
+     * Get the upsample program from `shaders`, which must outlive this.
+     *
+     * @throws std::runtime_error if it fails to build
+     */
+    void init(ShaderCache& shaders);
+
+    /**
+     * Start a frame for a `width` x `height` viewport: take in finished
+     * measurements and return the target to render the scene into, sized
+     * by the current scale.
+     */
+    RenderTarget& begin(int width, int height);
+
+    /**
+     * Upsample the target over the bound framebuffer (premultiplied, so
+     * over what it was cleared to) and finish the measurement.
+     */
+    void end(int width, int height);
+
+    float scale() const { return m_governor.scale(); }
+    ResolutionGovernor& governor() { return m_governor; }
+
+    float target_ms() const { return m_target_ms; }
+    void set_target_ms(float ms);
+
+    /**
+     * Last measured GPU time of a scaled frame, a few frames old; 0 until
+     * the first arrives.
+     */
+    double gpu_ms() const { return m_gpu_ms; }
+
+    /**
+     * Scene pixels of the last begin().
+     */
+    int render_width() const;
+    int render_height() const;
+
+    /**
+     * Back to full resolution, e.g. when turned back on.
+     */
+    void reset();
+
+private:
+    struct QuerySlot {
+        GLuint begin = 0;
+        GLuint end = 0;
+        bool issued = false;
+    };
+
+    std::unique_ptr<RenderTarget> m_target;
+    GLuint m_program = 0;    // owned by the ShaderCache
+    GLuint m_vao = 0;        // empty; the triangle comes from gl_VertexID
+    QuerySlot m_queries[kQuerySlots];
+    size_t m_frame = 0;
+    ResolutionGovernor m_governor;
+    float m_target_ms = kDefaultTargetMs;
+    double m_gpu_ms = 0.0;
+
+    void collect(QuerySlot& slot);
+};
+
+}  // namespace sss
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Compute-shader code paths are compiled only when the GL loader exposes
+// GL 4.3 entry points; they are used only when the context supports them.
+#if defined(GL_VERSION_4_3)
+#define SSS_GL_HAS_COMPUTE 1
+#else
+#define SSS_GL_HAS_COMPUTE 0
+#endif
+
+// Immutable, persistently mapped buffer storage (GL 4.4 or
+// ARB_buffer_storage); without it, streaming falls back to orphaning
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+#define SSS_GL_HAS_BUFFER_STORAGE 1
+#else
+#define SSS_GL_HAS_BUFFER_STORAGE 0
+#endif
+
+// Program binaries (GL 4.1 or ARB_get_program_binary), for the shader cache
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+#define SSS_GL_HAS_PROGRAM_BINARY 1
+#else
+#define SSS_GL_HAS_PROGRAM_BINARY 0
+#endif
+
+namespace sss {
+
+/**
+ * Runtime queries for optional OpenGL features of the current context.
+ */
+struct GLCaps {
+    /**
+     * True if the current context supports compute shaders and SSBOs.
+     */
+    static bool compute_shaders() {
+#if SSS_GL_HAS_COMPUTE
+        return GLAD_GL_VERSION_4_3 != 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * True if the current context supports glBufferStorage with persistent
+     * and coherent mappings.
+     */
+    static bool buffer_storage() {
+#if SSS_GL_HAS_BUFFER_STORAGE
+#if defined(GL_VERSION_4_4)
+        if (GLAD_GL_VERSION_4_4) {
+            return true;
+        }
+#endif
+#if defined(GL_ARB_buffer_storage)
+        if (GLAD_GL_ARB_buffer_storage) {
+            return true;
+        }
+#endif
+#endif
+        return false;
+    }
+
+    /**
+     * True if the current context can save and load program binaries in
+     * at least one format (some drivers support the API but no format).
+     */
+    static bool program_binary() {
+#if SSS_GL_HAS_PROGRAM_BINARY
+        bool api = false;
+#if defined(GL_VERSION_4_1)
+        api = api || GLAD_GL_VERSION_4_1 != 0;
+#endif
+#if defined(GL_ARB_get_program_binary)
+        api = api || GLAD_GL_ARB_get_program_binary != 0;
+#endif
+        if (api) {
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            return formats > 0;
+        }
+#endif
+        return false;
+    }
+};
+
+}  // namespace sss
@@ -0,0 +1,237 @@
+#include "GpuRadixSort.hpp"
+#include "GLCaps.hpp"
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace sss {
+
+namespace {
+
+constexpr uint32_t kGroupSize = 256;
+
+uint32_t div_up(size_t n, uint32_t d) {
+    return (uint32_t)((n + d - 1) / d);
+}
+
+#if SSS_GL_HAS_COMPUTE
+
+// Per-block digit counts, stored digit-major: hist[digit * numBlocks + block]
+const char* kHistogramSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer Keys { uint keys[]; };
+layout(std430, binding = 2) writeonly buffer Hist { uint hist[]; };
+
+uniform uint uCount;
+uniform uint uShift;
+uniform uint uNumBlocks;
+
+shared uint s_hist[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint block = gl_WorkGroupID.x;
+
+    s_hist[lid] = 0u;
+    barrier();
+
+    uint base = block * 1024u;
+    for (uint r = 0u; r < 4u; ++r) {
+        uint idx = base + r * 256u + lid;
+        if (idx < uCount) {
+            atomicAdd(s_hist[(keys[idx] >> uShift) & 0xFFu], 1u);
+        }
+    }
+    barrier();
+
+    hist[lid * uNumBlocks + block] = s_hist[lid];
+}
+)";
+
+// Exclusive scan of the digit-major histogram; one thread per digit row
+const char* kScanSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 2) buffer Hist { uint hist[]; };
+
+uniform uint uNumBlocks;
+
+shared uint s_sum[256];
+
+void main() {
+    uint d = gl_LocalInvocationID.x;
+    uint row = d * uNumBlocks;
+
+    uint total = 0u;
+    for (uint b = 0u; b < uNumBlocks; ++b) {
+        total += hist[row + b];
+    }
+    s_sum[d] = total;
+    barrier();
+
+    // Inclusive Hillis-Steele scan over the 256 digit totals
+    for (uint offset = 1u; offset < 256u; offset <<= 1u) {
+        uint v = (d >= offset) ? s_sum[d - offset] : 0u;
+        barrier();
+        s_sum[d] += v;
+        barrier();
+    }
+
+    uint running = s_sum[d] - total;
+    for (uint b = 0u; b < uNumBlocks; ++b) {
+        uint c = hist[row + b];
+        hist[row + b] = running;
+        running += c;
+    }
+}
+)";
+
+// Stable scatter: blocks are walked in 256-element rounds in input order and
+// each element's rank among equal digits earlier in its round is counted
+const char* kScatterSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer KeysIn { uint keys_in[]; };
+layout(std430, binding = 1) readonly buffer ValsIn { uint vals_in[]; };
+layout(std430, binding = 2) readonly buffer Hist { uint hist[]; };
+layout(std430, binding = 3) writeonly buffer KeysOut { uint keys_out[]; };
+layout(std430, binding = 4) writeonly buffer ValsOut { uint vals_out[]; };
+
+uniform uint uCount;
+uniform uint uShift;
+uniform uint uNumBlocks;
+
+shared uint s_offset[256];
+shared uint s_digit[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint block = gl_WorkGroupID.x;
+
+    s_offset[lid] = hist[lid * uNumBlocks + block];
+    barrier();
+
+    uint base = block * 1024u;
+    for (uint r = 0u; r < 4u; ++r) {
+        uint idx = base + r * 256u + lid;
+        bool valid = idx < uCount;
+        uint key = valid ? keys_in[idx] : 0u;
+        uint digit = valid ? ((key >> uShift) & 0xFFu) : 256u;
+        s_digit[lid] = digit;
+        barrier();
+
+        if (valid) {
+            uint rank = 0u;
+            for (uint j = 0u; j < lid; ++j) {
+                rank += (s_digit[j] == digit) ? 1u : 0u;
+            }
+            uint dst = s_offset[digit] + rank;
+            keys_out[dst] = key;
+            vals_out[dst] = vals_in[idx];
+        }
+        barrier();
+
+        uint n = 0u;
+        for (uint j = 0u; j < 256u; ++j) {
+            n += (s_digit[j] == lid) ? 1u : 0u;
+        }
+        s_offset[lid] += n;
+        barrier();
+    }
+}
+)";
+
+#endif
+
+}  // namespace
+
+GpuRadixSort::~GpuRadixSort() {
+    destroy();
+}
+
+void GpuRadixSort::init(ShaderCache& shaders) {
+#if SSS_GL_HAS_COMPUTE
+    destroy();
+    try {
+        m_histogram_program = shaders.program({"radix_histogram", nullptr, nullptr, kHistogramSrc});
+        m_scan_program = shaders.program({"radix_scan", nullptr, nullptr, kScanSrc});
+        m_scatter_program = shaders.program({"radix_scatter", nullptr, nullptr, kScatterSrc});
+    } catch (...) {
+        destroy();
+        throw;
+    }
+    m_histogram = std::make_unique<Buffer>();
+#else
+    (void)shaders;
+#endif
+}
+
+bool GpuRadixSort::sort(GLuint keys, GLuint values, GLuint keys_alt, GLuint values_alt, uint32_t count, uint32_t bits) {
+    bool in_alt = false;
+#if SSS_GL_HAS_COMPUTE
+    if (count == 0 || !ready()) {
+        return false;
+    }
+    const uint32_t num_blocks = div_up(count, kBlockSize);
+    if (num_blocks > m_histogram_blocks) {
+        m_histogram_blocks = std::max<size_t>(num_blocks, m_histogram_blocks + m_histogram_blocks / 2);
+        m_histogram->allocate(GL_SHADER_STORAGE_BUFFER, m_histogram_blocks * 256 * sizeof(uint32_t), GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_histogram->handle());
+
+    GLuint keys_in = keys, keys_out = keys_alt;
+    GLuint vals_in = values, vals_out = values_alt;
+    for (uint32_t shift = 0; shift < bits; shift += 8) {
+        glUseProgram(m_histogram_program);
+        glUniform1ui(Shader::get_uniform_location(m_histogram_program, "uCount"), count);
+        glUniform1ui(Shader::get_uniform_location(m_histogram_program, "uShift"), shift);
+        glUniform1ui(Shader::get_uniform_location(m_histogram_program, "uNumBlocks"), num_blocks);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keys_in);
+        glDispatchCompute(num_blocks, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUseProgram(m_scan_program);
+        glUniform1ui(Shader::get_uniform_location(m_scan_program, "uNumBlocks"), num_blocks);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUseProgram(m_scatter_program);
+        glUniform1ui(Shader::get_uniform_location(m_scatter_program, "uCount"), count);
+        glUniform1ui(Shader::get_uniform_location(m_scatter_program, "uShift"), shift);
+        glUniform1ui(Shader::get_uniform_location(m_scatter_program, "uNumBlocks"), num_blocks);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keys_in);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, vals_in);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, keys_out);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, vals_out);
+        glDispatchCompute(num_blocks, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        std::swap(keys_in, keys_out);
+        std::swap(vals_in, vals_out);
+        in_alt = !in_alt;
+    }
+    glUseProgram(0);
+#else
+    (void)keys;
+    (void)values;
+    (void)keys_alt;
+    (void)values_alt;
+    (void)count;
+    (void)bits;
+#endif
+    return in_alt;
+}
+
+void GpuRadixSort::destroy() {
+    // The programs belong to the ShaderCache
+    for (GLuint* p : {&m_histogram_program, &m_scan_program, &m_scatter_program}) {
+        *p = 0;
+    }
+    m_histogram.reset();
+    m_histogram_blocks = 0;
+}
+
+}  // namespace sss
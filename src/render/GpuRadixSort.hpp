@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include "Buffers.hpp"
+
+namespace sss {
+
+class ShaderCache;
+
+/**
+ * Stable LSD radix sort of uint32 key/value pairs in SSBOs, 8 bits per
+ * compute pass (GL 4.3). Shared by the depth sorter and the tile
+ * rasterizer; callers own the key/value buffers and their ping-pong
+ * alternates, this owns the histogram scratch (the ShaderCache owns the
+ * programs).
+ */
+class GpuRadixSort {
+public:
+    // Elements handled by one workgroup per pass
+    static constexpr uint32_t kBlockSize = 1024;
+
+    GpuRadixSort() = default;
+    ~GpuRadixSort();
+
+    GpuRadixSort(const GpuRadixSort&) = delete;
+    GpuRadixSort& operator=(const GpuRadixSort&) = delete;
+
+    /**
+     * Get the programs from `shaders`, which must outlive this.
+     *
+     * @throws std::runtime_error if a program fails to build
+     */
+    void init(ShaderCache& shaders);
+    bool ready() const { return m_scatter_program != 0; }
+
+    /**
+     * Sort `count` pairs by the low `bits` bits of their keys (rounded up to
+     * whole 8-bit passes). Each pass reads from one buffer pair and writes
+     * the other. Returns true if the result ended in the alternates, which
+     * happens for an odd number of passes.
+     */
+    bool sort(GLuint keys, GLuint values, GLuint keys_alt, GLuint values_alt, uint32_t count, uint32_t bits);
+
+private:
+    GLuint m_histogram_program = 0;
+    GLuint m_scan_program = 0;
+    GLuint m_scatter_program = 0;
+    std::unique_ptr<Buffer> m_histogram;
+    size_t m_histogram_blocks = 0;   // allocated per-digit rows
+
+    void destroy();
+};
+
+}  // namespace sss
@@ -0,0 +1,61 @@
+#include "GpuTimer.hpp"
+
+namespace sss {
+
+GpuTimer::~GpuTimer() {
+    for (FrameQueries& frame : m_frames) {
+        for (const Query& q : frame.queries) {
+            glDeleteQueries(1, &q.id);
+        }
+    }
+}
+
+void GpuTimer::new_frame() {
+    if (m_active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_active = false;
+    }
+    m_frame = (m_frame + 1) % kFramesInFlight;
+
+    // This set was issued kFramesInFlight frames ago; anything still
+    // pending is dropped rather than waited for
+    FrameQueries& frame = m_frames[m_frame];
+    Profiler& profiler = Profiler::instance();
+    for (size_t i = 0; i < frame.used; ++i) {
+        const Query& q = frame.queries[i];
+        GLint available = 0;
+        glGetQueryObjectiv(q.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(q.id, GL_QUERY_RESULT, &ns);
+            profiler.record(q.pass, (double)ns * 1e-6);
+        }
+    }
+    frame.used = 0;
+}
+
+bool GpuTimer::begin(uint32_t pass) {
+    if (m_active || pass >= Profiler::kMaxPasses) {
+        return false;
+    }
+    FrameQueries& frame = m_frames[m_frame];
+    if (frame.used == frame.queries.size()) {
+        Query q;
+        glGenQueries(1, &q.id);
+        frame.queries.push_back(q);
+    }
+    Query& q = frame.queries[frame.used++];
+    q.pass = pass;
+    glBeginQuery(GL_TIME_ELAPSED, q.id);
+    m_active = true;
+    return true;
+}
+
+void GpuTimer::end() {
+    if (m_active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_active = false;
+    }
+}
+
+}  // namespace sss
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../core/Profiler.hpp"
+
+namespace sss {
+
+/**
+ * GPU pass timing with GL_TIME_ELAPSED queries.
+ *
+ * Queries are kept in a ring of kFramesInFlight per-frame sets. A set is
+ * read back only when the ring wraps around to it, and only if the driver
+ * reports the results available, so timing never waits on the GPU;
+ * results reach the Profiler kFramesInFlight - 1 frames after the pass ran.
+ *
+ * GL_TIME_ELAPSED queries cannot nest: time one pass at a time.
+ */
+class GpuTimer {
+public:
+    static constexpr size_t kFramesInFlight = 4;
+
+    GpuTimer() = default;
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    /**
+     * Collect the oldest frame's results and start recording a new frame.
+     * Call once per frame before any begin().
+     */
+    void new_frame();
+
+    /**
+     * Start timing `pass`. Returns false (and times nothing) while another
+     * pass is being timed.
+     */
+    bool begin(uint32_t pass);
+    void end();
+
+private:
+    struct Query {
+        GLuint id = 0;
+        uint32_t pass = 0;
+    };
+
+    struct FrameQueries {
+        std::vector<Query> queries;   // names are reused across frames
+        size_t used = 0;
+    };
+
+    FrameQueries m_frames[kFramesInFlight];
+    size_t m_frame = 0;
+    bool m_active = false;
+};
+
+/**
+ * Times the enclosing C++ scope as a GPU pass.
+ */
+class GpuScope {
+public:
+    GpuScope(GpuTimer& timer, uint32_t pass) {
+        if (Profiler::instance().enabled() && timer.begin(pass)) {
+            m_timer = &timer;
+        }
+    }
+
+    ~GpuScope() {
+        if (m_timer) {
+            m_timer->end();
+        }
+    }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    GpuTimer* m_timer = nullptr;
+};
+
+}  // namespace sss
+
+#if SSS_PROFILER
+// Time the rest of the enclosing scope as GPU pass `name` on `timer`
+#define SSS_GPU_SCOPE(timer, name)                                                                        \
+    static const uint32_t SSS_PROFILE_CONCAT(sss_gpu_pass_, __LINE__) =                                   \
+        ::sss::Profiler::instance().pass_id(name, ::sss::Profiler::Domain::Gpu);                         \
+    ::sss::GpuScope SSS_PROFILE_CONCAT(sss_gpu_scope_, __LINE__)((timer), SSS_PROFILE_CONCAT(sss_gpu_pass_, __LINE__))
+#else
+#define SSS_GPU_SCOPE(timer, name) ((void)0)
+#endif
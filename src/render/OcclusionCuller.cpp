@@ -0,0 +1,512 @@
+#include "OcclusionCuller.hpp"
+#include "GLCaps.hpp"
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include "../core/Log.hpp"
+#include "../scene/SpatialIndex.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace sss {
+
+namespace {
+
+constexpr uint32_t kGroupSize = 256;
+constexpr uint32_t kTestGroupSize = 64;
+constexpr uint32_t kScanBlock = 1024;   // elements per compaction workgroup
+constexpr float kFarDepth = 1e30f;      // proxy texels no occluder covers
+
+uint32_t div_up(size_t n, uint32_t d) {
+    return (uint32_t)((n + d - 1) / d);
+}
+
+#if SSS_GL_HAS_COMPUTE
+
+// One Hi-Z level from the one below: the farthest depth of the 2x2 texels
+// under each texel, plus the row or column a halving of an odd size drops
+const char* kDownsampleSrc = R"(
+#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(r32f, binding = 0) readonly uniform image2D uSrc;
+layout(r32f, binding = 1) writeonly uniform image2D uDst;
+
+void main() {
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 dst_size = imageSize(uDst);
+    if (any(greaterThanEqual(p, dst_size))) return;
+
+    ivec2 src_size = imageSize(uSrc);
+    ivec2 lo = p * 2;
+    ivec2 hi = min(lo + 1 + ivec2(equal(p, dst_size - 1)) * (src_size & 1), src_size - 1);
+    float farthest = 0.0;
+    for (int y = lo.y; y <= hi.y; ++y) {
+        for (int x = lo.x; x <= hi.x; ++x) {
+            farthest = max(farthest, imageLoad(uSrc, ivec2(x, y)).r);
+        }
+    }
+    imageStore(uDst, p, vec4(farthest));
+}
+)";
+
+// Per leaf: project the box corners, pick the level where the screen rect
+// spans at most 2x2 texels and compare the nearest corner with the
+// farthest occluder there. Boxes crossing the near plane always pass.
+const char* kTestSrc = R"(
+#version 430 core
+layout(local_size_x = 64) in;
+layout(std430, binding = 0) readonly buffer Leaves { vec4 bounds[]; };   // min, max per leaf
+layout(std430, binding = 1) writeonly buffer LeafVisible { uint leaf_visible[]; };
+layout(std430, binding = 2) buffer Command { uint command[]; };          // [4]: occluded leaves
+
+uniform sampler2D uHiZ;   // farthest view depth, mip pyramid
+uniform mat4 uView;
+uniform mat4 uProj;
+uniform uint uLeafCount;
+uniform int uMaxLevel;
+
+void main() {
+    uint leaf = gl_GlobalInvocationID.x;
+    if (leaf >= uLeafCount) return;
+
+    vec3 lo = bounds[leaf * 2u + 0u].xyz;
+    vec3 hi = bounds[leaf * 2u + 1u].xyz;
+    vec2 size = vec2(textureSize(uHiZ, 0));
+    vec2 rect_lo = vec2(1e30);
+    vec2 rect_hi = vec2(-1e30);
+    float nearest = 1e30;
+    bool visible = false;
+    for (int c = 0; c < 8; ++c) {
+        vec3 corner = vec3((c & 1) != 0 ? hi.x : lo.x, (c & 2) != 0 ? hi.y : lo.y, (c & 4) != 0 ? hi.z : lo.z);
+        vec4 cam = uView * vec4(corner, 1.0);
+        vec4 clip = uProj * cam;
+        if (clip.w <= 1e-5) {
+            visible = true;
+            break;
+        }
+        vec2 px = (clip.xy / clip.w * 0.5 + 0.5) * size;
+        rect_lo = min(rect_lo, px);
+        rect_hi = max(rect_hi, px);
+        nearest = min(nearest, -cam.z);
+    }
+
+    if (!visible) {
+        ivec2 a = clamp(ivec2(floor(rect_lo)), ivec2(0), ivec2(size) - 1);
+        ivec2 b = clamp(ivec2(floor(rect_hi)), ivec2(0), ivec2(size) - 1);
+        int extent = max(b.x - a.x, b.y - a.y) + 1;
+        int level = clamp(int(ceil(log2(float(extent)))), 0, uMaxLevel);
+        ivec2 level_max = textureSize(uHiZ, level) - 1;
+        a = min(a >> level, level_max);
+        b = min(b >> level, level_max);
+        float farthest = 0.0;
+        for (int y = a.y; y <= b.y; ++y) {
+            for (int x = a.x; x <= b.x; ++x) {
+                farthest = max(farthest, texelFetch(uHiZ, ivec2(x, y), level).r);
+            }
+        }
+        visible = nearest <= farthest;
+    }
+
+    leaf_visible[leaf] = visible ? 1u : 0u;
+    if (!visible) {
+        atomicAdd(command[4], 1u);
+    }
+}
+)";
+
+// Exclusive scan of the kept flags of the draw order per 1024-element
+// block; each element's offset carries its flag in the top bit
+const char* kCompactBlocksSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer Order { uint order[]; };
+layout(std430, binding = 1) readonly buffer LeafOf { uint leaf_of[]; };
+layout(std430, binding = 2) readonly buffer LeafVisible { uint leaf_visible[]; };
+layout(std430, binding = 3) writeonly buffer Offsets { uint offsets[]; };
+layout(std430, binding = 4) writeonly buffer Sums { uint sums[]; };
+
+uniform uint uCount;
+uniform uint uIndexedCount;   // instances past the index (added since, LOD representatives) are always kept
+
+shared uint s_sum[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint base = gl_WorkGroupID.x * 1024u + lid * 4u;
+
+    uint v[4];
+    uint total = 0u;
+    for (uint r = 0u; r < 4u; ++r) {
+        v[r] = 0u;
+        if (base + r < uCount) {
+            uint index = order[base + r];
+            v[r] = (index >= uIndexedCount || leaf_visible[leaf_of[index]] != 0u) ? 1u : 0u;
+        }
+        total += v[r];
+    }
+    s_sum[lid] = total;
+    barrier();
+
+    for (uint offset = 1u; offset < 256u; offset <<= 1u) {
+        uint x = (lid >= offset) ? s_sum[lid - offset] : 0u;
+        barrier();
+        s_sum[lid] += x;
+        barrier();
+    }
+
+    uint running = s_sum[lid] - total;
+    for (uint r = 0u; r < 4u; ++r) {
+        if (base + r < uCount) {
+            offsets[base + r] = running | (v[r] << 31u);
+        }
+        running += v[r];
+    }
+    if (lid == 255u) {
+        sums[gl_WorkGroupID.x] = s_sum[255];
+    }
+}
+)";
+
+// Exclusive scan of the block totals in one workgroup; the grand total is
+// the instance count of the indirect draw
+const char* kCompactSumsSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 4) buffer Sums { uint sums[]; };
+layout(std430, binding = 5) buffer Command { uint command[]; };
+
+uniform uint uNumBlocks;
+
+shared uint s_sum[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint per = (uNumBlocks + 255u) / 256u;
+    uint first = min(lid * per, uNumBlocks);
+    uint last = min(first + per, uNumBlocks);
+
+    uint total = 0u;
+    for (uint b = first; b < last; ++b) {
+        total += sums[b];
+    }
+    s_sum[lid] = total;
+    barrier();
+
+    for (uint offset = 1u; offset < 256u; offset <<= 1u) {
+        uint x = (lid >= offset) ? s_sum[lid - offset] : 0u;
+        barrier();
+        s_sum[lid] += x;
+        barrier();
+    }
+
+    uint running = s_sum[lid] - total;
+    for (uint b = first; b < last; ++b) {
+        uint c = sums[b];
+        sums[b] = running;
+        running += c;
+    }
+    if (lid == 255u) {
+        command[1] = s_sum[255];
+    }
+}
+)";
+
+// Kept indices to their place in the compacted order
+const char* kCompactScatterSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer Order { uint order[]; };
+layout(std430, binding = 3) readonly buffer Offsets { uint offsets[]; };
+layout(std430, binding = 4) readonly buffer Sums { uint sums[]; };
+layout(std430, binding = 6) writeonly buffer Kept { uint kept[]; };
+
+uniform uint uCount;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uCount) return;
+    uint offset = offsets[i];
+    if ((offset & 0x80000000u) != 0u) {
+        kept[sums[i / 1024u] + (offset & 0x7FFFFFFFu)] = order[i];
+    }
+}
+)";
+
+#endif
+
+}  // namespace
+
+OcclusionCuller::OcclusionCuller() = default;
+
+OcclusionCuller::~OcclusionCuller() {
+    destroy();
+}
+
+void OcclusionCuller::init(ShaderCache& shaders) {
+#if SSS_GL_HAS_COMPUTE
+    if (!GLCaps::compute_shaders()) {
+        throw std::runtime_error("compute shaders unavailable");
+    }
+    destroy();
+    m_test_program = shaders.program({"occlusion_test", nullptr, nullptr, kTestSrc});
+    m_downsample_program = shaders.program({"occlusion_downsample", nullptr, nullptr, kDownsampleSrc});
+    m_compact_blocks_program = shaders.program({"occlusion_compact_blocks", nullptr, nullptr, kCompactBlocksSrc});
+    m_compact_sums_program = shaders.program({"occlusion_compact_sums", nullptr, nullptr, kCompactSumsSrc});
+    m_compact_scatter_program = shaders.program({"occlusion_compact_scatter", nullptr, nullptr, kCompactScatterSrc});
+
+    for (std::unique_ptr<Buffer>* b : {&m_leaf_bounds, &m_leaf_of, &m_leaf_visible, &m_offsets, &m_block_sums,
+                                       &m_indices}) {
+        *b = std::make_unique<Buffer>();
+    }
+    for (std::unique_ptr<Buffer>& command : m_commands) {
+        command = std::make_unique<Buffer>();
+        command->allocate(GL_DRAW_INDIRECT_BUFFER, 8 * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glGenFramebuffers(1, &m_fbo);
+#else
+    (void)shaders;
+    throw std::runtime_error("built without GL 4.3 support");
+#endif
+}
+
+void OcclusionCuller::set_index(std::shared_ptr<const SpatialIndex> index) {
+    if (index && index->empty()) {
+        index.reset();
+    }
+    const uint64_t id = index ? index->id() : 0;
+    if (id == m_index_id) {
+        return;
+    }
+    const bool same_layout = index && m_index && index->layout() == m_index->layout();
+    m_index = std::move(index);
+    m_index_id = id;
+    if (!m_index) {
+        m_leaf_count = 0;
+        m_indexed = 0;
+        return;
+    }
+
+    // Leaves in node order, and unless only the bounds moved, the leaf of
+    // every gaussian through the slots each one covers
+    std::vector<glm::vec4> bounds;
+    std::vector<uint32_t> leaf_of(same_layout ? 0 : m_index->size(), 0);
+    const std::vector<uint32_t>& order = m_index->order();
+    for (const SpatialIndex::Node& node : m_index->nodes()) {
+        if (node.left != SpatialIndex::kLeaf) {
+            continue;
+        }
+        const uint32_t leaf = (uint32_t)(bounds.size() / 2);
+        bounds.emplace_back(node.bounds_min, 0.f);
+        bounds.emplace_back(node.bounds_max, 0.f);
+        for (uint32_t slot = node.first; !same_layout && slot < node.first + node.count; ++slot) {
+            leaf_of[order[slot]] = leaf;
+        }
+    }
+    if (same_layout) {
+        m_leaf_bounds->update_data(GL_SHADER_STORAGE_BUFFER, 0, bounds.data(), bounds.size());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return;
+    }
+    m_leaf_count = bounds.size() / 2;
+    m_indexed = m_index->size();
+    m_leaf_bounds->set_data(GL_SHADER_STORAGE_BUFFER, bounds, GL_DYNAMIC_DRAW);
+    m_leaf_of->set_data(GL_SHADER_STORAGE_BUFFER, leaf_of, GL_STATIC_DRAW);
+    m_leaf_visible->allocate(GL_SHADER_STORAGE_BUFFER, m_leaf_count * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+bool OcclusionCuller::active(size_t scene_count) const {
+    return m_index && m_index->size() <= scene_count;
+}
+
+void OcclusionCuller::begin_proxy(int width, int height) {
+    resize(std::max(1, (width + kProxyDownscale - 1) / kProxyDownscale),
+           std::max(1, (height + kProxyDownscale - 1) / kProxyDownscale));
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_width, m_height);
+    const GLfloat far[4] = {kFarDepth, 0.f, 0.f, 0.f};
+    glClearBufferfv(GL_COLOR, 0, far);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void OcclusionCuller::cull(const glm::mat4& view, const glm::mat4& projection, const Buffer& order, size_t count) {
+#if SSS_GL_HAS_COMPUTE
+    // Read the counts of the command used kCommandSlots culls ago, then
+    // reuse it. If its fence hasn't signaled the read would stall on the
+    // GPU, so the last counts are kept instead
+    m_command = (size_t)(m_culls++ % kCommandSlots);
+    Buffer& command = *m_commands[m_command];
+    command.bind(GL_SHADER_STORAGE_BUFFER);
+    GLsync& fence = m_command_fences[m_command];
+    bool done_ready = true;   // no fence: that cull dispatched nothing
+    if (fence) {
+        const GLenum status = glClientWaitSync(fence, 0, 0);
+        done_ready = status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_culls > kCommandSlots && done_ready) {
+        uint32_t done[8];
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(done), done);
+        m_stats.chunks = m_leaf_count;
+        m_stats.occluded_chunks = done[4];
+        m_stats.tested = m_command_tested[m_command];
+        m_stats.drawn = done[1];
+    }
+    const uint32_t reset[8] = {6u, 0u, 0u, 0u, 0u, 0u, 0u, 0u};   // count, instances, first, base instance
+    command.update_data(GL_SHADER_STORAGE_BUFFER, 0, reset, 8);
+    m_command_tested[m_command] = count;
+    const uint32_t n = (uint32_t)count;
+    if (n == 0 || m_leaf_count == 0) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return;
+    }
+    reserve(count);
+
+    // 2. Hi-Z pyramid over the proxy
+    glUseProgram(m_downsample_program);
+    for (int level = 1; level < m_levels; ++level) {
+        glBindImageTexture(0, m_hiz, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, m_hiz, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute(div_up((size_t)std::max(1, m_width >> level), 8),
+                          div_up((size_t)std::max(1, m_height >> level), 8), 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    // 3. Leaf boxes against the pyramid
+    GLuint p = m_test_program;
+    glUseProgram(p);
+    glUniformMatrix4fv(Shader::get_uniform_location(p, "uView"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(Shader::get_uniform_location(p, "uProj"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1ui(Shader::get_uniform_location(p, "uLeafCount"), (GLuint)m_leaf_count);
+    glUniform1i(Shader::get_uniform_location(p, "uMaxLevel"), m_levels - 1);
+    glUniform1i(Shader::get_uniform_location(p, "uHiZ"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_hiz);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_leaf_bounds->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_leaf_visible->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, command.handle());
+    glDispatchCompute(div_up(m_leaf_count, kTestGroupSize), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 4. Order-preserving compaction of the draw order
+    const uint32_t num_blocks = div_up(n, kScanBlock);
+    p = m_compact_blocks_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uCount"), n);
+    glUniform1ui(Shader::get_uniform_location(p, "uIndexedCount"), (GLuint)m_indexed);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, order.handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_leaf_of->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_leaf_visible->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_offsets->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_block_sums->handle());
+    glDispatchCompute(num_blocks, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    p = m_compact_sums_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uNumBlocks"), num_blocks);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, command.handle());
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    p = m_compact_scatter_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uCount"), n);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, m_indices->handle());
+    glDispatchCompute(div_up(n, kGroupSize), 1, 1);
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glUseProgram(0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+#else
+    (void)view;
+    (void)projection;
+    (void)order;
+    (void)count;
+#endif
+}
+
+void OcclusionCuller::resize(int width, int height) {
+#if SSS_GL_HAS_COMPUTE
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    if (m_hiz != 0) {
+        glDeleteTextures(1, &m_hiz);
+        glDeleteTextures(1, &m_depth);
+    }
+    m_width = width;
+    m_height = height;
+    m_levels = 1;
+    while ((std::max(width, height) >> m_levels) > 0) {
+        ++m_levels;
+    }
+
+    glGenTextures(1, &m_hiz);
+    glBindTexture(GL_TEXTURE_2D, m_hiz);
+    glTexStorage2D(GL_TEXTURE_2D, m_levels, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenTextures(1, &m_depth);
+    glBindTexture(GL_TEXTURE_2D, m_depth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT,
+                 nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_hiz, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        SSS_LOG_ERROR("[OcclusionCuller] Depth proxy framebuffer incomplete (%d x %d)", width, height);
+    }
+#else
+    (void)width;
+    (void)height;
+#endif
+}
+
+void OcclusionCuller::reserve(size_t count) {
+    if (count <= m_capacity) {
+        return;
+    }
+    m_capacity = std::max(count, m_capacity + m_capacity / 2);
+    m_offsets->allocate(GL_SHADER_STORAGE_BUFFER, m_capacity * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    m_indices->allocate(GL_SHADER_STORAGE_BUFFER, m_capacity * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    m_block_sums->allocate(GL_SHADER_STORAGE_BUFFER, (div_up(m_capacity, kScanBlock) + 1) * sizeof(uint32_t),
+                           GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void OcclusionCuller::destroy() {
+    // The programs belong to the ShaderCache
+    for (GLuint* p : {&m_test_program, &m_downsample_program, &m_compact_blocks_program, &m_compact_sums_program,
+                      &m_compact_scatter_program}) {
+        *p = 0;
+    }
+    for (GLsync& fence : m_command_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (m_hiz != 0) {
+        glDeleteTextures(1, &m_hiz);
+        glDeleteTextures(1, &m_depth);
+        m_hiz = m_depth = 0;
+    }
+    if (m_fbo != 0) {
+        glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+    m_width = m_height = m_levels = 0;
+    m_capacity = 0;
+}
+
+}  // namespace sss
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "Buffers.hpp"
+
+namespace sss {
+
+class ShaderCache;
+class SpatialIndex;
+
+/**
+ * Occlusion culling results, a few frames old (they are read back without
+ * waiting on the GPU).
+ */
+struct OcclusionStats {
+    size_t chunks = 0;            // spatial index leaves tested
+    size_t occluded_chunks = 0;
+    size_t tested = 0;            // splats in
+    size_t drawn = 0;             // splats out
+};
+
+/**
+ * GPU occlusion culling for the quad backend (GL 4.3), at the granularity
+ * of SpatialIndex leaves ("chunks"):
+ *
+ *  1. the renderer draws the nearly opaque core of every visible splat
+ *     into a depth proxy at 1/kProxyDownscale of its size, keeping the
+ *     nearest view depth per texel (begin_proxy())
+ *  2. the proxy is reduced into a Hi-Z pyramid, each texel holding the
+ *     farthest depth of the four (or, at odd edges, more) below it
+ *  3. each leaf's box is projected and tested against the pyramid level
+ *     where it covers at most 2x2 texels; it is occluded if its nearest
+ *     corner lies behind everything there
+ *  4. the depth-sorted draw order is compacted to the splats of leaves
+ *     that passed, keeping its order, and the instance count is written
+ *     straight into an indirect draw command
+ *
+ * Nothing is read back, so the CPU never waits for the result. Splats are
+ * not opaque, so this is an approximation: what it drops lies behind
+ * proxy texels of alpha >= the proxy threshold.
+ */
+class OcclusionCuller {
+public:
+    static constexpr int kProxyDownscale = 4;
+    static constexpr float kDefaultProxyAlpha = 0.95f;   // alpha a splat must reach to occlude
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    /**
+     * Get the programs from `shaders`, which must outlive this.
+     *
+     * @throws std::runtime_error if compute shaders are unavailable or a
+     *         program fails to build
+     */
+    void init(ShaderCache& shaders);
+
+    /**
+     * Take the chunks from `index` (null disables culling) and the chunk of
+     * each of its gaussians. Cheap when the index is the current one, and
+     * only the chunk bounds are uploaded for a refit of it.
+     */
+    void set_index(std::shared_ptr<const SpatialIndex> index);
+
+    /**
+     * True if the index covers no more than `scene_count` gaussians, so
+     * cull() can run for a scene of that size.
+     */
+    bool active(size_t scene_count) const;
+
+    /**
+     * Bind and clear the depth proxy for a `width` x `height` view; the
+     * caller then draws the occluders into it (writing view depth to
+     * color 0, with depth test and writes on) and rebinds its framebuffer.
+     * A new size reallocates the proxy and pyramid, so pass one that stays
+     * put from frame to frame, such as the window's.
+     */
+    void begin_proxy(int width, int height);
+
+    /**
+     * Build the Hi-Z pyramid from the proxy, test every chunk, and compact
+     * `count` indices in draw order from `order` into indices(). Indices
+     * past the index (gaussians added since it was built, and LOD
+     * representatives) are always kept.
+     */
+    void cull(const glm::mat4& view, const glm::mat4& projection, const Buffer& order, size_t count);
+
+    /**
+     * Draw order after the last cull(), and the DrawArraysIndirectCommand
+     * (6 vertices per instance) that draws exactly its length.
+     */
+    const Buffer& indices() const { return *m_indices; }
+    const Buffer& draw_command() const { return *m_commands[m_command]; }
+
+    // Counts from a cull a few frames back; they stay put while the GPU lags
+    OcclusionStats stats() const { return m_stats; }
+
+    float proxy_alpha() const { return m_proxy_alpha; }
+    void set_proxy_alpha(float alpha) { m_proxy_alpha = alpha; }
+
+private:
+    static constexpr size_t kCommandSlots = 3;   // commands in flight; the oldest one's counts are read
+                                                 // once its fence has signaled
+
+    std::shared_ptr<const SpatialIndex> m_index;
+    uint64_t m_index_id = 0;
+    size_t m_leaf_count = 0;
+    size_t m_indexed = 0;                     // gaussians the index covers
+    float m_proxy_alpha = kDefaultProxyAlpha;
+
+    GLuint m_test_program = 0;       // programs owned by the ShaderCache
+    GLuint m_downsample_program = 0;
+    GLuint m_compact_blocks_program = 0;
+    GLuint m_compact_sums_program = 0;
+    GLuint m_compact_scatter_program = 0;
+
+    // Proxy and Hi-Z pyramid (level 0 is the proxy's color)
+    GLuint m_fbo = 0;
+    GLuint m_hiz = 0;
+    GLuint m_depth = 0;
+    int m_width = 0;
+    int m_height = 0;
+    int m_levels = 0;
+
+    std::unique_ptr<Buffer> m_leaf_bounds;    // per leaf: min, max as vec4
+    std::unique_ptr<Buffer> m_leaf_of;        // per scene gaussian
+    std::unique_ptr<Buffer> m_leaf_visible;   // per leaf, from the test
+    size_t m_capacity = 0;                    // order elements the buffers below hold
+    std::unique_ptr<Buffer> m_offsets;        // per element: offset in block, drawn flag in the top bit
+    std::unique_ptr<Buffer> m_block_sums;
+    std::unique_ptr<Buffer> m_indices;
+    std::unique_ptr<Buffer> m_commands[kCommandSlots];   // command, then the occluded chunk count
+    size_t m_command = 0;
+    size_t m_command_tested[kCommandSlots] = {};
+    GLsync m_command_fences[kCommandSlots] = {};         // after each cull's dispatches
+    uint64_t m_culls = 0;
+    OcclusionStats m_stats;
+
+    void resize(int width, int height);
+    void reserve(size_t count);
+    void destroy();
+};
+
+}  // namespace sss
@@ -0,0 +1,208 @@
+#include "RenderTarget.hpp"
+#include "../core/Log.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace sss {
+
+namespace {
+
+GLuint create_texture(GLint internal_format, GLenum format, GLenum type, int width, int height) {
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+    // Single level, sampled as-is
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+}  // namespace
+
+RenderTarget::RenderTarget(int width, int height, uint32_t attachments)
+    : m_attachments(attachments & (kAttachColor | kAttachDepth)) {
+    if (m_attachments == 0) {
+        throw std::runtime_error("Render target needs at least one attachment");
+    }
+    for (Slot& slot : m_slots) {
+        slot.pack = std::make_unique<Buffer>();
+    }
+    glGenFramebuffers(1, &m_fbo);
+    resize(width, height);
+}
+
+RenderTarget::~RenderTarget() {
+    destroy();
+}
+
+void RenderTarget::resize(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("Render target size must be positive");
+    }
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    release_slots();
+    if (m_color != 0) {
+        glDeleteTextures(1, &m_color);
+        m_color = 0;
+    }
+    if (m_depth != 0) {
+        glDeleteTextures(1, &m_depth);
+        m_depth = 0;
+    }
+    m_width = width;
+    m_height = height;
+
+    // Color on attachment 0 and depth on 1 whichever are present, matching
+    // the splat shaders' output locations
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    if (has(kAttachColor)) {
+        m_color = create_texture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color, 0);
+    }
+    if (has(kAttachDepth)) {
+        m_depth = create_texture(GL_R32F, GL_RED, GL_FLOAT, width, height);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_depth, 0);
+    }
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Render target framebuffer incomplete: 0x" + std::to_string(status));
+    }
+}
+
+void RenderTarget::bind_and_clear() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    const GLenum buffers[2] = {has(kAttachColor) ? GLenum(GL_COLOR_ATTACHMENT0) : GLenum(GL_NONE),
+                               has(kAttachDepth) ? GLenum(GL_COLOR_ATTACHMENT1) : GLenum(GL_NONE)};
+    glDrawBuffers(2, buffers);
+    glViewport(0, 0, m_width, m_height);
+
+    const GLfloat zero[4] = {0.f, 0.f, 0.f, 0.f};
+    if (has(kAttachColor)) {
+        glClearBufferfv(GL_COLOR, 0, zero);
+    }
+    if (has(kAttachDepth)) {
+        glClearBufferfv(GL_COLOR, 1, zero);
+    }
+}
+
+size_t RenderTarget::color_bytes() const {
+    return has(kAttachColor) ? (size_t)m_width * m_height * 4 : 0;
+}
+
+size_t RenderTarget::depth_bytes() const {
+    return has(kAttachDepth) ? (size_t)m_width * m_height * sizeof(float) : 0;
+}
+
+uint64_t RenderTarget::request_readback() {
+    if (m_pending == kReadbackSlots) {
+        ++m_dropped;
+        return 0;
+    }
+    Slot& slot = m_slots[m_next_slot];
+    const size_t bytes = color_bytes() + depth_bytes();
+    slot.pack->bind(GL_PIXEL_PACK_BUFFER);
+    if (slot.width != m_width || slot.height != m_height) {
+        slot.pack->allocate(GL_PIXEL_PACK_BUFFER, bytes, GL_STREAM_READ);
+        slot.width = m_width;
+        slot.height = m_height;
+    }
+
+    // Rows of RGBA8 and R32F are always 4-byte aligned
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    if (has(kAttachColor)) {
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    }
+    if (has(kAttachDepth)) {
+        glReadBuffer(GL_COLOR_ATTACHMENT1);
+        glReadPixels(0, 0, m_width, m_height, GL_RED, GL_FLOAT, (void*)color_bytes());
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Without a flush the fence may never reach the GPU before the poll
+    glFlush();
+    slot.ticket = m_next_ticket++;
+    m_next_slot = (m_next_slot + 1) % kReadbackSlots;
+    ++m_pending;
+    return slot.ticket;
+}
+
+bool RenderTarget::poll_readback(RenderReadback& out) {
+    if (m_pending == 0) {
+        return false;
+    }
+    Slot& slot = m_slots[(m_next_slot + kReadbackSlots - m_pending) % kReadbackSlots];
+    const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    --m_pending;
+    if (status == GL_WAIT_FAILED) {
+        // The copy may never have finished; don't map it
+        SSS_LOG_ERROR("[RenderTarget] Readback %llu fence wait failed (GL error 0x%x); dropped",
+                      (unsigned long long)slot.ticket, glGetError());
+        ++m_dropped;
+        return false;
+    }
+
+    const size_t color = color_bytes();
+    const size_t depth = depth_bytes();
+    out.ticket = slot.ticket;
+    out.width = slot.width;
+    out.height = slot.height;
+    out.color.resize(color);
+    out.depth.resize(depth / sizeof(float));
+
+    slot.pack->bind(GL_PIXEL_PACK_BUFFER);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)(color + depth), GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(out.color.data(), mapped, color);
+        std::memcpy(out.depth.data(), (const uint8_t*)mapped + color, depth);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return mapped != nullptr;
+}
+
+void RenderTarget::release_slots() {
+    for (Slot& slot : m_slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+    }
+    m_pending = 0;
+}
+
+void RenderTarget::destroy() {
+    release_slots();
+    for (Slot& slot : m_slots) {
+        slot.pack.reset();
+    }
+    if (m_color != 0) {
+        glDeleteTextures(1, &m_color);
+        m_color = 0;
+    }
+    if (m_depth != 0) {
+        glDeleteTextures(1, &m_depth);
+        m_depth = 0;
+    }
+    if (m_fbo != 0) {
+        glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+}
+
+}  // namespace sss
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Buffers.hpp"
+
+namespace sss {
+
+/**
+ * Attachments of a RenderTarget, combinable as a bit mask.
+ */
+enum RenderAttachment : uint32_t {
+    // RGBA8: premultiplied color over a transparent background, alpha =
+    // accumulated opacity
+    kAttachColor = 1u << 0,
+    // R32F: opacity-weighted view depth, sum of alpha_i * T_i * z_i; divide
+    // by the color's alpha for the expected depth of the covered part
+    kAttachDepth = 1u << 1,
+};
+
+/**
+ * One completed readback of a RenderTarget. Rows are bottom-up, as GL
+ * stores them.
+ */
+struct RenderReadback {
+    uint64_t ticket = 0;           // from RenderTarget::request_readback()
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> color;    // RGBA8, width * height * 4 (if kAttachColor)
+    std::vector<float> depth;      // width * height (if kAttachDepth)
+};
+
+/**
+ * Offscreen framebuffer for rendering a scene from an arbitrary pose and
+ * size, e.g. a tracking camera at sensor resolution, with asynchronous
+ * readback through a ring of pixel-pack buffers.
+ *
+ * request_readback() issues glReadPixels into the next free pack buffer
+ * and fences it, so it returns as soon as the copy is queued. Once the
+ * fence has passed, poll_readback() maps the buffer and hands the pixels
+ * over without waiting. With kReadbackSlots buffers in flight, a caller
+ * can render and request frame N+1 while frame N is still being copied.
+ */
+class RenderTarget {
+public:
+    static constexpr size_t kReadbackSlots = 3;
+
+    /**
+     * @throws std::runtime_error if the framebuffer is incomplete
+     */
+    RenderTarget(int width, int height, uint32_t attachments = kAttachColor | kAttachDepth);
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    /**
+     * Reallocate the attachments; readbacks in flight are dropped.
+     */
+    void resize(int width, int height);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    uint32_t attachments() const { return m_attachments; }
+    bool has(RenderAttachment attachment) const { return (m_attachments & attachment) != 0; }
+
+    GLuint framebuffer() const { return m_fbo; }
+    GLuint color_texture() const { return m_color; }
+    GLuint depth_texture() const { return m_depth; }
+
+    /**
+     * Bind the framebuffer with its attachments as draw buffers, set the
+     * viewport to it and clear it to transparent black and zero depth.
+     */
+    void bind_and_clear();
+
+    /**
+     * Queue a copy of the target's current contents (call after rendering
+     * into it). Never waits on the GPU.
+     *
+     * @return Ticket identifying the readback, or 0 if every slot is still
+     *         in flight; poll_readback() frees them
+     */
+    uint64_t request_readback();
+
+    /**
+     * Fetch the oldest readback if its copy has finished, without waiting.
+     * One whose fence wait fails is logged and dropped.
+     *
+     * @return true if `out` was filled
+     */
+    bool poll_readback(RenderReadback& out);
+
+    /**
+     * Readbacks queued and not yet returned by poll_readback().
+     */
+    size_t readbacks_pending() const { return m_pending; }
+
+    // Requests refused because every slot was in flight, and readbacks
+    // lost to a failed fence wait
+    uint64_t readbacks_dropped() const { return m_dropped; }
+
+private:
+    struct Slot {
+        std::unique_ptr<Buffer> pack;   // color then depth
+        GLsync fence = nullptr;
+        uint64_t ticket = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    int m_width = 0;
+    int m_height = 0;
+    uint32_t m_attachments = 0;
+    GLuint m_fbo = 0;
+    GLuint m_color = 0;
+    GLuint m_depth = 0;
+
+    Slot m_slots[kReadbackSlots];
+    size_t m_next_slot = 0;      // where the next request goes
+    size_t m_pending = 0;        // in flight, oldest at m_next_slot - m_pending
+    uint64_t m_next_ticket = 1;
+    uint64_t m_dropped = 0;
+
+    size_t color_bytes() const;
+    size_t depth_bytes() const;
+    void release_slots();
+    void destroy();
+};
+
+}  // namespace sss
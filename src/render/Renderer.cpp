@@ -1,34 +1,245 @@
 #include "Renderer.hpp"
+#include "GLCaps.hpp"
+#include "RenderTarget.hpp"
+#include "../core/Log.hpp"
+#include "../core/ThreadPool.hpp"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace sss {
 
-Renderer::Renderer() = default;
+namespace {
+
+const glm::vec3 kClearColor(0.1f, 0.1f, 0.1f);
+
+// EWA splatting: each splat's world covariance is projected to a 2D
+// pixel covariance (project_covariance in SplatGlsl) and the quad is
+// laid along its eigenvectors out to where the gaussian falls below
+// 1/255 of its peak. Built once per instance format
+// (splat_format_defines()).
+const char* kQuadVertexSrc = R"(
+#version 330 core
+layout(location=0) in vec2 aQuadPos;
+layout(location=1) in uint iIndex;
+
+uniform usamplerBuffer uInstances;    // 4 texels per GaussianInstanceGPU, 2 per GaussianInstanceCompact
+uniform samplerBuffer uCovariances;   // 2 texels per GaussianCovarianceGPU (full format)
+uniform mat4 uView;
+uniform mat4 uProj;
+uniform vec2 uViewport;               // pixels
+#ifdef SSS_DEPTH_PROXY
+uniform float uProxyAlpha;
+#endif
+
+out vec2 vLocalPos;   // offset from the mean in standard deviations
+out vec3 vColor;
+out float vOpacity;
+flat out float vDepth;   // view depth of the mean
 
-Renderer::~Renderer() {
-    if (m_program != 0) {
-        glDeleteProgram(m_program);
+void main() {
+    SplatInstance s;
+    mat3 sigma;
+#ifdef SSS_COMPACT_INSTANCES
+    int base = int(iIndex) * 2;
+    s = decode_compact(texelFetch(uInstances, base + 0), texelFetch(uInstances, base + 1));
+    sigma = splat_covariance(s);
+#else
+    int base = int(iIndex) * 4;
+    s = decode_full(texelFetch(uInstances, base + 0), texelFetch(uInstances, base + 1),
+                    texelFetch(uInstances, base + 2), texelFetch(uInstances, base + 3));
+    sigma = unpack_covariance(texelFetch(uCovariances, int(iIndex) * 2 + 0),
+                              texelFetch(uCovariances, int(iIndex) * 2 + 1));
+#endif
+
+#ifdef SSS_DEPTH_PROXY
+    vColor = vec3(0.0);   // depth only
+#else
+    vColor = eval_sh(iIndex, s.color, s.mean);
+#endif
+    vOpacity = s.opacity;
+
+    vec4 cam = uView * vec4(s.mean, 1.0);
+    vec4 clip = uProj * cam;
+    vDepth = -cam.z;
+#ifdef SSS_DEPTH_PROXY
+    // Only the core where the splat stays at least uProxyAlpha opaque
+    float k = vOpacity > uProxyAlpha ? min(sqrt(2.0 * log(vOpacity / uProxyAlpha)), 3.0) : 0.0;
+#else
+    // Extent at which opacity * exp(-r^2 / 2) drops to 1/255, capped at
+    // the 3 sigma the culler uses
+    float k = min(sqrt(2.0 * log(max(vOpacity * 255.0, 1.0))), 3.0);
+#endif
+    if (clip.w <= 0.0 || k <= 0.0) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);   // outside the clip volume
+        return;
     }
+
+    vec3 cov = project_covariance(cam.xyz, sigma, uView, uProj, uViewport);
+    float a = cov.x;
+    float b = cov.y;
+    float c = cov.z;
+
+    // Eigen-decomposition of the symmetric 2x2 [a b; b c]
+    float mid = 0.5 * (a + c);
+    float rad = length(vec2(0.5 * (a - c), b));
+    float l1 = mid + rad;
+    float l2 = max(mid - rad, 0.0);
+    float theta = 0.5 * atan(2.0 * b, a - c);
+    vec2 major = vec2(cos(theta), sin(theta));
+    vec2 minor = vec2(-major.y, major.x);
+
+    vLocalPos = aQuadPos * k;
+    vec2 offset = major * (vLocalPos.x * sqrt(l1)) + minor * (vLocalPos.y * sqrt(l2));
+    gl_Position = clip + vec4(offset * 2.0 / uViewport * clip.w, 0.0, 0.0);
 }
+)";
+
+const char* kQuadFragmentSrc = R"(
+#version 330 core
+in vec2 vLocalPos;
+in vec3 vColor;
+in float vOpacity;
+flat in float vDepth;
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 DepthOut;   // offscreen targets only; blends like color
+
+void main() {
+    float alpha = vOpacity * exp(-0.5 * dot(vLocalPos, vLocalPos));
+
+    if (alpha < 1.0 / 255.0) discard;
+
+    FragColor = vec4(vColor * alpha, alpha);
+    DepthOut = vec4(vDepth * alpha, 0.0, 0.0, alpha);
+}
+)";
+
+// Occluder depth for OcclusionCuller: the nearest view depth among the
+// splat cores covering each proxy texel (depth test on the means)
+const char* kProxyFragmentSrc = R"(
+#version 330 core
+in vec2 vLocalPos;
+in float vOpacity;
+flat in float vDepth;
+uniform float uProxyAlpha;
+layout(location = 0) out float DepthOut;
+
+void main() {
+    if (vOpacity * exp(-0.5 * dot(vLocalPos, vLocalPos)) < uProxyAlpha) discard;
+    DepthOut = vDepth;
+}
+)";
+
+const ShaderProgramDesc kQuadProgram{"splat_quad", kQuadVertexSrc, kQuadFragmentSrc, nullptr, true};
+const ShaderProgramDesc kProxyProgram{"splat_depth_proxy", kQuadVertexSrc, kProxyFragmentSrc, nullptr, true};
+
+}  // namespace
+
+const char* render_backend_name(RenderBackend backend) {
+    switch (backend) {
+        case RenderBackend::Quads: return "quads";
+        case RenderBackend::Tiles: return "tiles";
+        default:                   return "unknown";
+    }
+}
+
+Renderer::Renderer() = default;
+
+Renderer::~Renderer() = default;
 
 void Renderer::init(int width, int height) {
     m_viewport_width = width;
     m_viewport_height = height;
 
-    // Create shader program
-    create_shader_program();
+    // Every program comes from the cache, which survives re-initialization
+    if (!m_shaders) {
+        m_shaders = std::make_unique<ShaderCache>();
+        m_shaders->init(ShaderCache::default_binary_directory(), ShaderCache::default_source_directory());
+    }
+    const double shader_ms = m_shaders->stats().compile_ms;
+
+    m_occlusion.reset();
+    if (GLCaps::compute_shaders()) {
+        try {
+            m_occlusion = std::make_unique<OcclusionCuller>();
+            m_occlusion->init(*m_shaders);
+        } catch (const std::exception& e) {
+            SSS_LOG_WARN("[Renderer] Occlusion culling unavailable: %s", e.what());
+            m_occlusion.reset();
+        }
+    }
+    create_quad_programs();
+
+    m_resolution.reset();
+    m_dynamic_resolution = false;
+    try {
+        m_resolution = std::make_unique<DynamicResolution>();
+        m_resolution->init(*m_shaders);
+    } catch (const std::exception& e) {
+        SSS_LOG_WARN("[Renderer] Dynamic resolution unavailable: %s", e.what());
+        m_resolution.reset();
+    }
 
     // Create quad mesh
     m_quad_mesh = std::make_unique<QuadMesh>();
 
     // Create instance buffer
     m_instance_buffer = std::make_unique<InstanceBuffer>();
+    m_instance_buffer->vbo = std::make_unique<Buffer>();
+    m_instance_buffer->texture = std::make_unique<TextureBuffer>();
+    m_instance_buffer->cov_vbo = std::make_unique<Buffer>();
+    m_instance_buffer->cov_texture = std::make_unique<TextureBuffer>();
+    m_instance_buffer->sh_vbo = std::make_unique<Buffer>();
+    m_instance_buffer->sh_texture = std::make_unique<TextureBuffer>();
+    m_upload_ring = std::make_unique<UploadRing>();
+
+    // Create depth sorter (its index buffer drives the draw order)
+    m_sorter = std::make_unique<SplatSorter>();
+    m_sorter->init(*m_shaders);
+    m_culler = std::make_unique<SplatCuller>();
+    m_cull_valid = false;
+    m_gpu_timer = std::make_unique<GpuTimer>();
+
+    // Tile rasterization where compute shaders allow, quads otherwise
+    m_tile_rasterizer.reset();
+    m_backend = RenderBackend::Quads;
+    if (GLCaps::compute_shaders()) {
+        try {
+            m_tile_rasterizer = std::make_unique<TileRasterizer>();
+            m_tile_rasterizer->init(width, height, *m_shaders);
+            m_backend = RenderBackend::Tiles;
+        } catch (const std::exception& e) {
+            SSS_LOG_WARN("[Renderer] Tile rasterizer unavailable, using quads: %s", e.what());
+            m_tile_rasterizer.reset();
+        }
+    }
+
+    m_attribute_indices = nullptr;
+    setup_instance_attributes(m_sorter->index_buffer());
+
+    const ShaderCacheStats& shaders = m_shaders->stats();
+    SSS_LOG_INFO("[Renderer] %zu shader programs ready in %.1f ms (%zu from binaries)", shaders.programs,
+                 shaders.compile_ms - shader_ms, shaders.loaded);
+}
+
+void Renderer::resize(int width, int height) {
+    m_viewport_width = width;
+    m_viewport_height = height;
+    if (m_tile_rasterizer) {
+        m_tile_rasterizer->resize(width, height);
+    }
 }
 
 void Renderer::begin_frame() {
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    // Hot reload relinks programs in place, resetting their uniforms
+    if (m_shaders->poll()) {
+        create_quad_programs();
+    }
+    m_gpu_timer->new_frame();
+    m_frame_memory.begin_frame();
+    glClearColor(kClearColor.r, kClearColor.g, kClearColor.b, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glViewport(0, 0, m_viewport_width, m_viewport_height);
 }
@@ -41,28 +252,193 @@ float Renderer::aspect_ratio() const {
     return (m_viewport_height > 0) ? (float)m_viewport_width / (float)m_viewport_height : 1.f;
 }
 
-void Renderer::render_scene(const Scene& scene, const glm::mat4& view, const glm::mat4& projection) {
-    const auto& gaussians = scene.get_gaussians();
-    if (gaussians.empty()) {
+void Renderer::set_sort_mode(SortMode mode) {
+    m_sorter->set_mode(mode);
+}
+
+SortMode Renderer::sort_mode() const {
+    return m_sorter ? m_sorter->mode() : SortMode::None;
+}
+
+void Renderer::set_backend(RenderBackend backend) {
+    if (backend == RenderBackend::Tiles && !m_tile_rasterizer) {
+        backend = RenderBackend::Quads;
+    }
+    m_backend = backend;
+}
+
+void Renderer::set_culling(bool enabled) {
+    if (enabled != m_culling) {
+        m_culling = enabled;
+        m_cull_valid = false;
+    }
+}
+
+void Renderer::set_lod(bool enabled) {
+    if (enabled != m_lod) {
+        m_lod = enabled;
+        m_cull_valid = false;
+    }
+}
+
+void Renderer::set_lod_error(float pixels) {
+    pixels = std::max(pixels, 0.01f);
+    if (pixels != m_lod_error) {
+        m_lod_error = pixels;
+        m_cull_valid = false;
+    }
+}
+
+void Renderer::set_dynamic_resolution(bool enabled) {
+    enabled = enabled && m_resolution;
+    if (enabled && !m_dynamic_resolution) {
+        m_resolution->reset();
+    }
+    m_dynamic_resolution = enabled;
+}
+
+void Renderer::set_target_frame_ms(float ms) {
+    if (m_resolution) {
+        m_resolution->set_target_ms(ms);
+    }
+}
+
+float Renderer::target_frame_ms() const {
+    return m_resolution ? m_resolution->target_ms() : DynamicResolution::kDefaultTargetMs;
+}
+
+OcclusionStats Renderer::occlusion_stats() const {
+    return m_occlusion_drawn ? m_occlusion->stats() : OcclusionStats{};
+}
+
+void Renderer::set_max_sh_degree(int degree) {
+    m_max_sh_degree = std::clamp(degree, 0, kMaxShDegree);
+}
+
+void Renderer::render_scene(Scene& scene, const glm::mat4& view, const glm::mat4& projection) {
+    if (m_dynamic_resolution) {
+        // Into the scaled target, then upsampled over the cleared window
+        SSS_PROFILE_SCOPE("Scaled view");
+        RenderTarget& target = m_resolution->begin(m_viewport_width, m_viewport_height);
+        render_scene(scene, view, projection, target);
+        m_resolution->end(m_viewport_width, m_viewport_height);
         return;
     }
+    draw_scene(scene, view, projection, nullptr);
+}
+
+void Renderer::render_scene(Scene& scene, const glm::mat4& view, const glm::mat4& projection, RenderTarget& target) {
+    target.bind_and_clear();
+    draw_scene(scene, view, projection, &target);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, m_viewport_width, m_viewport_height);
+}
 
-    // Convert gaussians to GPU format
-    std::vector<GaussianInstanceGPU> instanceData;
-    instanceData.reserve(gaussians.size());
-    for (const auto& g : gaussians) {
-        GaussianInstanceGPU inst;
-        inst.mean_opacity = glm::vec4(g.mean, g.opacity);
-        inst.quat = glm::vec4(g.rotation.x, g.rotation.y, g.rotation.z, g.rotation.w);
-        inst.scale_colorx = glm::vec4(g.scale, g.color.r);
-        inst.coloryz_pad = glm::vec4(g.color.g, g.color.b, 0.f, 0.f);
-        instanceData.push_back(inst);
+void Renderer::draw_scene(Scene& scene, const glm::mat4& view, const glm::mat4& projection, RenderTarget* target) {
+    const int width = target ? target->width() : m_viewport_width;
+    const int height = target ? target->height() : m_viewport_height;
+    bool changed = false;
+    {
+        SSS_PROFILE_SCOPE("Upload");
+        changed = upload_instances(scene) || m_packed_uploaded;
+    }
+    m_packed_uploaded = false;
+    m_occlusion_drawn = false;
+    if (m_instance_buffer->instance_count == 0) {
+        m_visible_count = 0;
+        return;
     }
 
-    // Update instance buffer
-    m_instance_buffer->vbo = std::make_unique<Buffer>();
-    m_instance_buffer->vbo->set_data(GL_ARRAY_BUFFER, instanceData, GL_DYNAMIC_DRAW);
-    m_instance_buffer->instance_count = instanceData.size();
+    // Cull only when the camera or the splats moved; the sorter then
+    // orders just the surviving indices
+    const uint32_t* subset = nullptr;
+    size_t draw_count = m_instance_buffer->instance_count;
+    if (m_culling) {
+        const glm::mat4 view_proj = projection * view;
+        if (changed || !m_cull_valid || view_proj != m_last_view_proj || height != m_cull_height) {
+            SSS_PROFILE_SCOPE("Cull");
+            const Frustum frustum = Frustum::from_matrix(view_proj);
+            if (m_lod && m_lod_hierarchy) {
+                // Representatives are stored right after the scene's instances
+                m_culler->cull_lod(frustum, *m_lod_hierarchy, lod_params(view, projection, height),
+                                   (uint32_t)m_lod_base, &ThreadPool::shared());
+            } else {
+                m_culler->cull(frustum, &ThreadPool::shared());
+            }
+            m_last_view_proj = view_proj;
+            m_cull_height = height;   // the LOD cut depends on it
+            m_cull_valid = true;
+            changed = true;
+        }
+        subset = m_culler->visible().data();
+        draw_count = m_culler->visible().size();
+        m_lod_count = m_culler->lod_count();
+    } else {
+        m_lod_count = 0;
+        if (m_cull_valid) {
+            // Switching culling off changes the input set
+            m_cull_valid = false;
+            changed = true;
+        }
+    }
+    m_visible_count = draw_count;
+    if (draw_count == 0) {
+        return;
+    }
+
+    if (m_backend == RenderBackend::Tiles) {
+        // Sorts per tile itself; the culled set goes in unordered
+        SSS_PROFILE_SCOPE("Raster");
+        SSS_GPU_SCOPE(*m_gpu_timer, "Raster");
+        const InstanceBuffer& ib = *m_instance_buffer;
+        m_tile_rasterizer->render(*ib.vbo, ib.format, ib.format == InstanceFormat::Full ? ib.cov_vbo.get() : nullptr,
+                                  sh_input(view), subset, draw_count, view, projection, kClearColor, target);
+        return;
+    }
+
+    // Back-to-front order for the blend below
+    {
+        SSS_PROFILE_SCOPE("Sort");
+        SSS_GPU_SCOPE(*m_gpu_timer, "Sort");
+        m_sorter->sort(scene, *m_instance_buffer->vbo, subset, draw_count, view, changed,
+                       m_lod_hierarchy ? m_lod_hierarchy->means().data() : nullptr);
+    }
+
+    // Occluders into the depth proxy, then the sorted order compacted to
+    // the leaves they leave visible, all on the GPU
+    const InstanceBuffer& ib = *m_instance_buffer;
+    const bool occlude = m_occlusion_enabled && m_occlusion && m_occlusion->active(ib.instance_count);
+    if (occlude) {
+        SSS_PROFILE_SCOPE("Occlusion");
+        SSS_GPU_SCOPE(*m_gpu_timer, "Occlusion");
+        const QuadProgram& proxy = m_proxy_programs[(size_t)ib.format];
+        // Sized from the window: the scaled target changes size with
+        // dynamic resolution, which would reallocate the proxy each time
+        m_occlusion->begin_proxy(m_viewport_width, m_viewport_height);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        glUseProgram(proxy.program);
+        glUniformMatrix4fv(proxy.loc_view, 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(proxy.loc_proj, 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform2f(proxy.loc_viewport, (float)width, (float)height);   // footprints as the view draws them
+        glUniform1f(proxy.loc_proxy_alpha, m_occlusion->proxy_alpha());
+        setup_instance_attributes(m_sorter->index_buffer());
+        glBindVertexArray(m_quad_mesh->vao());
+        ib.texture->bind(0);
+        ib.cov_texture->bind(1);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)draw_count);
+        glBindVertexArray(0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, target ? target->framebuffer() : 0);
+        glViewport(0, 0, width, height);
+        m_occlusion->cull(view, projection, m_sorter->index_buffer(), draw_count);
+        m_occlusion_drawn = true;
+    }
+
+    SSS_PROFILE_SCOPE("Draw");
+    SSS_GPU_SCOPE(*m_gpu_timer, "Draw");
 
     // Setup rendering state
     glEnable(GL_BLEND);
@@ -70,107 +446,345 @@ void Renderer::render_scene(const Scene& scene, const glm::mat4& view, const glm
     glEnable(GL_DEPTH_TEST);
     glDepthMask(GL_FALSE);
 
-    // Bind program and set uniforms
-    glUseProgram(m_program);
-    glUniformMatrix4fv(Shader::get_uniform_location(m_program, "uView"), 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(Shader::get_uniform_location(m_program, "uProj"), 1, GL_FALSE, glm::value_ptr(projection));
+    // Bind the program for the instance format and set uniforms
+    const QuadProgram& quad = m_quad_programs[(size_t)ib.format];
+    glUseProgram(quad.program);
+    glUniformMatrix4fv(quad.loc_view, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(quad.loc_proj, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform2f(quad.loc_viewport, (float)width, (float)height);
 
-    // Setup VAO and render
+    setup_instance_attributes(occlude ? m_occlusion->indices() : m_sorter->index_buffer());
     glBindVertexArray(m_quad_mesh->vao());
-
-    // Bind instance buffer
-    glBindBuffer(GL_ARRAY_BUFFER, m_instance_buffer->vbo->handle());
-
-    // Define instanced attributes
-    for (int i = 0; i < 4; i++) {
-        glEnableVertexAttribArray(i + 1);
-        glVertexAttribPointer(i + 1, 4, GL_FLOAT, GL_FALSE, sizeof(GaussianInstanceGPU), 
-                            (void*)(i * sizeof(glm::vec4)));
-        glVertexAttribDivisor(i + 1, 1);
+    ib.texture->bind(0);
+    ib.cov_texture->bind(1);
+    set_sh_uniforms(quad.program, sh_input(view), 2);
+
+    // Draw; the culled count never comes back to the CPU
+    if (occlude) {
+#if SSS_GL_HAS_COMPUTE
+        m_occlusion->draw_command().bind(GL_DRAW_INDIRECT_BUFFER);
+        glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)draw_count);
     }
 
-    // Draw
-    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)m_instance_buffer->instance_count);
-
     // Cleanup state
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
     glDepthMask(GL_TRUE);
     glDisable(GL_BLEND);
 
     GLenum err = glGetError();
     if (err != GL_NO_ERROR) {
-        fprintf(stderr, "[Renderer] GL Error: 0x%x\n", err);
+        SSS_LOG_ERROR("[Renderer] GL Error: 0x%x", err);
     }
 }
 
-void Renderer::create_shader_program() {
-    const char* vs_src = R"(
-#version 330 core
-layout(location=0) in vec2 aQuadPos;
-layout(location=1) in vec4 iMeanOpacity;
-layout(location=2) in vec4 iQuat;
-layout(location=3) in vec4 iScaleColorX;
-layout(location=4) in vec4 iColorYZPad;
+bool Renderer::upload_instances(Scene& scene) {
+    const size_t count = scene.gaussian_count();
+    InstanceBuffer& ib = *m_instance_buffer;
+    sync_spatial_index(scene);
 
-uniform mat4 uView;
-uniform mat4 uProj;
+    // LOD representatives are only usable while they match the culler's index
+    std::shared_ptr<const LodHierarchy> lod = scene.lod_hierarchy_shared();
+    if (lod && scene.spatial_index() != &lod->index()) {
+        lod.reset();
+    }
+    const size_t lod_count = lod ? lod->size() : 0;
+    // Appending keeps the same hierarchy but moves where its
+    // representatives go, after the scene's instances
+    bool lod_changed = lod != m_lod_hierarchy || (lod && m_lod_base != count);
+
+    DirtyRange range = scene.dirty_range();
+    const bool resized = count != ib.instance_count;
+    const InstanceFormat format = scene.instance_format();
+    if (count + lod_count > ib.capacity || format != ib.format) {
+        // Grow geometrically so streamed-in gaussians don't reallocate every frame.
+        // The buffer name stays the same, so the VAO bindings remain valid.
+        // Both formats are viewed as uint rows; the shaders decode them.
+        if (format == ib.format) {
+            ib.capacity = std::max(count + lod_count, ib.capacity + ib.capacity / 2);
+        } else {
+            ib.capacity = count + lod_count;
+            ib.format = format;
+        }
+        ib.vbo->allocate(GL_ARRAY_BUFFER, ib.capacity * instance_stride(format), GL_DYNAMIC_DRAW);
+        ib.texture->attach(*ib.vbo, GL_RGBA32UI);
+        // Compact records carry what the shaders need to build the
+        // covariance, so they skip the 32-byte precomputed copy
+        const size_t cov_capacity = format == InstanceFormat::Full ? ib.capacity : 0;
+        ib.cov_vbo->allocate(GL_ARRAY_BUFFER, cov_capacity * sizeof(GaussianCovarianceGPU), GL_DYNAMIC_DRAW);
+        ib.cov_texture->attach(*ib.cov_vbo, GL_RGBA32F);
+        m_sorter->set_instance_format(format);
+        range = DirtyRange{0, count};
+        lod_changed = true;
+        ib.sh_degree = -1;   // reallocate below
+    }
+    range.end = std::min(range.end, count);
+
+    // Bands above the cap stay on the CPU
+    DirtyRange sh_range = range;
+    const int sh_degree = std::min(scene.sh_degree(), m_max_sh_degree);
+    if (sh_degree != ib.sh_degree || scene.sh_precision() != ib.sh_precision) {
+        ib.sh_degree = sh_degree;
+        ib.sh_precision = scene.sh_precision();
+        ib.sh_vbo->allocate(GL_ARRAY_BUFFER, ib.capacity * sh_word_count(sh_degree, ib.sh_precision) * sizeof(uint32_t),
+                            GL_DYNAMIC_DRAW);
+        ib.sh_texture->attach(*ib.sh_vbo, GL_RGBA32UI);
+        sh_range = DirtyRange{0, count};
+    }
+    if (sh_degree > 0 && !sh_range.empty()) {
+        upload_sh(scene, sh_range.begin, sh_range.count());
+    }
 
-out vec2 vLocalPos;
-out vec3 vColor;
-out float vOpacity;
+    // Bounds follow the same dirty range as the GPU copy
+    m_culler->update_bounds(scene, range.begin, range.count());
 
-void main() {
-    vLocalPos = aQuadPos;
-    vColor = vec3(iScaleColorX.w, iColorYZPad.x, iColorYZPad.y);
-    vOpacity = iMeanOpacity.w;
+    if (!range.empty()) {
+        stream_instances(scene, range.begin, range.count());
+    }
+
+    if (lod && lod_changed) {
+        const GaussianInstanceGPU* reps = lod->instances().data();
+        if (format == InstanceFormat::Compact) {
+            std::pmr::vector<GaussianInstanceCompact> compact(lod_count, &frame_arena());
+            for (size_t i = 0; i < lod_count; ++i) {
+                compact[i] = pack_gaussian_compact(unpack_gaussian(reps[i]));
+            }
+            m_upload_ring->upload(*ib.vbo, count, compact.data(), lod_count);
+        } else {
+            m_upload_ring->upload(*ib.vbo, count, reps, lod_count);
+            upload_covariances(count, reps, lod_count);
+        }
+    }
+    m_lod_hierarchy = std::move(lod);
+    m_lod_base = count;
+
+    // Everything staged this frame, including packed uploads made since
+    // the last frame, reaches the buffers before they are drawn from
+    m_upload_ring->submit();
+
+    ib.instance_count = count;
+    scene.clear_dirty();
+    return !range.empty() || resized || lod_changed;
+}
 
-    mat3 camR = transpose(mat3(uView));
-    vec3 right = camR[0];
-    vec3 up    = camR[1];
+void Renderer::upload_packed_instances(Scene& scene, size_t first, const GaussianInstanceGPU* instances, size_t count) {
+    if (reallocate_for_packed(scene, InstanceFormat::Full, first, count)) {
+        return;
+    }
+    m_upload_ring->upload(*m_instance_buffer->vbo, first, instances, count);
+    upload_covariances(first, instances, count);
+    finish_packed_upload(scene, first, count);
+}
 
-    float eps = 0.03;
-    float op  = max(vOpacity, eps);
-    float r2  = 2.0 * log(op / eps);
-    float r   = sqrt(max(r2, 0.0));
-    r = min(r, 1.5);
+void Renderer::upload_packed_instances(Scene& scene, size_t first, const GaussianInstanceCompact* instances,
+                                       size_t count) {
+    if (reallocate_for_packed(scene, InstanceFormat::Compact, first, count)) {
+        return;
+    }
+    m_upload_ring->upload(*m_instance_buffer->vbo, first, instances, count);
+    finish_packed_upload(scene, first, count);
+}
 
-    float z = max(-(uView * vec4(iMeanOpacity.xyz, 1.0)).z, 0.1);
-    float maxWorld = 0.01 * z;
-    vec2 s = min(iScaleColorX.xy, vec2(maxWorld));
+void Renderer::upload_instance_ranges(Scene& scene, const std::vector<DirtyRange>& ranges) {
+    const InstanceFormat format = scene.instance_format();
+    for (const DirtyRange& range : ranges) {
+        if (reallocate_for_packed(scene, format, range.begin, range.count())) {
+            // Repacked the whole scene, later ranges included
+            return;
+        }
+        stream_instances(scene, range.begin, range.count());
+        finish_packed_upload(scene, range.begin, range.count());
+    }
+}
 
-    vec3 worldPos = iMeanOpacity.xyz +
-                    right * (aQuadPos.x * s.x * r) +
-                    up    * (aQuadPos.y * s.y * r);
+bool Renderer::reallocate_for_packed(Scene& scene, InstanceFormat format, size_t first, size_t count) {
+    const InstanceBuffer& ib = *m_instance_buffer;
+    if (scene.gaussian_count() <= ib.capacity && scene.instance_format() == format && ib.format == format) {
+        return false;
+    }
+    // Growing or switching format reallocates the buffer, which repacks
+    // the whole scene from CPU data (including this range)
+    scene.mark_dirty(first, count);
+    m_packed_uploaded |= upload_instances(scene);
+    return true;
+}
 
-    gl_Position = uProj * uView * vec4(worldPos, 1.0);
+void Renderer::finish_packed_upload(Scene& scene, size_t first, size_t count) {
+    InstanceBuffer& ib = *m_instance_buffer;
+    // SH is never packed on disk in GPU layout; upload it from the scene.
+    // A changed layout has marked the whole scene dirty instead.
+    if (ib.sh_degree > 0 && ib.sh_degree == std::min(scene.sh_degree(), m_max_sh_degree) &&
+        ib.sh_precision == scene.sh_precision()) {
+        upload_sh(scene, first, count);
+    }
+    sync_spatial_index(scene);
+    m_culler->update_bounds(scene, first, count);
+    ib.instance_count = scene.gaussian_count();
+    m_packed_uploaded = true;
 }
-    )";
 
-    const char* fs_src = R"(
-#version 330 core
-in vec2 vLocalPos;
-in vec3 vColor;
-in float vOpacity;
-out vec4 FragColor;
+void Renderer::stream_instances(const Scene& scene, size_t first, size_t count) {
+    const InstanceBuffer& ib = *m_instance_buffer;
+    ThreadPool& pool = ThreadPool::shared();
+    if (scene.instance_format() == InstanceFormat::Compact) {
+        const size_t per_piece = m_upload_ring->region_bytes() / sizeof(GaussianInstanceCompact);
+        for (size_t done = 0; done < count; done += per_piece) {
+            const size_t n = std::min(per_piece, count - done);
+            auto* out = static_cast<GaussianInstanceCompact*>(m_upload_ring->allocate(n * sizeof(GaussianInstanceCompact)));
+            pool.parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+                scene.pack_range(first + done + begin, end - begin, out + begin);
+            });
+            m_upload_ring->copy(out, *ib.vbo, (first + done) * sizeof(GaussianInstanceCompact),
+                                n * sizeof(GaussianInstanceCompact));
+        }
+        return;
+    }
 
-void main() {
-    float r2 = dot(vLocalPos, vLocalPos);
-    float t = 1.0 - r2;
-    t = clamp(t, 0.0, 1.0);
+    // Staging memory is write-combined and must not be read back, so each
+    // worker packs a block into cache, then writes the record and its
+    // covariance out from there
+    constexpr size_t kBlock = 256;
+    const size_t per_piece =
+        m_upload_ring->region_bytes() / (sizeof(GaussianInstanceGPU) + sizeof(GaussianCovarianceGPU)) / kBlock * kBlock;
+    for (size_t done = 0; done < count; done += per_piece) {
+        const size_t n = std::min(per_piece, count - done);
+        // One allocation for both, since a new one may submit the region
+        void* staging = m_upload_ring->allocate(n * (sizeof(GaussianInstanceGPU) + sizeof(GaussianCovarianceGPU)));
+        auto* instances = static_cast<GaussianInstanceGPU*>(staging);
+        auto* covariances = reinterpret_cast<GaussianCovarianceGPU*>(instances + n);
+        pool.parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+            GaussianInstanceGPU block[kBlock];
+            for (size_t i = begin; i < end; i += kBlock) {
+                const size_t k = std::min(kBlock, end - i);
+                scene.pack_range(first + done + i, k, block);
+                std::memcpy(instances + i, block, k * sizeof(GaussianInstanceGPU));
+                for (size_t j = 0; j < k; ++j) {
+                    covariances[i + j] = pack_covariance(block[j]);
+                }
+            }
+        });
+        m_upload_ring->copy(instances, *ib.vbo, (first + done) * sizeof(GaussianInstanceGPU),
+                            n * sizeof(GaussianInstanceGPU));
+        m_upload_ring->copy(covariances, *ib.cov_vbo, (first + done) * sizeof(GaussianCovarianceGPU),
+                            n * sizeof(GaussianCovarianceGPU));
+    }
+}
 
-    float alpha = vOpacity * t * t;
+void Renderer::upload_covariances(size_t first, const GaussianInstanceGPU* instances, size_t count) {
+    // Once per upload rather than per vertex: the shader only projects
+    const size_t per_piece = m_upload_ring->region_bytes() / sizeof(GaussianCovarianceGPU);
+    for (size_t done = 0; done < count; done += per_piece) {
+        const size_t n = std::min(per_piece, count - done);
+        auto* out = static_cast<GaussianCovarianceGPU*>(m_upload_ring->allocate(n * sizeof(GaussianCovarianceGPU)));
+        ThreadPool::shared().parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                out[i] = pack_covariance(instances[done + i]);
+            }
+        });
+        m_upload_ring->copy(out, *m_instance_buffer->cov_vbo, (first + done) * sizeof(GaussianCovarianceGPU),
+                            n * sizeof(GaussianCovarianceGPU));
+    }
+}
 
-    if (alpha < 0.03) discard;
+void Renderer::upload_sh(const Scene& scene, size_t first, size_t count) {
+    const InstanceBuffer& ib = *m_instance_buffer;
+    const size_t words = sh_word_count(ib.sh_degree, ib.sh_precision);
+    const size_t per_piece = m_upload_ring->region_bytes() / (words * sizeof(uint32_t));
+    for (size_t done = 0; done < count; done += per_piece) {
+        const size_t n = std::min(per_piece, count - done);
+        auto* out = static_cast<uint32_t*>(m_upload_ring->allocate(n * words * sizeof(uint32_t)));
+        ThreadPool::shared().parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+            scene.pack_sh_range(first + done + begin, end - begin, ib.sh_degree, out + begin * words);
+        });
+        m_upload_ring->copy(out, *ib.sh_vbo, (first + done) * words * sizeof(uint32_t), n * words * sizeof(uint32_t));
+    }
+}
 
-    FragColor = vec4(vColor * alpha, alpha);
+SplatShInput Renderer::sh_input(const glm::mat4& view) const {
+    const InstanceBuffer& ib = *m_instance_buffer;
+    SplatShInput sh;
+    sh.texture = ib.sh_texture.get();
+    sh.degree = ib.sh_degree;
+    sh.precision = ib.sh_precision;
+    sh.count = ib.instance_count;
+    // Camera position from the rigid view transform: -R^T * t
+    sh.eye = -(glm::transpose(glm::mat3(view)) * glm::vec3(view[3]));
+    return sh;
 }
-    )";
 
-    try {
-        m_program = Shader::create_program(vs_src, fs_src);
-    } catch (const std::exception& e) {
-        fprintf(stderr, "[Renderer] Shader creation failed: %s\n", e.what());
-        throw;
+void Renderer::sync_spatial_index(const Scene& scene) {
+    // Hierarchical culling while the scene's index is current, flat otherwise
+    if (m_culler->set_index(scene, scene.spatial_index_shared())) {
+        m_cull_valid = false;
+    }
+}
+
+LodCutParams Renderer::lod_params(const glm::mat4& view, const glm::mat4& projection, int viewport_height) const {
+    LodCutParams params;
+    // Camera position from the rigid view transform: -R^T * t
+    params.eye = -(glm::transpose(glm::mat3(view)) * glm::vec3(view[3]));
+    params.pixels_per_unit = 0.5f * (float)viewport_height * projection[1][1];
+    params.max_error = m_lod_error;
+    return params;
+}
+
+void Renderer::setup_instance_attributes(const Buffer& indices) {
+    // Keeps the binding while the index source stays the same
+    if (&indices == m_attribute_indices) {
+        return;
+    }
+    m_attribute_indices = &indices;
+    glBindVertexArray(m_quad_mesh->vao());
+    indices.bind(GL_ARRAY_BUFFER);
+
+    // One sorted instance index per instance; the shader fetches the
+    // instance record it points at from the instance buffer texture
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+    glVertexAttribDivisor(1, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Renderer::create_quad_programs() {
+    auto create = [this](QuadProgram& quad, const ShaderProgramDesc& desc, const ShaderDefines& defines) {
+        try {
+            quad.program = m_shaders->program(desc, defines);
+        } catch (const std::exception& e) {
+            SSS_LOG_ERROR("[Renderer] Shader creation failed: %s", e.what());
+            throw;
+        }
+        quad.loc_view = Shader::get_uniform_location(quad.program, "uView");
+        quad.loc_proj = Shader::get_uniform_location(quad.program, "uProj");
+        quad.loc_viewport = Shader::get_uniform_location(quad.program, "uViewport");
+        quad.loc_proxy_alpha = Shader::get_uniform_location(quad.program, "uProxyAlpha");
+
+        // Instance data is read through buffer textures: instances on unit
+        // 0, their covariances (full format only) on unit 1, SH on unit 2
+        glUseProgram(quad.program);
+        glUniform1i(Shader::get_uniform_location(quad.program, "uInstances"), 0);
+        glUniform1i(Shader::get_uniform_location(quad.program, "uCovariances"), 1);
+    };
+
+    // Both formats up front, so switching never waits on a compile
+    for (InstanceFormat format : {InstanceFormat::Full, InstanceFormat::Compact}) {
+        ShaderDefines defines = splat_format_defines(format);
+        create(m_quad_programs[(size_t)format], kQuadProgram, defines);
+        if (m_occlusion) {
+            defines.emplace_back("SSS_DEPTH_PROXY", "1");
+            create(m_proxy_programs[(size_t)format], kProxyProgram, defines);
+        }
     }
+    glUseProgram(0);
 }
 
 }  // namespace sss
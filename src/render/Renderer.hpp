@@ -3,12 +3,35 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
+#include "../core/FrameArena.hpp"
+#include "../scene/LodHierarchy.hpp"
 #include "../scene/Scene.hpp"
 #include "Buffers.hpp"
+#include "DynamicResolution.hpp"
+#include "GpuTimer.hpp"
+#include "OcclusionCuller.hpp"
 #include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include "SplatGlsl.hpp"
+#include "SplatCuller.hpp"
+#include "SplatSorter.hpp"
+#include "TileRasterizer.hpp"
 
 namespace sss {
 
+class RenderTarget;
+
+/**
+ * How sorted splats become pixels.
+ */
+enum class RenderBackend {
+    Quads,   // instanced screen-space quads, fixed-function blending (GL 3.3)
+    Tiles    // compute tile rasterizer, front-to-back per 16x16 tile (GL 4.3)
+};
+
+const char* render_backend_name(RenderBackend backend);
+
 class Renderer {
 public:
     Renderer();
@@ -16,11 +39,21 @@ public:
 
     /**
      * Initialize renderer with window dimensions.
+     * Builds shaders through the ShaderCache (program binaries under
+     * ShaderCache::default_binary_directory()) and creates GPU resources;
+     * call once.
      */
     void init(int width, int height);
 
     /**
-     * Prepare for a new frame (clear buffers, etc).
+     * Update the viewport after a framebuffer resize.
+     * Cheap: no GPU resources are recreated.
+     */
+    void resize(int width, int height);
+
+    /**
+     * Prepare for a new frame (clear buffers, etc). Starts a new frame
+     * arena, releasing the one from two frames ago.
      */
     void begin_frame();
 
@@ -31,12 +64,155 @@ public:
 
     /**
      * Render a scene of gaussians.
+     * Only the scene's dirty range is re-uploaded to the resident instance
+     * buffer; the range is cleared once uploaded. With culling enabled,
+     * only splats whose bounds touch the view frustum are sorted and drawn;
+     * culling is hierarchical while the scene has a current spatial index,
+     * and with a current LOD hierarchy distant clusters are drawn as single
+     * representative splats.
      * 
      * @param scene The scene to render
      * @param view View matrix from camera
      * @param projection Projection matrix from camera
      */
-    void render_scene(const Scene& scene, const glm::mat4& view, const glm::mat4& projection);
+    void render_scene(Scene& scene, const glm::mat4& view, const glm::mat4& projection);
+
+    /**
+     * Render the scene into an offscreen target at the target's size, from
+     * any pose (e.g. a tracking hypothesis), with the same backend,
+     * culling and LOD as the on-screen view; the default framebuffer and
+     * viewport are bound again afterwards. Queue the result with
+     * target.request_readback() for asynchronous readback.
+     *
+     * Culling is cached for one pose, so alternating poses re-culls each
+     * call; the statistics describe the last call of either overload.
+     */
+    void render_scene(Scene& scene, const glm::mat4& view, const glm::mat4& projection, RenderTarget& target);
+
+    /**
+     * Upload already packed instances (e.g. from a mapped binary scene)
+     * into [first, first + count) of the scene's GPU copy, skipping the CPU
+     * packing pass. `instances` must match the scene's gaussians in that
+     * range, and the range must not be marked dirty. Records in a format
+     * other than the scene's are ignored in favour of a repack.
+     */
+    void upload_packed_instances(Scene& scene, size_t first, const GaussianInstanceGPU* instances, size_t count);
+    void upload_packed_instances(Scene& scene, size_t first, const GaussianInstanceCompact* instances, size_t count);
+
+    /**
+     * Pack and upload each of `ranges` (sorted, disjoint) from the scene,
+     * for edits written without marking dirty (SceneUpdateQueue::apply()).
+     * Cheaper than one dirty range spanning scattered edits.
+     */
+    void upload_instance_ranges(Scene& scene, const std::vector<DirtyRange>& ranges);
+
+    /**
+     * Staging ring behind all uploads, for statistics.
+     */
+    const UploadRing& upload_ring() const { return *m_upload_ring; }
+
+    /**
+     * Arena for transient allocations this frame; they stay valid until
+     * the begin_frame() after next. Render thread only.
+     */
+    FrameArena& frame_arena() { return m_frame_memory.current(); }
+    FrameArenaStats frame_arena_stats() const { return m_frame_memory.stats(); }
+
+    /**
+     * Select how splats are depth-sorted before blending.
+     */
+    void set_sort_mode(SortMode mode);
+    SortMode sort_mode() const;
+
+    /**
+     * Select the rasterization backend. init() picks Tiles when compute
+     * shaders are available; requesting Tiles without them keeps Quads.
+     */
+    void set_backend(RenderBackend backend);
+    RenderBackend backend() const { return m_backend; }
+
+    /**
+     * Enable CPU frustum culling (on by default).
+     */
+    void set_culling(bool enabled);
+    bool culling_enabled() const { return m_culling; }
+
+    /**
+     * Draw distant clusters through the scene's LOD hierarchy (on by
+     * default; needs culling). The cut keeps every cluster it collapses
+     * within `pixels` of screen-space error.
+     */
+    void set_lod(bool enabled);
+    bool lod_enabled() const { return m_lod; }
+    void set_lod_error(float pixels);
+    float lod_error() const { return m_lod_error; }
+
+    /**
+     * Drop spatial index leaves hidden behind nearly opaque splats on the
+     * GPU (see OcclusionCuller; off by default). Quad backend only, and
+     * only while the scene has a current spatial index.
+     */
+    void set_occlusion(bool enabled) { m_occlusion_enabled = enabled; }
+    bool occlusion_enabled() const { return m_occlusion_enabled; }
+    bool occlusion_available() const { return m_occlusion != nullptr; }
+
+    /**
+     * Results of recent occlusion culls (a few frames old); all zero while
+     * occlusion culling is off or unavailable.
+     */
+    OcclusionStats occlusion_stats() const;
+
+    /**
+     * Render the on-screen view at a fraction of the viewport, chosen each
+     * frame to keep its GPU time near target_frame_ms(), and upsample it to
+     * the window (see DynamicResolution; off by default). Offscreen targets
+     * always render at their own size.
+     */
+    void set_dynamic_resolution(bool enabled);
+    bool dynamic_resolution() const { return m_dynamic_resolution; }
+    void set_target_frame_ms(float ms);
+    float target_frame_ms() const;
+
+    /**
+     * Fraction of the viewport's width and height the view is rendered at
+     * (1 without dynamic resolution), and the GPU time last measured for a
+     * scaled frame.
+     */
+    float render_scale() const { return m_dynamic_resolution ? m_resolution->scale() : 1.f; }
+    double scaled_frame_ms() const { return m_resolution ? m_resolution->gpu_ms() : 0.0; }
+
+    /**
+     * Cap on the spherical-harmonics degree drawn (default kMaxShDegree).
+     * Bands above it are not uploaded, so lowering the cap saves GPU
+     * memory and bandwidth too; changing it re-uploads the SH buffer.
+     */
+    void set_max_sh_degree(int degree);
+    int max_sh_degree() const { return m_max_sh_degree; }
+
+    /**
+     * SH degree resident on the GPU and drawn: the scene's, capped.
+     */
+    int sh_degree() const { return m_instance_buffer ? m_instance_buffer->sh_degree : 0; }
+
+    /**
+     * Splats drawn in the last render_scene() call.
+     */
+    size_t visible_count() const { return m_visible_count; }
+
+    /**
+     * LOD representatives among visible_count().
+     */
+    size_t lod_count() const { return m_lod_count; }
+
+    /**
+     * (tile, splat) pairs blended by the tile backend in the last frame.
+     */
+    size_t tile_pair_count() const { return m_tile_rasterizer ? m_tile_rasterizer->pair_count() : 0; }
+
+    /**
+     * GPU pass timer; the renderer starts its frame in begin_frame().
+     */
+    GpuTimer& gpu_timer() { return *m_gpu_timer; }
 
     /**
      * Get current viewport width.
@@ -56,17 +232,81 @@ public:
 private:
     struct InstanceBuffer {
         std::unique_ptr<Buffer> vbo;
-        size_t instance_count = 0;
+        std::unique_ptr<TextureBuffer> texture;   // RGBA32UI view of vbo
+        std::unique_ptr<Buffer> cov_vbo;          // GaussianCovarianceGPU per instance, same indexing (Full only)
+        std::unique_ptr<TextureBuffer> cov_texture;
+        std::unique_ptr<Buffer> sh_vbo;           // scene SH records up to sh_degree, same indexing
+        std::unique_ptr<TextureBuffer> sh_texture;
+        InstanceFormat format = InstanceFormat::Full;
+        int sh_degree = 0;
+        ShPrecision sh_precision = ShPrecision::Float;
+        size_t instance_count = 0;   // scene instances; LOD representatives follow them
+        size_t capacity = 0;     // allocated instances in vbo
+    };
+
+    // Instanced-quad program for one instance format
+    struct QuadProgram {
+        GLuint program = 0;   // owned by m_shaders
+        GLint loc_view = -1;
+        GLint loc_proj = -1;
+        GLint loc_viewport = -1;
+        GLint loc_proxy_alpha = -1;   // depth proxy variant only
     };
 
     int m_viewport_width = 0;
     int m_viewport_height = 0;
 
-    GLuint m_program = 0;
+    std::unique_ptr<ShaderCache> m_shaders;   // every program; declared first so it outlives their users
+    QuadProgram m_quad_programs[2];           // by InstanceFormat
+    QuadProgram m_proxy_programs[2];          // occluder depth, by InstanceFormat (with m_occlusion only)
     std::unique_ptr<QuadMesh> m_quad_mesh;
     std::unique_ptr<InstanceBuffer> m_instance_buffer;
+    std::unique_ptr<SplatSorter> m_sorter;
+    std::unique_ptr<SplatCuller> m_culler;
+    std::unique_ptr<GpuTimer> m_gpu_timer;
+    std::unique_ptr<TileRasterizer> m_tile_rasterizer;   // null without compute support
+    std::unique_ptr<OcclusionCuller> m_occlusion;        // null without compute support
+    std::unique_ptr<DynamicResolution> m_resolution;     // null if its program failed to build
+    bool m_dynamic_resolution = false;
+    bool m_occlusion_enabled = false;
+    bool m_occlusion_drawn = false;                      // last draw went through m_occlusion
+    const Buffer* m_attribute_indices = nullptr;         // buffer behind the quad VAO's instance indices
+    RenderBackend m_backend = RenderBackend::Quads;
+    std::unique_ptr<UploadRing> m_upload_ring;      // staging for every instance, covariance and SH upload
+    FrameAllocator m_frame_memory;
+    int m_max_sh_degree = kMaxShDegree;
+    bool m_packed_uploaded = false;                 // upload_packed_instances() ran since the last sort
+
+    bool m_culling = true;
+    bool m_cull_valid = false;      // culler's visible list matches m_last_view_proj
+    glm::mat4 m_last_view_proj{1.f};
+    int m_cull_height = 0;          // viewport height m_last_view_proj was culled at
+    size_t m_visible_count = 0;
+
+    bool m_lod = true;
+    float m_lod_error = 1.0f;                        // pixels
+    std::shared_ptr<const LodHierarchy> m_lod_hierarchy;   // representatives resident in the instance buffer
+    size_t m_lod_base = 0;                                 // instance the first of them was uploaded to
+    size_t m_lod_count = 0;
 
-    void create_shader_program();
+    void create_quad_programs();   // (re)fetch all variants and set their one-time uniforms
+    void setup_instance_attributes(const Buffer& indices);
+    void sync_spatial_index(const Scene& scene);
+    void draw_scene(Scene& scene, const glm::mat4& view, const glm::mat4& projection, RenderTarget* target);
+    LodCutParams lod_params(const glm::mat4& view, const glm::mat4& projection, int viewport_height) const;
+    bool upload_instances(Scene& scene);   // true if anything was uploaded or the count changed
+    // Pack [first, first + count) of the scene straight into staging memory
+    // and copy it (and, for Full, its covariances) to the instance buffer
+    void stream_instances(const Scene& scene, size_t first, size_t count);
+    // Precompute world covariances for [first, first + count) of the instance buffer
+    void upload_covariances(size_t first, const GaussianInstanceGPU* instances, size_t count);
+    // Shared by the upload_packed_instances() overloads: true if the range
+    // was repacked through upload_instances() instead
+    bool reallocate_for_packed(Scene& scene, InstanceFormat format, size_t first, size_t count);
+    void finish_packed_upload(Scene& scene, size_t first, size_t count);
+    // SH records of [first, first + count) at the resident degree
+    void upload_sh(const Scene& scene, size_t first, size_t count);
+    SplatShInput sh_input(const glm::mat4& view) const;
 };
 
 }  // namespace sss
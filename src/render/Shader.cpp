@@ -35,6 +35,24 @@ GLuint Shader::create_program(const char* vs_src, const char* fs_src) {
     glDeleteShader(vs);
     glDeleteShader(fs);
 
+    return check_link(p);
+}
+
+#if defined(GL_VERSION_4_3)
+GLuint Shader::create_compute_program(const char* cs_src) {
+    GLuint cs = compile(GL_COMPUTE_SHADER, cs_src);
+
+    GLuint p = glCreateProgram();
+    glAttachShader(p, cs);
+    glLinkProgram(p);
+
+    glDeleteShader(cs);
+
+    return check_link(p);
+}
+#endif
+
+GLuint Shader::check_link(GLuint p) {
     GLint ok = 0;
     glGetProgramiv(p, GL_LINK_STATUS, &ok);
     if (!ok) {
@@ -25,10 +25,26 @@ public:
      */
     static GLuint create_program(const char* vs_src, const char* fs_src);
 
+#if defined(GL_VERSION_4_3)
+    /**
+     * Create a compute program (requires a GL 4.3 context).
+     * 
+     * @param cs_src Compute shader source
+     * @return OpenGL program handle
+     */
+    static GLuint create_compute_program(const char* cs_src);
+#endif
+
     /**
      * Get the uniform location for a program and variable name.
      */
     static GLint get_uniform_location(GLuint program, const char* name);
+
+    /**
+     * Throw with the info log if linking failed (deleting the program);
+     * returns the program otherwise.
+     */
+    static GLuint check_link(GLuint program);
 };
 
 }  // namespace sss
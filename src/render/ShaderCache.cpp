@@ -0,0 +1,442 @@
+#include "ShaderCache.hpp"
+#include "GLCaps.hpp"
+#include "Shader.hpp"
+#include "SplatGlsl.hpp"
+#include "../core/Log.hpp"
+#include "../core/Time.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace sss {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t kBinaryMagic = 0x42535353;   // "SSSB"
+constexpr uint32_t kBinaryVersion = 1;
+constexpr uint32_t kMaxBinaryBytes = 64u << 20;   // anything larger is a corrupt header
+constexpr double kPollInterval = 0.25;            // seconds between override file checks
+
+// Program binary file: this header, then `length` bytes for glProgramBinary
+struct BinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t hash;     // of the driver strings and every stage's source
+    uint32_t format;
+    uint32_t length;
+};
+
+// FNV-1a, 64 bit
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+const char* stage_extension(GLenum stage) {
+    switch (stage) {
+        case GL_VERTEX_SHADER:   return "vert";
+        case GL_FRAGMENT_SHADER: return "frag";
+        default:                 return "comp";
+    }
+}
+
+std::string gl_string(GLenum name) {
+    const char* s = reinterpret_cast<const char*>(glGetString(name));
+    return s ? s : "";
+}
+
+// `text` inserted after the #version line (before everything if none)
+std::string insert_after_version(std::string src, const std::string& text) {
+    const size_t version = src.find("#version");
+    const size_t line_end = version == std::string::npos ? std::string::npos : src.find('\n', version);
+    if (line_end == std::string::npos) {
+        return text + src;
+    }
+    src.insert(line_end + 1, text);
+    return src;
+}
+
+bool read_file(const fs::path& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    out = text.str();
+    return true;
+}
+
+}  // namespace
+
+ShaderCache::ShaderCache() = default;
+
+ShaderCache::~ShaderCache() {
+    clear();
+}
+
+void ShaderCache::init(const std::string& binary_directory, const std::string& source_directory) {
+    m_driver = gl_string(GL_VENDOR) + "\n" + gl_string(GL_RENDERER) + "\n" + gl_string(GL_VERSION) + "\n" +
+               gl_string(GL_SHADING_LANGUAGE_VERSION);
+
+    m_binary_dir = binary_directory;
+    m_binaries = false;
+    if (!m_binary_dir.empty()) {
+        std::error_code ec;
+        if (!GLCaps::program_binary()) {
+            SSS_LOG_INFO("[ShaderCache] No program binary support; shaders compile every run");
+        } else if (fs::create_directories(m_binary_dir, ec), ec) {
+            SSS_LOG_WARN("[ShaderCache] Cannot create %s: %s", m_binary_dir.string().c_str(), ec.message().c_str());
+        } else {
+            m_binaries = true;
+        }
+    }
+
+#if SSS_SHADER_HOT_RELOAD
+    m_source_dir = source_directory;
+    if (!m_source_dir.empty()) {
+        std::error_code ec;
+        fs::create_directories(m_source_dir, ec);
+        SSS_LOG_INFO("[ShaderCache] Watching shader sources in %s", m_source_dir.string().c_str());
+    }
+#else
+    if (!source_directory.empty()) {
+        SSS_LOG_WARN("[ShaderCache] Built without hot reload; ignoring %s", source_directory.c_str());
+    }
+#endif
+}
+
+std::string ShaderCache::default_binary_directory() {
+    if (const char* dir = std::getenv("SSS_SHADER_CACHE")) {
+        return dir;
+    }
+    fs::path base;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        base = xdg;
+    } else if (const char* local = std::getenv("LOCALAPPDATA"); local && *local) {
+        base = local;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        base = fs::path(home) / ".cache";
+    } else {
+        return {};
+    }
+    return (base / "sentient-splat-slam" / "shaders").string();
+}
+
+std::string ShaderCache::default_source_directory() {
+    const char* dir = std::getenv("SSS_SHADER_DIR");
+    return dir ? dir : "";
+}
+
+GLuint ShaderCache::program(const ShaderProgramDesc& desc, const ShaderDefines& defines) {
+    std::string key = variant_key(desc, defines);
+    auto it = m_variants.find(key);
+    if (it != m_variants.end()) {
+        return it->second.program;
+    }
+
+    Variant variant;
+    variant.desc = desc;
+    variant.defines = defines;
+    build(variant);
+    ++m_stats.programs;
+    const GLuint program = variant.program;
+    m_variants.emplace(std::move(key), std::move(variant));
+    return program;
+}
+
+bool ShaderCache::poll() {
+#if SSS_SHADER_HOT_RELOAD
+    if (m_source_dir.empty()) {
+        return false;
+    }
+    const double now = Time::now();
+    if (now - m_last_poll < kPollInterval) {
+        return false;
+    }
+    m_last_poll = now;
+
+    bool reloaded = false;
+    for (auto& [key, variant] : m_variants) {
+        if (override_times(variant) == variant.override_times) {
+            continue;
+        }
+        // build() records the new file times first, so a broken edit is
+        // not retried until the file changes again
+        try {
+            build(variant);
+            ++m_stats.reloads;
+            reloaded = true;
+            SSS_LOG_INFO("[ShaderCache] Reloaded %s", key.c_str());
+        } catch (const std::exception& e) {
+            SSS_LOG_ERROR("[ShaderCache] Reloading %s failed, keeping the previous program: %s", key.c_str(),
+                          e.what());
+        }
+    }
+    if (reloaded) {
+        ++m_generation;
+    }
+    return reloaded;
+#else
+    return false;
+#endif
+}
+
+void ShaderCache::clear() {
+    for (auto& [key, variant] : m_variants) {
+        glDeleteProgram(variant.program);
+    }
+    m_variants.clear();
+}
+
+std::string ShaderCache::variant_key(const ShaderProgramDesc& desc, const ShaderDefines& defines) {
+    std::string key = desc.name;
+    for (const auto& [name, value] : defines) {
+        key += "|" + name + "=" + value;
+    }
+    return key;
+}
+
+std::vector<std::pair<GLenum, const char*>> ShaderCache::stages(const ShaderProgramDesc& desc) {
+    std::vector<std::pair<GLenum, const char*>> out;
+    if (desc.compute) {
+#if SSS_GL_HAS_COMPUTE
+        out.emplace_back(GL_COMPUTE_SHADER, desc.compute);
+#endif
+    } else {
+        out.emplace_back(GL_VERTEX_SHADER, desc.vertex);
+        out.emplace_back(GL_FRAGMENT_SHADER, desc.fragment);
+    }
+    return out;
+}
+
+std::string ShaderCache::stage_source(const Variant& variant, GLenum stage, const char* embedded) const {
+    std::string src = embedded;
+#if SSS_SHADER_HOT_RELOAD
+    if (!m_source_dir.empty()) {
+        std::string text;
+        if (read_file(override_path(variant.desc, stage), text)) {
+            src = std::move(text);
+        }
+    }
+#else
+    (void)stage;
+#endif
+    if (variant.desc.splat_glsl) {
+        src = splat_shader_source(src.c_str());
+    }
+    std::string defines;
+    for (const auto& [name, value] : variant.defines) {
+        defines += "#define " + name + " " + value + "\n";
+    }
+    return insert_after_version(std::move(src), defines);
+}
+
+fs::path ShaderCache::override_path(const ShaderProgramDesc& desc, GLenum stage) const {
+    return m_source_dir / (std::string(desc.name) + "." + stage_extension(stage));
+}
+
+std::vector<fs::file_time_type> ShaderCache::override_times(const Variant& variant) const {
+    std::vector<fs::file_time_type> times;
+    if (m_source_dir.empty()) {
+        return times;
+    }
+    for (const auto& [stage, embedded] : stages(variant.desc)) {
+        std::error_code ec;
+        const fs::file_time_type time = fs::last_write_time(override_path(variant.desc, stage), ec);
+        times.push_back(ec ? fs::file_time_type::min() : time);
+    }
+    return times;
+}
+
+void ShaderCache::link(Variant& variant, const std::vector<std::pair<GLenum, std::string>>& sources) {
+    std::vector<GLuint> shaders;
+    auto delete_shaders = [&shaders]() {
+        for (GLuint s : shaders) {
+            glDeleteShader(s);
+        }
+    };
+    GLuint p = 0;
+    try {
+        for (const auto& [stage, src] : sources) {
+            shaders.push_back(Shader::compile(stage, src.c_str()));
+        }
+        p = glCreateProgram();
+        for (GLuint s : shaders) {
+            glAttachShader(p, s);
+        }
+#if SSS_GL_HAS_PROGRAM_BINARY
+        if (m_binaries) {
+            glProgramParameteri(p, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+#endif
+        glLinkProgram(p);
+        Shader::check_link(p);
+    } catch (...) {
+        delete_shaders();
+        throw;
+    }
+
+    if (variant.program != 0) {
+        // Hot reload: relink the existing name, which users hold on to, now
+        // that the new sources are known to link
+        GLuint attached[8];
+        GLsizei count = 0;
+        glGetAttachedShaders(variant.program, 8, &count, attached);
+        for (GLsizei i = 0; i < count; ++i) {
+            glDetachShader(variant.program, attached[i]);
+        }
+        for (GLuint s : shaders) {
+            glAttachShader(variant.program, s);
+        }
+        glLinkProgram(variant.program);
+        glDeleteProgram(p);
+        p = variant.program;
+    }
+    delete_shaders();   // flagged; freed with the program
+    variant.program = p;
+}
+
+bool ShaderCache::load_binary(GLuint program, const fs::path& path, uint64_t hash) {
+#if SSS_GL_HAS_PROGRAM_BINARY
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    BinaryHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kBinaryMagic ||
+        header.version != kBinaryVersion || header.hash != hash || header.length > kMaxBinaryBytes) {
+        return false;
+    }
+    std::vector<char> data(header.length);
+    if (!in.read(data.data(), (std::streamsize)data.size())) {
+        return false;
+    }
+    glProgramBinary(program, (GLenum)header.format, data.data(), (GLsizei)data.size());
+    GLint ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        SSS_LOG_INFO("[ShaderCache] Driver rejected %s; recompiling", path.string().c_str());
+    }
+    return ok != 0;
+#else
+    (void)program;
+    (void)path;
+    (void)hash;
+    return false;
+#endif
+}
+
+void ShaderCache::save_binary(GLuint program, const fs::path& path, uint64_t hash) {
+#if SSS_GL_HAS_PROGRAM_BINARY
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> data((size_t)length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, data.data());
+    if (written <= 0) {
+        return;
+    }
+    const BinaryHeader header{kBinaryMagic, kBinaryVersion, hash, (uint32_t)format, (uint32_t)written};
+
+    // Write beside the final name and rename, so another run never reads a
+    // partial file
+    const fs::path tmp = path.string() + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(data.data(), written);
+        if (!out) {
+            SSS_LOG_WARN("[ShaderCache] Failed to write %s", tmp.string().c_str());
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        SSS_LOG_WARN("[ShaderCache] Failed to save %s: %s", path.string().c_str(), ec.message().c_str());
+        fs::remove(tmp, ec);
+        return;
+    }
+    ++m_stats.binaries_written;
+#else
+    (void)program;
+    (void)path;
+    (void)hash;
+#endif
+}
+
+void ShaderCache::build(Variant& variant) {
+    const double start = Time::now();
+    const std::vector<std::pair<GLenum, const char*>> program_stages = stages(variant.desc);
+    if (program_stages.empty()) {
+        throw std::runtime_error(std::string(variant.desc.name) + ": compute shaders unavailable");
+    }
+
+#if SSS_SHADER_HOT_RELOAD
+    // Give a new override directory the embedded sources to edit
+    if (!m_source_dir.empty()) {
+        for (const auto& [stage, embedded] : program_stages) {
+            const fs::path path = override_path(variant.desc, stage);
+            std::error_code ec;
+            if (!fs::exists(path, ec)) {
+                std::ofstream(path, std::ios::binary) << embedded;
+            }
+        }
+    }
+#endif
+    variant.override_times = override_times(variant);
+
+    std::vector<std::pair<GLenum, std::string>> sources;
+    uint64_t hash = hash_bytes(kHashSeed, m_driver.data(), m_driver.size());
+    for (const auto& [stage, embedded] : program_stages) {
+        sources.emplace_back(stage, stage_source(variant, stage, embedded));
+        hash = hash_bytes(hash, &stage, sizeof(stage));
+        hash = hash_bytes(hash, sources.back().second.data(), sources.back().second.size());
+    }
+
+    fs::path path;
+    bool loaded = false;
+    if (m_binaries) {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), "-%016llx.bin", (unsigned long long)hash);
+        path = m_binary_dir / (std::string(variant.desc.name) + suffix);
+        // Reloads always compile, so the old program stays usable on failure
+        if (variant.program == 0) {
+            GLuint p = glCreateProgram();
+            loaded = load_binary(p, path, hash);
+            if (loaded) {
+                variant.program = p;
+            } else {
+                glDeleteProgram(p);
+            }
+        }
+    }
+    if (!loaded) {
+        link(variant, sources);
+        if (m_binaries) {
+            save_binary(variant.program, path, hash);
+        }
+    }
+
+    const double ms = (Time::now() - start) * 1000.0;
+    m_stats.compile_ms += ms;
+    ++(loaded ? m_stats.loaded : m_stats.compiled);
+    SSS_LOG_DEBUG("[ShaderCache] %s %s in %.1f ms", variant_key(variant.desc, variant.defines).c_str(),
+                  loaded ? "loaded" : "compiled", ms);
+}
+
+}  // namespace sss
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Debug builds watch shader override files and relink programs when they
+// change (see ShaderCache::poll()); release builds compile the watcher out.
+#ifndef SSS_SHADER_HOT_RELOAD
+#ifdef NDEBUG
+#define SSS_SHADER_HOT_RELOAD 0
+#else
+#define SSS_SHADER_HOT_RELOAD 1
+#endif
+#endif
+
+namespace sss {
+
+/**
+ * A program's stages as embedded GLSL. The sources must outlive the cache
+ * (in practice they are string literals).
+ */
+struct ShaderProgramDesc {
+    const char* name = nullptr;       // names binary and override files, e.g. "splat_quad"
+    const char* vertex = nullptr;
+    const char* fragment = nullptr;
+    const char* compute = nullptr;    // instead of vertex + fragment
+    bool splat_glsl = false;          // insert the shared splat GLSL (splat_shader_source)
+};
+
+/**
+ * Permutation of a program: each pair becomes `#define NAME VALUE` right
+ * after the #version line, e.g. {{"SSS_COMPACT_INSTANCES", "1"}}.
+ */
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+struct ShaderCacheStats {
+    size_t programs = 0;        // variants built so far
+    size_t compiled = 0;        // of which compiled from source
+    size_t loaded = 0;          // of which loaded from a program binary
+    size_t binaries_written = 0;
+    size_t reloads = 0;         // hot reloads
+    double compile_ms = 0.0;    // time spent building programs, either way
+};
+
+/**
+ * Builds and owns the GL programs of the renderer, one per
+ * (ShaderProgramDesc, ShaderDefines) variant.
+ *
+ * With a cache directory and program binary support (GL 4.1 or
+ * ARB_get_program_binary), every program is saved with glGetProgramBinary
+ * under a hash of the driver strings and its full preprocessed source, and
+ * later runs load it with glProgramBinary instead of compiling. A binary
+ * the driver rejects is rebuilt from source and replaced; a driver or
+ * source change simply misses.
+ *
+ * With SSS_SHADER_HOT_RELOAD and a source directory, each stage is read
+ * from <dir>/<name>.vert|.frag|.comp when that file exists (a missing one
+ * is written from the embedded source to start from), and poll() relinks
+ * the programs whose files changed, keeping their GL names. A failed
+ * reload keeps the previous program.
+ *
+ * Render thread only: programs are created and deleted in the current
+ * context.
+ */
+class ShaderCache {
+public:
+    ShaderCache();
+    ~ShaderCache();
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    /**
+     * Set where program binaries are kept (empty: memory only) and, with
+     * hot reload, where override sources are looked for (empty: none).
+     * Call before the first program().
+     */
+    void init(const std::string& binary_directory, const std::string& source_directory = {});
+
+    /**
+     * $SSS_SHADER_CACHE if set (empty disables binaries), otherwise
+     * sentient-splat-slam/shaders in the user cache directory.
+     */
+    static std::string default_binary_directory();
+
+    /**
+     * $SSS_SHADER_DIR, or empty.
+     */
+    static std::string default_source_directory();
+
+    /**
+     * The program for a variant, built on first use. The cache owns it:
+     * do not delete it. The GL name stays valid across hot reloads, but
+     * uniform locations and values do not survive one; see generation().
+     *
+     * @throws std::runtime_error if the program fails to compile or link
+     */
+    GLuint program(const ShaderProgramDesc& desc, const ShaderDefines& defines = {});
+
+    /**
+     * Relink programs whose override files changed since they were built;
+     * checks the files at most a few times a second. Returns true if any
+     * program was relinked. Does nothing without hot reload.
+     */
+    bool poll();
+
+    /**
+     * Incremented by every hot reload, so users that cache uniform
+     * locations or set uniforms once know to refresh them.
+     */
+    uint64_t generation() const { return m_generation; }
+
+    const ShaderCacheStats& stats() const { return m_stats; }
+
+    /**
+     * Delete every program.
+     */
+    void clear();
+
+private:
+    struct Variant {
+        ShaderProgramDesc desc;
+        ShaderDefines defines;
+        GLuint program = 0;
+        std::vector<std::filesystem::file_time_type> override_times;   // per stage, at the last build
+    };
+
+    std::filesystem::path m_binary_dir;    // empty: no binaries
+    std::filesystem::path m_source_dir;    // empty: embedded sources only
+    std::string m_driver;                  // vendor, renderer and version strings
+    bool m_binaries = false;               // binary dir set and the context supports program binaries
+    std::unordered_map<std::string, Variant> m_variants;   // by variant_key()
+    uint64_t m_generation = 0;
+    double m_last_poll = 0.0;
+    ShaderCacheStats m_stats;
+
+    static std::string variant_key(const ShaderProgramDesc& desc, const ShaderDefines& defines);
+    // (stage, embedded source) of each stage the program has
+    static std::vector<std::pair<GLenum, const char*>> stages(const ShaderProgramDesc& desc);
+    // Source of one stage: override file or embedded, with defines and splat GLSL inserted
+    std::string stage_source(const Variant& variant, GLenum stage, const char* embedded) const;
+    std::filesystem::path override_path(const ShaderProgramDesc& desc, GLenum stage) const;
+    std::vector<std::filesystem::file_time_type> override_times(const Variant& variant) const;
+    // Compile and link variant.program (created if 0) from `sources`
+    void link(Variant& variant, const std::vector<std::pair<GLenum, std::string>>& sources);
+    bool load_binary(GLuint program, const std::filesystem::path& path, uint64_t hash);
+    void save_binary(GLuint program, const std::filesystem::path& path, uint64_t hash);
+    void build(Variant& variant);
+};
+
+}  // namespace sss
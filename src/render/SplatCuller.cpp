@@ -0,0 +1,366 @@
+#include "SplatCuller.hpp"
+#include "../core/ThreadPool.hpp"
+#include "../scene/LodHierarchy.hpp"
+#include "../scene/Scene.hpp"
+#include "../scene/SpatialIndex.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#if defined(__AVX2__)
+#define SSS_CULL_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SSS_CULL_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define SSS_CULL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace sss {
+
+namespace {
+
+constexpr size_t kMinPart = 1 << 15;   // splats per thread before splitting pays off
+constexpr float kSigmaRadius = 3.0f;
+
+// Append the set bits of `mask` as indices relative to `base`, mapped
+// through `remap` (slot -> scene index) when given
+inline void emit_mask(uint32_t mask, size_t base, const uint32_t* remap, std::vector<uint32_t>& out) {
+    while (mask) {
+        const size_t i = base + std::countr_zero(mask);
+        out.push_back(remap ? remap[i] : (uint32_t)i);
+        mask &= mask - 1;
+    }
+}
+
+// Scalar test for the elements after the last whole SIMD block
+void cull_tail(const float* x, const float* y, const float* z, const float* r,
+               size_t begin, size_t end, const Frustum& f, const uint32_t* remap, std::vector<uint32_t>& out) {
+    for (size_t i = begin; i < end; ++i) {
+        bool inside = true;
+        for (const glm::vec4& p : f.planes) {
+            inside &= p.x * x[i] + p.y * y[i] + p.z * z[i] + p.w >= -r[i];
+        }
+        if (inside) {
+            out.push_back(remap ? remap[i] : (uint32_t)i);
+        }
+    }
+}
+
+// Each kernel tests [begin, end) and appends the indices of spheres that
+// are not fully outside any plane
+
+#if SSS_CULL_AVX2
+
+void cull_range(const float* x, const float* y, const float* z, const float* r,
+                size_t begin, size_t end, const Frustum& f, const uint32_t* remap, std::vector<uint32_t>& out) {
+    __m256 px[6], py[6], pz[6], pw[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm256_set1_ps(f.planes[p].x);
+        py[p] = _mm256_set1_ps(f.planes[p].y);
+        pz[p] = _mm256_set1_ps(f.planes[p].z);
+        pw[p] = _mm256_set1_ps(f.planes[p].w);
+    }
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(x + i);
+        const __m256 cy = _mm256_loadu_ps(y + i);
+        const __m256 cz = _mm256_loadu_ps(z + i);
+        const __m256 neg_r = _mm256_xor_ps(_mm256_loadu_ps(r + i), sign);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(px[p], cx), pw[p]);
+            d = _mm256_add_ps(d, _mm256_mul_ps(py[p], cy));
+            d = _mm256_add_ps(d, _mm256_mul_ps(pz[p], cz));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, neg_r, _CMP_GE_OQ));
+        }
+        emit_mask((uint32_t)_mm256_movemask_ps(inside), i, remap, out);
+    }
+    cull_tail(x, y, z, r, i, end, f, remap, out);
+}
+
+#elif SSS_CULL_SSE
+
+void cull_range(const float* x, const float* y, const float* z, const float* r,
+                size_t begin, size_t end, const Frustum& f, const uint32_t* remap, std::vector<uint32_t>& out) {
+    __m128 px[6], py[6], pz[6], pw[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm_set1_ps(f.planes[p].x);
+        py[p] = _mm_set1_ps(f.planes[p].y);
+        pz[p] = _mm_set1_ps(f.planes[p].z);
+        pw[p] = _mm_set1_ps(f.planes[p].w);
+    }
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128 cx = _mm_loadu_ps(x + i);
+        const __m128 cy = _mm_loadu_ps(y + i);
+        const __m128 cz = _mm_loadu_ps(z + i);
+        const __m128 neg_r = _mm_xor_ps(_mm_loadu_ps(r + i), sign);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 d = _mm_add_ps(_mm_mul_ps(px[p], cx), pw[p]);
+            d = _mm_add_ps(d, _mm_mul_ps(py[p], cy));
+            d = _mm_add_ps(d, _mm_mul_ps(pz[p], cz));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, neg_r));
+        }
+        emit_mask((uint32_t)_mm_movemask_ps(inside), i, remap, out);
+    }
+    cull_tail(x, y, z, r, i, end, f, remap, out);
+}
+
+#elif SSS_CULL_NEON
+
+void cull_range(const float* x, const float* y, const float* z, const float* r,
+                size_t begin, size_t end, const Frustum& f, const uint32_t* remap, std::vector<uint32_t>& out) {
+    float32x4_t px[6], py[6], pz[6], pw[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = vdupq_n_f32(f.planes[p].x);
+        py[p] = vdupq_n_f32(f.planes[p].y);
+        pz[p] = vdupq_n_f32(f.planes[p].z);
+        pw[p] = vdupq_n_f32(f.planes[p].w);
+    }
+    const uint32_t lane_bits_init[4] = {1u, 2u, 4u, 8u};
+    const uint32x4_t lane_bits = vld1q_u32(lane_bits_init);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const float32x4_t cx = vld1q_f32(x + i);
+        const float32x4_t cy = vld1q_f32(y + i);
+        const float32x4_t cz = vld1q_f32(z + i);
+        const float32x4_t neg_r = vnegq_f32(vld1q_f32(r + i));
+
+        uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+        for (int p = 0; p < 6; ++p) {
+            float32x4_t d = vmlaq_f32(pw[p], px[p], cx);
+            d = vmlaq_f32(d, py[p], cy);
+            d = vmlaq_f32(d, pz[p], cz);
+            inside = vandq_u32(inside, vcgeq_f32(d, neg_r));
+        }
+        emit_mask(vaddvq_u32(vandq_u32(inside, lane_bits)), i, remap, out);
+    }
+    cull_tail(x, y, z, r, i, end, f, remap, out);
+}
+
+#else
+
+void cull_range(const float* x, const float* y, const float* z, const float* r,
+                size_t begin, size_t end, const Frustum& f, const uint32_t* remap, std::vector<uint32_t>& out) {
+    cull_tail(x, y, z, r, begin, end, f, remap, out);
+}
+
+#endif
+
+}  // namespace
+
+const char* cull_backend_name(CullBackend backend) {
+    switch (backend) {
+        case CullBackend::Scalar: return "scalar";
+        case CullBackend::Sse:    return "SSE2";
+        case CullBackend::Avx2:   return "AVX2";
+        case CullBackend::Neon:   return "NEON";
+        default:                  return "unknown";
+    }
+}
+
+CullBackend SplatCuller::backend() {
+#if SSS_CULL_AVX2
+    return CullBackend::Avx2;
+#elif SSS_CULL_SSE
+    return CullBackend::Sse;
+#elif SSS_CULL_NEON
+    return CullBackend::Neon;
+#else
+    return CullBackend::Scalar;
+#endif
+}
+
+bool SplatCuller::set_index(const Scene& scene, std::shared_ptr<const SpatialIndex> index) {
+    const uint64_t id = index ? index->id() : 0;
+    if (id == m_index_id) {
+        return false;
+    }
+    const bool same_layout = index && m_index && index->layout() == m_index->layout();
+    m_index = std::move(index);
+    m_index_id = id;
+    if (same_layout) {
+        return true;   // only node bounds moved
+    }
+    // Slot order changed, so the whole bounds array moves
+    m_count = 0;
+    if (m_index) {
+        m_remap = m_index->order();
+    } else {
+        m_remap.clear();
+    }
+    update_bounds(scene, 0, scene.gaussian_count());
+    return true;
+}
+
+void SplatCuller::update_bounds(const Scene& scene, size_t first, size_t count) {
+    const size_t n = scene.gaussian_count();
+    if (m_index && m_index->size() > n) {
+        // The scene shrank below the index; fall back to flat culling
+        m_index.reset();
+        m_index_id = 0;
+        m_count = 0;
+        m_remap.clear();
+        first = 0;
+        count = n;
+    }
+    if (n != m_count) {
+        m_x.resize(n);
+        m_y.resize(n);
+        m_z.resize(n);
+        m_radius.resize(n);
+        if (n > m_count) {
+            std::fill(m_radius.begin() + m_count, m_radius.end(), -std::numeric_limits<float>::infinity());
+        }
+        if (m_index) {
+            const size_t old = m_remap.size();
+            m_remap.resize(n);
+            for (size_t k = old; k < n; ++k) {
+                m_remap[k] = (uint32_t)k;
+            }
+        }
+        m_count = n;
+    }
+
+    const size_t last = std::min(first + count, n);
+    const glm::vec3* means = scene.means().data();
+    const glm::vec3* scales = scene.scales().data();
+    const float* opacities = scene.opacities().data();
+    const SpatialIndex* index = m_index.get();
+    const size_t indexed = index ? index->size() : 0;
+    for (size_t i = first; i < last; ++i) {
+        const size_t slot = i < indexed ? index->slot_of((uint32_t)i) : i;
+        m_x[slot] = means[i].x;
+        m_y[slot] = means[i].y;
+        m_z[slot] = means[i].z;
+        // Fully transparent splats (including loader placeholders) never draw
+        const glm::vec3 s = glm::abs(scales[i]);
+        m_radius[slot] = opacities[i] > 0.f ? kSigmaRadius * std::max(s.x, std::max(s.y, s.z))
+                                            : -std::numeric_limits<float>::infinity();
+    }
+}
+
+size_t SplatCuller::cull(const Frustum& frustum, ThreadPool* pool) {
+    m_visible.clear();
+    m_ranges.clear();
+    m_lod_nodes.clear();
+
+    // Ranges of slots to test: from the hierarchy when there is one, with
+    // whole nodes inside the frustum accepted (or outside it skipped)
+    // without touching their splats; otherwise the entire array
+    if (m_index) {
+        m_index->query_frustum(frustum, m_ranges);
+        add_tail();
+    } else if (m_count > 0) {
+        m_ranges.push_back(SpatialRange{0, (uint32_t)m_count, false});
+    }
+    return test_ranges(frustum, pool);
+}
+
+size_t SplatCuller::cull_lod(const Frustum& frustum, const LodHierarchy& lod, const LodCutParams& params,
+                             uint32_t lod_base, ThreadPool* pool) {
+    if (!m_index || lod.index().id() != m_index_id) {
+        return cull(frustum, pool);
+    }
+    m_visible.clear();
+    m_ranges.clear();
+    m_lod_nodes.clear();
+
+    lod.select(frustum, params, m_ranges, m_lod_nodes);
+    add_tail();
+    test_ranges(frustum, pool);
+    for (uint32_t node : m_lod_nodes) {
+        m_visible.push_back(lod_base + node);
+    }
+    return m_visible.size();
+}
+
+void SplatCuller::add_tail() {
+    // Splats added since the index was built are outside its nodes
+    if (m_count > m_index->size()) {
+        m_ranges.push_back(SpatialRange{(uint32_t)m_index->size(), (uint32_t)(m_count - m_index->size()), false});
+    }
+}
+
+size_t SplatCuller::test_ranges(const Frustum& frustum, ThreadPool* pool) {
+    const uint32_t* remap = m_index ? m_remap.data() : nullptr;
+
+    // Contained runs need no plane tests, but transparent splats still drop out
+    std::vector<SpatialRange>::iterator keep = m_ranges.begin();
+    for (const SpatialRange& range : m_ranges) {
+        if (range.contained) {
+            for (uint32_t k = range.first; k < range.first + range.count; ++k) {
+                if (m_radius[k] >= 0.f) {
+                    m_visible.push_back(remap ? remap[k] : k);
+                }
+            }
+        } else {
+            *keep++ = range;
+        }
+    }
+    m_ranges.erase(keep, m_ranges.end());
+
+    size_t tested = 0;
+    for (const SpatialRange& range : m_ranges) {
+        tested += range.count;
+    }
+
+    size_t parts = 1;
+    if (pool && tested >= 2 * kMinPart) {
+        parts = std::min(pool->thread_count() + 1, tested / kMinPart);
+    }
+
+    if (parts == 1) {
+        for (const SpatialRange& range : m_ranges) {
+            cull_range(m_x.data(), m_y.data(), m_z.data(), m_radius.data(),
+                       range.first, range.first + range.count, frustum, remap, m_visible);
+        }
+        return m_visible.size();
+    }
+
+    // Split the tested slots into equal contiguous shares, cutting ranges
+    // where needed; concatenating shares in order keeps the output stable
+    const size_t share = (tested + parts - 1) / parts;
+    m_part_visible.resize(parts);
+    pool->parallel_for(parts, 1, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p) {
+            std::vector<uint32_t>& out = m_part_visible[p];
+            out.clear();
+            const size_t lo = p * share;
+            const size_t hi = std::min(tested, lo + share);
+            size_t offset = 0;   // tested slots before the current range
+            for (const SpatialRange& range : m_ranges) {
+                const size_t a = std::max(lo, offset);
+                const size_t b = std::min(hi, offset + range.count);
+                if (a < b) {
+                    cull_range(m_x.data(), m_y.data(), m_z.data(), m_radius.data(),
+                               range.first + (a - offset), range.first + (b - offset), frustum, remap, out);
+                }
+                offset += range.count;
+                if (offset >= hi) {
+                    break;
+                }
+            }
+        }
+    });
+
+    for (const std::vector<uint32_t>& part : m_part_visible) {
+        m_visible.insert(m_visible.end(), part.begin(), part.end());
+    }
+    return m_visible.size();
+}
+
+}  // namespace sss
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../core/Frustum.hpp"
+#include "../scene/SpatialIndex.hpp"
+
+namespace sss {
+
+class LodHierarchy;
+class Scene;
+class ThreadPool;
+struct LodCutParams;
+
+/**
+ * Instruction set the culling kernel was compiled for.
+ */
+enum class CullBackend {
+    Scalar,
+    Sse,    // 4 lanes, SSE2
+    Avx2,   // 8 lanes, enabled with SSS_ENABLE_AVX2
+    Neon    // 4 lanes, AArch64
+};
+
+const char* cull_backend_name(CullBackend backend);
+
+/**
+ * CPU view-frustum culling over bounding spheres
+ * (mean, 3 sigma of the largest scale axis).
+ *
+ * Bounds are kept as separate x/y/z/radius float arrays, refreshed from the
+ * scene's dirty range, so the kernel tests several splats per instruction
+ * against all six planes. Output is the list of visible instance indices,
+ * which feeds the depth sort and the draw.
+ *
+ * With a SpatialIndex attached, the arrays are stored in its slot order
+ * and culling walks the hierarchy first: nodes outside the frustum are
+ * skipped and nodes inside it accepted wholesale, so only splats in
+ * leaves straddling a plane are tested one by one. Splats added after the
+ * index was built follow in scene order and are always tested one by one.
+ */
+class SplatCuller {
+public:
+    /**
+     * Backend selected at compile time.
+     */
+    static CullBackend backend();
+
+    /**
+     * Attach (or detach, with null) the scene's spatial index. Bounds are
+     * rebuilt in its slot order when its layout differs from the current
+     * one's; a refit of the current index keeps them. The index must
+     * describe the scene's first index->size() gaussians as they are now.
+     *
+     * @return true if the index changed
+     */
+    bool set_index(const Scene& scene, std::shared_ptr<const SpatialIndex> index);
+
+    /**
+     * Recompute bounds for [first, first + count) and match the scene size.
+     */
+    void update_bounds(const Scene& scene, size_t first, size_t count);
+
+    /**
+     * Test every splat against the frustum and rebuild visible().
+     *
+     * @param pool Optional pool for splitting large scenes across threads
+     * @return Number of visible splats
+     */
+    size_t cull(const Frustum& frustum, ThreadPool* pool);
+
+    /**
+     * Cull through a LOD cut instead: clusters within the error budget are
+     * emitted as their representative, instance index `lod_base + node`,
+     * and only leaves the cut opens are tested per splat. Falls back to
+     * cull() when `lod` was not built over the attached index.
+     *
+     * @return Number of visible splats, representatives included
+     */
+    size_t cull_lod(const Frustum& frustum, const LodHierarchy& lod, const LodCutParams& params,
+                    uint32_t lod_base, ThreadPool* pool);
+
+    const std::vector<uint32_t>& visible() const { return m_visible; }
+
+    /**
+     * Representatives in visible() after the last cull_lod(); 0 after cull().
+     */
+    size_t lod_count() const { return m_lod_nodes.size(); }
+
+    /**
+     * Number of splats with bounds (the scene size at the last update).
+     */
+    size_t size() const { return m_count; }
+
+private:
+    size_t m_count = 0;
+
+    std::shared_ptr<const SpatialIndex> m_index;
+    uint64_t m_index_id = 0;
+
+    // Bounding spheres, in index slot order when an index is attached
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_radius;
+    std::vector<uint32_t> m_remap;        // slot -> scene index with an index: its order, then the tail as is
+
+    std::vector<SpatialRange> m_ranges;   // slot runs left to test per splat
+    std::vector<uint32_t> m_lod_nodes;    // nodes drawn as representatives
+    std::vector<uint32_t> m_visible;
+    std::vector<std::vector<uint32_t>> m_part_visible;   // per-thread output
+
+    void add_tail();
+    size_t test_ranges(const Frustum& frustum, ThreadPool* pool);
+};
+
+}  // namespace sss
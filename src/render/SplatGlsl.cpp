@@ -0,0 +1,191 @@
+#include "SplatGlsl.hpp"
+#include "Shader.hpp"
+
+namespace sss {
+
+namespace {
+
+const char* kSplatGlsl = R"(
+// Splat instance decoding (see Scene.hpp for the record layouts)
+struct SplatInstance {
+    vec3 mean;
+    float opacity;
+    vec3 color;
+    vec4 rotation;   // xyzw
+    vec3 scale;
+};
+
+SplatInstance decode_full(uvec4 r0, uvec4 r1, uvec4 r2, uvec4 r3) {
+    SplatInstance s;
+    vec4 meanOpacity = uintBitsToFloat(r0);
+    vec4 scaleColorX = uintBitsToFloat(r2);
+    vec4 colorYZPad = uintBitsToFloat(r3);
+    s.mean = meanOpacity.xyz;
+    s.opacity = meanOpacity.w;
+    s.rotation = uintBitsToFloat(r1);
+    s.scale = scaleColorX.xyz;
+    s.color = vec3(scaleColorX.w, colorYZPad.xy);
+    return s;
+}
+
+float decode_half(uint h) {
+    uint e = (h >> 10u) & 31u;
+    float m = float(h & 1023u);
+    float v = e == 0u ? m * exp2(-24.0) : (1.0 + m / 1024.0) * exp2(float(e) - 15.0);
+    return (h & 0x8000u) != 0u ? -v : v;
+}
+
+// Smallest-three: three 10-bit components in xyzw order, skipping the
+// largest, whose index is in the top two bits and which is positive
+vec4 decode_rotation(uint bits) {
+    uint largest = bits >> 30u;
+    vec3 v = (vec3(uvec3(bits, bits >> 10u, bits >> 20u) & 1023u) / 1023.0 * 2.0 - 1.0) * 0.70710678;
+    float l = sqrt(max(0.0, 1.0 - dot(v, v)));
+    if (largest == 0u) return vec4(l, v);
+    if (largest == 1u) return vec4(v.x, l, v.yz);
+    if (largest == 2u) return vec4(v.xy, l, v.z);
+    return vec4(v, l);
+}
+
+SplatInstance decode_compact(uvec4 r0, uvec4 r1) {
+    SplatInstance s;
+    s.mean = uintBitsToFloat(r0.xyz);
+    s.scale = vec3(decode_half(r0.w & 0xFFFFu), decode_half(r0.w >> 16u), decode_half(r1.x & 0xFFFFu));
+    s.rotation = decode_rotation(r1.y);
+    vec4 c = vec4(uvec4(r1.z, r1.z >> 8u, r1.z >> 16u, r1.z >> 24u) & 255u) / 255.0;
+    s.color = c.rgb;
+    s.opacity = c.a;
+    return s;
+}
+
+// World covariance R S S^T R^T (the CPU pack_covariance, for records that
+// carry no precomputed one)
+mat3 splat_covariance(SplatInstance s) {
+    vec4 q = normalize(s.rotation);
+    float x = q.x, y = q.y, z = q.z, w = q.w;
+    mat3 R = mat3(1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + w * z), 2.0 * (x * z - w * y),
+                  2.0 * (x * y - w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + w * x),
+                  2.0 * (x * z + w * y), 2.0 * (y * z - w * x), 1.0 - 2.0 * (x * x + y * y));
+    mat3 M = mat3(R[0] * s.scale.x, R[1] * s.scale.y, R[2] * s.scale.z);
+    return M * transpose(M);
+}
+
+// Upper triangle of a GaussianCovarianceGPU
+mat3 unpack_covariance(vec4 c0, vec4 c1) {
+    return mat3(c0.x, c0.y, c0.z,
+                c0.y, c0.w, c1.x,
+                c0.z, c1.x, c1.y);
+}
+
+// EWA splatting: pixel covariance (a, b, c) of [a b; b c] from the local
+// affine approximation of the perspective, J W Sigma W^T J^T. The mean is
+// clamped to a guard band around the frustum so splats beside the view do
+// not blow up; the 0.3 px^2 low-pass makes every splat cover about a pixel.
+vec3 project_covariance(vec3 cam, mat3 sigma, mat4 view, mat4 proj, vec2 viewport) {
+    float tz = -cam.z;
+    vec2 focal = 0.5 * viewport * vec2(proj[0][0], proj[1][1]);
+    vec2 limit = 1.3 / vec2(proj[0][0], proj[1][1]);
+    vec2 txy = clamp(cam.xy / tz, -limit, limit) * tz;
+    mat3 J = mat3(focal.x / tz, 0.0, 0.0,
+                  0.0, focal.y / tz, 0.0,
+                  focal.x * txy.x / (tz * tz), focal.y * txy.y / (tz * tz), 0.0);
+    mat3 T = J * mat3(view);
+    mat3 cov = T * sigma * transpose(T);
+    return vec3(cov[0][0] + 0.3, cov[0][1], cov[1][1] + 0.3);
+}
+
+// Spherical-harmonics color (see Scene::sh_degree). Each gaussian's
+// coefficients are uShRows uvec4 rows of float32 or packed half words.
+uniform usamplerBuffer uSh;
+uniform uint uShDegree;      // 0: base color only
+uniform uint uShRows;
+uniform bool uShHalf;
+uniform uint uShCount;       // gaussians with SH; LOD representatives past it have none
+uniform vec3 uEye;           // world-space camera position
+
+uvec4 sh_rows[12];
+
+float sh_value(uint i) {
+    uint word = uShHalf ? i >> 1u : i;
+    uint bits = sh_rows[word >> 2u][word & 3u];
+    if (uShHalf) {
+        return decode_half((bits >> ((i & 1u) * 16u)) & 0xFFFFu);
+    }
+    return uintBitsToFloat(bits);
+}
+
+vec3 sh_coefficient(uint k) {
+    return vec3(sh_value(3u * k), sh_value(3u * k + 1u), sh_value(3u * k + 2u));
+}
+
+// Base color plus bands 1..uShDegree seen from uEye, as in the reference
+// 3DGS renderer
+vec3 eval_sh(uint index, vec3 base, vec3 mean) {
+    if (uShDegree == 0u || index >= uShCount) {
+        return base;
+    }
+    for (uint r = 0u; r < uShRows; ++r) {
+        sh_rows[r] = texelFetch(uSh, int(index * uShRows + r));
+    }
+
+    vec3 d = normalize(mean - uEye);
+    float x = d.x, y = d.y, z = d.z;
+    vec3 color = base
+        - 0.48860251 * y * sh_coefficient(0u)
+        + 0.48860251 * z * sh_coefficient(1u)
+        - 0.48860251 * x * sh_coefficient(2u);
+    if (uShDegree > 1u) {
+        float xx = x * x, yy = y * y, zz = z * z;
+        color += 1.09254843 * x * y * sh_coefficient(3u)
+               - 1.09254843 * y * z * sh_coefficient(4u)
+               + 0.31539157 * (2.0 * zz - xx - yy) * sh_coefficient(5u)
+               - 1.09254843 * x * z * sh_coefficient(6u)
+               + 0.54627422 * (xx - yy) * sh_coefficient(7u);
+        if (uShDegree > 2u) {
+            color += -0.59004359 * y * (3.0 * xx - yy) * sh_coefficient(8u)
+                   + 2.89061144 * x * y * z * sh_coefficient(9u)
+                   - 0.45704580 * y * (4.0 * zz - xx - yy) * sh_coefficient(10u)
+                   + 0.37317633 * z * (2.0 * zz - 3.0 * xx - 3.0 * yy) * sh_coefficient(11u)
+                   - 0.45704580 * x * (4.0 * zz - xx - yy) * sh_coefficient(12u)
+                   + 1.44530572 * z * (xx - yy) * sh_coefficient(13u)
+                   - 0.59004359 * x * (xx - 3.0 * yy) * sh_coefficient(14u);
+        }
+    }
+    return max(color, 0.0);
+}
+)";
+
+}  // namespace
+
+void set_sh_uniforms(GLuint program, const SplatShInput& sh, GLuint unit) {
+    if (sh.texture) {
+        sh.texture->bind(unit);
+    }
+    glUniform1i(Shader::get_uniform_location(program, "uSh"), (GLint)unit);
+    glUniform1ui(Shader::get_uniform_location(program, "uShDegree"), (GLuint)sh.degree);
+    glUniform1ui(Shader::get_uniform_location(program, "uShRows"),
+                 (GLuint)(sh_word_count(sh.degree, sh.precision) / 4));
+    glUniform1i(Shader::get_uniform_location(program, "uShHalf"), sh.precision == ShPrecision::Half ? 1 : 0);
+    glUniform1ui(Shader::get_uniform_location(program, "uShCount"), (GLuint)sh.count);
+    glUniform3f(Shader::get_uniform_location(program, "uEye"), sh.eye.x, sh.eye.y, sh.eye.z);
+}
+
+ShaderDefines splat_format_defines(InstanceFormat format) {
+    if (format == InstanceFormat::Compact) {
+        return {{"SSS_COMPACT_INSTANCES", "1"}};
+    }
+    return {};
+}
+
+std::string splat_shader_source(const char* src) {
+    std::string out(src);
+    const size_t version = out.find("#version");
+    const size_t line_end = version == std::string::npos ? std::string::npos : out.find('\n', version);
+    if (line_end == std::string::npos) {
+        return kSplatGlsl + out;
+    }
+    out.insert(line_end + 1, kSplatGlsl);
+    return out;
+}
+
+}  // namespace sss
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include "Buffers.hpp"
+#include "ShaderCache.hpp"
+#include "../scene/Scene.hpp"
+
+namespace sss {
+
+/**
+ * GLSL shared by the splat shaders (quad vertex shader and tile
+ * preprocess): instance record decoding for both InstanceFormat layouts,
+ * the EWA projection of a 3D covariance to pixels and spherical-harmonics
+ * color (eval_sh). Valid GLSL 3.30, so the GL 3.3 path can use it; the
+ * half-float decode is done by hand since unpackHalf2x16 needs 4.20.
+ *
+ * Instance buffers are read as uvec4 rows: 4 per GaussianInstanceGPU,
+ * 2 per GaussianInstanceCompact.
+ *
+ * Returns `src` with the shared code inserted after its #version line.
+ */
+std::string splat_shader_source(const char* src);
+
+/**
+ * Defines specializing a splat shader for one instance layout: the
+ * decoders stay shared, but SSS_COMPACT_INSTANCES selects which one a
+ * variant reads with (#ifdef) instead of branching on a uniform.
+ */
+ShaderDefines splat_format_defines(InstanceFormat format);
+
+/**
+ * Per-draw inputs of eval_sh: the resident SH buffer and its layout.
+ */
+struct SplatShInput {
+    const TextureBuffer* texture = nullptr;   // RGBA32UI view, one record per gaussian
+    int degree = 0;                           // bands evaluated; 0 skips SH
+    ShPrecision precision = ShPrecision::Float;
+    size_t count = 0;                         // gaussians with SH records
+    glm::vec3 eye{0.f};                       // world-space camera position
+};
+
+/**
+ * Bind the SH texture to `unit` and set eval_sh's uniforms on the bound
+ * program.
+ */
+void set_sh_uniforms(GLuint program, const SplatShInput& sh, GLuint unit);
+
+}  // namespace sss
@@ -0,0 +1,266 @@
+#include "SplatSorter.hpp"
+#include "GLCaps.hpp"
+#include "GpuRadixSort.hpp"
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include "../core/Log.hpp"
+#include "../core/RadixSort.hpp"
+#include "../core/ThreadPool.hpp"
+#include "../scene/Scene.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace sss {
+
+namespace {
+
+constexpr uint32_t kGroupSize = 256;
+
+uint32_t div_up(size_t n, uint32_t d) {
+    return (uint32_t)((n + d - 1) / d);
+}
+
+#if SSS_GL_HAS_COMPUTE
+
+// View-space depth -> descending-depth key. The payload is the instance
+// index: either i, or read from vals[] when a subset was uploaded there.
+// Both instance formats start with the float32 mean; uStride is the
+// record size in vec4s.
+const char* kKeygenSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) writeonly buffer Keys { uint keys[]; };
+layout(std430, binding = 1) buffer Vals { uint vals[]; };
+layout(std430, binding = 5) readonly buffer Instances { vec4 inst[]; };
+
+uniform mat4 uView;
+uniform uint uCount;
+uniform uint uStride;
+uniform bool uSubset;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uCount) return;
+
+    uint index = uSubset ? vals[i] : i;
+    float depth = -(uView * vec4(inst[index * uStride].xyz, 1.0)).z;
+    uint u = floatBitsToUint(depth);
+    uint key = ((u & 0x80000000u) != 0u) ? ~u : (u | 0x80000000u);
+
+    keys[i] = ~key;   // farthest first
+    vals[i] = index;
+}
+)";
+
+#endif
+
+}  // namespace
+
+const char* sort_mode_name(SortMode mode) {
+    switch (mode) {
+        case SortMode::None: return "none";
+        case SortMode::Cpu:  return "CPU radix";
+        case SortMode::Gpu:  return "GPU radix";
+        default:             return "unknown";
+    }
+}
+
+SplatSorter::SplatSorter()
+    : m_indices(std::make_unique<Buffer>()) {
+}
+
+SplatSorter::~SplatSorter() {
+    destroy_gpu_programs();
+}
+
+void SplatSorter::init(ShaderCache& shaders) {
+    m_mode = SortMode::Cpu;
+    if (GLCaps::compute_shaders()) {
+        try {
+            create_gpu_programs(shaders);
+            m_mode = SortMode::Gpu;
+        } catch (const std::exception& e) {
+            SSS_LOG_WARN("[SplatSorter] GPU sort unavailable, using CPU: %s", e.what());
+            destroy_gpu_programs();
+        }
+    }
+}
+
+void SplatSorter::set_mode(SortMode mode) {
+    if (mode == SortMode::Gpu && m_keygen_program == 0) {
+        mode = SortMode::Cpu;
+    }
+    if (mode != m_mode) {
+        m_mode = mode;
+        m_order_valid = false;
+        m_have_last_view = false;
+    }
+}
+
+void SplatSorter::reserve(size_t count) {
+    if (count <= m_capacity) {
+        return;
+    }
+    m_capacity = std::max(count, m_capacity + m_capacity / 2);
+    const size_t bytes = m_capacity * sizeof(uint32_t);
+
+    // Reallocation keeps the buffer names, so VAO bindings stay valid
+    m_indices->allocate(GL_ARRAY_BUFFER, bytes, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+#if SSS_GL_HAS_COMPUTE
+    if (m_gpu_keys) {
+        m_gpu_keys->allocate(GL_SHADER_STORAGE_BUFFER, bytes, GL_DYNAMIC_COPY);
+        m_gpu_keys_alt->allocate(GL_SHADER_STORAGE_BUFFER, bytes, GL_DYNAMIC_COPY);
+        m_gpu_values_alt->allocate(GL_SHADER_STORAGE_BUFFER, bytes, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+#endif
+
+    m_order_valid = false;
+    m_have_last_view = false;
+}
+
+void SplatSorter::sort(const Scene& scene, const Buffer& instances, const uint32_t* subset, size_t count,
+                       const glm::mat4& view, bool inputs_changed, const glm::vec3* extra_means) {
+    if (count == 0) {
+        return;
+    }
+    reserve(count);
+
+    if (count != m_last_count) {
+        m_last_count = count;
+        m_order_valid = false;
+        m_have_last_view = false;
+    }
+    if (inputs_changed) {
+        m_order_valid = false;
+        m_have_last_view = false;
+    }
+
+    if (m_mode == SortMode::None) {
+        if (!m_order_valid) {
+            write_input_order(subset, count);
+        }
+        return;
+    }
+
+    // Order only changes when the camera, the splats or the subset change
+    if (m_have_last_view && view == m_last_view) {
+        return;
+    }
+    m_last_view = view;
+    m_have_last_view = true;
+    m_order_valid = false;
+
+    if (m_mode == SortMode::Gpu) {
+        sort_gpu(instances, subset, count, view);
+    } else {
+        sort_cpu(scene, extra_means, subset, count, view);
+    }
+}
+
+void SplatSorter::write_input_order(const uint32_t* subset, size_t count) {
+    if (subset) {
+        m_indices->update_data(GL_ARRAY_BUFFER, 0, subset, count);
+    } else {
+        m_values.resize(count);
+        std::iota(m_values.begin(), m_values.end(), 0u);
+        m_indices->update_data(GL_ARRAY_BUFFER, 0, m_values.data(), count);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_order_valid = true;
+}
+
+void SplatSorter::sort_cpu(const Scene& scene, const glm::vec3* extra_means, const uint32_t* subset, size_t count,
+                           const glm::mat4& view) {
+    // Depth keys need positions only, so stream the mean array alone
+    const glm::vec3* means = scene.means().data();
+    const uint32_t scene_count = (uint32_t)scene.gaussian_count();
+    if (!subset) {
+        count = std::min(count, scene.gaussian_count());
+    }
+    m_keys.resize(count);
+    m_values.resize(count);
+
+    // Row 2 of the view matrix gives view-space z
+    const glm::vec4 row_z(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+    ThreadPool& pool = ThreadPool::shared();
+    pool.parallel_for(count, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t index = subset ? subset[i] : (uint32_t)i;
+            const glm::vec3& m = index < scene_count ? means[index] : extra_means[index - scene_count];
+            const float depth = -(row_z.x * m.x + row_z.y * m.y + row_z.z * m.z + row_z.w);
+            m_keys[i] = ~float_to_sortable_key(depth);   // farthest first
+            m_values[i] = index;
+        }
+    });
+
+    radix_sort_pairs(m_keys, m_values, m_scratch_keys, m_scratch_values, &pool);
+
+    m_indices->update_data(GL_ARRAY_BUFFER, 0, m_values.data(), count);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SplatSorter::sort_gpu(const Buffer& instances, const uint32_t* subset, size_t count, const glm::mat4& view) {
+#if SSS_GL_HAS_COMPUTE
+    const uint32_t n = (uint32_t)count;
+
+    // The subset goes in as the keygen payload and is sorted in place
+    if (subset) {
+        m_indices->update_data(GL_ARRAY_BUFFER, 0, subset, count);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glUseProgram(m_keygen_program);
+    glUniformMatrix4fv(Shader::get_uniform_location(m_keygen_program, "uView"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniform1ui(Shader::get_uniform_location(m_keygen_program, "uCount"), n);
+    glUniform1ui(Shader::get_uniform_location(m_keygen_program, "uStride"),
+                 (GLuint)(instance_stride(m_instance_format) / sizeof(glm::vec4)));
+    glUniform1i(Shader::get_uniform_location(m_keygen_program, "uSubset"), subset ? 1 : 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_gpu_keys->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_indices->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, instances.handle());
+    glDispatchCompute(div_up(n, kGroupSize), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Four 8-bit passes ping-pong between the primary and alternate buffers,
+    // so the sorted indices end up back in m_indices
+    m_radix->sort(m_gpu_keys->handle(), m_indices->handle(), m_gpu_keys_alt->handle(), m_gpu_values_alt->handle(),
+                  n, 32);
+
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    glUseProgram(0);
+#else
+    (void)instances;
+    (void)subset;
+    (void)count;
+    (void)view;
+#endif
+}
+
+void SplatSorter::create_gpu_programs(ShaderCache& shaders) {
+#if SSS_GL_HAS_COMPUTE
+    m_radix = std::make_unique<GpuRadixSort>();
+    m_radix->init(shaders);
+    m_keygen_program = shaders.program({"sort_keygen", nullptr, nullptr, kKeygenSrc});
+
+    m_gpu_keys = std::make_unique<Buffer>();
+    m_gpu_keys_alt = std::make_unique<Buffer>();
+    m_gpu_values_alt = std::make_unique<Buffer>();
+#else
+    (void)shaders;
+#endif
+}
+
+void SplatSorter::destroy_gpu_programs() {
+    m_keygen_program = 0;   // owned by the ShaderCache
+    m_radix.reset();
+    m_gpu_keys.reset();
+    m_gpu_keys_alt.reset();
+    m_gpu_values_alt.reset();
+}
+
+}  // namespace sss
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Buffers.hpp"
+#include "../scene/Scene.hpp"
+
+namespace sss {
+
+class GpuRadixSort;
+class ShaderCache;
+
+/**
+ * How splats are ordered before blending.
+ */
+enum class SortMode {
+    None,   // scene order
+    Cpu,    // parallel radix sort on the thread pool, indices uploaded per frame
+    Gpu     // compute-shader radix sort, indices never leave the GPU
+};
+
+const char* sort_mode_name(SortMode mode);
+
+/**
+ * Produces the per-frame draw order: a buffer of instance indices sorted
+ * back-to-front by view-space depth, consumed as an instanced vertex
+ * attribute by the splat shader.
+ */
+class SplatSorter {
+public:
+    SplatSorter();
+    ~SplatSorter();
+
+    SplatSorter(const SplatSorter&) = delete;
+    SplatSorter& operator=(const SplatSorter&) = delete;
+
+    /**
+     * Create GPU resources, with programs from `shaders` (which must
+     * outlive this). Picks Gpu mode when compute shaders are available,
+     * otherwise Cpu.
+     */
+    void init(ShaderCache& shaders);
+
+    /**
+     * Request a sort mode; Gpu falls back to Cpu without compute support.
+     */
+    void set_mode(SortMode mode);
+    SortMode mode() const { return m_mode; }
+
+    /**
+     * Record layout of the instance buffer the GPU path reads means from.
+     */
+    void set_instance_format(InstanceFormat format) { m_instance_format = format; }
+
+    /**
+     * Write the draw order for `count` instances into index_buffer().
+     *
+     * @param scene Source of gaussian means for the CPU path
+     * @param instances Packed instance buffer for the GPU path, in the
+     *        format given to set_instance_format()
+     * @param subset If non-null, the `count` instance indices to order
+     *        (e.g. the frustum-culled set); otherwise instances 0..count-1
+     * @param count Number of instances to order
+     * @param view Camera view matrix
+     * @param inputs_changed True if instance data or the subset changed
+     *        since the last call
+     * @param extra_means For the CPU path, means of instances stored after
+     *        the scene's own (LOD representatives), indexed from
+     *        scene.gaussian_count()
+     */
+    void sort(const Scene& scene, const Buffer& instances, const uint32_t* subset, size_t count,
+              const glm::mat4& view, bool inputs_changed, const glm::vec3* extra_means = nullptr);
+
+    /**
+     * Buffer of uint32 instance indices in draw order. Its GL name is
+     * stable for the sorter's lifetime.
+     */
+    const Buffer& index_buffer() const { return *m_indices; }
+
+private:
+    SortMode m_mode = SortMode::None;
+    InstanceFormat m_instance_format = InstanceFormat::Full;
+    size_t m_capacity = 0;           // allocated elements in GPU buffers
+    size_t m_last_count = 0;
+    bool m_order_valid = false;      // index buffer holds the unsorted input order
+    bool m_have_last_view = false;
+    glm::mat4 m_last_view{1.f};
+
+    std::unique_ptr<Buffer> m_indices;
+
+    // CPU path scratch, reused across frames
+    std::vector<uint32_t> m_keys;
+    std::vector<uint32_t> m_values;
+    std::vector<uint32_t> m_scratch_keys;
+    std::vector<uint32_t> m_scratch_values;
+
+    // GPU path resources
+    std::unique_ptr<Buffer> m_gpu_keys;
+    std::unique_ptr<Buffer> m_gpu_keys_alt;
+    std::unique_ptr<Buffer> m_gpu_values_alt;
+    std::unique_ptr<GpuRadixSort> m_radix;
+    GLuint m_keygen_program = 0;
+
+    void reserve(size_t count);
+    void write_input_order(const uint32_t* subset, size_t count);
+    void sort_cpu(const Scene& scene, const glm::vec3* extra_means, const uint32_t* subset, size_t count,
+                  const glm::mat4& view);
+    void sort_gpu(const Buffer& instances, const uint32_t* subset, size_t count, const glm::mat4& view);
+    void create_gpu_programs(ShaderCache& shaders);
+    void destroy_gpu_programs();
+};
+
+}  // namespace sss
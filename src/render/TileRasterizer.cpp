@@ -0,0 +1,628 @@
+#include "TileRasterizer.hpp"
+#include "GLCaps.hpp"
+#include "GpuRadixSort.hpp"
+#include "RenderTarget.hpp"
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include "SplatGlsl.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace sss {
+
+namespace {
+
+constexpr uint32_t kGroupSize = 256;
+constexpr uint32_t kScanBlock = 1024;   // elements per scan workgroup
+
+uint32_t div_up(size_t n, uint32_t d) {
+    return (uint32_t)((n + d - 1) / d);
+}
+
+// Bits needed to hold tile ids [0, tiles)
+uint32_t bits_for(uint32_t tiles) {
+    uint32_t bits = 1;
+    while (bits < 32 && (1u << bits) < tiles) {
+        ++bits;
+    }
+    return bits;
+}
+
+#if SSS_GL_HAS_COMPUTE
+
+// Same projection as the quad vertex shader in Renderer, producing the
+// inverse 2D covariance (conic) and the tiles inside the 1/255 footprint.
+// Splats that cannot draw get no tiles and sort last. Compiled with the
+// SplatGlsl decoders, once per instance format (splat_format_defines());
+// covs[] is only read for full-format instances.
+const char* kPreprocessSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer Instances { uvec4 inst[]; };
+layout(std430, binding = 1) readonly buffer Covariances { vec4 covs[]; };
+layout(std430, binding = 2) readonly buffer Subset { uint subset[]; };
+layout(std430, binding = 3) writeonly buffer Splats { vec4 splats[]; };
+layout(std430, binding = 4) writeonly buffer Rects { uvec4 rects[]; };
+layout(std430, binding = 5) writeonly buffer Counts { uint counts[]; };
+layout(std430, binding = 6) writeonly buffer Keys { uint keys[]; };
+layout(std430, binding = 7) writeonly buffer Order { uint order[]; };
+
+uniform mat4 uView;
+uniform mat4 uProj;
+uniform vec2 uViewport;
+uniform uvec2 uTiles;
+uniform uint uCount;
+uniform bool uSubset;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uCount) return;
+
+    counts[i] = 0u;
+    rects[i] = uvec4(0u);
+    keys[i] = 0xFFFFFFFFu;
+    order[i] = i;
+
+    uint index = uSubset ? subset[i] : i;
+    SplatInstance s;
+    mat3 sigma;
+#ifdef SSS_COMPACT_INSTANCES
+    s = decode_compact(inst[index * 2u + 0u], inst[index * 2u + 1u]);
+    sigma = splat_covariance(s);
+#else
+    s = decode_full(inst[index * 4u + 0u], inst[index * 4u + 1u], inst[index * 4u + 2u], inst[index * 4u + 3u]);
+    sigma = unpack_covariance(covs[index * 2u + 0u], covs[index * 2u + 1u]);
+#endif
+
+    float opacity = s.opacity;
+    float k = min(sqrt(2.0 * log(max(opacity * 255.0, 1.0))), 3.0);
+    vec4 cam = uView * vec4(s.mean, 1.0);
+    vec4 clip = uProj * cam;
+    if (clip.w <= 0.0 || k <= 0.0 || abs(clip.z) > clip.w) return;
+
+    float tz = -cam.z;
+    vec3 cov = project_covariance(cam.xyz, sigma, uView, uProj, uViewport);
+    float a = cov.x;
+    float b = cov.y;
+    float c = cov.z;
+    float det = a * c - b * b;
+    if (det <= 0.0) return;
+
+    // Axis-aligned extent of the k-sigma ellipse, in pixels
+    vec2 px = (clip.xy / clip.w * 0.5 + 0.5) * uViewport;
+    vec2 extent = k * sqrt(vec2(a, c));
+    ivec2 lo = clamp(ivec2(floor((px - extent) / 16.0)), ivec2(0), ivec2(uTiles));
+    ivec2 hi = clamp(ivec2(floor((px + extent) / 16.0)) + 1, ivec2(0), ivec2(uTiles));
+    if (lo.x >= hi.x || lo.y >= hi.y) return;
+
+    splats[i * 3u + 0u] = vec4(px, 0.0, opacity);
+    splats[i * 3u + 1u] = vec4(c / det, -b / det, a / det, tz);
+    splats[i * 3u + 2u] = vec4(eval_sh(index, s.color, s.mean), 0.0);
+    rects[i] = uvec4(lo, hi);
+    counts[i] = uint((hi.x - lo.x) * (hi.y - lo.y));
+    keys[i] = floatBitsToUint(tz);   // positive floats order as their bits, near first
+}
+)";
+
+// Exclusive scan of tile counts taken in depth order, per 1024-element
+// block; block totals go to sums[]
+const char* kScanBlocksSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer Counts { uint counts[]; };
+layout(std430, binding = 1) readonly buffer Order { uint order[]; };
+layout(std430, binding = 2) writeonly buffer Offsets { uint offsets[]; };
+layout(std430, binding = 3) writeonly buffer Sums { uint sums[]; };
+
+uniform uint uCount;
+
+shared uint s_sum[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint base = gl_WorkGroupID.x * 1024u + lid * 4u;
+
+    uint v[4];
+    uint total = 0u;
+    for (uint r = 0u; r < 4u; ++r) {
+        v[r] = (base + r < uCount) ? counts[order[base + r]] : 0u;
+        total += v[r];
+    }
+    s_sum[lid] = total;
+    barrier();
+
+    for (uint offset = 1u; offset < 256u; offset <<= 1u) {
+        uint x = (lid >= offset) ? s_sum[lid - offset] : 0u;
+        barrier();
+        s_sum[lid] += x;
+        barrier();
+    }
+
+    uint running = s_sum[lid] - total;
+    for (uint r = 0u; r < 4u; ++r) {
+        if (base + r < uCount) {
+            offsets[base + r] = running;
+        }
+        running += v[r];
+    }
+    if (lid == 255u) {
+        sums[gl_WorkGroupID.x] = s_sum[255];
+    }
+}
+)";
+
+// Exclusive scan of the block totals in one workgroup; the grand total
+// lands in sums[uNumBlocks] for the host to read
+const char* kScanSumsSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 3) buffer Sums { uint sums[]; };
+
+uniform uint uNumBlocks;
+
+shared uint s_sum[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint per = (uNumBlocks + 255u) / 256u;
+    uint first = min(lid * per, uNumBlocks);
+    uint last = min(first + per, uNumBlocks);
+
+    uint total = 0u;
+    for (uint b = first; b < last; ++b) {
+        total += sums[b];
+    }
+    s_sum[lid] = total;
+    barrier();
+
+    for (uint offset = 1u; offset < 256u; offset <<= 1u) {
+        uint x = (lid >= offset) ? s_sum[lid - offset] : 0u;
+        barrier();
+        s_sum[lid] += x;
+        barrier();
+    }
+
+    uint running = s_sum[lid] - total;
+    for (uint b = first; b < last; ++b) {
+        uint c = sums[b];
+        sums[b] = running;
+        running += c;
+    }
+    if (lid == 255u) {
+        sums[uNumBlocks] = s_sum[255];
+    }
+}
+)";
+
+// One (tile, splat) pair per touched tile, written in depth order
+const char* kDuplicateSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer Order { uint order[]; };
+layout(std430, binding = 1) readonly buffer Offsets { uint offsets[]; };
+layout(std430, binding = 2) readonly buffer Sums { uint sums[]; };
+layout(std430, binding = 3) readonly buffer Rects { uvec4 rects[]; };
+layout(std430, binding = 4) writeonly buffer TileKeys { uint tile_keys[]; };
+layout(std430, binding = 5) writeonly buffer PairSplats { uint pair_splats[]; };
+
+uniform uint uCount;
+uniform uint uTilesX;
+uniform uint uCapacity;
+
+void main() {
+    uint j = gl_GlobalInvocationID.x;
+    if (j >= uCount) return;
+
+    uint slot = order[j];
+    uvec4 r = rects[slot];
+    uint off = offsets[j] + sums[j / 1024u];
+    for (uint y = r.y; y < r.w; ++y) {
+        for (uint x = r.x; x < r.z; ++x) {
+            if (off >= uCapacity) return;
+            tile_keys[off] = y * uTilesX + x;
+            pair_splats[off] = slot;
+            ++off;
+        }
+    }
+}
+)";
+
+// [begin, end) of each tile's run in the tile-sorted pairs
+const char* kRangesSrc = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+layout(std430, binding = 0) readonly buffer TileKeys { uint tile_keys[]; };
+layout(std430, binding = 1) buffer Ranges { uvec2 ranges[]; };
+
+uniform uint uCount;
+
+void main() {
+    uint j = gl_GlobalInvocationID.x;
+    if (j >= uCount) return;
+
+    uint tile = tile_keys[j];
+    if (j == 0u || tile_keys[j - 1u] != tile) {
+        ranges[tile].x = j;
+    }
+    if (j == uCount - 1u || tile_keys[j + 1u] != tile) {
+        ranges[tile].y = j + 1u;
+    }
+}
+)";
+
+// One workgroup per tile: splats are staged through shared memory in
+// batches and blended front to back
+const char* kBlendSrc = R"(
+#version 430 core
+layout(local_size_x = 16, local_size_y = 16) in;
+layout(std430, binding = 0) readonly buffer Ranges { uvec2 ranges[]; };
+layout(std430, binding = 1) readonly buffer PairSplats { uint pair_splats[]; };
+layout(std430, binding = 2) readonly buffer Splats { vec4 splats[]; };
+layout(rgba8, binding = 0) writeonly uniform image2D uOutput;
+layout(r32f, binding = 1) writeonly uniform image2D uDepth;
+
+uniform uvec2 uTiles;
+uniform ivec2 uSize;
+uniform vec4 uBackground;   // alpha 0 keeps the coverage in the output's alpha
+uniform bool uWriteColor;
+uniform bool uWriteDepth;
+
+shared vec4 s_pos_opacity[256];
+shared vec4 s_conic[256];   // w: view depth
+shared vec3 s_color[256];
+shared uint s_done;
+
+void main() {
+    ivec2 pix = ivec2(gl_GlobalInvocationID.xy);
+    bool inside = all(lessThan(pix, uSize));
+    vec2 p = vec2(pix) + 0.5;
+    uint lid = gl_LocalInvocationIndex;
+    uvec2 range = ranges[gl_WorkGroupID.y * uTiles.x + gl_WorkGroupID.x];
+
+    float T = 1.0;
+    vec3 C = vec3(0.0);
+    float D = 0.0;
+    bool done = !inside;
+
+    for (uint start = range.x; start < range.y; start += 256u) {
+        // Stop fetching once every pixel of the tile is saturated
+        if (lid == 0u) s_done = 0u;
+        barrier();
+        if (done) atomicAdd(s_done, 1u);
+        barrier();
+        if (s_done == 256u) break;
+
+        uint j = start + lid;
+        if (j < range.y) {
+            uint slot = pair_splats[j];
+            s_pos_opacity[lid] = splats[slot * 3u + 0u];
+            s_conic[lid] = splats[slot * 3u + 1u];
+            s_color[lid] = splats[slot * 3u + 2u].rgb;
+        }
+        barrier();
+
+        uint n = min(256u, range.y - start);
+        for (uint k = 0u; k < n && !done; ++k) {
+            vec2 d = s_pos_opacity[k].xy - p;
+            vec3 con = s_conic[k].xyz;
+            float power = -0.5 * (con.x * d.x * d.x + con.z * d.y * d.y) - con.y * d.x * d.y;
+            if (power > 0.0) continue;
+            float alpha = min(0.99, s_pos_opacity[k].w * exp(power));
+            if (alpha < 1.0 / 255.0) continue;
+            float next_T = T * (1.0 - alpha);
+            if (next_T < 0.0001) {
+                done = true;
+                break;
+            }
+            C += s_color[k] * alpha * T;
+            D += s_conic[k].w * alpha * T;
+            T = next_T;
+        }
+        barrier();
+    }
+
+    if (inside) {
+        if (uWriteColor) imageStore(uOutput, pix, vec4(C + T * uBackground.rgb, 1.0 - T + T * uBackground.a));
+        if (uWriteDepth) imageStore(uDepth, pix, vec4(D));
+    }
+}
+)";
+
+#endif
+
+}  // namespace
+
+TileRasterizer::TileRasterizer() = default;
+
+TileRasterizer::~TileRasterizer() {
+    destroy();
+}
+
+void TileRasterizer::init(int width, int height, ShaderCache& shaders) {
+#if SSS_GL_HAS_COMPUTE
+    if (!GLCaps::compute_shaders()) {
+        throw std::runtime_error("compute shaders unavailable");
+    }
+    destroy();
+    try {
+        for (InstanceFormat format : {InstanceFormat::Full, InstanceFormat::Compact}) {
+            m_preprocess_programs[(size_t)format] = shaders.program(
+                {"tile_preprocess", nullptr, nullptr, kPreprocessSrc, true}, splat_format_defines(format));
+        }
+        m_scan_blocks_program = shaders.program({"tile_scan_blocks", nullptr, nullptr, kScanBlocksSrc});
+        m_scan_sums_program = shaders.program({"tile_scan_sums", nullptr, nullptr, kScanSumsSrc});
+        m_duplicate_program = shaders.program({"tile_duplicate", nullptr, nullptr, kDuplicateSrc});
+        m_ranges_program = shaders.program({"tile_ranges", nullptr, nullptr, kRangesSrc});
+        m_blend_program = shaders.program({"tile_blend", nullptr, nullptr, kBlendSrc});
+        m_radix = std::make_unique<GpuRadixSort>();
+        m_radix->init(shaders);
+    } catch (...) {
+        destroy();
+        throw;
+    }
+
+    for (std::unique_ptr<Buffer>* b : {&m_subset, &m_splats, &m_rects, &m_counts, &m_depth_keys, &m_order,
+                                       &m_depth_keys_alt, &m_order_alt, &m_offsets, &m_block_sums,
+                                       &m_tile_keys, &m_pair_splats, &m_tile_keys_alt, &m_pair_splats_alt,
+                                       &m_ranges}) {
+        *b = std::make_unique<Buffer>();
+    }
+    glGenFramebuffers(1, &m_fbo);
+    resize(width, height);
+#else
+    (void)width;
+    (void)height;
+    (void)shaders;
+    throw std::runtime_error("built without GL 4.3 support");
+#endif
+}
+
+void TileRasterizer::resize(int width, int height) {
+#if SSS_GL_HAS_COMPUTE
+    if (m_fbo == 0 || width <= 0 || height <= 0 || (width == m_width && height == m_height)) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    m_tiles_x = div_up((size_t)width, kTileSize);
+    m_tiles_y = div_up((size_t)height, kTileSize);
+
+    if (m_image != 0) {
+        glDeleteTextures(1, &m_image);
+    }
+    glGenTextures(1, &m_image);
+    glBindTexture(GL_TEXTURE_2D, m_image);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_image, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    reserve_ranges((size_t)m_tiles_x * m_tiles_y);
+#else
+    (void)width;
+    (void)height;
+#endif
+}
+
+void TileRasterizer::reserve_ranges(size_t tiles) {
+    if (tiles <= m_range_capacity) {
+        return;
+    }
+    m_range_capacity = tiles;
+    m_ranges->allocate(GL_SHADER_STORAGE_BUFFER, tiles * 2 * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void TileRasterizer::reserve_splats(size_t count) {
+    if (count <= m_splat_capacity) {
+        return;
+    }
+    m_splat_capacity = std::max(count, m_splat_capacity + m_splat_capacity / 2);
+    const size_t n = m_splat_capacity;
+    const GLenum target = GL_SHADER_STORAGE_BUFFER;
+    m_subset->allocate(target, n * sizeof(uint32_t), GL_DYNAMIC_DRAW);
+    m_splats->allocate(target, n * 3 * sizeof(glm::vec4), GL_DYNAMIC_COPY);
+    m_rects->allocate(target, n * 4 * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    for (Buffer* b : {m_counts.get(), m_depth_keys.get(), m_order.get(), m_depth_keys_alt.get(), m_order_alt.get(),
+                      m_offsets.get()}) {
+        b->allocate(target, n * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    }
+    m_block_sums->allocate(target, ((size_t)div_up(n, kScanBlock) + 1) * sizeof(uint32_t), GL_DYNAMIC_READ);
+    glBindBuffer(target, 0);
+}
+
+void TileRasterizer::reserve_pairs(size_t count) {
+    if (count <= m_pair_capacity) {
+        return;
+    }
+    m_pair_capacity = std::min(std::max(count, m_pair_capacity + m_pair_capacity / 2), kMaxPairs);
+    for (Buffer* b : {m_tile_keys.get(), m_pair_splats.get(), m_tile_keys_alt.get(), m_pair_splats_alt.get()}) {
+        b->allocate(GL_SHADER_STORAGE_BUFFER, m_pair_capacity * sizeof(uint32_t), GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void TileRasterizer::render(const Buffer& instances, InstanceFormat format, const Buffer* covariances,
+                            const SplatShInput& sh, const uint32_t* subset, size_t count, const glm::mat4& view,
+                            const glm::mat4& projection, const glm::vec3& background, const RenderTarget* target) {
+#if SSS_GL_HAS_COMPUTE
+    m_pair_count = 0;
+    const int width = target ? target->width() : m_width;
+    const int height = target ? target->height() : m_height;
+    if (count == 0 || width <= 0 || height <= 0) {
+        return;
+    }
+    const uint32_t tiles_x = div_up((size_t)width, kTileSize);
+    const uint32_t tiles_y = div_up((size_t)height, kTileSize);
+    reserve_ranges((size_t)tiles_x * tiles_y);
+    const uint32_t n = (uint32_t)count;
+    const uint32_t num_blocks = div_up(n, kScanBlock);
+    reserve_splats(count);
+    if (subset) {
+        m_subset->update_data(GL_SHADER_STORAGE_BUFFER, 0, subset, count);
+    }
+
+    // 1. Preprocess
+    GLuint p = m_preprocess_programs[(size_t)format];
+    glUseProgram(p);
+    glUniformMatrix4fv(Shader::get_uniform_location(p, "uView"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(Shader::get_uniform_location(p, "uProj"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform2f(Shader::get_uniform_location(p, "uViewport"), (float)width, (float)height);
+    glUniform2ui(Shader::get_uniform_location(p, "uTiles"), tiles_x, tiles_y);
+    glUniform1ui(Shader::get_uniform_location(p, "uCount"), n);
+    glUniform1i(Shader::get_uniform_location(p, "uSubset"), subset ? 1 : 0);
+    set_sh_uniforms(p, sh, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instances.handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, covariances ? covariances->handle() : 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_subset->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_splats->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_rects->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_counts->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, m_depth_keys->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, m_order->handle());
+    glDispatchCompute(div_up(n, kGroupSize), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    // 2. Depth sort of the splats (four passes, back in m_order)
+    m_radix->sort(m_depth_keys->handle(), m_order->handle(), m_depth_keys_alt->handle(), m_order_alt->handle(), n, 32);
+
+    // 3. Scan tile counts in depth order and read back the pair total
+    p = m_scan_blocks_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uCount"), n);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_counts->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_order->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_offsets->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_block_sums->handle());
+    glDispatchCompute(num_blocks, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    p = m_scan_sums_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uNumBlocks"), num_blocks);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    uint32_t total = 0;
+    m_block_sums->bind(GL_SHADER_STORAGE_BUFFER);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr)(num_blocks * sizeof(uint32_t)), sizeof(uint32_t), &total);
+    if (total == 0) {
+        glUseProgram(0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return;
+    }
+    reserve_pairs(total);
+    const uint32_t pairs = (uint32_t)std::min<size_t>(total, m_pair_capacity);
+
+    p = m_duplicate_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uCount"), n);
+    glUniform1ui(Shader::get_uniform_location(p, "uTilesX"), tiles_x);
+    glUniform1ui(Shader::get_uniform_location(p, "uCapacity"), pairs);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_order->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_offsets->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_block_sums->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_rects->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_tile_keys->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_pair_splats->handle());
+    glDispatchCompute(div_up(n, kGroupSize), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 4. Stable sort by tile keeps each tile's pairs in depth order
+    GLuint tile_keys = m_tile_keys->handle(), pair_splats = m_pair_splats->handle();
+    if (m_radix->sort(tile_keys, pair_splats, m_tile_keys_alt->handle(), m_pair_splats_alt->handle(), pairs,
+                      bits_for(tiles_x * tiles_y))) {
+        tile_keys = m_tile_keys_alt->handle();
+        pair_splats = m_pair_splats_alt->handle();
+    }
+
+    // 5. Tile ranges, then blend
+    m_ranges->bind(GL_SHADER_STORAGE_BUFFER);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    p = m_ranges_program;
+    glUseProgram(p);
+    glUniform1ui(Shader::get_uniform_location(p, "uCount"), pairs);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, tile_keys);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_ranges->handle());
+    glDispatchCompute(div_up(pairs, kGroupSize), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    p = m_blend_program;
+    glUseProgram(p);
+    glUniform2ui(Shader::get_uniform_location(p, "uTiles"), tiles_x, tiles_y);
+    glUniform2i(Shader::get_uniform_location(p, "uSize"), width, height);
+    // Offscreen targets keep coverage in alpha over a transparent background
+    const float background_alpha = target ? 0.f : 1.f;
+    const glm::vec3 bg = target ? glm::vec3(0.f) : background;
+    glUniform4f(Shader::get_uniform_location(p, "uBackground"), bg.r, bg.g, bg.b, background_alpha);
+    const GLuint color_image = target ? target->color_texture() : m_image;
+    const GLuint depth_image = target ? target->depth_texture() : 0;
+    glUniform1i(Shader::get_uniform_location(p, "uWriteColor"), color_image != 0 ? 1 : 0);
+    glUniform1i(Shader::get_uniform_location(p, "uWriteDepth"), depth_image != 0 ? 1 : 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_ranges->handle());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pair_splats);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_splats->handle());
+    if (color_image != 0) {
+        glBindImageTexture(0, color_image, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    }
+    if (depth_image != 0) {
+        glBindImageTexture(1, depth_image, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    }
+    glDispatchCompute(tiles_x, tiles_y, 1);
+
+    if (target) {
+        // Written straight into the target, for readback or sampling
+        glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    } else {
+        glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+
+        // The image replaces the framebuffer's color
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glUseProgram(0);
+    m_pair_count = pairs;
+#else
+    (void)instances;
+    (void)covariances;
+    (void)subset;
+    (void)count;
+    (void)view;
+    (void)projection;
+    (void)background;
+    (void)target;
+#endif
+}
+
+void TileRasterizer::destroy() {
+    // The programs belong to the ShaderCache
+    for (GLuint* p : {&m_preprocess_programs[0], &m_preprocess_programs[1], &m_scan_blocks_program,
+                      &m_scan_sums_program, &m_duplicate_program, &m_ranges_program, &m_blend_program}) {
+        *p = 0;
+    }
+    m_radix.reset();
+    if (m_image != 0) {
+        glDeleteTextures(1, &m_image);
+        m_image = 0;
+    }
+    if (m_fbo != 0) {
+        glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+    m_width = m_height = 0;
+    m_splat_capacity = m_pair_capacity = m_range_capacity = 0;
+}
+
+}  // namespace sss
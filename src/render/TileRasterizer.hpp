@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include "Buffers.hpp"
+#include "SplatGlsl.hpp"
+#include "../scene/Scene.hpp"
+
+namespace sss {
+
+class GpuRadixSort;
+class RenderTarget;
+class ShaderCache;
+
+/**
+ * Compute-shader splat rasterizer following the reference 3DGS pipeline
+ * (GL 4.3), used instead of instanced quads and fixed-function blending:
+ *
+ *  1. preprocess: project each splat's covariance to a 2D conic, find the
+ *     16x16 pixel tiles its 1/255 footprint touches, key it by depth
+ *  2. sort splats by depth
+ *  3. duplicate: scan the tile counts and emit one (tile, splat) pair per
+ *     touched tile, in depth order
+ *  4. stable sort of the pairs by tile; together with step 2 this orders
+ *     them by the 64-bit key (tile << 32 | depth) with far fewer passes
+ *     than sorting that key directly
+ *  5. per-tile ranges, then one workgroup per tile blends its list front
+ *     to back into an image, each pixel stopping once its transmittance
+ *     saturates and the tile stopping once all of its pixels have
+ *
+ * The pair count is read back after the scan to size step 3. That waits
+ * for the preprocess, as in the reference implementation. Pairs beyond
+ * kMaxPairs are dropped; since they are emitted near-first, the farthest
+ * splats go first.
+ */
+class TileRasterizer {
+public:
+    static constexpr uint32_t kTileSize = 16;
+    static constexpr size_t kMaxPairs = size_t(1) << 26;
+
+    TileRasterizer();
+    ~TileRasterizer();
+
+    TileRasterizer(const TileRasterizer&) = delete;
+    TileRasterizer& operator=(const TileRasterizer&) = delete;
+
+    /**
+     * Get the programs from `shaders` (which owns them and must outlive
+     * this) and size the output image.
+     *
+     * @throws std::runtime_error if compute shaders are unavailable or a
+     *         program fails to build
+     */
+    void init(int width, int height, ShaderCache& shaders);
+
+    void resize(int width, int height);
+
+    /**
+     * Rasterize `count` instances into the default framebuffer, replacing
+     * its contents (splats over `background`), or into `target` at its
+     * size: premultiplied color with coverage in alpha, and
+     * opacity-weighted depth, over transparent black.
+     *
+     * @param instances Instance buffer of `format` records
+     * @param covariances GaussianCovarianceGPU buffer with the same
+     *        indexing; required for Full, unused (may be null) for Compact,
+     *        whose covariances are built from rotation and scale
+     * @param sh Spherical-harmonics color for the same instances
+     * @param subset If non-null, the `count` instance indices to draw;
+     *        otherwise instances 0..count-1
+     */
+    void render(const Buffer& instances, InstanceFormat format, const Buffer* covariances, const SplatShInput& sh,
+                const uint32_t* subset, size_t count, const glm::mat4& view, const glm::mat4& projection,
+                const glm::vec3& background, const RenderTarget* target = nullptr);
+
+    /**
+     * (tile, splat) pairs blended in the last render() call.
+     */
+    size_t pair_count() const { return m_pair_count; }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    uint32_t m_tiles_x = 0;
+    uint32_t m_tiles_y = 0;
+
+    GLuint m_preprocess_programs[2] = {0, 0};   // by InstanceFormat
+    GLuint m_scan_blocks_program = 0;
+    GLuint m_scan_sums_program = 0;
+    GLuint m_duplicate_program = 0;
+    GLuint m_ranges_program = 0;
+    GLuint m_blend_program = 0;
+    std::unique_ptr<GpuRadixSort> m_radix;
+
+    // Per splat, in subset order
+    size_t m_splat_capacity = 0;
+    std::unique_ptr<Buffer> m_subset;
+    std::unique_ptr<Buffer> m_splats;        // 3 vec4: pixel xy + opacity, conic, color
+    std::unique_ptr<Buffer> m_rects;         // touched tiles [min, max) as uvec4
+    std::unique_ptr<Buffer> m_counts;        // tiles touched
+    std::unique_ptr<Buffer> m_depth_keys;
+    std::unique_ptr<Buffer> m_order;         // splat slots, sorted by depth
+    std::unique_ptr<Buffer> m_depth_keys_alt;
+    std::unique_ptr<Buffer> m_order_alt;
+    std::unique_ptr<Buffer> m_offsets;       // first pair of each sorted splat, per scan block
+    std::unique_ptr<Buffer> m_block_sums;    // scan block offsets, then the pair total
+
+    // Per (tile, splat) pair
+    size_t m_pair_capacity = 0;
+    size_t m_pair_count = 0;
+    std::unique_ptr<Buffer> m_tile_keys;
+    std::unique_ptr<Buffer> m_pair_splats;
+    std::unique_ptr<Buffer> m_tile_keys_alt;
+    std::unique_ptr<Buffer> m_pair_splats_alt;
+
+    size_t m_range_capacity = 0;             // tiles
+    std::unique_ptr<Buffer> m_ranges;        // uvec2 [begin, end) of each tile's pairs
+    GLuint m_image = 0;
+    GLuint m_fbo = 0;
+
+    void reserve_ranges(size_t tiles);
+    void reserve_splats(size_t count);
+    void reserve_pairs(size_t count);
+    void destroy();
+};
+
+}  // namespace sss
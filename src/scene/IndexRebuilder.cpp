@@ -0,0 +1,75 @@
+#include "IndexRebuilder.hpp"
+#include "../core/Log.hpp"
+#include "../core/ThreadPool.hpp"
+#include <chrono>
+
+namespace sss {
+
+IndexRebuilder::~IndexRebuilder() {
+    // The worker holds the snapshot, not the scene; just don't leave it behind
+    if (m_build.valid()) {
+        m_build.wait();
+    }
+}
+
+bool IndexRebuilder::needed(const Scene& scene) {
+    const SpatialIndex* index = scene.spatial_index();
+    if (scene.gaussian_count() == 0) {
+        return false;
+    }
+    if (!index || !scene.lod_hierarchy()) {
+        return true;
+    }
+    return (float)(scene.gaussian_count() - index->size()) > kMaxTailFraction * (float)index->size();
+}
+
+bool IndexRebuilder::start(const Scene& scene, ThreadPool* pool) {
+    if (m_build.valid()) {
+        return false;
+    }
+    ThreadPool& workers = pool ? *pool : ThreadPool::shared();
+
+    // The fields the index and the LOD fit read, as they are now
+    auto snapshot = std::make_shared<Scene>();
+    snapshot->resize(scene.gaussian_count(), Gaussian3D{});
+    snapshot->means_mut() = scene.means();
+    snapshot->scales_mut() = scene.scales();
+    snapshot->rotations_mut() = scene.rotations();
+    snapshot->opacities_mut() = scene.opacities();
+    snapshot->colors_mut() = scene.colors();
+    m_layout_revision = scene.layout_revision();
+
+    m_build = workers.submit([snapshot, &workers]() {
+        const auto start = std::chrono::steady_clock::now();
+        Build build;
+        build.index = std::make_shared<const SpatialIndex>(SpatialIndex::build(*snapshot, &workers));
+        build.lod = std::make_shared<const LodHierarchy>(LodHierarchy::build(*snapshot, build.index, &workers));
+        build.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return build;
+    });
+    return true;
+}
+
+bool IndexRebuilder::ready() const {
+    return m_build.valid() && m_build.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+bool IndexRebuilder::commit(Scene& scene, ThreadPool* pool) {
+    if (!m_build.valid()) {
+        return false;
+    }
+    const Build build = m_build.get();
+    if (scene.layout_revision() != m_layout_revision || build.index->size() > scene.gaussian_count()) {
+        return false;   // slots moved under the snapshot
+    }
+    // Every gaussian, since which ones were edited meanwhile is unknown
+    const auto start = std::chrono::steady_clock::now();
+    scene.refit_spatial_index(build.index, build.lod, nullptr, pool ? pool : &ThreadPool::shared());
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_last_ms = build.ms;
+    SSS_LOG_INFO("[IndexRebuilder] Rebuilt index over %zu of %zu gaussians in %.0f ms + %.1f ms",
+                 build.index->size(), scene.gaussian_count(), build.ms, ms);
+    return true;
+}
+
+}  // namespace sss
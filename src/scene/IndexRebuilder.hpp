@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include "LodHierarchy.hpp"
+#include "Scene.hpp"
+#include "SpatialIndex.hpp"
+
+namespace sss {
+
+class ThreadPool;
+
+/**
+ * Background rebuild of a scene's spatial index and LOD hierarchy.
+ *
+ * Edits applied through SceneUpdateQueue refit both in place, but that
+ * leaves gaussians added since the build outside the index (culled one by
+ * one, never occluded) and cannot follow a compaction, which moves slots.
+ * needed() tells when a rebuild pays off; start() then copies the scene's
+ * fields (render thread) and builds on a ThreadPool worker. commit()
+ * installs the result through Scene::refit_spatial_index() over every
+ * gaussian, so edits made meanwhile are accounted for, unless the slot
+ * layout changed in between, in which case the result is dropped.
+ */
+class IndexRebuilder {
+public:
+    // Gaussians outside the index, relative to the ones in it, worth a rebuild
+    static constexpr float kMaxTailFraction = 0.125f;
+
+    IndexRebuilder() = default;
+    ~IndexRebuilder();
+
+    IndexRebuilder(const IndexRebuilder&) = delete;
+    IndexRebuilder& operator=(const IndexRebuilder&) = delete;
+
+    /**
+     * `scene` has no current index or LOD hierarchy, or too many gaussians
+     * outside the index.
+     */
+    static bool needed(const Scene& scene);
+
+    /**
+     * Snapshot `scene` and start building on `pool` (the shared pool if
+     * null). Returns false if a build is already pending.
+     */
+    bool start(const Scene& scene, ThreadPool* pool = nullptr);
+
+    bool pending() const { return m_build.valid(); }
+
+    /**
+     * The pending build is done, so commit() will not wait for it.
+     */
+    bool ready() const;
+
+    /**
+     * Install the pending build in `scene` (the one passed to start()),
+     * waiting for it if needed. Returns false if there was none or the
+     * scene's slots moved since the snapshot.
+     */
+    bool commit(Scene& scene, ThreadPool* pool = nullptr);
+
+    /**
+     * Background time of the last committed build.
+     */
+    double last_ms() const { return m_last_ms; }
+
+private:
+    struct Build {
+        std::shared_ptr<const SpatialIndex> index;
+        std::shared_ptr<const LodHierarchy> lod;
+        double ms = 0.0;
+    };
+
+    std::future<Build> m_build;
+    uint64_t m_layout_revision = 0;   // the snapshot's
+    double m_last_ms = 0.0;
+};
+
+}  // namespace sss
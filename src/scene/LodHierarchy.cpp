@@ -0,0 +1,324 @@
+#include "LodHierarchy.hpp"
+#include "../core/ThreadPool.hpp"
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+namespace sss {
+
+namespace {
+
+constexpr size_t kMinChunk = 1 << 10;   // nodes per job
+
+std::atomic<uint64_t> g_next_id{1};
+
+void for_range(ThreadPool* pool, size_t count, const std::function<void(size_t, size_t)>& fn) {
+    if (pool) {
+        pool->parallel_for(count, kMinChunk, fn);
+    } else {
+        fn(0, count);
+    }
+}
+
+// Symmetric 3x3 matrix
+struct Sym3 {
+    float xx = 0.f, xy = 0.f, xz = 0.f, yy = 0.f, yz = 0.f, zz = 0.f;
+};
+
+Sym3 operator*(const Sym3& a, float s) {
+    return Sym3{a.xx * s, a.xy * s, a.xz * s, a.yy * s, a.yz * s, a.zz * s};
+}
+
+Sym3 operator+(const Sym3& a, const Sym3& b) {
+    return Sym3{a.xx + b.xx, a.xy + b.xy, a.xz + b.xz, a.yy + b.yy, a.yz + b.yz, a.zz + b.zz};
+}
+
+Sym3 outer(const glm::vec3& d) {
+    return Sym3{d.x * d.x, d.x * d.y, d.x * d.z, d.y * d.y, d.y * d.z, d.z * d.z};
+}
+
+// Proxy for an ellipsoid's surface area, which drives how much of the
+// screen a splat covers from an arbitrary direction
+float area(const glm::vec3& scale) {
+    const glm::vec3 s = glm::abs(scale);
+    return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+// Weighted second-order statistics of a set of gaussians
+struct Moments {
+    float mass = 0.f;        // sum of opacity * area
+    glm::vec3 mean{0.f};
+    Sym3 cov;                // about mean, including each gaussian's own covariance
+    glm::vec3 color{0.f};
+
+    void merge(const Moments& o) {
+        if (o.mass <= 0.f) {
+            return;
+        }
+        if (mass <= 0.f) {
+            *this = o;
+            return;
+        }
+        const float total = mass + o.mass;
+        const float wa = mass / total;
+        const float wb = o.mass / total;
+        const glm::vec3 m = mean * wa + o.mean * wb;
+        cov = (cov + outer(mean - m)) * wa + (o.cov + outer(o.mean - m)) * wb;
+        color = color * wa + o.color * wb;
+        mean = m;
+        mass = total;
+    }
+};
+
+Moments gaussian_moments(const glm::vec3& mean, const glm::vec3& scale, const glm::quat& rotation,
+                         float opacity, const glm::vec3& color) {
+    Moments m;
+    m.mass = std::max(opacity, 0.f) * area(scale);
+    m.mean = mean;
+    m.color = color;
+    // R * S^2 * R^T, one rank-1 term per local axis
+    const glm::mat3 r = glm::mat3_cast(glm::normalize(rotation));
+    for (int a = 0; a < 3; ++a) {
+        m.cov = m.cov + outer(r[a]) * (scale[a] * scale[a]);
+    }
+    return m;
+}
+
+// Cyclic Jacobi eigen-decomposition; eigenvectors are the columns of `vectors`
+void eigen_symmetric(const Sym3& s, glm::vec3& values, glm::mat3& vectors) {
+    float a[3][3] = {{s.xx, s.xy, s.xz}, {s.xy, s.yy, s.yz}, {s.xz, s.yz, s.zz}};
+    float v[3][3] = {{1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, 0.f, 1.f}};
+    constexpr int kPairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+
+    for (int sweep = 0; sweep < 12; ++sweep) {
+        const float off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        const float diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (off <= 1e-12f * diag) {
+            break;
+        }
+        for (const auto& pair : kPairs) {
+            const int p = pair[0], q = pair[1];
+            if (a[p][q] == 0.f) {
+                continue;
+            }
+            const float theta = (a[q][q] - a[p][p]) / (2.f * a[p][q]);
+            const float t = (theta >= 0.f ? 1.f : -1.f) / (std::fabs(theta) + std::sqrt(theta * theta + 1.f));
+            const float c = 1.f / std::sqrt(t * t + 1.f);
+            const float sn = t * c;
+            for (int k = 0; k < 3; ++k) {
+                const float kp = a[k][p], kq = a[k][q];
+                a[k][p] = c * kp - sn * kq;
+                a[k][q] = sn * kp + c * kq;
+            }
+            for (int k = 0; k < 3; ++k) {
+                const float pk = a[p][k], qk = a[q][k];
+                a[p][k] = c * pk - sn * qk;
+                a[q][k] = sn * pk + c * qk;
+            }
+            for (int k = 0; k < 3; ++k) {
+                const float kp = v[k][p], kq = v[k][q];
+                v[k][p] = c * kp - sn * kq;
+                v[k][q] = sn * kp + c * kq;
+            }
+        }
+    }
+
+    values = glm::vec3(a[0][0], a[1][1], a[2][2]);
+    for (int j = 0; j < 3; ++j) {
+        vectors[j] = glm::vec3(v[0][j], v[1][j], v[2][j]);
+    }
+}
+
+// Gaussian with the given moments: covariance factored into scale and
+// rotation, opacity set so that opacity * area matches the mass
+Gaussian3D fit_gaussian(const Moments& m) {
+    Gaussian3D g;
+    g.mean = m.mean;
+    g.color = m.color;
+
+    glm::vec3 values;
+    glm::mat3 axes;
+    eigen_symmetric(m.cov, values, axes);
+    if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.f) {
+        axes[2] = -axes[2];   // keep a proper rotation
+    }
+    g.rotation = glm::normalize(glm::quat_cast(axes));
+    g.scale = glm::vec3(std::sqrt(std::max(values.x, 0.f)),
+                        std::sqrt(std::max(values.y, 0.f)),
+                        std::sqrt(std::max(values.z, 0.f)));
+    g.opacity = m.mass > 0.f ? std::min(1.f, m.mass / std::max(area(g.scale), 1e-20f)) : 0.f;
+    return g;
+}
+
+Moments leaf_moments(const Scene& scene, const SpatialIndex& index, const SpatialIndex::Node& node) {
+    const std::vector<uint32_t>& order = index.order();
+    const glm::vec3* means = scene.means().data();
+    const glm::vec3* scales = scene.scales().data();
+    const glm::quat* rotations = scene.rotations().data();
+    const float* opacities = scene.opacities().data();
+    const glm::vec3* colors = scene.colors().data();
+    Moments m;
+    for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+        const uint32_t i = order[k];
+        m.merge(gaussian_moments(means[i], scales[i], rotations[i], opacities[i], colors[i]));
+    }
+    return m;
+}
+
+// A node's representative and the sphere its LOD error is measured on
+void fit_node(const Moments& m, const SpatialIndex::Node& node, GaussianInstanceGPU& instance, glm::vec3& mean,
+              glm::vec4& sphere) {
+    const Gaussian3D g = fit_gaussian(m);
+    instance = pack_gaussian(g);
+    mean = g.mean;
+    const glm::vec3 half = (node.bounds_max - node.bounds_min) * 0.5f;
+    sphere = glm::vec4(node.bounds_min + half, glm::length(half));
+}
+
+}  // namespace
+
+LodHierarchy LodHierarchy::build(const Scene& scene, std::shared_ptr<const SpatialIndex> index, ThreadPool* pool) {
+    static_assert(sizeof(Moments) == kMomentFloats * sizeof(float), "moments are stored as floats");
+    LodHierarchy lod;
+    lod.m_id = g_next_id.fetch_add(1);
+    lod.m_index = std::move(index);
+
+    const std::vector<SpatialIndex::Node>& nodes = lod.m_index->nodes();
+    const size_t count = nodes.size();
+    if (count == 0) {
+        return lod;
+    }
+
+    // Leaves straight from their splats
+    std::vector<Moments> moments(count);
+    for_range(pool, count, [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; ++n) {
+            if (nodes[n].left == SpatialIndex::kLeaf) {
+                moments[n] = leaf_moments(scene, *lod.m_index, nodes[n]);
+            }
+        }
+    });
+
+    // Children always follow their parent in node order, so a reverse
+    // sweep sees both children of a node before the node itself
+    for (size_t n = count; n-- > 0;) {
+        const SpatialIndex::Node& node = nodes[n];
+        if (node.left != SpatialIndex::kLeaf) {
+            Moments m = moments[node.left];
+            m.merge(moments[node.left + 1]);
+            moments[n] = m;
+        }
+    }
+
+    lod.m_instances.resize(count);
+    lod.m_means.resize(count);
+    lod.m_spheres.resize(count);
+    lod.m_moments.resize(count * kMomentFloats);
+    std::memcpy(lod.m_moments.data(), moments.data(), count * sizeof(Moments));
+    for_range(pool, count, [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; ++n) {
+            fit_node(moments[n], nodes[n], lod.m_instances[n], lod.m_means[n], lod.m_spheres[n]);
+        }
+    });
+    return lod;
+}
+
+LodHierarchy LodHierarchy::refit(const Scene& scene, std::shared_ptr<const SpatialIndex> index,
+                                 const std::vector<uint32_t>& nodes, ThreadPool* pool) const {
+    LodHierarchy lod = *this;
+    lod.m_id = g_next_id.fetch_add(1);
+    lod.m_index = std::move(index);
+    const std::vector<SpatialIndex::Node>& tree = lod.m_index->nodes();
+    float* stored = lod.m_moments.data();
+    auto load = [stored](uint32_t n) {
+        Moments m;
+        std::memcpy(static_cast<void*>(&m), stored + n * kMomentFloats, sizeof(Moments));
+        return m;
+    };
+    auto store = [stored](uint32_t n, const Moments& m) {
+        std::memcpy(stored + n * kMomentFloats, &m, sizeof(Moments));
+    };
+
+    for_range(pool, nodes.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t n = nodes[k];
+            if (tree[n].left == SpatialIndex::kLeaf) {
+                store(n, leaf_moments(scene, *lod.m_index, tree[n]));
+            }
+        }
+    });
+    // In the given order both children are final before their parent
+    for (uint32_t n : nodes) {
+        const SpatialIndex::Node& node = tree[n];
+        if (node.left != SpatialIndex::kLeaf) {
+            Moments m = load(node.left);
+            m.merge(load(node.left + 1));
+            store(n, m);
+        }
+    }
+    for_range(pool, nodes.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t n = nodes[k];
+            fit_node(load(n), tree[n], lod.m_instances[n], lod.m_means[n], lod.m_spheres[n]);
+        }
+    });
+    return lod;
+}
+
+void LodHierarchy::select(const Frustum& frustum, const LodCutParams& params,
+                          std::vector<SpatialRange>& ranges, std::vector<uint32_t>& nodes) const {
+    if (!m_index || m_index->nodes().empty()) {
+        return;
+    }
+    const std::vector<SpatialIndex::Node>& tree = m_index->nodes();
+
+    // Projected size s * ppu / d stays within max_error while d >= s * ppu / max_error
+    const float distance_scale = params.pixels_per_unit / std::max(params.max_error, 1e-6f);
+
+    struct Entry {
+        uint32_t node;
+        bool contained;   // parent already inside the frustum
+    };
+    Entry stack[128];   // depth is bounded by 30 code bits plus duplicate-code splits
+    int top = 0;
+    stack[top++] = Entry{0, false};
+    while (top > 0) {
+        const Entry e = stack[--top];
+        const SpatialIndex::Node& node = tree[e.node];
+        if (m_instances[e.node].mean_opacity.w <= 0.f) {
+            continue;   // nothing visible below
+        }
+        int c = 1;
+        if (!e.contained) {
+            c = frustum.classify_box(node.bounds_min, node.bounds_max);
+            if (c < 0) {
+                continue;
+            }
+        }
+
+        const glm::vec4& sphere = m_spheres[e.node];
+        const float distance = glm::length(glm::vec3(sphere) - params.eye) - sphere.w;
+        if (distance > 0.f && distance >= sphere.w * distance_scale) {
+            nodes.push_back(e.node);
+            continue;
+        }
+
+        if (node.left == SpatialIndex::kLeaf) {
+            if (!ranges.empty() && ranges.back().contained == (c > 0) &&
+                ranges.back().first + ranges.back().count == node.first) {
+                ranges.back().count += node.count;
+            } else {
+                ranges.push_back(SpatialRange{node.first, node.count, c > 0});
+            }
+            continue;
+        }
+        stack[top++] = Entry{node.left + 1, c > 0};
+        stack[top++] = Entry{node.left, c > 0};
+    }
+}
+
+}  // namespace sss
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../core/Frustum.hpp"
+#include "Scene.hpp"
+#include "SpatialIndex.hpp"
+
+namespace sss {
+
+class ThreadPool;
+
+/**
+ * Per-view inputs for choosing a LOD cut.
+ */
+struct LodCutParams {
+    glm::vec3 eye{0.f};             // camera position, world space
+    float pixels_per_unit = 0.f;    // on-screen pixels of a unit length at unit distance
+    float max_error = 1.f;          // screen-space error budget, in pixels
+};
+
+/**
+ * Level-of-detail hierarchy over a SpatialIndex.
+ *
+ * Every BVH node gets one representative gaussian, moment-matched to the
+ * splats below it. Splats are weighted by their "mass", opacity times the
+ * ellipsoid's surface-area proxy (sx*sy + sy*sz + sz*sx); the
+ * representative takes the weighted mean, the weighted covariance
+ * (including the spread of the child means) and the weighted color, and
+ * an opacity that gives it the same mass as the splats it replaces.
+ *
+ * Like the index it is built from, the hierarchy is a snapshot of the
+ * scene at build time; refit() follows in-place edits.
+ */
+class LodHierarchy {
+public:
+    LodHierarchy() = default;
+
+    /**
+     * Build representatives for every node of `index`, which must describe
+     * `scene` as it is now.
+     *
+     * @param pool Optional pool for the leaf and fitting passes
+     */
+    static LodHierarchy build(const Scene& scene, std::shared_ptr<const SpatialIndex> index, ThreadPool* pool);
+
+    /**
+     * Copy over `index`, a SpatialIndex::refit() of this one's index, with
+     * the representatives of `nodes` (its refitted list, children before
+     * parents) fitted again to `scene` as it is now. The rest are kept, so
+     * this costs in proportion to the edited part of the tree.
+     */
+    LodHierarchy refit(const Scene& scene, std::shared_ptr<const SpatialIndex> index,
+                       const std::vector<uint32_t>& nodes, ThreadPool* pool) const;
+
+    /**
+     * Unique per build.
+     */
+    uint64_t id() const { return m_id; }
+
+    const SpatialIndex& index() const { return *m_index; }
+    const std::shared_ptr<const SpatialIndex>& index_shared() const { return m_index; }
+
+    /**
+     * Number of representatives (one per index node).
+     */
+    size_t size() const { return m_instances.size(); }
+
+    /**
+     * Representatives in node order, packed for upload.
+     */
+    const std::vector<GaussianInstanceGPU>& instances() const { return m_instances; }
+
+    /**
+     * Representative means in node order, for depth sorting.
+     */
+    const std::vector<glm::vec3>& means() const { return m_means; }
+
+    /**
+     * Representative of `node` as a gaussian.
+     */
+    Gaussian3D representative(uint32_t node) const { return unpack_gaussian(m_instances[node]); }
+
+    /**
+     * Choose the cut for one view. Walking down from the root, a node whose
+     * bounds project to at most params.max_error pixels is drawn as its
+     * representative (appended to `nodes`); a leaf that is still too large
+     * is opened into the slot run of its splats (appended to `ranges`,
+     * marked contained when inside the frustum). Nodes outside the frustum
+     * and nodes without visible splats are dropped.
+     */
+    void select(const Frustum& frustum, const LodCutParams& params,
+                std::vector<SpatialRange>& ranges, std::vector<uint32_t>& nodes) const;
+
+private:
+    uint64_t m_id = 0;
+    std::shared_ptr<const SpatialIndex> m_index;
+    std::vector<GaussianInstanceGPU> m_instances;   // node -> representative
+    std::vector<glm::vec3> m_means;                 // node -> representative mean
+    std::vector<glm::vec4> m_spheres;               // node -> box center, half diagonal
+    std::vector<float> m_moments;                   // node -> kMomentFloats of fitting input, for refit()
+
+    static constexpr size_t kMomentFloats = 13;     // mass, mean, covariance (6), color
+};
+
+}  // namespace sss
@@ -0,0 +1,222 @@
+#include "MapCompactor.hpp"
+#include "SpatialIndex.hpp"
+#include "../core/Log.hpp"
+#include "../core/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace sss {
+
+namespace {
+
+float largest(const glm::vec3& scale) {
+    return std::max(scale.x, std::max(scale.y, scale.z));
+}
+
+bool prunable(float opacity, const glm::vec3& scale, const CompactionParams& params) {
+    return opacity < params.min_opacity || largest(scale) < params.min_radius;
+}
+
+// Close relative to the smaller one's size, and alike in shape, orientation
+// and color
+bool similar(const Gaussian3D& a, const Gaussian3D& b, const CompactionParams& params) {
+    const float reach = params.merge_distance * std::min(largest(a.scale), largest(b.scale));
+    const glm::vec3 d = b.mean - a.mean;
+    if (glm::dot(d, d) > reach * reach) {
+        return false;
+    }
+    if (std::abs(glm::dot(glm::normalize(a.rotation), glm::normalize(b.rotation))) < params.merge_alignment) {
+        return false;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        const float lo = std::min(a.scale[axis], b.scale[axis]);
+        const float hi = std::max(a.scale[axis], b.scale[axis]);
+        if (hi > lo * params.merge_scale_ratio) {
+            return false;
+        }
+    }
+    return glm::length(b.color - a.color) <= params.merge_color;
+}
+
+// One gaussian covering both: opacity-weighted mean and color, the more
+// opaque one's orientation, each axis widened to the pair's spread along
+// it, and their combined coverage as opacity
+Gaussian3D merge(const Gaussian3D& a, const Gaussian3D& b) {
+    const float total = a.opacity + b.opacity;
+    const float wa = total > 0.f ? a.opacity / total : 0.5f;
+    const float wb = 1.f - wa;
+    Gaussian3D g;
+    g.mean = a.mean * wa + b.mean * wb;
+    g.color = a.color * wa + b.color * wb;
+    g.rotation = a.opacity >= b.opacity ? a.rotation : b.rotation;
+    const glm::vec3 offset = glm::conjugate(glm::normalize(g.rotation)) * (b.mean - a.mean);
+    const glm::vec3 spread = 0.5f * glm::abs(offset);
+    g.scale = glm::sqrt(glm::max(a.scale * a.scale, b.scale * b.scale) + spread * spread);
+    g.opacity = a.opacity + b.opacity - a.opacity * b.opacity;
+    return g;
+}
+
+}  // namespace
+
+MapCompactor::MapCompactor(const CompactionParams& params) : m_params(params) {}
+
+MapCompactor::~MapCompactor() {
+    // Don't leave a worker planning for nobody
+    if (m_plan.valid()) {
+        m_plan.wait();
+    }
+}
+
+bool MapCompactor::start(const Scene& scene, ThreadPool* pool) {
+    if (m_plan.valid()) {
+        return false;
+    }
+    ThreadPool& workers = pool ? *pool : ThreadPool::shared();
+
+    // The fields only, as they are now; SH is not compared
+    const size_t count = scene.gaussian_count();
+    auto snapshot = std::make_shared<Scene>();
+    snapshot->resize(count, Gaussian3D{});
+    snapshot->means_mut() = scene.means();
+    snapshot->scales_mut() = scene.scales();
+    snapshot->rotations_mut() = scene.rotations();
+    snapshot->opacities_mut() = scene.opacities();
+    snapshot->colors_mut() = scene.colors();
+    auto ids = std::make_shared<std::vector<uint32_t>>(count);
+    for (size_t i = 0; i < count; ++i) {
+        (*ids)[i] = scene.id_of(i);
+    }
+
+    m_plan_params = m_params;
+    const CompactionParams params = m_params;
+    m_plan = workers.submit([snapshot, ids, params, &workers]() { return plan(*snapshot, *ids, params, workers); });
+    return true;
+}
+
+bool MapCompactor::ready() const {
+    return m_plan.valid() && m_plan.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+MapCompactor::Plan MapCompactor::plan(const Scene& snapshot, const std::vector<uint32_t>& ids,
+                                      const CompactionParams& params, ThreadPool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t count = snapshot.gaussian_count();
+    Plan plan;
+    plan.count = count;
+
+    std::vector<uint8_t> gone(count, 0);
+    pool.parallel_for(count, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            gone[i] = prunable(snapshot.opacities()[i], snapshot.scales()[i], params) ? 1 : 0;
+        }
+    });
+    for (size_t i = 0; i < count; ++i) {
+        if (gone[i]) {
+            plan.pruned.push_back(ids[i]);
+        }
+    }
+
+    if (params.merge_distance > 0.f && count > 1) {
+        // Each survivor's nearest similar neighbour further along in slot
+        // order, in parallel; then pairs taken greedily in slot order, so
+        // every gaussian is in at most one merge per pass
+        const SpatialIndex index = SpatialIndex::build(snapshot, &pool);
+        std::vector<uint32_t> partner(count, Scene::kNoSlot);
+        pool.parallel_for(count, 1 << 12, [&](size_t begin, size_t end) {
+            std::vector<uint32_t> near;
+            for (size_t i = begin; i < end; ++i) {
+                if (gone[i]) {
+                    continue;
+                }
+                const Gaussian3D a = snapshot.gaussian(i);
+                near.clear();
+                index.query_radius(a.mean, params.merge_distance * largest(a.scale), near);
+                float best = std::numeric_limits<float>::max();
+                for (uint32_t j : near) {
+                    if (j <= i || gone[j]) {
+                        continue;
+                    }
+                    const Gaussian3D b = snapshot.gaussian(j);
+                    const glm::vec3 d = b.mean - a.mean;
+                    if (glm::dot(d, d) < best && similar(a, b, params)) {
+                        best = glm::dot(d, d);
+                        partner[i] = j;
+                    }
+                }
+            }
+        });
+
+        std::vector<uint8_t> used(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t j = partner[i];
+            if (j == Scene::kNoSlot || used[i] || used[j]) {
+                continue;
+            }
+            used[i] = used[j] = 1;
+            plan.merges.emplace_back(ids[i], ids[j]);
+        }
+    }
+
+    plan.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return plan;
+}
+
+CompactionStats MapCompactor::commit(Scene& scene) {
+    if (!m_plan.valid()) {
+        return CompactionStats{};
+    }
+    const Plan plan = m_plan.get();
+    const auto start = std::chrono::steady_clock::now();
+    const CompactionParams& params = m_plan_params;
+
+    CompactionStats stats;
+    stats.before = scene.gaussian_count();
+    stats.plan_ms = plan.ms;
+
+    // Everything is checked again on the current values: edits since the
+    // snapshot may have made a candidate worth keeping
+    std::vector<uint8_t> remove(stats.before, 0);
+    for (uint32_t id : plan.pruned) {
+        const uint32_t slot = scene.slot_of(id);
+        if (slot == Scene::kNoSlot) {
+            continue;
+        }
+        if (!prunable(scene.opacities()[slot], scene.scales()[slot], params)) {
+            ++stats.skipped;
+            continue;
+        }
+        remove[slot] = 1;
+        ++stats.pruned;
+    }
+    for (const auto& [kept_id, folded_id] : plan.merges) {
+        const uint32_t kept = scene.slot_of(kept_id);
+        const uint32_t folded = scene.slot_of(folded_id);
+        if (kept == Scene::kNoSlot || folded == Scene::kNoSlot || remove[kept] || remove[folded]) {
+            ++stats.skipped;
+            continue;
+        }
+        const Gaussian3D a = scene.gaussian(kept);
+        const Gaussian3D b = scene.gaussian(folded);
+        if (!similar(a, b, params)) {
+            ++stats.skipped;
+            continue;
+        }
+        scene.set_gaussian(kept, merge(a, b));
+        remove[folded] = 1;
+        ++stats.merged;
+    }
+
+    scene.compact(remove);
+    stats.after = scene.gaussian_count();
+    stats.commit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_stats = stats;
+    SSS_LOG_INFO("[MapCompactor] %zu -> %zu gaussians (%zu pruned, %zu merged, %zu skipped) in %.0f ms + %.1f ms",
+                 stats.before, stats.after, stats.pruned, stats.merged, stats.skipped, stats.plan_ms,
+                 stats.commit_ms);
+    return stats;
+}
+
+}  // namespace sss
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <utility>
+#include <vector>
+#include "Scene.hpp"
+
+namespace sss {
+
+class ThreadPool;
+
+/**
+ * What MapCompactor removes. Pruning is by absolute thresholds; merging
+ * compares neighbours relative to their size, so it works at any scene
+ * scale.
+ */
+struct CompactionParams {
+    float min_opacity = 0.02f;        // prune below this (tombstones included)
+    float min_radius = 0.0f;          // prune if the largest scale is below this; world units, 0 = off
+    float merge_distance = 0.5f;      // merge means closer than this times the smaller largest scale; 0 = off
+    float merge_scale_ratio = 1.5f;   // per-axis scales at most this far apart
+    float merge_alignment = 0.95f;    // |dot| of the rotations at least this
+    float merge_color = 0.05f;        // RGB distance at most this
+};
+
+struct CompactionStats {
+    size_t before = 0;
+    size_t pruned = 0;
+    size_t merged = 0;        // gaussians folded into a neighbour
+    size_t skipped = 0;       // planned removals undone by edits since the snapshot
+    size_t after = 0;
+    double plan_ms = 0.0;     // in the background
+    double commit_ms = 0.0;   // on the render thread
+};
+
+/**
+ * Background compaction of a mapped scene: prunes gaussians too
+ * transparent or too small to matter, merges near-duplicate neighbours,
+ * and compacts what is left in place (Scene::compact()).
+ *
+ * start() copies the scene's fields (render thread) and plans on a
+ * ThreadPool worker: the prune candidates, and for merging a SpatialIndex
+ * over the copy, each gaussian's nearest similar neighbour and a greedy
+ * pairing in slot order. commit() then re-checks every candidate against
+ * the scene as it is by then, since mappers keep editing it, and applies
+ * the survivors. Plans refer to gaussians by Scene ID, so edits queued in
+ * a SceneUpdateQueue meanwhile land on the right gaussians.
+ *
+ * A merge keeps the ID and SH of the pair's lower slot at planning time.
+ * The spatial index and LOD hierarchy go stale like after any edit. Not
+ * for TileResidency scenes, whose slots are pages.
+ */
+class MapCompactor {
+public:
+    explicit MapCompactor(const CompactionParams& params = {});
+    ~MapCompactor();
+
+    MapCompactor(const MapCompactor&) = delete;
+    MapCompactor& operator=(const MapCompactor&) = delete;
+
+    /**
+     * Snapshot `scene` and start planning on `pool` (the shared pool if
+     * null). Returns false if a plan is already pending.
+     */
+    bool start(const Scene& scene, ThreadPool* pool = nullptr);
+
+    /**
+     * A plan is pending: started and not yet committed.
+     */
+    bool pending() const { return m_plan.valid(); }
+
+    /**
+     * The pending plan is done, so commit() will not wait for it.
+     */
+    bool ready() const;
+
+    /**
+     * Apply the pending plan to `scene` (the one passed to start()),
+     * waiting for it if needed. Returns this run's statistics; all zero
+     * without a pending plan.
+     */
+    CompactionStats commit(Scene& scene);
+
+    const CompactionParams& params() const { return m_params; }
+    void set_params(const CompactionParams& params) { m_params = params; }   // from the next start()
+
+    /**
+     * Statistics of the last commit().
+     */
+    const CompactionStats& last_stats() const { return m_stats; }
+
+private:
+    struct Plan {
+        std::vector<uint32_t> pruned;                        // IDs
+        std::vector<std::pair<uint32_t, uint32_t>> merges;   // (kept ID, folded ID)
+        size_t count = 0;                                    // gaussians in the snapshot
+        double ms = 0.0;
+    };
+
+    CompactionParams m_params;
+    CompactionParams m_plan_params;   // the pending plan's
+    std::future<Plan> m_plan;
+    CompactionStats m_stats;
+
+    static Plan plan(const Scene& snapshot, const std::vector<uint32_t>& ids, const CompactionParams& params,
+                     ThreadPool& pool);
+};
+
+}  // namespace sss
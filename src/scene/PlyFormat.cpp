@@ -0,0 +1,383 @@
+#include "PlyFormat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sss {
+
+namespace {
+
+// Band-0 SH basis constant: color = 0.5 + kShC0 * f_dc
+constexpr float kShC0 = 0.28209479177387814f;
+
+bool parse_type(std::string_view name, PlyType& type) {
+    struct Entry {
+        std::string_view name;
+        PlyType type;
+    };
+    static constexpr Entry kTypes[] = {
+        {"char", PlyType::Int8},     {"int8", PlyType::Int8},       {"uchar", PlyType::UInt8},
+        {"uint8", PlyType::UInt8},   {"short", PlyType::Int16},     {"int16", PlyType::Int16},
+        {"ushort", PlyType::UInt16}, {"uint16", PlyType::UInt16},   {"int", PlyType::Int32},
+        {"int32", PlyType::Int32},   {"uint", PlyType::UInt32},     {"uint32", PlyType::UInt32},
+        {"float", PlyType::Float32}, {"float32", PlyType::Float32}, {"double", PlyType::Float64},
+        {"float64", PlyType::Float64},
+    };
+    for (const Entry& e : kTypes) {
+        if (e.name == name) {
+            type = e.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t type_size(PlyType type) {
+    switch (type) {
+        case PlyType::Int8:
+        case PlyType::UInt8: return 1;
+        case PlyType::Int16:
+        case PlyType::UInt16: return 2;
+        case PlyType::Int32:
+        case PlyType::UInt32:
+        case PlyType::Float32: return 4;
+        case PlyType::Float64: return 8;
+    }
+    return 0;
+}
+
+// Whitespace-separated words of a header line
+size_t split_words(std::string_view line, std::string_view* words, size_t max_words) {
+    size_t n = 0;
+    size_t i = 0;
+    while (n < max_words) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
+            ++i;
+        }
+        if (i == line.size()) {
+            break;
+        }
+        size_t j = i;
+        while (j < line.size() && line[j] != ' ' && line[j] != '\t') {
+            ++j;
+        }
+        words[n++] = line.substr(i, j - i);
+        i = j;
+    }
+    return n;
+}
+
+size_t parse_count(std::string_view word) {
+    size_t value = 0;
+    if (word.empty()) {
+        throw std::runtime_error("PLY header: missing element count");
+    }
+    for (char c : word) {
+        if (c < '0' || c > '9') {
+            throw std::runtime_error("PLY header: bad element count '" + std::string(word) + "'");
+        }
+        value = value * 10 + (size_t)(c - '0');
+    }
+    return value;
+}
+
+// "prefix_<n>" properties; returns n, or -1 if the name doesn't match
+int indexed_property(std::string_view name, std::string_view prefix) {
+    if (name.size() <= prefix.size() || name.substr(0, prefix.size()) != prefix) {
+        return -1;
+    }
+    int value = 0;
+    for (char c : name.substr(prefix.size())) {
+        if (c < '0' || c > '9' || value > 1000) {
+            return -1;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+void map_property(PlyLayout& layout, std::string_view name, PlyField field) {
+    static constexpr std::string_view kAxes[3] = {"x", "y", "z"};
+    static constexpr std::string_view kRgb[3] = {"red", "green", "blue"};
+    for (int i = 0; i < 3; ++i) {
+        if (name == kAxes[i]) {
+            layout.mean[i] = field;
+            return;
+        }
+        if (name == kRgb[i]) {
+            layout.rgb[i] = field;
+            return;
+        }
+    }
+    if (name == "opacity") {
+        layout.opacity = field;
+        return;
+    }
+    int i = indexed_property(name, "scale_");
+    if (i >= 0 && i < 3) {
+        layout.scale[i] = field;
+        return;
+    }
+    i = indexed_property(name, "rot_");
+    if (i >= 0 && i < 4) {
+        layout.rotation[i] = field;
+        return;
+    }
+    i = indexed_property(name, "f_dc_");
+    if (i >= 0 && i < 3) {
+        layout.dc[i] = field;
+        return;
+    }
+    i = indexed_property(name, "f_rest_");
+    if (i >= 0) {
+        if (i >= PlyLayout::kMaxRest) {
+            throw std::runtime_error("PLY header: " + std::string(name) + " is beyond SH degree " +
+                                     std::to_string(kMaxShDegree));
+        }
+        layout.rest[i] = field;
+    }
+}
+
+float read_field(const uint8_t* record, const PlyField& field) {
+    const uint8_t* p = record + field.offset;
+    switch (field.type) {
+        case PlyType::Int8: return (float)(int8_t)*p;
+        case PlyType::UInt8: return (float)*p;
+        case PlyType::Int16: { int16_t v; std::memcpy(&v, p, sizeof(v)); return (float)v; }
+        case PlyType::UInt16: { uint16_t v; std::memcpy(&v, p, sizeof(v)); return (float)v; }
+        case PlyType::Int32: { int32_t v; std::memcpy(&v, p, sizeof(v)); return (float)v; }
+        case PlyType::UInt32: { uint32_t v; std::memcpy(&v, p, sizeof(v)); return (float)v; }
+        case PlyType::Float32: { float v; std::memcpy(&v, p, sizeof(v)); return v; }
+        case PlyType::Float64: { double v; std::memcpy(&v, p, sizeof(v)); return (float)v; }
+    }
+    return 0.f;
+}
+
+// Point-cloud colors: integer channels are full-range, floats are [0, 1]
+float color_scale(PlyType type) {
+    switch (type) {
+        case PlyType::UInt8: return 1.f / 255.f;
+        case PlyType::UInt16: return 1.f / 65535.f;
+        default: return 1.f;
+    }
+}
+
+}  // namespace
+
+PlyLayout parse_ply_header(const uint8_t* data, size_t size) {
+    const char* text = reinterpret_cast<const char*>(data);
+    size_t pos = 0;
+    auto next_line = [&](std::string_view& line) {
+        const void* nl = std::memchr(text + pos, '\n', size - pos);
+        if (!nl) {
+            throw std::runtime_error("PLY header is not terminated by end_header");
+        }
+        const size_t end = (size_t)(static_cast<const char*>(nl) - text);
+        line = std::string_view(text + pos, end - pos);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        pos = end + 1;
+    };
+
+    std::string_view line;
+    next_line(line);
+    if (line != "ply") {
+        throw std::runtime_error("Not a PLY file (missing 'ply' magic)");
+    }
+
+    PlyLayout layout;
+    bool format_seen = false;
+    bool in_vertex = false;
+    bool vertex_seen = false;
+    bool preceding_lists = false;   // a list property in an element before the vertices
+    size_t skip_bytes = 0;          // records of elements before the vertices
+    size_t element_count = 0;
+    size_t element_stride = 0;
+    size_t rest_count = 0;
+
+    auto finish_element = [&]() {
+        if (in_vertex) {
+            layout.stride = element_stride;
+        } else if (!vertex_seen) {
+            skip_bytes += element_count * element_stride;
+        }
+    };
+
+    while (true) {
+        next_line(line);
+        std::string_view words[6];
+        const size_t n = split_words(line, words, 6);
+        if (n == 0 || words[0] == "comment" || words[0] == "obj_info") {
+            continue;
+        }
+        if (words[0] == "end_header") {
+            break;
+        }
+        if (words[0] == "format") {
+            if (n < 2 || words[1] != "binary_little_endian") {
+                throw std::runtime_error("Unsupported PLY format '" + std::string(n > 1 ? words[1] : "") +
+                                         "': only binary_little_endian is supported");
+            }
+            format_seen = true;
+        } else if (words[0] == "element") {
+            if (n < 3) {
+                throw std::runtime_error("PLY header: malformed element line");
+            }
+            finish_element();
+            if (in_vertex) {
+                vertex_seen = true;
+            }
+            in_vertex = !vertex_seen && words[1] == "vertex";
+            element_count = parse_count(words[2]);
+            element_stride = 0;
+            if (in_vertex) {
+                layout.count = element_count;
+            }
+        } else if (words[0] == "property") {
+            if (n >= 2 && words[1] == "list") {
+                if (in_vertex) {
+                    throw std::runtime_error("PLY header: list properties on vertices are not supported");
+                }
+                preceding_lists = preceding_lists || !vertex_seen;
+                continue;
+            }
+            PlyType type;
+            if (n < 3 || !parse_type(words[1], type)) {
+                throw std::runtime_error("PLY header: bad property line '" + std::string(line) + "'");
+            }
+            if (in_vertex) {
+                map_property(layout, words[2], PlyField{(int32_t)element_stride, type});
+                if (indexed_property(words[2], "f_rest_") >= 0) {
+                    ++rest_count;
+                }
+            }
+            element_stride += type_size(type);
+        } else {
+            throw std::runtime_error("PLY header: unknown keyword '" + std::string(words[0]) + "'");
+        }
+    }
+    finish_element();
+    if (in_vertex) {
+        vertex_seen = true;
+    }
+
+    if (!format_seen) {
+        throw std::runtime_error("PLY header has no format line");
+    }
+    if (!vertex_seen) {
+        throw std::runtime_error("PLY file has no vertex element");
+    }
+    if (preceding_lists) {
+        throw std::runtime_error("PLY file has list elements before its vertices");
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!layout.mean[i].present()) {
+            throw std::runtime_error("PLY vertices have no x/y/z properties");
+        }
+        if (!layout.dc[i].present() && !layout.rgb[i].present()) {
+            throw std::runtime_error("PLY vertices have no color (f_dc_0..2 or red/green/blue)");
+        }
+    }
+
+    // f_rest_* must be 0..N-1 for N three times a band-limited coefficient count
+    for (size_t i = 0; i < rest_count; ++i) {
+        if (!layout.rest[i].present()) {
+            throw std::runtime_error("PLY f_rest properties are not numbered 0.." + std::to_string(rest_count - 1));
+        }
+    }
+    for (int d = 0; d <= kMaxShDegree; ++d) {
+        if (3 * sh_coefficient_count(d) == rest_count) {
+            layout.sh_degree = d;
+            break;
+        }
+        if (d == kMaxShDegree) {
+            throw std::runtime_error("PLY file has " + std::to_string(rest_count) +
+                                     " f_rest properties; expected 0, 9, 24 or 45");
+        }
+    }
+
+    layout.data_offset = pos + skip_bytes;
+    if (layout.stride == 0 && layout.count > 0) {
+        throw std::runtime_error("PLY vertex element has no properties");
+    }
+    if (layout.data_offset > size || layout.count > (size - layout.data_offset) / std::max<size_t>(layout.stride, 1)) {
+        throw std::runtime_error("PLY file is truncated: header declares " + std::to_string(layout.count) +
+                                 " vertices");
+    }
+    return layout;
+}
+
+void decode_ply_vertices(const PlyLayout& layout, const uint8_t* data, size_t first, size_t count,
+                         Scene& out, size_t out_first) {
+    const bool has_scale = layout.scale[0].present() && layout.scale[1].present() && layout.scale[2].present();
+    const bool has_rotation = layout.rotation[0].present() && layout.rotation[1].present() &&
+                              layout.rotation[2].present() && layout.rotation[3].present();
+    const bool has_dc = layout.dc[0].present() && layout.dc[1].present() && layout.dc[2].present();
+    const size_t sh_count = sh_coefficient_count(layout.sh_degree);
+
+    std::vector<glm::vec3>& means = out.means_mut();
+    std::vector<glm::vec3>& scales = out.scales_mut();
+    std::vector<glm::quat>& rotations = out.rotations_mut();
+    std::vector<float>& opacities = out.opacities_mut();
+    std::vector<glm::vec3>& colors = out.colors_mut();
+
+    glm::vec3 sh[PlyLayout::kMaxRest / 3];
+    const uint8_t* record = data + layout.data_offset + first * layout.stride;
+    for (size_t i = 0; i < count; ++i, record += layout.stride) {
+        const size_t dst = out_first + i;
+        means[dst] = glm::vec3(read_field(record, layout.mean[0]), read_field(record, layout.mean[1]),
+                               read_field(record, layout.mean[2]));
+
+        if (has_scale) {
+            scales[dst] = glm::vec3(std::exp(read_field(record, layout.scale[0])),
+                                    std::exp(read_field(record, layout.scale[1])),
+                                    std::exp(read_field(record, layout.scale[2])));
+        } else {
+            scales[dst] = glm::vec3(1.f);
+        }
+
+        glm::quat q(1.f, 0.f, 0.f, 0.f);
+        if (has_rotation) {
+            const glm::quat raw(read_field(record, layout.rotation[0]), read_field(record, layout.rotation[1]),
+                                read_field(record, layout.rotation[2]), read_field(record, layout.rotation[3]));
+            const float len = glm::length(raw);
+            if (len > 0.f && std::isfinite(len)) {
+                q = glm::normalize(raw);
+            }
+        }
+        rotations[dst] = q;
+
+        opacities[dst] = layout.opacity.present()
+                             ? 1.f / (1.f + std::exp(-read_field(record, layout.opacity)))
+                             : 1.f;
+
+        if (has_dc) {
+            const glm::vec3 dc(read_field(record, layout.dc[0]), read_field(record, layout.dc[1]),
+                               read_field(record, layout.dc[2]));
+            colors[dst] = glm::vec3(0.5f) + dc * kShC0;
+        } else {
+            glm::vec3 c;
+            for (int ch = 0; ch < 3; ++ch) {
+                c[ch] = read_field(record, layout.rgb[ch]) * color_scale(layout.rgb[ch].type);
+            }
+            colors[dst] = c;
+        }
+
+        if (sh_count > 0) {
+            // Channel-major in the file, RGB-interleaved in the scene
+            for (size_t k = 0; k < sh_count; ++k) {
+                for (int ch = 0; ch < 3; ++ch) {
+                    sh[k][ch] = read_field(record, layout.rest[ch * sh_count + k]);
+                }
+            }
+            out.write_sh(dst, sh, sh_count);
+        }
+    }
+}
+
+}  // namespace sss
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Scene.hpp"
+
+namespace sss {
+
+// Binary little-endian PLY as written by 3DGS trainers: one "vertex"
+// element per gaussian with float properties
+//
+//   x y z            mean
+//   scale_0..2       log scale
+//   rot_0..3         unnormalized quaternion, w first
+//   opacity          logit
+//   f_dc_0..2        SH band 0, RGB
+//   f_rest_0..N-1    SH bands 1+, channel-major: all R, then G, then B
+//
+// Point-cloud PLYs (red/green/blue, no gaussian properties) are accepted
+// too and get the same defaults as JSON scenes. Other properties (normals,
+// extra features) are skipped.
+
+enum class PlyType : uint8_t { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+/**
+ * Location of one vertex property within a record; offset < 0 if the file
+ * does not have it.
+ */
+struct PlyField {
+    int32_t offset = -1;
+    PlyType type = PlyType::Float32;
+
+    bool present() const { return offset >= 0; }
+};
+
+/**
+ * Property layout of a PLY file's vertex records, resolved from its header.
+ */
+struct PlyLayout {
+    static constexpr int kMaxRest = 45;   // f_rest properties of degree 3
+
+    size_t count = 0;            // vertices
+    size_t stride = 0;           // bytes per vertex record
+    size_t data_offset = 0;      // byte offset of the first vertex record
+    PlyField mean[3];
+    PlyField scale[3];
+    PlyField rotation[4];        // w, x, y, z
+    PlyField opacity;
+    PlyField dc[3];
+    PlyField rgb[3];             // point-cloud color, used without f_dc
+    PlyField rest[kMaxRest];
+    int sh_degree = 0;           // from the number of f_rest properties
+};
+
+/**
+ * Parse the header of a PLY file held in memory and map its vertex
+ * properties.
+ *
+ * @throws std::runtime_error if the header is malformed, the format is not
+ *         binary_little_endian, a mean or color is missing, or the vertex
+ *         data is truncated
+ */
+PlyLayout parse_ply_header(const uint8_t* data, size_t size);
+
+/**
+ * Decode vertices [first, first + count) into gaussians
+ * [out_first, out_first + count) of `out`, applying the trainer's
+ * activations: exp of scale, sigmoid of opacity, quaternion normalization
+ * and the band-0 SH to color mapping.
+ *
+ * `out` must already be large enough and have SH degree layout.sh_degree.
+ * Writes the field arrays directly without marking dirty, so disjoint
+ * ranges can be decoded concurrently.
+ */
+void decode_ply_vertices(const PlyLayout& layout, const uint8_t* data, size_t first, size_t count,
+                         Scene& out, size_t out_first);
+
+}  // namespace sss
@@ -1,8 +1,442 @@
 #include "Scene.hpp"
+#include "LodHierarchy.hpp"
+#include "SpatialIndex.hpp"
+#include <glm/gtc/packing.hpp>
+#include <bit>
+#include <cmath>
 
 namespace sss {
 
+namespace {
+
+constexpr float kSqrt2 = 1.41421356f;
+
+// Smallest-three quaternion encoding: the largest component is dropped
+// (made positive, since q and -q are the same rotation) and the other
+// three, each within +-1/sqrt(2), are stored as 10-bit unorm
+uint32_t pack_rotation(const glm::quat& rotation) {
+    const glm::quat q = glm::normalize(rotation);
+    float c[4] = {q.x, q.y, q.z, q.w};
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i) {
+        if (std::fabs(c[i]) > std::fabs(c[largest])) {
+            largest = i;
+        }
+    }
+    const float sign = c[largest] < 0.f ? -1.f : 1.f;
+
+    uint32_t bits = largest << 30;
+    uint32_t shift = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        const float v = std::clamp(sign * c[i] * kSqrt2 * 0.5f + 0.5f, 0.f, 1.f);
+        bits |= (uint32_t)std::lround(v * 1023.f) << shift;
+        shift += 10;
+    }
+    return bits;
+}
+
+// Value `i` of one gaussian's SH record
+float read_sh_value(const uint32_t* words, size_t i, ShPrecision precision) {
+    if (precision == ShPrecision::Half) {
+        return glm::unpackHalf1x16((uint16_t)(words[i / 2] >> (16 * (i % 2))));
+    }
+    return std::bit_cast<float>(words[i]);
+}
+
+void write_sh_value(uint32_t* words, size_t i, float v, ShPrecision precision) {
+    if (precision == ShPrecision::Half) {
+        const uint32_t shift = 16 * (uint32_t)(i % 2);
+        words[i / 2] = (words[i / 2] & ~(0xFFFFu << shift)) | ((uint32_t)glm::packHalf1x16(v) << shift);
+    } else {
+        words[i] = std::bit_cast<uint32_t>(v);
+    }
+}
+
+glm::quat unpack_rotation(uint32_t bits) {
+    const uint32_t largest = bits >> 30;
+    float c[4];
+    float sum = 0.f;
+    uint32_t shift = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        c[i] = ((float)((bits >> shift) & 1023u) / 1023.f * 2.f - 1.f) / kSqrt2;
+        sum += c[i] * c[i];
+        shift += 10;
+    }
+    c[largest] = std::sqrt(std::max(0.f, 1.f - sum));
+    return glm::quat(c[3], c[0], c[1], c[2]);
+}
+
+}  // namespace
+
+const char* instance_format_name(InstanceFormat format) {
+    switch (format) {
+        case InstanceFormat::Full: return "full";
+        case InstanceFormat::Compact: return "compact";
+    }
+    return "unknown";
+}
+
+const char* sh_precision_name(ShPrecision precision) {
+    switch (precision) {
+        case ShPrecision::Float: return "float";
+        case ShPrecision::Half: return "half";
+    }
+    return "unknown";
+}
+
+GaussianInstanceCompact pack_gaussian_compact(const Gaussian3D& g) {
+    GaussianInstanceCompact inst;
+    inst.mean = g.mean;
+    inst.scale_xy = (uint32_t)glm::packHalf1x16(g.scale.x) | ((uint32_t)glm::packHalf1x16(g.scale.y) << 16);
+    inst.scale_z = glm::packHalf1x16(g.scale.z);
+    inst.rotation = pack_rotation(g.rotation);
+    inst.color_opacity = glm::packUnorm4x8(glm::vec4(g.color, g.opacity));
+    inst.reserved = 0;
+    return inst;
+}
+
+Gaussian3D unpack_gaussian(const GaussianInstanceCompact& inst) {
+    Gaussian3D g;
+    g.mean = inst.mean;
+    g.scale = glm::vec3(glm::unpackHalf1x16((uint16_t)(inst.scale_xy & 0xffffu)),
+                        glm::unpackHalf1x16((uint16_t)(inst.scale_xy >> 16)),
+                        glm::unpackHalf1x16((uint16_t)(inst.scale_z & 0xffffu)));
+    g.rotation = unpack_rotation(inst.rotation);
+    const glm::vec4 color_opacity = glm::unpackUnorm4x8(inst.color_opacity);
+    g.color = glm::vec3(color_opacity);
+    g.opacity = color_opacity.w;
+    return g;
+}
+
 // Scene implementation
-// (Most functionality is in the header as inline methods)
+// (Small accessors are in the header as inline methods)
+
+void Scene::set_gaussians(const std::vector<Gaussian3D>& gaussians) {
+    const size_t count = gaussians.size();
+    m_means.resize(count);
+    m_scales.resize(count);
+    m_rotations.resize(count);
+    m_opacities.resize(count);
+    m_colors.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Gaussian3D& g = gaussians[i];
+        m_means[i] = g.mean;
+        m_scales[i] = g.scale;
+        m_rotations[i] = g.rotation;
+        m_opacities[i] = g.opacity;
+        m_colors[i] = g.color;
+    }
+    m_sh.assign(count * sh_words(), 0u);
+    m_ids.clear();
+    m_slots.clear();
+    ++m_layout_revision;
+    mark_all_dirty();
+}
+
+void Scene::reserve(size_t count) {
+    m_means.reserve(count);
+    m_scales.reserve(count);
+    m_rotations.reserve(count);
+    m_opacities.reserve(count);
+    m_colors.reserve(count);
+    m_sh.reserve(count * sh_words());
+}
+
+void Scene::resize(size_t count, const Gaussian3D& fill) {
+    const size_t old_count = m_means.size();
+    ++m_revision;
+    m_means.resize(count, fill.mean);
+    m_scales.resize(count, fill.scale);
+    m_rotations.resize(count, fill.rotation);
+    m_opacities.resize(count, fill.opacity);
+    m_colors.resize(count, fill.color);
+    m_sh.resize(count * sh_words(), 0u);
+    if (count < old_count) {
+        ++m_layout_revision;
+        if (!m_slots.empty()) {
+            for (size_t slot = count; slot < old_count; ++slot) {
+                m_slots[m_ids[slot]] = kNoSlot;
+            }
+            m_ids.resize(count);
+        }
+        m_dirty.end = std::min(m_dirty.end, count);
+    } else {
+        append_ids(count - old_count);
+        mark_dirty(old_count, count - old_count);
+    }
+}
+
+void Scene::write_range(size_t first, const Scene& src, bool mark_dirty_range) {
+    std::copy(src.m_means.begin(), src.m_means.end(), m_means.begin() + first);
+    std::copy(src.m_scales.begin(), src.m_scales.end(), m_scales.begin() + first);
+    std::copy(src.m_rotations.begin(), src.m_rotations.end(), m_rotations.begin() + first);
+    std::copy(src.m_opacities.begin(), src.m_opacities.end(), m_opacities.begin() + first);
+    std::copy(src.m_colors.begin(), src.m_colors.end(), m_colors.begin() + first);
+    if (src.m_sh_degree > m_sh_degree) {
+        set_sh_layout(src.m_sh_degree, m_sh_precision);
+    }
+    if (m_sh_degree > 0) {
+        if (src.m_sh_degree == m_sh_degree && src.m_sh_precision == m_sh_precision) {
+            std::copy(src.m_sh.begin(), src.m_sh.end(), m_sh.begin() + first * sh_words());
+        } else {
+            glm::vec3 coefficients[15];
+            const size_t count = sh_coefficient_count(src.m_sh_degree);
+            for (size_t i = 0; i < src.gaussian_count(); ++i) {
+                src.get_sh(i, coefficients);
+                write_sh(first + i, coefficients, count);
+            }
+        }
+    }
+    ++m_revision;
+    if (mark_dirty_range) {
+        mark_dirty(first, src.gaussian_count());
+    }
+}
+
+void Scene::write_packed(size_t first, const GaussianInstanceGPU* src, size_t count, bool mark_dirty_range) {
+    glm::vec3* means = m_means.data() + first;
+    glm::vec3* scales = m_scales.data() + first;
+    glm::quat* rotations = m_rotations.data() + first;
+    float* opacities = m_opacities.data() + first;
+    glm::vec3* colors = m_colors.data() + first;
+    for (size_t i = 0; i < count; ++i) {
+        const GaussianInstanceGPU& inst = src[i];
+        means[i] = glm::vec3(inst.mean_opacity);
+        opacities[i] = inst.mean_opacity.w;
+        rotations[i] = glm::quat(inst.quat.w, inst.quat.x, inst.quat.y, inst.quat.z);
+        scales[i] = glm::vec3(inst.scale_colorx);
+        colors[i] = glm::vec3(inst.scale_colorx.w, inst.coloryz_pad.x, inst.coloryz_pad.y);
+    }
+    if (mark_dirty_range) {
+        mark_dirty(first, count);
+    }
+}
+
+void Scene::write_packed(size_t first, const GaussianInstanceCompact* src, size_t count, bool mark_dirty_range) {
+    for (size_t i = 0; i < count; ++i) {
+        const Gaussian3D g = unpack_gaussian(src[i]);
+        m_means[first + i] = g.mean;
+        m_scales[first + i] = g.scale;
+        m_rotations[first + i] = g.rotation;
+        m_opacities[first + i] = g.opacity;
+        m_colors[first + i] = g.color;
+    }
+    if (mark_dirty_range) {
+        mark_dirty(first, count);
+    }
+}
+
+void Scene::pack_range(size_t first, size_t count, GaussianInstanceGPU* out) const {
+    const glm::vec3* means = m_means.data() + first;
+    const glm::vec3* scales = m_scales.data() + first;
+    const glm::quat* rotations = m_rotations.data() + first;
+    const float* opacities = m_opacities.data() + first;
+    const glm::vec3* colors = m_colors.data() + first;
+    for (size_t i = 0; i < count; ++i) {
+        GaussianInstanceGPU& inst = out[i];
+        inst.mean_opacity = glm::vec4(means[i], opacities[i]);
+        inst.quat = glm::vec4(rotations[i].x, rotations[i].y, rotations[i].z, rotations[i].w);
+        inst.scale_colorx = glm::vec4(scales[i], colors[i].r);
+        inst.coloryz_pad = glm::vec4(colors[i].g, colors[i].b, 0.f, 0.f);
+    }
+}
+
+void Scene::pack_range(size_t first, size_t count, GaussianInstanceCompact* out) const {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = pack_gaussian_compact(Gaussian3D{m_means[first + i], m_scales[first + i], m_rotations[first + i],
+                                                  m_opacities[first + i], m_colors[first + i]});
+    }
+}
+
+void Scene::set_sh_layout(int degree, ShPrecision precision) {
+    degree = std::clamp(degree, 0, kMaxShDegree);
+    if (degree == m_sh_degree && precision == m_sh_precision) {
+        return;
+    }
+
+    const size_t count = gaussian_count();
+    const size_t old_words = sh_words();
+    const size_t words = sh_word_count(degree, precision);
+    const size_t values = 3 * sh_coefficient_count(std::min(degree, m_sh_degree));
+    std::vector<uint32_t> sh(count * words, 0u);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t* from = m_sh.data() + i * old_words;
+        uint32_t* to = sh.data() + i * words;
+        for (size_t v = 0; v < values; ++v) {
+            write_sh_value(to, v, read_sh_value(from, v, m_sh_precision), precision);
+        }
+    }
+    m_sh = std::move(sh);
+    m_sh_degree = degree;
+    m_sh_precision = precision;
+    m_dirty = DirtyRange{0, count};
+}
+
+void Scene::set_sh(size_t index, const glm::vec3* coefficients, size_t count) {
+    write_sh(index, coefficients, count);
+    mark_dirty(index, 1);
+}
+
+void Scene::write_sh(size_t index, const glm::vec3* coefficients, size_t count) {
+    uint32_t* words = m_sh.data() + index * sh_words();
+    const size_t stored = sh_coefficient_count(m_sh_degree);
+    for (size_t k = 0; k < stored; ++k) {
+        const glm::vec3 c = k < count ? coefficients[k] : glm::vec3(0.f);
+        for (int ch = 0; ch < 3; ++ch) {
+            write_sh_value(words, 3 * k + ch, c[ch], m_sh_precision);
+        }
+    }
+}
+
+void Scene::get_sh(size_t index, glm::vec3* out) const {
+    const uint32_t* words = m_sh.data() + index * sh_words();
+    const size_t stored = sh_coefficient_count(m_sh_degree);
+    for (size_t k = 0; k < stored; ++k) {
+        for (int ch = 0; ch < 3; ++ch) {
+            out[k][ch] = read_sh_value(words, 3 * k + ch, m_sh_precision);
+        }
+    }
+}
+
+void Scene::pack_sh_range(size_t first, size_t count, int degree, uint32_t* out) const {
+    degree = std::min(degree, m_sh_degree);
+    const size_t words = sh_word_count(degree, m_sh_precision);
+    const size_t stored_words = sh_words();
+    if (degree == m_sh_degree) {
+        std::copy(m_sh.begin() + first * stored_words, m_sh.begin() + (first + count) * stored_words, out);
+        return;
+    }
+    // Lower bands come first, so a truncated record is a prefix of the
+    // stored one (its padding may hold the next band, which goes unread)
+    for (size_t i = 0; i < count; ++i) {
+        std::copy_n(m_sh.data() + (first + i) * stored_words, words, out + i * words);
+    }
+}
+
+void Scene::clear() {
+    m_means.clear();
+    m_scales.clear();
+    m_rotations.clear();
+    m_opacities.clear();
+    m_colors.clear();
+    m_sh.clear();
+    m_sh_degree = 0;
+    m_ids.clear();
+    m_slots.clear();
+    m_dirty = DirtyRange{};
+    ++m_revision;
+    ++m_layout_revision;
+}
+
+size_t Scene::compact(const std::vector<uint8_t>& remove) {
+    const size_t count = m_means.size();
+    size_t first = 0;
+    while (first < count && !remove[first]) {
+        ++first;
+    }
+    if (first == count) {
+        return 0;
+    }
+    if (m_slots.empty()) {
+        // IDs part from slots from here on
+        m_ids.resize(count);
+        m_slots.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_ids[i] = m_slots[i] = (uint32_t)i;
+        }
+    }
+
+    const size_t words = sh_words();
+    size_t kept = first;
+    for (size_t i = first; i < count; ++i) {
+        if (remove[i]) {
+            m_slots[m_ids[i]] = kNoSlot;
+            continue;
+        }
+        m_means[kept] = m_means[i];
+        m_scales[kept] = m_scales[i];
+        m_rotations[kept] = m_rotations[i];
+        m_opacities[kept] = m_opacities[i];
+        m_colors[kept] = m_colors[i];
+        std::copy_n(m_sh.data() + i * words, words, m_sh.data() + kept * words);
+        m_ids[kept] = m_ids[i];
+        m_slots[m_ids[kept]] = (uint32_t)kept;
+        ++kept;
+    }
+
+    // Shrinking keeps the capacity, so later growth doesn't reallocate either
+    m_means.resize(kept);
+    m_scales.resize(kept);
+    m_rotations.resize(kept);
+    m_opacities.resize(kept);
+    m_colors.resize(kept);
+    m_sh.resize(kept * words);
+    m_ids.resize(kept);
+
+    ++m_revision;
+    ++m_layout_revision;
+    m_dirty.end = std::min(m_dirty.end, kept);
+    mark_dirty(first, kept - first);
+    return count - kept;
+}
+
+uint32_t Scene::revive(uint32_t id, const Gaussian3D& gaussian) {
+    const uint32_t slot = (uint32_t)m_means.size();
+    m_means.push_back(gaussian.mean);
+    m_scales.push_back(gaussian.scale);
+    m_rotations.push_back(gaussian.rotation);
+    m_opacities.push_back(gaussian.opacity);
+    m_colors.push_back(gaussian.color);
+    m_sh.resize(m_sh.size() + sh_words(), 0u);
+    m_ids.push_back(id);
+    m_slots[id] = slot;
+    mark_dirty(slot, 1);
+    return slot;
+}
+
+void Scene::build_spatial_index(ThreadPool* pool) {
+    m_spatial_index = std::make_shared<const SpatialIndex>(SpatialIndex::build(*this, pool));
+    m_spatial_revision = m_revision;
+}
+
+void Scene::refit_spatial_index(std::shared_ptr<const SpatialIndex> index, std::shared_ptr<const LodHierarchy> lod,
+                                const std::vector<uint32_t>* changed, ThreadPool* pool) {
+    if (!index || index->size() > m_means.size()) {
+        return;
+    }
+    if (lod && &lod->index() != index.get()) {
+        lod.reset();
+    }
+    if (changed && changed->empty()) {
+        // Only appended to; the tail is outside the index anyway
+        m_spatial_index = std::move(index);
+    } else {
+        std::vector<uint32_t> nodes;
+        auto refitted = std::make_shared<const SpatialIndex>(index->refit(*this, changed, pool, &nodes));
+        if (lod) {
+            lod = std::make_shared<const LodHierarchy>(lod->refit(*this, refitted, nodes, pool));
+        }
+        m_spatial_index = std::move(refitted);
+    }
+    m_spatial_revision = m_revision;
+    if (lod) {
+        m_lod = std::move(lod);
+        m_lod_revision = m_revision;
+    }
+}
+
+void Scene::build_lod_hierarchy(ThreadPool* pool) {
+    if (!spatial_index()) {
+        build_spatial_index(pool);
+    }
+    m_lod = std::make_shared<const LodHierarchy>(LodHierarchy::build(*this, m_spatial_index, pool));
+    m_lod_revision = m_revision;
+}
 
 }  // namespace sss
@@ -2,6 +2,12 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace sss {
@@ -31,37 +37,540 @@ struct GaussianInstanceGPU {
 
 static_assert(sizeof(GaussianInstanceGPU) == 64, "GaussianInstanceGPU must be 64 bytes");
 
+// Pack a gaussian into its GPU instance layout
+inline GaussianInstanceGPU pack_gaussian(const Gaussian3D& g) {
+    GaussianInstanceGPU inst;
+    inst.mean_opacity = glm::vec4(g.mean, g.opacity);
+    inst.quat = glm::vec4(g.rotation.x, g.rotation.y, g.rotation.z, g.rotation.w);
+    inst.scale_colorx = glm::vec4(g.scale, g.color.r);
+    inst.coloryz_pad = glm::vec4(g.color.g, g.color.b, 0.f, 0.f);
+    return inst;
+}
+
+// Inverse of pack_gaussian
+inline Gaussian3D unpack_gaussian(const GaussianInstanceGPU& inst) {
+    Gaussian3D g;
+    g.mean = glm::vec3(inst.mean_opacity);
+    g.opacity = inst.mean_opacity.w;
+    g.rotation = glm::quat(inst.quat.w, inst.quat.x, inst.quat.y, inst.quat.z);
+    g.scale = glm::vec3(inst.scale_colorx);
+    g.color = glm::vec3(inst.scale_colorx.w, inst.coloryz_pad.x, inst.coloryz_pad.y);
+    return g;
+}
+
+// World-space 3D covariance of an instance (32 bytes), the symmetric
+// Sigma = R S S^T R^T stored as its upper triangle
+struct GaussianCovarianceGPU {
+    glm::vec4 xx_xy_xz_yy;
+    glm::vec4 yz_zz_pad;         // xy = yz, zz; zw = padding
+};
+
+static_assert(sizeof(GaussianCovarianceGPU) == 32, "GaussianCovarianceGPU must be 32 bytes");
+
+// Covariance of a packed instance (rotation need not be normalized)
+inline GaussianCovarianceGPU pack_covariance(const GaussianInstanceGPU& inst) {
+    const glm::quat q = glm::normalize(glm::quat(inst.quat.w, inst.quat.x, inst.quat.y, inst.quat.z));
+    // M = R S; Sigma = M M^T
+    glm::mat3 m = glm::mat3_cast(q);
+    m[0] *= inst.scale_colorx.x;
+    m[1] *= inst.scale_colorx.y;
+    m[2] *= inst.scale_colorx.z;
+    const glm::mat3 sigma = m * glm::transpose(m);
+
+    GaussianCovarianceGPU cov;
+    cov.xx_xy_xz_yy = glm::vec4(sigma[0][0], sigma[1][0], sigma[2][0], sigma[1][1]);
+    cov.yz_zz_pad = glm::vec4(sigma[2][1], sigma[2][2], 0.f, 0.f);
+    return cov;
+}
+
+// Instance record layouts the renderer and binary scenes can use
+enum class InstanceFormat : uint32_t {
+    Full,      // GaussianInstanceGPU: 64 bytes, float32 throughout
+    Compact    // GaussianInstanceCompact: 32 bytes, quantized
+};
+
+const char* instance_format_name(InstanceFormat format);
+
+// Quantized GPU instance data (32 bytes). The position stays float32, so
+// scenes keep full precision far from the origin; scale is half-float,
+// rotation smallest-three 10:10:10:2, color and opacity 8-bit unorm.
+struct GaussianInstanceCompact {
+    glm::vec3 mean;
+    uint32_t scale_xy;           // half x | half y << 16
+    uint32_t scale_z;            // half z in the low 16 bits
+    uint32_t rotation;           // three smallest of xyzw as 10-bit snorm / sqrt(2), index of the largest in bits 30-31
+    uint32_t color_opacity;      // RGBA8 unorm, a = opacity
+    uint32_t reserved;           // 0
+};
+
+static_assert(sizeof(GaussianInstanceCompact) == 32, "GaussianInstanceCompact must be 32 bytes");
+
+// Bytes per record of `format`
+inline size_t instance_stride(InstanceFormat format) {
+    return format == InstanceFormat::Compact ? sizeof(GaussianInstanceCompact) : sizeof(GaussianInstanceGPU);
+}
+
+// Quantize a gaussian into the compact layout; color and opacity are
+// clamped to [0, 1]
+GaussianInstanceCompact pack_gaussian_compact(const Gaussian3D& g);
+
+// Inverse of pack_gaussian_compact, up to quantization
+Gaussian3D unpack_gaussian(const GaussianInstanceCompact& inst);
+
+// Storage precision of spherical-harmonics coefficients
+enum class ShPrecision : uint32_t {
+    Float,
+    Half
+};
+
+const char* sh_precision_name(ShPrecision precision);
+
+constexpr int kMaxShDegree = 3;
+
+// RGB coefficients per gaussian for SH bands 1..degree (the DC band is the
+// base color): 3, 8 or 15 for degrees 1-3
+inline size_t sh_coefficient_count(int degree) {
+    return (size_t)((degree + 1) * (degree + 1) - 1);
+}
+
+// 32-bit words per gaussian of SH storage, padded to 16 bytes so each
+// gaussian's coefficients are whole uvec4 rows on the GPU
+inline size_t sh_word_count(int degree, ShPrecision precision) {
+    const size_t values = 3 * sh_coefficient_count(degree);
+    const size_t words = precision == ShPrecision::Half ? (values + 1) / 2 : values;
+    return (words + 3) / 4 * 4;
+}
+
+// Half-open range [begin, end) of gaussian indices modified since the last upload
+struct DirtyRange {
+    size_t begin = 0;
+    size_t end = 0;
+
+    bool empty() const { return begin >= end; }
+    size_t count() const { return empty() ? 0 : end - begin; }
+};
+
 // GPU point structure for simple rendering
 struct GPUPoint {
     float x, y, z;
     float r, g, b;
 };
 
-// Scene container
+class Scene;
+class LodHierarchy;
+class SpatialIndex;
+class ThreadPool;
+
+/**
+ * Read-only view of a Scene as Gaussian3D values, for code written against
+ * the original array-of-structs storage. Elements are assembled on access,
+ * so hot loops should read the Scene's field arrays instead.
+ */
+class GaussianView {
+public:
+    // Elements are returned by value, so for the legacy categories this is
+    // only an input iterator; C++20 algorithms get random access
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+        using value_type = Gaussian3D;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Gaussian3D;
+
+        iterator() = default;
+        iterator(const Scene* scene, size_t index) : m_scene(scene), m_index(index) {}
+
+        Gaussian3D operator*() const;
+        Gaussian3D operator[](difference_type n) const { return *(*this + n); }
+        iterator& operator++() { ++m_index; return *this; }
+        iterator operator++(int) { iterator t = *this; ++m_index; return t; }
+        iterator& operator--() { --m_index; return *this; }
+        iterator operator--(int) { iterator t = *this; --m_index; return t; }
+        iterator& operator+=(difference_type n) { m_index += n; return *this; }
+        iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(m_scene, m_index + n); }
+        iterator operator-(difference_type n) const { return iterator(m_scene, m_index - n); }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+        difference_type operator-(const iterator& o) const { return (difference_type)m_index - (difference_type)o.m_index; }
+        bool operator==(const iterator& o) const { return m_index == o.m_index; }
+        bool operator!=(const iterator& o) const { return m_index != o.m_index; }
+        bool operator<(const iterator& o) const { return m_index < o.m_index; }
+        bool operator>(const iterator& o) const { return m_index > o.m_index; }
+        bool operator<=(const iterator& o) const { return m_index <= o.m_index; }
+        bool operator>=(const iterator& o) const { return m_index >= o.m_index; }
+
+    private:
+        const Scene* m_scene = nullptr;
+        size_t m_index = 0;
+    };
+
+    explicit GaussianView(const Scene& scene) : m_scene(&scene) {}
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    Gaussian3D operator[](size_t index) const;
+    iterator begin() const { return iterator(m_scene, 0); }
+    iterator end() const { return iterator(m_scene, size()); }
+
+private:
+    const Scene* m_scene;
+};
+
+// Scene container.
+// Gaussians are stored as a structure of arrays, one contiguous array per
+// field, so passes that only need positions (culling, depth keys, LOD)
+// stream just those bytes.
 class Scene {
 public:
     Scene() = default;
     ~Scene() = default;
 
-    const std::vector<Gaussian3D>& get_gaussians() const { return m_gaussians; }
-    std::vector<Gaussian3D>& get_gaussians_mut() { return m_gaussians; }
-    
-    size_t gaussian_count() const { return m_gaussians.size(); }
-    
-    void set_gaussians(const std::vector<Gaussian3D>& gaussians) {
-        m_gaussians = gaussians;
+    /**
+     * Compatibility view yielding Gaussian3D by value.
+     */
+    GaussianView get_gaussians() const { return GaussianView(*this); }
+
+    Gaussian3D gaussian(size_t index) const {
+        Gaussian3D g;
+        g.mean = m_means[index];
+        g.scale = m_scales[index];
+        g.rotation = m_rotations[index];
+        g.opacity = m_opacities[index];
+        g.color = m_colors[index];
+        return g;
+    }
+
+    size_t gaussian_count() const { return m_means.size(); }
+
+    // Field arrays, all gaussian_count() long
+    const std::vector<glm::vec3>& means() const { return m_means; }
+    const std::vector<glm::vec3>& scales() const { return m_scales; }
+    const std::vector<glm::quat>& rotations() const { return m_rotations; }
+    const std::vector<float>& opacities() const { return m_opacities; }
+    const std::vector<glm::vec3>& colors() const { return m_colors; }
+
+    /**
+     * Mutable field access. Callers must keep the array lengths unchanged
+     * and report the indices they touch via mark_dirty().
+     */
+    std::vector<glm::vec3>& means_mut() { return m_means; }
+    std::vector<glm::vec3>& scales_mut() { return m_scales; }
+    std::vector<glm::quat>& rotations_mut() { return m_rotations; }
+    std::vector<float>& opacities_mut() { return m_opacities; }
+    std::vector<glm::vec3>& colors_mut() { return m_colors; }
+
+    void set_gaussians(const std::vector<Gaussian3D>& gaussians);
+
+    void set_gaussian(size_t index, const Gaussian3D& gaussian) {
+        m_means[index] = gaussian.mean;
+        m_scales[index] = gaussian.scale;
+        m_rotations[index] = gaussian.rotation;
+        m_opacities[index] = gaussian.opacity;
+        m_colors[index] = gaussian.color;
+        mark_dirty(index, 1);
     }
 
     void add_gaussian(const Gaussian3D& gaussian) {
-        m_gaussians.push_back(gaussian);
+        m_means.push_back(gaussian.mean);
+        m_scales.push_back(gaussian.scale);
+        m_rotations.push_back(gaussian.rotation);
+        m_opacities.push_back(gaussian.opacity);
+        m_colors.push_back(gaussian.color);
+        m_sh.resize(m_sh.size() + sh_words(), 0u);
+        append_ids(1);
+        mark_dirty(m_means.size() - 1, 1);
+    }
+
+    void reserve(size_t count);
+
+    /**
+     * Resize storage; new entries are copies of fill and marked dirty.
+     */
+    void resize(size_t count, const Gaussian3D& fill);
+
+    /**
+     * Overwrite [first, first + src.gaussian_count()) with the gaussians of
+     * src. The range must already exist. Pass mark_dirty_range = false when
+     * the GPU copy is updated some other way. If src has a higher SH degree,
+     * this scene's SH layout is raised to it first.
+     */
+    void write_range(size_t first, const Scene& src, bool mark_dirty_range = true);
+
+    /**
+     * Overwrite [first, first + count) by unpacking GPU instance records.
+     * The range must already exist. Without mark_dirty_range nothing else
+     * is touched, not even the revision, so disjoint ranges can be written
+     * from several threads; call mark_all_dirty() once they are done.
+     */
+    void write_packed(size_t first, const GaussianInstanceGPU* src, size_t count, bool mark_dirty_range = true);
+    void write_packed(size_t first, const GaussianInstanceCompact* src, size_t count, bool mark_dirty_range = true);
+
+    /**
+     * Pack [first, first + count) into GPU instance layout.
+     */
+    void pack_range(size_t first, size_t count, GaussianInstanceGPU* out) const;
+    void pack_range(size_t first, size_t count, GaussianInstanceCompact* out) const;
+
+    /**
+     * Record layout the scene is drawn (and saved) with; Full by default.
+     * Changing it marks every gaussian dirty, so the GPU copy is repacked,
+     * but leaves the revision (and so the spatial index and LOD) alone.
+     */
+    InstanceFormat instance_format() const { return m_instance_format; }
+    void set_instance_format(InstanceFormat format) {
+        if (format != m_instance_format) {
+            m_instance_format = format;
+            m_dirty = DirtyRange{0, m_means.size()};
+        }
+    }
+
+    /**
+     * Spherical-harmonics color, 3DGS convention: the base color is the DC
+     * band already converted to RGB, and bands 1..sh_degree() add the view
+     * dependent part. Coefficients live apart from the instance fields,
+     * sh_words() 32-bit words per gaussian in coefficient order with RGB
+     * interleaved, as float32 or half. Degree 0 (the default) stores
+     * nothing.
+     */
+    int sh_degree() const { return m_sh_degree; }
+    ShPrecision sh_precision() const { return m_sh_precision; }
+    size_t sh_words() const { return sh_word_count(m_sh_degree, m_sh_precision); }
+    const std::vector<uint32_t>& sh_data() const { return m_sh; }
+
+    /**
+     * Change the SH layout, converting the stored coefficients: bands above
+     * a lowered degree are dropped, added bands are zero. Like
+     * set_instance_format(), marks every gaussian dirty if anything changed
+     * without bumping the revision.
+     */
+    void set_sh_layout(int degree, ShPrecision precision);
+    void set_sh_precision(ShPrecision precision) { set_sh_layout(m_sh_degree, precision); }
+
+    /**
+     * Set gaussian `index`'s coefficients from `count` RGB values, band 1
+     * first. Values past the stored degree are ignored; missing ones are
+     * zero.
+     */
+    void set_sh(size_t index, const glm::vec3* coefficients, size_t count);
+
+    /**
+     * set_sh() without marking dirty, so decoders can fill distinct
+     * gaussians from several threads and report the range once.
+     */
+    void write_sh(size_t index, const glm::vec3* coefficients, size_t count);
+
+    /**
+     * Read gaussian `index`'s sh_coefficient_count(sh_degree()) coefficients.
+     */
+    void get_sh(size_t index, glm::vec3* out) const;
+
+    /**
+     * Pack the SH of [first, first + count) truncated to `degree` (at most
+     * sh_degree()), in the stored precision:
+     * sh_word_count(degree, sh_precision()) words per gaussian.
+     */
+    void pack_sh_range(size_t first, size_t count, int degree, uint32_t* out) const;
+
+    /**
+     * Overwrite the SH of [first, first + count) with records already in
+     * the stored layout (e.g. from a binary scene). Does not mark dirty.
+     */
+    void write_sh_records(size_t first, const uint32_t* records, size_t count) {
+        std::copy(records, records + count * sh_words(), m_sh.begin() + first * sh_words());
+    }
+
+    /**
+     * Remove every gaussian, starting IDs over.
+     */
+    void clear();
+
+    static constexpr uint32_t kNoSlot = 0xFFFFFFFFu;
+
+    /**
+     * Stable ID of the gaussian in `slot`. Each gaussian gets the next ID
+     * when it is added and keeps it when compact() moves it to another
+     * slot, so mappers can refer to gaussians across compactions; removed
+     * IDs are not handed out again. Until the first compaction IDs equal
+     * slots and no table is stored. set_gaussians() and clear() start over.
+     */
+    uint32_t id_of(size_t slot) const { return m_slots.empty() ? (uint32_t)slot : m_ids[slot]; }
+
+    /**
+     * Slot of the gaussian with `id`, or kNoSlot if compact() removed it or
+     * the ID was not handed out yet.
+     */
+    uint32_t slot_of(uint32_t id) const {
+        if (m_slots.empty()) {
+            return id < m_means.size() ? id : kNoSlot;
+        }
+        return id < m_slots.size() ? m_slots[id] : kNoSlot;
+    }
+
+    /**
+     * IDs handed out so far; the next gaussian added gets this one.
+     */
+    size_t id_count() const { return m_slots.empty() ? m_means.size() : m_slots.size(); }
+
+    /**
+     * Remove the gaussians flagged in `remove` (gaussian_count() long) and
+     * move the rest down, in order, in place: storage is shrunk but not
+     * reallocated. The moved range is marked dirty, so the GPU copy is
+     * updated from the first removed slot on. Returns the number removed.
+     */
+    size_t compact(const std::vector<uint8_t>& remove);
+
+    /**
+     * Extend the dirty range to cover [first, first + count).
+     */
+    void mark_dirty(size_t first, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        ++m_revision;
+        const size_t last = std::min(first + count, m_means.size());
+        if (m_dirty.empty()) {
+            m_dirty = DirtyRange{first, last};
+        } else {
+            m_dirty.begin = std::min(m_dirty.begin, first);
+            m_dirty.end = std::max(m_dirty.end, last);
+        }
+    }
+
+    void mark_all_dirty() {
+        ++m_revision;
+        m_dirty = DirtyRange{0, m_means.size()};
+    }
+
+    /**
+     * Record a modification made through the *_mut() arrays without
+     * extending the dirty range, for edits whose GPU copy is updated some
+     * other way (e.g. Renderer::upload_instance_ranges()).
+     */
+    void bump_revision() { ++m_revision; }
+
+    /**
+     * Range of gaussians modified since the last clear_dirty().
+     */
+    const DirtyRange& dirty_range() const { return m_dirty; }
+
+    void clear_dirty() { m_dirty = DirtyRange{}; }
+
+    /**
+     * Counter bumped by every modification, including ones that leave the
+     * dirty range alone; lets derived data (e.g. the spatial index) detect
+     * that it is stale.
+     */
+    uint64_t revision() const { return m_revision; }
+
+    /**
+     * Counter bumped when gaussians change slots or go away (compact(),
+     * shrinking, set_gaussians(), clear()), but not by edits in place or
+     * appends; data kept per slot, like an index under construction,
+     * still lines up while it is unchanged.
+     */
+    uint64_t layout_revision() const { return m_layout_revision; }
+
+    /**
+     * Build a spatial index over the current gaussians, replacing any
+     * previous one. Call once loading finishes; edits make it stale unless
+     * followed by refit_spatial_index().
+     */
+    void build_spatial_index(ThreadPool* pool = nullptr);
+
+    /**
+     * Make `index` current again after edits: refit (SpatialIndex::refit())
+     * to the gaussians in `changed`, all of them if null, and carry `lod`
+     * over when it was built on `index`. `index` must be this scene's, from
+     * before the edits, in the same slot layout; gaussians appended since
+     * stay outside it. Nothing is copied when `changed` is empty.
+     *
+     * @param pool Optional pool for the refit
+     */
+    void refit_spatial_index(std::shared_ptr<const SpatialIndex> index, std::shared_ptr<const LodHierarchy> lod,
+                             const std::vector<uint32_t>* changed, ThreadPool* pool = nullptr);
+
+    /**
+     * The spatial index, or nullptr if none was built or the scene has
+     * been modified since. It covers the first size() gaussians; any past
+     * those were added after it was built.
+     */
+    const SpatialIndex* spatial_index() const {
+        return (m_spatial_index && m_spatial_revision == m_revision) ? m_spatial_index.get() : nullptr;
     }
 
-    void clear() {
-        m_gaussians.clear();
+    /**
+     * Shared handle to the index (null when spatial_index() is), for
+     * holders that must keep it alive across scene edits.
+     */
+    std::shared_ptr<const SpatialIndex> spatial_index_shared() const {
+        return spatial_index() ? m_spatial_index : nullptr;
+    }
+
+    /**
+     * Build the level-of-detail hierarchy over the spatial index, building
+     * the index first if it is missing or stale. Edits make it stale.
+     */
+    void build_lod_hierarchy(ThreadPool* pool = nullptr);
+
+    /**
+     * The LOD hierarchy, or nullptr if none was built or the scene has been
+     * modified since.
+     */
+    const LodHierarchy* lod_hierarchy() const {
+        return (m_lod && m_lod_revision == m_revision) ? m_lod.get() : nullptr;
+    }
+
+    std::shared_ptr<const LodHierarchy> lod_hierarchy_shared() const {
+        return lod_hierarchy() ? m_lod : nullptr;
     }
 
 private:
-    std::vector<Gaussian3D> m_gaussians;
+    friend class SceneUpdateQueue;
+
+    std::vector<glm::vec3> m_means;
+    std::vector<glm::vec3> m_scales;
+    std::vector<glm::quat> m_rotations;
+    std::vector<float> m_opacities;
+    std::vector<glm::vec3> m_colors;
+    DirtyRange m_dirty;
+    uint64_t m_revision = 0;
+    uint64_t m_layout_revision = 0;
+    InstanceFormat m_instance_format = InstanceFormat::Full;
+    std::vector<uint32_t> m_sh;   // gaussian_count() * sh_words()
+    int m_sh_degree = 0;
+    ShPrecision m_sh_precision = ShPrecision::Float;
+
+    std::vector<uint32_t> m_ids;     // slot -> ID; both tables empty while IDs equal slots
+    std::vector<uint32_t> m_slots;   // ID -> slot, kNoSlot once removed
+
+    std::shared_ptr<const SpatialIndex> m_spatial_index;
+    uint64_t m_spatial_revision = 0;
+
+    std::shared_ptr<const LodHierarchy> m_lod;
+    uint64_t m_lod_revision = 0;
+
+    // Append `gaussian` under `id`, which compact() removed (e.g. a mapper
+    // edits a gaussian compaction pruned meanwhile); returns its new slot.
+    // Only SceneUpdateQueue, which checks slot_of(id) == kNoSlot first,
+    // calls this.
+    uint32_t revive(uint32_t id, const Gaussian3D& gaussian);
+
+    // Give the last `count` slots the next IDs, once IDs have left the slots
+    void append_ids(size_t count) {
+        if (m_slots.empty()) {
+            return;
+        }
+        for (size_t slot = m_means.size() - count; slot < m_means.size(); ++slot) {
+            m_ids.push_back((uint32_t)m_slots.size());
+            m_slots.push_back((uint32_t)slot);
+        }
+    }
 };
 
+inline size_t GaussianView::size() const { return m_scene->gaussian_count(); }
+inline Gaussian3D GaussianView::operator[](size_t index) const { return m_scene->gaussian(index); }
+inline Gaussian3D GaussianView::iterator::operator*() const { return m_scene->gaussian(m_index); }
+
 }  // namespace sss
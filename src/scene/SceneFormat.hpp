@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include "Scene.hpp"
+
+namespace sss {
+
+// Binary scene file (.sss), little-endian:
+//
+//   [SceneFileHeader][zero padding to payload_offset][count x record]
+//   [zero padding to a kSceneFilePayloadAlign multiple][count x SH record]
+//
+// Records are GaussianInstanceGPU, or GaussianInstanceCompact when
+// kSceneFileCompact is set, so the payload can be handed to the GPU as-is.
+// payload_offset is a multiple of kSceneFilePayloadAlign. The SH section is
+// present when the flags carry a nonzero SH degree; its records are the
+// Scene's SH storage, sh_word_count() words each.
+
+constexpr char kSceneFileMagic[4] = {'S', 'S', 'S', '\0'};
+constexpr uint32_t kSceneFileVersion = 1;
+constexpr uint64_t kSceneFilePayloadAlign = 64;
+
+// SceneFileHeader::flags
+constexpr uint32_t kSceneFileCompact = 1u << 0;   // records are GaussianInstanceCompact
+constexpr uint32_t kSceneFileShHalf = 1u << 1;    // SH coefficients are half-float
+constexpr uint32_t kSceneFileShDegreeShift = 8;   // SH degree in bits 8-9
+constexpr uint32_t kSceneFileShDegreeMask = 3u << kSceneFileShDegreeShift;
+
+struct SceneFileHeader {
+    char magic[4];              // kSceneFileMagic
+    uint32_t version;           // kSceneFileVersion
+    uint32_t header_size;       // sizeof(SceneFileHeader)
+    uint32_t stride;            // bytes per record
+    uint64_t count;             // number of gaussians
+    uint64_t payload_offset;    // byte offset of the first record
+    uint32_t flags;             // kSceneFile* bits, others 0
+    uint32_t reserved;          // reserved, 0
+};
+
+static_assert(sizeof(SceneFileHeader) == 40, "SceneFileHeader layout is part of the file format");
+
+}  // namespace sss
@@ -1,5 +1,10 @@
 #include "SceneIO.hpp"
+#include "SceneJsonSax.hpp"
+#include "../core/ThreadPool.hpp"
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
 
@@ -7,59 +12,47 @@ namespace sss {
 
 using json = nlohmann::json;
 
-Scene SceneIO::load_scene_json(const std::string& filepath) {
-    std::ifstream in(filepath);
-    if (!in.is_open()) {
-        throw std::runtime_error("Failed to open file: " + filepath);
-    }
-
-    json j;
-    in >> j;
-
-    Scene scene;
-    std::vector<Gaussian3D> gaussians;
-
-    if (!j.contains("gaussians") || !j["gaussians"].is_array()) {
-        throw std::runtime_error("JSON missing 'gaussians' array: " + filepath);
-    }
-
-    for (const auto& item : j["gaussians"]) {
-        if (!item.contains("color")) {
-            throw std::runtime_error("Gaussian missing 'color' field");
-        }
+static_assert(std::endian::native == std::endian::little,
+              "binary scene files are little-endian and read in place");
 
-        Gaussian3D g;
+Scene SceneIO::load_scene(const std::string& filepath) {
+    Scene scene = is_binary_scene(filepath) ? load_scene_binary(filepath)
+                  : is_ply_scene(filepath)  ? load_scene_ply(filepath)
+                                            : load_scene_json(filepath);
+    scene.build_lod_hierarchy(&ThreadPool::shared());
+    return scene;
+}
 
-        // Default values for all fields
-        g.mean = glm::vec3(0.0f, 0.0f, 0.0f);
-        g.scale = glm::vec3(1.0f, 1.0f, 1.0f);
-        g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-        g.opacity = 1.0f;
-        g.color = glm::vec3(item["color"][0], item["color"][1], item["color"][2]);
+bool SceneIO::is_binary_scene(const std::string& filepath) {
+    const std::string ext = ".sss";
+    return filepath.size() >= ext.size() &&
+           filepath.compare(filepath.size() - ext.size(), ext.size(), ext) == 0;
+}
 
-        // Parse optional fields if present
-        if (item.contains("mean") && item["mean"].is_array() && item["mean"].size() >= 3) {
-            g.mean = glm::vec3(item["mean"][0], item["mean"][1], item["mean"][2]);
-        } else if (item.contains("position") && item["position"].is_array() && item["position"].size() >= 3) {
-            g.mean = glm::vec3(item["position"][0], item["position"][1], item["position"][2]);
-        }
+bool SceneIO::is_ply_scene(const std::string& filepath) {
+    const std::string ext = ".ply";
+    return filepath.size() >= ext.size() &&
+           filepath.compare(filepath.size() - ext.size(), ext.size(), ext) == 0;
+}
 
-        if (item.contains("scale") && item["scale"].is_array() && item["scale"].size() >= 3) {
-            g.scale = glm::vec3(item["scale"][0], item["scale"][1], item["scale"][2]);
-        }
+Scene SceneIO::load_scene_json(const std::string& filepath, size_t count_hint) {
+    // Parse straight from the page cache into the scene's field arrays;
+    // no intermediate copy of the data is built
+    MappedFile file(filepath);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
 
-        if (item.contains("rotation") && item["rotation"].is_array() && item["rotation"].size() >= 4) {
-            g.rotation = glm::quat(item["rotation"][0], item["rotation"][1], item["rotation"][2], item["rotation"][3]);
-        }
+    Scene scene;
+    scene.reserve(count_hint);
 
-        if (item.contains("opacity") && item["opacity"].is_number()) {
-            g.opacity = item["opacity"].get<float>();
-        }
+    GaussianJsonSax sax(scene, GaussianJsonSax::Mode::Document);
+    json::sax_parse(begin, end, &sax);
 
-        gaussians.push_back(g);
+    if (!sax.saw_gaussians()) {
+        throw std::runtime_error("JSON missing 'gaussians' array: " + filepath);
     }
 
-    scene.set_gaussians(gaussians);
+    scene.mark_all_dirty();
     return scene;
 }
 
@@ -67,13 +60,26 @@ void SceneIO::save_scene_json(const std::string& filepath, const Scene& scene) {
     json j;
     j["gaussians"] = json::array();
 
-    for (const auto& g : scene.get_gaussians()) {
+    const size_t sh_count = sh_coefficient_count(scene.sh_degree());
+    std::vector<glm::vec3> sh(sh_count);
+    for (size_t i = 0; i < scene.gaussian_count(); ++i) {
+        const Gaussian3D g = scene.gaussian(i);
         json item;
         item["mean"] = {g.mean.x, g.mean.y, g.mean.z};
         item["scale"] = {g.scale.x, g.scale.y, g.scale.z};
         item["rotation"] = {g.rotation.x, g.rotation.y, g.rotation.z, g.rotation.w};
         item["opacity"] = g.opacity;
         item["color"] = {g.color.r, g.color.g, g.color.b};
+        if (sh_count > 0) {
+            scene.get_sh(i, sh.data());
+            json coefficients = json::array();
+            for (const glm::vec3& c : sh) {
+                coefficients.push_back(c.r);
+                coefficients.push_back(c.g);
+                coefficients.push_back(c.b);
+            }
+            item["sh"] = std::move(coefficients);
+        }
         j["gaussians"].push_back(item);
     }
 
@@ -85,4 +91,168 @@ void SceneIO::save_scene_json(const std::string& filepath, const Scene& scene) {
     out << j.dump(2);
 }
 
+namespace {
+
+// Start of the SH section: records end, rounded up to the payload alignment
+uint64_t sh_section_offset(const SceneFileHeader& header) {
+    const uint64_t end = header.payload_offset + header.count * header.stride;
+    return (end + kSceneFilePayloadAlign - 1) / kSceneFilePayloadAlign * kSceneFilePayloadAlign;
+}
+
+template <typename Record>
+void write_records(std::ofstream& out, const Scene& scene, size_t chunk) {
+    const size_t count = scene.gaussian_count();
+    std::vector<Record> records;
+    records.resize(std::min(chunk, count));
+    for (size_t first = 0; first < count; first += chunk) {
+        records.resize(std::min(chunk, count - first));
+        scene.pack_range(first, records.size(), records.data());
+        out.write(reinterpret_cast<const char*>(records.data()), (std::streamsize)(records.size() * sizeof(Record)));
+    }
+}
+
+}  // namespace
+
+MappedScene SceneIO::map_scene_binary(const std::string& filepath) {
+    MappedScene mapped;
+    mapped.file = MappedFile(filepath);
+
+    const size_t size = mapped.file.size();
+    if (size < sizeof(SceneFileHeader)) {
+        throw std::runtime_error("Binary scene too small for header: " + filepath);
+    }
+
+    const auto* header = reinterpret_cast<const SceneFileHeader*>(mapped.file.data());
+    if (std::memcmp(header->magic, kSceneFileMagic, sizeof(kSceneFileMagic)) != 0) {
+        throw std::runtime_error("Not a binary scene file: " + filepath);
+    }
+    if (header->version != kSceneFileVersion) {
+        throw std::runtime_error("Unsupported binary scene version " + std::to_string(header->version) + ": " + filepath);
+    }
+    if ((header->flags & ~(kSceneFileCompact | kSceneFileShHalf | kSceneFileShDegreeMask)) != 0) {
+        throw std::runtime_error("Unsupported binary scene flags: " + filepath);
+    }
+    const InstanceFormat format = (header->flags & kSceneFileCompact) ? InstanceFormat::Compact : InstanceFormat::Full;
+    if (header->header_size < sizeof(SceneFileHeader) || header->stride != instance_stride(format)) {
+        throw std::runtime_error("Binary scene record layout mismatch: " + filepath);
+    }
+    if (header->payload_offset % alignof(GaussianInstanceGPU) != 0 ||
+        header->payload_offset > size ||
+        header->count > (size - header->payload_offset) / header->stride) {
+        throw std::runtime_error("Binary scene payload truncated: " + filepath);
+    }
+
+    // Optional SH section after the records
+    const int sh_degree = (int)((header->flags & kSceneFileShDegreeMask) >> kSceneFileShDegreeShift);
+    const ShPrecision sh_precision = (header->flags & kSceneFileShHalf) ? ShPrecision::Half : ShPrecision::Float;
+    if (sh_degree > 0) {
+        const uint64_t sh_offset = sh_section_offset(*header);
+        const uint64_t sh_record = sh_word_count(sh_degree, sh_precision) * sizeof(uint32_t);
+        if (sh_offset > size || header->count > (size - sh_offset) / sh_record) {
+            throw std::runtime_error("Binary scene SH section truncated: " + filepath);
+        }
+        mapped.sh_degree = sh_degree;
+        mapped.sh_precision = sh_precision;
+        mapped.sh = reinterpret_cast<const uint32_t*>(mapped.file.data() + sh_offset);
+    }
+
+    mapped.header = header;
+    mapped.format = format;
+    const uint8_t* payload = mapped.file.data() + header->payload_offset;
+    if (format == InstanceFormat::Compact) {
+        mapped.compact = reinterpret_cast<const GaussianInstanceCompact*>(payload);
+    } else {
+        mapped.instances = reinterpret_cast<const GaussianInstanceGPU*>(payload);
+    }
+    mapped.count = (size_t)header->count;
+    return mapped;
+}
+
+Scene SceneIO::unpack_scene_binary(const MappedScene& mapped) {
+    Scene scene;
+    scene.resize(mapped.count, Gaussian3D{});
+    scene.set_sh_layout(mapped.sh_degree, mapped.sh_precision);
+
+    ThreadPool::shared().parallel_for(mapped.count, 1 << 16, [&](size_t begin, size_t end) {
+        if (mapped.format == InstanceFormat::Compact) {
+            scene.write_packed(begin, mapped.compact + begin, end - begin, false);
+        } else {
+            scene.write_packed(begin, mapped.instances + begin, end - begin, false);
+        }
+        if (mapped.sh) {
+            scene.write_sh_records(begin, mapped.sh + begin * scene.sh_words(), end - begin);
+        }
+    });
+
+    scene.set_instance_format(mapped.format);
+    scene.mark_all_dirty();
+    return scene;
+}
+
+Scene SceneIO::load_scene_binary(const std::string& filepath) {
+    return unpack_scene_binary(map_scene_binary(filepath));
+}
+
+void SceneIO::save_scene_binary(const std::string& filepath, const Scene& scene) {
+    std::ofstream out(filepath, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filepath);
+    }
+
+    const size_t count = scene.gaussian_count();
+    const InstanceFormat format = scene.instance_format();
+
+    SceneFileHeader header{};
+    std::memcpy(header.magic, kSceneFileMagic, sizeof(header.magic));
+    header.version = kSceneFileVersion;
+    header.header_size = sizeof(SceneFileHeader);
+    header.stride = (uint32_t)instance_stride(format);
+    header.count = count;
+    header.payload_offset = (sizeof(SceneFileHeader) + kSceneFilePayloadAlign - 1) / kSceneFilePayloadAlign * kSceneFilePayloadAlign;
+    header.flags = format == InstanceFormat::Compact ? kSceneFileCompact : 0;
+    if (scene.sh_degree() > 0) {
+        header.flags |= (uint32_t)scene.sh_degree() << kSceneFileShDegreeShift;
+        header.flags |= scene.sh_precision() == ShPrecision::Half ? kSceneFileShHalf : 0u;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const char padding[kSceneFilePayloadAlign] = {};
+    out.write(padding, (std::streamsize)(header.payload_offset - sizeof(header)));
+
+    // Pack in bounded chunks so saving never holds a second full copy
+    constexpr size_t kChunk = 1 << 14;
+    if (format == InstanceFormat::Compact) {
+        write_records<GaussianInstanceCompact>(out, scene, kChunk);
+    } else {
+        write_records<GaussianInstanceGPU>(out, scene, kChunk);
+    }
+
+    if (scene.sh_degree() > 0) {
+        const uint64_t records_end = header.payload_offset + header.count * header.stride;
+        out.write(padding, (std::streamsize)(sh_section_offset(header) - records_end));
+        out.write(reinterpret_cast<const char*>(scene.sh_data().data()),
+                  (std::streamsize)(scene.sh_data().size() * sizeof(uint32_t)));
+    }
+
+    if (!out) {
+        throw std::runtime_error("Failed to write binary scene: " + filepath);
+    }
+}
+
+Scene SceneIO::load_scene_ply(const std::string& filepath) {
+    MappedFile file(filepath);
+    const PlyLayout layout = parse_ply_header(file.data(), file.size());
+
+    Scene scene;
+    scene.resize(layout.count, Gaussian3D{});
+    scene.set_sh_layout(layout.sh_degree, ShPrecision::Float);
+
+    ThreadPool::shared().parallel_for(layout.count, 1 << 14, [&](size_t begin, size_t end) {
+        decode_ply_vertices(layout, file.data(), begin, end - begin, scene, begin);
+    });
+
+    scene.mark_all_dirty();
+    return scene;
+}
+
 }  // namespace sss
@@ -1,22 +1,94 @@
 #pragma once
 
 #include "Scene.hpp"
+#include "PlyFormat.hpp"
+#include "SceneFormat.hpp"
+#include "../core/MappedFile.hpp"
 #include <string>
 
 namespace sss {
 
+/**
+ * A validated, memory-mapped binary scene. The instance records point
+ * straight into the mapping and stay valid while this object lives; only
+ * the pointer matching `format` is set.
+ */
+struct MappedScene {
+    MappedFile file;
+    const SceneFileHeader* header = nullptr;
+    InstanceFormat format = InstanceFormat::Full;
+    const GaussianInstanceGPU* instances = nullptr;
+    const GaussianInstanceCompact* compact = nullptr;
+    size_t count = 0;
+    int sh_degree = 0;                        // SH section, if sh_degree > 0
+    ShPrecision sh_precision = ShPrecision::Float;
+    const uint32_t* sh = nullptr;             // count * sh_word_count(sh_degree, sh_precision) words
+};
+
 class SceneIO {
 public:
+    /**
+     * Load a scene, choosing the format from the file extension
+     * (.sss binary, .ply, otherwise JSON), and build its spatial index and LOD
+     * hierarchy.
+     */
+    static Scene load_scene(const std::string& filepath);
+
+    /**
+     * True if the path names a binary (.sss) scene.
+     */
+    static bool is_binary_scene(const std::string& filepath);
+
+    /**
+     * True if the path names a PLY (.ply) scene.
+     */
+    static bool is_ply_scene(const std::string& filepath);
+
     /**
      * Load a scene from a JSON file.
      * Expected format: { "gaussians": [ { "color": [r,g,b], "mean"?: [x,y,z], ... } ] }
+     *
+     * The file is streamed through a SAX parser into Scene storage, so no
+     * DOM is built. Storage is reserved from count_hint, or from a top-level
+     * "count" field when the file has one.
      */
-    static Scene load_scene_json(const std::string& filepath);
+    static Scene load_scene_json(const std::string& filepath, size_t count_hint = 0);
 
     /**
      * Save a scene to a JSON file.
      */
     static void save_scene_json(const std::string& filepath, const Scene& scene);
+
+    /**
+     * Map a binary scene file and validate its header.
+     * Throws std::runtime_error on a malformed or truncated file.
+     */
+    static MappedScene map_scene_binary(const std::string& filepath);
+
+    /**
+     * Decode a mapped binary scene into Scene storage, adopting the file's
+     * instance format.
+     * Records are fixed-size, so this is a parallel copy with no parsing.
+     */
+    static Scene unpack_scene_binary(const MappedScene& mapped);
+
+    /**
+     * Load a binary scene file.
+     */
+    static Scene load_scene_binary(const std::string& filepath);
+
+    /**
+     * Save a scene to a binary scene file, in the scene's instance format.
+     */
+    static void save_scene_binary(const std::string& filepath, const Scene& scene);
+
+    /**
+     * Load a binary little-endian PLY file of 3DGS training output (see
+     * PlyFormat.hpp). The file is mapped and its vertices decoded in
+     * parallel straight into Scene storage; f_rest properties set the SH
+     * degree.
+     */
+    static Scene load_scene_ply(const std::string& filepath);
 };
 
 }  // namespace sss
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "Scene.hpp"
+
+namespace sss {
+
+/**
+ * nlohmann SAX handler that decodes gaussian3d_v1 objects straight into
+ * Scene storage, without building a DOM.
+ *
+ * In document mode it expects { "gaussians": [ {...}, ... ] } (plus an
+ * optional top-level "count" used as a reserve hint). In object mode each
+ * parse call must cover exactly one gaussian object, which lets callers
+ * parse pre-split slices of a file independently.
+ *
+ * Field handling matches the original DOM loader: "color" is required,
+ * "mean" wins over "position", missing fields take defaults. An optional
+ * "sh" array holds the higher SH bands as flat [r, g, b, r, g, b, ...]
+ * coefficients (9, 24 or 45 numbers); the scene's SH degree is raised to
+ * fit the longest one seen.
+ */
+class GaussianJsonSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+    enum class Mode { Document, Object };
+
+    GaussianJsonSax(Scene& out, Mode mode)
+        : m_out(out),
+          m_object_depth(mode == Mode::Document ? 3 : 1),
+          m_mode(mode) {
+    }
+
+    /**
+     * True once a top-level "gaussians" array was seen (document mode).
+     */
+    bool saw_gaussians() const { return m_saw_gaussians; }
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t v) override { return number((double)v); }
+    bool number_unsigned(number_unsigned_t v) override { return number((double)v); }
+    bool number_float(number_float_t v, const string_t&) override { return number((double)v); }
+    bool string(string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override {
+        ++m_depth;
+        if (m_depth == m_object_depth && in_gaussian_list()) {
+            begin_gaussian();
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (m_depth == m_object_depth && m_in_gaussian) {
+            end_gaussian();
+        }
+        --m_depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++m_depth;
+        if (m_mode == Mode::Document && m_depth == 2 && m_root_key == "gaussians") {
+            m_in_list = true;
+            m_saw_gaussians = true;
+        } else if (m_in_gaussian && m_depth == m_object_depth + 1) {
+            m_component = 0;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (m_in_gaussian && m_depth == m_object_depth + 1) {
+            field_state().components = m_component;
+        } else if (m_mode == Mode::Document && m_depth == 2) {
+            m_in_list = false;
+        }
+        --m_depth;
+        return true;
+    }
+
+    bool key(string_t& k) override {
+        if (m_mode == Mode::Document && m_depth == 1) {
+            m_root_key = k;
+        } else if (m_in_gaussian && m_depth == m_object_depth) {
+            m_field = field_from_key(k);
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override {
+        throw std::runtime_error("JSON parse error at byte " + std::to_string(position) + ": " + ex.what());
+    }
+
+private:
+    enum Field { Mean, Position, Scale, Rotation, Color, Opacity, Sh, FieldCount, Other = FieldCount };
+    static constexpr int kMaxShValues = 45;
+
+    struct FieldState {
+        float v[4];
+        int components;   // numbers seen in the field's array
+    };
+
+    Scene& m_out;
+    const int m_object_depth;
+    const Mode m_mode;
+
+    int m_depth = 0;
+    std::string m_root_key;
+    bool m_in_list = false;
+    bool m_saw_gaussians = false;
+
+    bool m_in_gaussian = false;
+    Field m_field = Other;
+    int m_component = 0;
+    FieldState m_fields[FieldCount];
+    bool m_have_opacity = false;
+    float m_opacity = 1.f;
+    float m_sh[kMaxShValues];   // values of the Sh field
+    FieldState m_discard;
+
+    static Field field_from_key(const std::string& k) {
+        if (k == "mean") return Mean;
+        if (k == "position") return Position;
+        if (k == "scale") return Scale;
+        if (k == "rotation") return Rotation;
+        if (k == "color") return Color;
+        if (k == "opacity") return Opacity;
+        if (k == "sh") return Sh;
+        return Other;
+    }
+
+    bool in_gaussian_list() const {
+        return m_mode == Mode::Object || m_in_list;
+    }
+
+    FieldState& field_state() {
+        return (m_field < FieldCount) ? m_fields[m_field] : m_discard;
+    }
+
+    bool number(double v) {
+        if (m_mode == Mode::Document && m_depth == 1 && m_root_key == "count") {
+            if (v > 0) {
+                m_out.reserve(m_out.gaussian_count() + (size_t)v);
+            }
+        } else if (m_in_gaussian && m_depth == m_object_depth + 1) {
+            if (m_field == Sh) {
+                if (m_component < kMaxShValues) {
+                    m_sh[m_component] = (float)v;
+                }
+            } else if (m_component < 4) {
+                field_state().v[m_component] = (float)v;
+            }
+            ++m_component;
+        } else if (m_in_gaussian && m_depth == m_object_depth && m_field == Opacity) {
+            m_opacity = (float)v;
+            m_have_opacity = true;
+        }
+        return true;
+    }
+
+    void begin_gaussian() {
+        m_in_gaussian = true;
+        m_field = Other;
+        for (FieldState& f : m_fields) {
+            f.components = 0;
+        }
+        m_have_opacity = false;
+        m_opacity = 1.f;
+    }
+
+    void end_gaussian() {
+        m_in_gaussian = false;
+
+        const FieldState& color = m_fields[Color];
+        if (color.components == 0) {
+            throw std::runtime_error("Gaussian missing 'color' field");
+        }
+        if (color.components < 3) {
+            throw std::runtime_error("Gaussian 'color' needs 3 components");
+        }
+
+        Gaussian3D g;
+        g.mean = glm::vec3(0.0f, 0.0f, 0.0f);
+        g.scale = glm::vec3(1.0f, 1.0f, 1.0f);
+        g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        g.opacity = m_have_opacity ? m_opacity : 1.0f;
+        g.color = glm::vec3(color.v[0], color.v[1], color.v[2]);
+
+        const FieldState& mean = m_fields[Mean];
+        const FieldState& position = m_fields[Position];
+        if (mean.components >= 3) {
+            g.mean = glm::vec3(mean.v[0], mean.v[1], mean.v[2]);
+        } else if (position.components >= 3) {
+            g.mean = glm::vec3(position.v[0], position.v[1], position.v[2]);
+        }
+
+        const FieldState& scale = m_fields[Scale];
+        if (scale.components >= 3) {
+            g.scale = glm::vec3(scale.v[0], scale.v[1], scale.v[2]);
+        }
+
+        // Stored as [x, y, z, w]; glm::quat takes (w, x, y, z)
+        const FieldState& rotation = m_fields[Rotation];
+        if (rotation.components >= 4) {
+            g.rotation = glm::quat(rotation.v[3], rotation.v[0], rotation.v[1], rotation.v[2]);
+        }
+
+        m_out.add_gaussian(g);
+
+        const FieldState& sh = m_fields[Sh];
+        if (sh.components >= 3) {
+            const size_t count = (size_t)std::min(sh.components, kMaxShValues) / 3;
+            int degree = 1;
+            while (sh_coefficient_count(degree) < count) {
+                ++degree;
+            }
+            if (degree > m_out.sh_degree()) {
+                m_out.set_sh_layout(degree, m_out.sh_precision());
+            }
+            glm::vec3 coefficients[kMaxShValues / 3];
+            for (size_t k = 0; k < count; ++k) {
+                coefficients[k] = glm::vec3(m_sh[3 * k], m_sh[3 * k + 1], m_sh[3 * k + 2]);
+            }
+            m_out.set_sh(m_out.gaussian_count() - 1, coefficients, count);
+        }
+    }
+};
+
+}  // namespace sss
@@ -0,0 +1,431 @@
+#include "SceneLoader.hpp"
+#include "SceneJsonSax.hpp"
+#include "../core/ThreadPool.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace sss {
+
+namespace {
+
+// Gaussians per chunk: small enough that the first chunk lands within a
+// frame or two, large enough to amortize task and upload overhead
+constexpr size_t kChunkGaussians = 1 << 15;
+
+// Placeholder for indices whose chunk has not arrived; zero opacity and
+// zero extent, so it never covers a pixel
+Gaussian3D placeholder_gaussian() {
+    Gaussian3D g;
+    g.mean = glm::vec3(0.0f);
+    g.scale = glm::vec3(0.0f);
+    g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    g.opacity = 0.0f;
+    g.color = glm::vec3(0.0f);
+    return g;
+}
+
+// Structural JSON scanning: just enough to find object boundaries, without
+// decoding values. Strings are skipped so braces inside them don't count.
+
+// p points at an opening quote; returns the closing quote, or nullptr
+const char* skip_string(const char* p, const char* end) {
+    for (++p; p < end; ++p) {
+        if (*p == '\\') {
+            ++p;
+        } else if (*p == '"') {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+// p points at '{' or '['; returns one past the matching bracket, or nullptr
+const char* find_value_end(const char* p, const char* end) {
+    int depth = 0;
+    for (; p < end; ++p) {
+        const char c = *p;
+        if (c == '"') {
+            p = skip_string(p, end);
+            if (!p) {
+                return nullptr;
+            }
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return p + 1;
+            }
+        }
+    }
+    return nullptr;
+}
+
+const char* skip_separators(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == ',')) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns one past the '[' of the top-level "gaussians" array, or nullptr
+const char* find_gaussian_array(const char* begin, const char* end) {
+    static constexpr char kKey[] = "gaussians";
+    const char* key = nullptr;
+    size_t key_len = 0;
+    int depth = 0;
+
+    for (const char* p = begin; p < end; ++p) {
+        const char c = *p;
+        if (c == '"') {
+            const char* close = skip_string(p, end);
+            if (!close) {
+                return nullptr;
+            }
+            if (depth == 1) {
+                key = p + 1;
+                key_len = (size_t)(close - key);
+            }
+            p = close;
+        } else if (c == '{' || c == '[') {
+            // A value directly after a top-level string must follow its key
+            if (c == '[' && depth == 1 && key_len == sizeof(kKey) - 1 &&
+                std::memcmp(key, kKey, key_len) == 0) {
+                return p + 1;
+            }
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+SceneLoader::SceneLoader() = default;
+
+SceneLoader::~SceneLoader() {
+    cancel();
+}
+
+void SceneLoader::start(const std::string& filepath, InstanceFormat format) {
+    cancel();
+
+    // Open and validate up front so the caller gets a synchronous error
+    const bool binary = SceneIO::is_binary_scene(filepath);
+    const bool ply = !binary && SceneIO::is_ply_scene(filepath);
+    MappedScene mapped_binary;
+    MappedFile mapped_json;
+    MappedFile mapped_ply;
+    PlyLayout ply_layout;
+    size_t bytes_total = 0;
+    size_t total = 0;
+    if (binary) {
+        mapped_binary = SceneIO::map_scene_binary(filepath);
+        bytes_total = mapped_binary.count * instance_stride(mapped_binary.format);
+        total = mapped_binary.count;
+    } else if (ply) {
+        mapped_ply = MappedFile(filepath);
+        ply_layout = parse_ply_header(mapped_ply.data(), mapped_ply.size());
+        bytes_total = ply_layout.count * ply_layout.stride;
+        total = ply_layout.count;
+    } else {
+        mapped_json = MappedFile(filepath);
+        bytes_total = mapped_json.size();
+    }
+
+    m_binary = std::move(mapped_binary);
+    m_json = std::move(mapped_json);
+    m_ply = std::move(mapped_ply);
+    m_ply_layout = ply_layout;
+    m_filepath = filepath;
+    m_format = format;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready.clear();
+        m_total = total;
+        m_total_known = binary || ply;
+        m_applied = 0;
+        m_bytes_total = bytes_total;
+        m_bytes_done = 0;
+        m_active = true;
+        m_failed = false;
+        m_error.clear();
+        m_start_time = std::chrono::steady_clock::now();
+        m_finish_seconds = -1.f;
+    }
+
+    m_cancel = false;
+    m_decoding = true;
+    m_thread = std::thread([this, binary, ply]() {
+        try {
+            if (binary) {
+                run_binary();
+            } else if (ply) {
+                run_ply();
+            } else {
+                run_json();
+            }
+        } catch (const std::exception& e) {
+            fail(e.what());
+        }
+        drain(0);
+        m_decoding = false;
+    });
+}
+
+void SceneLoader::cancel() {
+    m_cancel = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+size_t SceneLoader::poll(Scene& scene, std::vector<PackedRange>* packed_ranges) {
+    std::vector<Chunk> ready;
+    bool decoding = false;
+    size_t total = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_active) {
+            return 0;
+        }
+        // Read under the lock: once decoding is over, every chunk has been
+        // pushed, so this swap collects the last of them
+        decoding = m_decoding;
+        ready.swap(m_ready);
+        total = m_total_known ? m_total : 0;
+    }
+
+    scene.set_instance_format(m_format);
+
+    // Grow to the known total (binary) or the furthest chunk seen (JSON)
+    size_t extent = std::max(scene.gaussian_count(), total);
+    for (const Chunk& chunk : ready) {
+        extent = std::max(extent, chunk.first + chunk.gaussians.gaussian_count());
+    }
+    if (extent > scene.gaussian_count()) {
+        scene.resize(extent, placeholder_gaussian());
+    }
+
+    size_t applied = 0;
+    for (const Chunk& chunk : ready) {
+        const size_t count = chunk.gaussians.gaussian_count();
+        const bool direct = packed_ranges && (m_format == InstanceFormat::Compact ? chunk.packed_compact != nullptr
+                                                                                  : chunk.packed != nullptr);
+        scene.write_range(chunk.first, chunk.gaussians, !direct);
+        if (direct) {
+            packed_ranges->push_back(PackedRange{chunk.first, count, chunk.packed, chunk.packed_compact});
+        }
+        applied += count;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_applied += applied;
+        if (!decoding && m_finish_seconds < 0.f) {
+            m_finish_seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_start_time).count();
+        }
+    }
+
+    if (!decoding && (m_json.is_open() || m_ply.is_open())) {
+        // The input is no longer needed once every chunk is decoded
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        m_json.close();
+        m_ply.close();
+    }
+    return applied;
+}
+
+SceneLoadProgress SceneLoader::progress() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SceneLoadProgress p;
+    p.active = m_active;
+    p.done = m_active && m_finish_seconds >= 0.f;
+    p.failed = m_failed;
+    p.error = m_error;
+    p.filepath = m_filepath;
+    p.loaded = m_applied;
+    p.total = m_total_known ? m_total : 0;
+    if (p.done) {
+        p.fraction = 1.f;
+        p.seconds = m_finish_seconds;
+    } else {
+        p.fraction = m_bytes_total ? (float)((double)m_bytes_done / (double)m_bytes_total) : 0.f;
+        if (m_active) {
+            p.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_start_time).count();
+        }
+    }
+    return p;
+}
+
+bool SceneLoader::busy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_decoding || !m_ready.empty();
+}
+
+void SceneLoader::run_binary() {
+    ThreadPool& pool = ThreadPool::shared();
+    const size_t max_in_flight = pool.thread_count() * 2;
+    const size_t count = m_binary.count;
+
+    for (size_t first = 0; first < count && !m_cancel; first += kChunkGaussians) {
+        const size_t n = std::min(kChunkGaussians, count - first);
+        m_jobs.push_back(pool.submit([this, first, n]() {
+            if (m_cancel) {
+                return;
+            }
+            Chunk chunk;
+            chunk.first = first;
+            chunk.gaussians.resize(n, Gaussian3D{});
+            chunk.gaussians.set_sh_layout(m_binary.sh_degree, m_binary.sh_precision);
+            if (m_binary.sh) {
+                chunk.gaussians.write_sh_records(0, m_binary.sh + first * chunk.gaussians.sh_words(), n);
+            }
+            if (m_binary.format == InstanceFormat::Compact) {
+                chunk.packed_compact = m_binary.compact + first;
+                chunk.gaussians.write_packed(0, chunk.packed_compact, n, false);
+            } else {
+                chunk.packed = m_binary.instances + first;
+                chunk.gaussians.write_packed(0, chunk.packed, n, false);
+            }
+            push_chunk(std::move(chunk), n * instance_stride(m_binary.format));
+        }));
+        drain(max_in_flight);
+    }
+}
+
+void SceneLoader::run_ply() {
+    ThreadPool& pool = ThreadPool::shared();
+    const size_t max_in_flight = pool.thread_count() * 2;
+    const size_t count = m_ply_layout.count;
+
+    for (size_t first = 0; first < count && !m_cancel; first += kChunkGaussians) {
+        const size_t n = std::min(kChunkGaussians, count - first);
+        m_jobs.push_back(pool.submit([this, first, n]() {
+            if (m_cancel) {
+                return;
+            }
+            Chunk chunk;
+            chunk.first = first;
+            chunk.gaussians.resize(n, Gaussian3D{});
+            chunk.gaussians.set_sh_layout(m_ply_layout.sh_degree, ShPrecision::Float);
+            decode_ply_vertices(m_ply_layout, m_ply.data(), first, n, chunk.gaussians, 0);
+            push_chunk(std::move(chunk), n * m_ply_layout.stride);
+        }));
+        drain(max_in_flight);
+    }
+}
+
+void SceneLoader::run_json() {
+    ThreadPool& pool = ThreadPool::shared();
+    const size_t max_in_flight = pool.thread_count() * 2;
+    const char* begin = reinterpret_cast<const char*>(m_json.data());
+    const char* end = begin + m_json.size();
+
+    const char* p = begin ? find_gaussian_array(begin, end) : nullptr;
+    if (!p) {
+        throw std::runtime_error("JSON missing 'gaussians' array: " + m_filepath);
+    }
+
+    // Delimit chunks of whole objects serially (a brace scan, much cheaper
+    // than parsing) and parse each chunk on the pool as soon as it is found
+    size_t first = 0;
+    bool list_end = false;
+    while (!list_end && !m_cancel) {
+        const char* chunk_begin = nullptr;
+        size_t n = 0;
+        while (n < kChunkGaussians) {
+            p = skip_separators(p, end);
+            if (p == end) {
+                throw std::runtime_error("JSON 'gaussians' array is not terminated: " + m_filepath);
+            }
+            if (*p == ']') {
+                list_end = true;
+                break;
+            }
+            if (*p != '{') {
+                throw std::runtime_error("JSON parse error at byte " + std::to_string(p - begin) +
+                                         ": expected a gaussian object");
+            }
+            if (!chunk_begin) {
+                chunk_begin = p;
+            }
+            p = find_value_end(p, end);
+            if (!p) {
+                throw std::runtime_error("JSON gaussian object is not terminated: " + m_filepath);
+            }
+            ++n;
+        }
+
+        if (n > 0) {
+            const char* chunk_end = p;
+            m_jobs.push_back(pool.submit([this, first, n, chunk_begin, chunk_end]() {
+                if (m_cancel) {
+                    return;
+                }
+                Chunk chunk;
+                chunk.first = first;
+                chunk.gaussians.reserve(n);
+                GaussianJsonSax sax(chunk.gaussians, GaussianJsonSax::Mode::Object);
+
+                const char* obj = chunk_begin;
+                for (size_t i = 0; i < n; ++i) {
+                    obj = skip_separators(obj, chunk_end);
+                    const char* obj_end = find_value_end(obj, chunk_end);
+                    try {
+                        nlohmann::json::sax_parse(obj, obj_end, &sax);
+                    } catch (const std::exception& e) {
+                        throw std::runtime_error("Gaussian " + std::to_string(first + i) + ": " + e.what());
+                    }
+                    obj = obj_end;
+                }
+                push_chunk(std::move(chunk), (size_t)(chunk_end - chunk_begin));
+            }));
+            first += n;
+        }
+        drain(max_in_flight);
+    }
+
+    if (!m_cancel) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_total = first;
+        m_total_known = true;
+    }
+}
+
+void SceneLoader::push_chunk(Chunk&& chunk, size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytes_done += bytes;
+    m_ready.push_back(std::move(chunk));
+}
+
+void SceneLoader::fail(const std::string& message) {
+    m_cancel = true;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_failed) {
+        m_failed = true;
+        m_error = message;
+    }
+}
+
+void SceneLoader::drain(size_t keep) {
+    // Oldest first, so a slow chunk doesn't hide errors behind it
+    while (m_jobs.size() > keep) {
+        std::future<void> job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        try {
+            job.get();
+        } catch (const std::exception& e) {
+            fail(e.what());
+        }
+    }
+}
+
+}  // namespace sss
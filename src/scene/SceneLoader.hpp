@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Scene.hpp"
+#include "SceneIO.hpp"
+
+namespace sss {
+
+/**
+ * Snapshot of a background load, for display.
+ */
+struct SceneLoadProgress {
+    bool active = false;          // a load was started and has not been cleared
+    bool done = false;            // all chunks decoded and handed to the scene
+    bool failed = false;
+    std::string error;
+    std::string filepath;
+    size_t loaded = 0;            // gaussians applied to the scene so far
+    size_t total = 0;             // total gaussians, 0 until known
+    float fraction = 0.f;         // decoded bytes / file bytes
+    float seconds = 0.f;          // since start()
+};
+
+/**
+ * Loads a scene on background threads in fixed-size chunks.
+ *
+ * A coordinator thread splits the input (binary and PLY records directly;
+ * JSON via a cheap structural scan for object boundaries) and hands chunks
+ * to the shared ThreadPool, which decodes them in parallel. The render thread
+ * calls poll() each frame to copy finished chunks into their final index
+ * ranges of the Scene, so partially loaded scenes can be drawn.
+ */
+class SceneLoader {
+public:
+    /**
+     * A range of the scene whose records are available already packed in
+     * GPU layout (binary scenes stored in the requested instance format).
+     * Only the pointer matching that format is set. It stays valid while
+     * the loader lives and no new load is started.
+     */
+    struct PackedRange {
+        size_t first = 0;
+        size_t count = 0;
+        const GaussianInstanceGPU* instances = nullptr;
+        const GaussianInstanceCompact* compact = nullptr;
+    };
+
+    SceneLoader();
+    ~SceneLoader();
+
+    SceneLoader(const SceneLoader&) = delete;
+    SceneLoader& operator=(const SceneLoader&) = delete;
+
+    /**
+     * Begin loading a scene (file format chosen by extension). poll()
+     * switches the scene to `format`; binary records stored in another
+     * format are converted rather than uploaded as-is.
+     * Opening and header validation happen synchronously and throw
+     * std::runtime_error; decode errors are reported via progress().
+     * Any load in flight is cancelled first.
+     */
+    void start(const std::string& filepath, InstanceFormat format = InstanceFormat::Full);
+
+    /**
+     * Cancel a running load and wait for its threads to stop.
+     */
+    void cancel();
+
+    /**
+     * Apply chunks finished since the last call (render thread only).
+     * The scene grows as needed; indices not yet loaded hold invisible
+     * placeholders.
+     *
+     * @param scene Scene to fill; should be empty when the load starts
+     * @param packed_ranges If non-null, ranges with packed GPU records are
+     *        appended here and left clean in the scene, so the caller can
+     *        upload them directly; otherwise they are marked dirty
+     * @return Number of gaussians applied by this call
+     */
+    size_t poll(Scene& scene, std::vector<PackedRange>* packed_ranges = nullptr);
+
+    SceneLoadProgress progress() const;
+
+    /**
+     * True while chunks are still being decoded or waiting for poll().
+     */
+    bool busy() const;
+
+private:
+    struct Chunk {
+        size_t first = 0;
+        Scene gaussians;   // decoded records, written at [first, first + count)
+        const GaussianInstanceGPU* packed = nullptr;
+        const GaussianInstanceCompact* packed_compact = nullptr;
+    };
+
+    std::thread m_thread;                   // coordinator: splits input, queues chunk jobs
+    std::deque<std::future<void>> m_jobs;   // chunk jobs in flight (coordinator only)
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_decoding{false};
+
+    // Input kept alive for the duration of the load
+    MappedScene m_binary;
+    MappedFile m_json;
+    MappedFile m_ply;
+    PlyLayout m_ply_layout;
+    std::string m_filepath;
+    InstanceFormat m_format = InstanceFormat::Full;
+
+    mutable std::mutex m_mutex;   // guards the members below
+    std::vector<Chunk> m_ready;
+    size_t m_total = 0;
+    size_t m_applied = 0;
+    size_t m_bytes_total = 0;
+    size_t m_bytes_done = 0;
+    bool m_total_known = false;
+    bool m_active = false;
+    bool m_failed = false;
+    std::string m_error;
+    std::chrono::steady_clock::time_point m_start_time;
+    float m_finish_seconds = -1.f;
+
+    void run_binary();
+    void run_ply();
+    void run_json();
+    void push_chunk(Chunk&& chunk, size_t bytes);
+    void fail(const std::string& message);
+    void drain(size_t keep);   // wait until at most `keep` jobs are in flight
+};
+
+}  // namespace sss
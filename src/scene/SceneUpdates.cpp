@@ -0,0 +1,186 @@
+#include "SceneUpdates.hpp"
+#include "LodHierarchy.hpp"
+#include "SpatialIndex.hpp"
+#include "../core/ThreadPool.hpp"
+#include <algorithm>
+
+namespace sss {
+
+namespace {
+
+// Stands in for pruned gaussians and for indices an out-of-order batch
+// refers to before their insert arrives; never covers a pixel
+Gaussian3D tombstone_gaussian() {
+    Gaussian3D g;
+    g.mean = glm::vec3(0.0f);
+    g.scale = glm::vec3(0.0f);
+    g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    g.opacity = 0.0f;
+    g.color = glm::vec3(0.0f);
+    return g;
+}
+
+}  // namespace
+
+SceneUpdateQueue::~SceneUpdateQueue() {
+    free_list(m_head.exchange(nullptr, std::memory_order_acquire));
+}
+
+size_t SceneUpdateQueue::publish(SceneUpdate&& update) {
+    update.first_inserted = m_next_index.fetch_add(update.inserted.size(), std::memory_order_relaxed);
+    const size_t first = update.first_inserted;
+
+    Node* node = new Node{std::move(update), m_head.load(std::memory_order_relaxed)};
+    while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    m_published.fetch_add(1, std::memory_order_relaxed);
+    return first;
+}
+
+size_t SceneUpdateQueue::apply(Scene& scene, std::vector<DirtyRange>& runs) {
+    runs.clear();
+    Node* head = m_head.exchange(nullptr, std::memory_order_acquire);
+    if (!head) {
+        return 0;
+    }
+
+    // The stack holds the newest batch first
+    Node* ordered = nullptr;
+    while (head) {
+        Node* next = head->next;
+        head->next = ordered;
+        ordered = head;
+        head = next;
+    }
+
+    // Taken before the first edit, to be refitted afterwards rather than
+    // left stale
+    const std::shared_ptr<const SpatialIndex> index = scene.spatial_index_shared();
+    const std::shared_ptr<const LodHierarchy> lod = scene.lod_hierarchy_shared();
+
+    std::vector<glm::vec3>& means = scene.means_mut();
+    std::vector<glm::vec3>& scales = scene.scales_mut();
+    std::vector<glm::quat>& rotations = scene.rotations_mut();
+    std::vector<float>& opacities = scene.opacities_mut();
+    std::vector<glm::vec3>& colors = scene.colors_mut();
+    auto write = [&](size_t index, const Gaussian3D& g) {
+        means[index] = g.mean;
+        scales[index] = g.scale;
+        rotations[index] = g.rotation;
+        opacities[index] = g.opacity;
+        colors[index] = g.color;
+    };
+    // IDs up to `count` exist, the new ones as placeholders at the end
+    auto ensure = [&](size_t count) {
+        if (count > scene.id_count()) {
+            scene.resize(scene.gaussian_count() + (count - scene.id_count()), tombstone_gaussian());
+        }
+    };
+    // Slot to write `id` to, or kNoSlot once `g` was appended for an ID
+    // compaction removed
+    auto slot_for = [&](uint32_t id, const Gaussian3D& g) {
+        const uint32_t slot = scene.slot_of(id);
+        if (slot == Scene::kNoSlot) {
+            scene.revive(id, g);
+            ++m_revived;
+        }
+        return slot;
+    };
+
+    m_touched.clear();
+    size_t applied = 0;
+    const Gaussian3D tombstone = tombstone_gaussian();
+    for (Node* node = ordered; node; ++applied) {
+        const SceneUpdate& u = node->update;
+
+        // Appended indices are inside the dirty range resize() extends; a
+        // batch that arrives after a later one fills its placeholders in
+        // place instead
+        if (!u.inserted.empty()) {
+            const size_t old_count = scene.gaussian_count();
+            ensure(u.first_inserted + u.inserted.size());
+            for (size_t i = 0; i < u.inserted.size(); ++i) {
+                const uint32_t slot = slot_for((uint32_t)(u.first_inserted + i), u.inserted[i]);
+                if (slot == Scene::kNoSlot) {
+                    continue;
+                }
+                write(slot, u.inserted[i]);
+                if (slot < old_count) {
+                    m_touched.push_back(slot);
+                }
+            }
+            m_inserted += u.inserted.size();
+        }
+
+        const size_t updates = std::min(u.updated_indices.size(), u.updated.size());
+        for (size_t i = 0; i < updates; ++i) {
+            ensure((size_t)u.updated_indices[i] + 1);
+            const uint32_t slot = slot_for(u.updated_indices[i], u.updated[i]);
+            if (slot != Scene::kNoSlot) {
+                write(slot, u.updated[i]);
+                m_touched.push_back(slot);
+            }
+        }
+        m_updated += updates;
+
+        for (uint32_t id : u.pruned) {
+            ensure((size_t)id + 1);
+            // Already gone if compaction removed it
+            const uint32_t slot = scene.slot_of(id);
+            if (slot != Scene::kNoSlot) {
+                write(slot, tombstone);
+                m_touched.push_back(slot);
+            }
+        }
+        m_pruned += u.pruned.size();
+
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+    m_applied += applied;
+
+    if (!m_touched.empty()) {
+        std::sort(m_touched.begin(), m_touched.end());
+        DirtyRange run{m_touched[0], (size_t)m_touched[0] + 1};
+        for (uint32_t index : m_touched) {
+            if (index > run.end + kRunGap) {
+                runs.push_back(run);
+                run.begin = index;
+            }
+            run.end = std::max(run.end, (size_t)index + 1);
+        }
+        runs.push_back(run);
+        scene.bump_revision();
+    }
+    if (index) {
+        scene.refit_spatial_index(index, lod, &m_touched, &ThreadPool::shared());
+    }
+    return applied;
+}
+
+void SceneUpdateQueue::reset(size_t base) {
+    free_list(m_head.exchange(nullptr, std::memory_order_acquire));
+    m_next_index.store(base, std::memory_order_relaxed);
+}
+
+SceneUpdateStats SceneUpdateQueue::stats() const {
+    SceneUpdateStats s;
+    s.published = m_published.load(std::memory_order_relaxed);
+    s.applied = m_applied;
+    s.inserted = m_inserted;
+    s.updated = m_updated;
+    s.pruned = m_pruned;
+    s.revived = m_revived;
+    return s;
+}
+
+void SceneUpdateQueue::free_list(Node* node) {
+    while (node) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+}  // namespace sss
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Scene.hpp"
+
+namespace sss {
+
+/**
+ * One batch of map edits from a mapping thread. Indices are stable IDs of
+ * the render thread's Scene (Scene::id_of()), which equal its slots until
+ * the scene is first compacted.
+ */
+struct SceneUpdate {
+    std::vector<Gaussian3D> inserted;          // placed at [first_inserted, first_inserted + size)
+    std::vector<uint32_t> updated_indices;
+    std::vector<Gaussian3D> updated;           // new values, parallel to updated_indices
+    std::vector<uint32_t> pruned;              // indices to turn into tombstones
+    size_t first_inserted = 0;                 // assigned by SceneUpdateQueue::publish()
+
+    void update(uint32_t index, const Gaussian3D& gaussian) {
+        updated_indices.push_back(index);
+        updated.push_back(gaussian);
+    }
+
+    bool empty() const { return inserted.empty() && updated.empty() && pruned.empty(); }
+};
+
+/**
+ * Running totals of a SceneUpdateQueue.
+ */
+struct SceneUpdateStats {
+    size_t published = 0;   // batches
+    size_t applied = 0;     // batches
+    size_t inserted = 0;    // gaussians, as applied
+    size_t updated = 0;
+    size_t pruned = 0;
+    size_t revived = 0;     // inserts and updates of gaussians compaction had removed
+};
+
+/**
+ * Lock-free multi-producer, single-consumer queue of SceneUpdate batches,
+ * so mapping threads can edit the scene while the render thread draws it.
+ *
+ * publish() pushes onto an intrusive stack with one CAS and never waits on
+ * the render thread. apply() takes the whole stack with one exchange at
+ * the start of a frame, so it never waits on the producers either, and
+ * applies the batches in publish order. A single producer's batches are
+ * applied in the order it published them; across producers, only the
+ * order of the pushes is kept.
+ *
+ * Pruned gaussians become tombstones (zero opacity and extent) rather than
+ * being erased; MapCompactor removes them later. Either way the IDs
+ * producers hold stay valid, and an edit to a gaussian compaction removed
+ * meanwhile brings it back under the same ID.
+ */
+class SceneUpdateQueue {
+public:
+    // Changed indices at most this far apart are uploaded as one range
+    static constexpr size_t kRunGap = 32;
+
+    SceneUpdateQueue() = default;
+    ~SceneUpdateQueue();
+
+    SceneUpdateQueue(const SceneUpdateQueue&) = delete;
+    SceneUpdateQueue& operator=(const SceneUpdateQueue&) = delete;
+
+    /**
+     * Queue a batch (any thread). Its inserted gaussians are given the next
+     * free indices, which are returned as the batch's first_inserted.
+     */
+    size_t publish(SceneUpdate&& update);
+
+    /**
+     * Apply every batch published so far (render thread only).
+     *
+     * Inserts grow the scene and go through its dirty range like any other
+     * appended gaussians, as do revived ones. Updates and prunes are written in place without
+     * marking dirty; their indices are returned in `runs` as sorted,
+     * coalesced ranges for Renderer::upload_instance_ranges(), so scattered
+     * edits don't widen the dirty range to most of the scene.
+     *
+     * A spatial index and LOD hierarchy current before the call are
+     * refitted to the edits (Scene::refit_spatial_index()), so culling
+     * keeps its hierarchy while mapping; inserts are left outside them
+     * until the next rebuild (IndexRebuilder).
+     *
+     * @return Number of batches applied
+     */
+    size_t apply(Scene& scene, std::vector<DirtyRange>& runs);
+
+    /**
+     * Drop pending batches and hand out insert indices from `base` on,
+     * e.g. after a new scene is loaded. Must not race with publish().
+     */
+    void reset(size_t base);
+
+    bool empty() const { return m_head.load(std::memory_order_acquire) == nullptr; }
+
+    // Render thread only, like apply()
+    SceneUpdateStats stats() const;
+
+private:
+    struct Node {
+        SceneUpdate update;
+        Node* next = nullptr;
+    };
+
+    std::atomic<Node*> m_head{nullptr};
+    std::atomic<size_t> m_next_index{0};
+    std::atomic<size_t> m_published{0};
+
+    // Render thread only
+    std::vector<uint32_t> m_touched;
+    size_t m_applied = 0;
+    size_t m_inserted = 0;
+    size_t m_updated = 0;
+    size_t m_pruned = 0;
+    size_t m_revived = 0;
+
+    static void free_list(Node* node);
+};
+
+}  // namespace sss
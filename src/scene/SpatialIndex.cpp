@@ -0,0 +1,361 @@
+#include "SpatialIndex.hpp"
+#include "Scene.hpp"
+#include "../core/RadixSort.hpp"
+#include "../core/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace sss {
+
+namespace {
+
+constexpr size_t kMinChunk = 1 << 15;
+constexpr size_t kMinNodeChunk = 1 << 9;
+constexpr float kSigmaRadius = 3.0f;   // matches SplatCuller's bounding spheres
+
+std::atomic<uint64_t> g_next_id{1};
+
+void for_range(ThreadPool* pool, size_t count, const std::function<void(size_t, size_t)>& fn,
+               size_t min_chunk = kMinChunk) {
+    if (pool) {
+        pool->parallel_for(count, min_chunk, fn);
+    } else {
+        fn(0, count);
+    }
+}
+
+// Spread the low 10 bits of v so there are two zero bits between each
+uint32_t expand_bits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+uint32_t morton3(const glm::vec3& unit) {
+    auto q = [](float f) {
+        return (uint32_t)std::min(std::max(f * 1024.0f, 0.0f), 1023.0f);
+    };
+    return (expand_bits(q(unit.x)) << 2) | (expand_bits(q(unit.y)) << 1) | expand_bits(q(unit.z));
+}
+
+float distance2_to_box(const glm::vec3& p, const glm::vec3& lo, const glm::vec3& hi) {
+    const glm::vec3 d = glm::max(glm::max(lo - p, p - hi), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+struct Builder {
+    const std::vector<uint32_t>& codes;
+    const std::vector<glm::vec3>& box_min;   // per slot
+    const std::vector<glm::vec3>& box_max;
+    std::vector<SpatialIndex::Node>& nodes;
+
+    // Fills nodes[node] for slots [lo, hi)
+    void build(uint32_t node, uint32_t lo, uint32_t hi) {
+        SpatialIndex::Node& n = nodes[node];
+        n.first = lo;
+        n.count = hi - lo;
+
+        if (hi - lo <= SpatialIndex::kMaxLeafSize) {
+            n.left = SpatialIndex::kLeaf;
+            glm::vec3 bmin(std::numeric_limits<float>::max());
+            glm::vec3 bmax(-std::numeric_limits<float>::max());
+            for (uint32_t i = lo; i < hi; ++i) {
+                bmin = glm::min(bmin, box_min[i]);
+                bmax = glm::max(bmax, box_max[i]);
+            }
+            n.bounds_min = bmin;
+            n.bounds_max = bmax;
+            return;
+        }
+
+        const uint32_t split = find_split(lo, hi);
+        const uint32_t left = (uint32_t)nodes.size();
+        nodes.emplace_back();
+        nodes.emplace_back();
+        nodes[left].parent = node;
+        nodes[left + 1].parent = node;
+        nodes[node].left = left;   // `n` may dangle after emplace_back
+
+        build(left, lo, split);
+        build(left + 1, split, hi);
+
+        SpatialIndex::Node& self = nodes[node];
+        self.bounds_min = glm::min(nodes[left].bounds_min, nodes[left + 1].bounds_min);
+        self.bounds_max = glm::max(nodes[left].bounds_max, nodes[left + 1].bounds_max);
+    }
+
+    // First slot whose code has the highest differing bit of the range set;
+    // the midpoint when all codes in the range are identical
+    uint32_t find_split(uint32_t lo, uint32_t hi) const {
+        const uint32_t first_code = codes[lo];
+        const uint32_t last_code = codes[hi - 1];
+        if (first_code == last_code) {
+            return lo + (hi - lo) / 2;
+        }
+        const int prefix = std::countl_zero(first_code ^ last_code);
+        const uint32_t bit = 0x80000000u >> prefix;
+        const auto begin = codes.begin() + lo;
+        const auto it = std::partition_point(begin, codes.begin() + hi, [&](uint32_t c) {
+            return (c & bit) == 0;
+        });
+        return (uint32_t)(it - codes.begin());
+    }
+};
+
+}  // namespace
+
+SpatialIndex SpatialIndex::build(const Scene& scene, ThreadPool* pool) {
+    SpatialIndex index;
+    index.m_id = g_next_id.fetch_add(1);
+    index.m_layout = index.m_id;
+
+    const size_t n = scene.gaussian_count();
+    if (n == 0) {
+        return index;
+    }
+    const glm::vec3* means = scene.means().data();
+    const glm::vec3* scales = scene.scales().data();
+
+    glm::vec3 lo = means[0], hi = means[0];
+    for (size_t i = 1; i < n; ++i) {
+        lo = glm::min(lo, means[i]);
+        hi = glm::max(hi, means[i]);
+    }
+    const glm::vec3 extent = glm::max(hi - lo, glm::vec3(1e-6f));
+    const glm::vec3 inv_extent(1.0f / extent.x, 1.0f / extent.y, 1.0f / extent.z);
+
+    // Sort splats along a Z-order curve of their means
+    std::vector<uint32_t> codes(n);
+    index.m_order.resize(n);
+    for_range(pool, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            codes[i] = morton3((means[i] - lo) * inv_extent);
+            index.m_order[i] = (uint32_t)i;
+        }
+    });
+    std::vector<uint32_t> scratch_keys, scratch_values;
+    radix_sort_pairs(codes, index.m_order, scratch_keys, scratch_values, pool);
+
+    // Per-slot data in sorted order
+    index.m_slot.resize(n);
+    index.m_points.resize(n);
+    std::vector<glm::vec3> box_min(n), box_max(n);
+    for_range(pool, n, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t i = index.m_order[k];
+            const glm::vec3 s = glm::abs(scales[i]);
+            const float r = kSigmaRadius * std::max(s.x, std::max(s.y, s.z));
+            index.m_slot[i] = (uint32_t)k;
+            index.m_points[k] = means[i];
+            box_min[k] = means[i] - glm::vec3(r);
+            box_max[k] = means[i] + glm::vec3(r);
+        }
+    });
+
+    index.m_nodes.reserve(2 * (n / (kMaxLeafSize / 2) + 1));
+    index.m_nodes.emplace_back();
+    index.m_nodes[0].parent = kLeaf;
+    Builder builder{codes, box_min, box_max, index.m_nodes};
+    builder.build(0, 0, (uint32_t)n);
+    return index;
+}
+
+SpatialIndex SpatialIndex::refit(const Scene& scene, const std::vector<uint32_t>* changed, ThreadPool* pool,
+                                 std::vector<uint32_t>* refitted) const {
+    SpatialIndex index = *this;
+    index.m_id = g_next_id.fetch_add(1);
+    if (refitted) {
+        refitted->clear();
+    }
+    if (m_nodes.empty()) {
+        return index;
+    }
+
+    const size_t n = m_order.size();
+    const glm::vec3* means = scene.means().data();
+    const glm::vec3* scales = scene.scales().data();
+    const float* opacities = scene.opacities().data();
+
+    // Points of the changed gaussians, and their leaves marked
+    std::vector<uint8_t> stale(m_nodes.size(), changed ? 0 : 1);
+    if (changed) {
+        for (uint32_t i : *changed) {
+            if (i < n) {
+                const uint32_t slot = m_slot[i];
+                index.m_points[slot] = means[i];
+                stale[leaf_of(slot)] = 1;
+            }
+        }
+    } else {
+        for_range(pool, n, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                index.m_points[k] = means[m_order[k]];
+            }
+        });
+    }
+
+    // Leaves from their visible splats; one with none keeps a point at its
+    // old center, so its parents don't grow to reach it
+    std::vector<Node>& nodes = index.m_nodes;
+    for_range(pool, nodes.size(), [&](size_t begin, size_t end) {
+        for (size_t id = begin; id < end; ++id) {
+            Node& node = nodes[id];
+            if (!stale[id] || node.left != kLeaf) {
+                continue;
+            }
+            glm::vec3 bmin(std::numeric_limits<float>::max());
+            glm::vec3 bmax(-std::numeric_limits<float>::max());
+            for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                const uint32_t i = m_order[k];
+                if (opacities[i] <= 0.f) {
+                    continue;
+                }
+                const glm::vec3 s = glm::abs(scales[i]);
+                const float r = kSigmaRadius * std::max(s.x, std::max(s.y, s.z));
+                bmin = glm::min(bmin, means[i] - glm::vec3(r));
+                bmax = glm::max(bmax, means[i] + glm::vec3(r));
+            }
+            if (bmin.x > bmax.x) {
+                bmin = bmax = 0.5f * (node.bounds_min + node.bounds_max);
+            }
+            node.bounds_min = bmin;
+            node.bounds_max = bmax;
+        }
+    }, kMinNodeChunk);
+
+    // Children follow their parent in node order, so a reverse sweep
+    // regrows each box after both of its children
+    for (size_t id = nodes.size(); id-- > 0;) {
+        Node& node = nodes[id];
+        if (node.left != kLeaf && (stale[node.left] || stale[node.left + 1])) {
+            node.bounds_min = glm::min(nodes[node.left].bounds_min, nodes[node.left + 1].bounds_min);
+            node.bounds_max = glm::max(nodes[node.left].bounds_max, nodes[node.left + 1].bounds_max);
+            stale[id] = 1;
+        }
+        if (stale[id] && refitted) {
+            refitted->push_back((uint32_t)id);
+        }
+    }
+    return index;
+}
+
+uint32_t SpatialIndex::leaf_of(uint32_t slot) const {
+    uint32_t id = 0;
+    while (m_nodes[id].left != kLeaf) {
+        const uint32_t right = m_nodes[id].left + 1;
+        id = slot < m_nodes[right].first ? m_nodes[id].left : right;
+    }
+    return id;
+}
+
+void SpatialIndex::query_frustum(const Frustum& frustum, std::vector<SpatialRange>& out) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+    uint32_t stack[128];   // depth is bounded by 30 code bits plus duplicate-code splits
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        const int c = frustum.classify_box(node.bounds_min, node.bounds_max);
+        if (c < 0) {
+            continue;
+        }
+        if (c > 0 || node.left == kLeaf) {
+            // Merge with the previous run when adjacent and of the same kind
+            if (!out.empty() && out.back().contained == (c > 0) &&
+                out.back().first + out.back().count == node.first) {
+                out.back().count += node.count;
+            } else {
+                out.push_back(SpatialRange{node.first, node.count, c > 0});
+            }
+            continue;
+        }
+        // Right first so the left subtree (lower slots) is visited first
+        stack[top++] = node.left + 1;
+        stack[top++] = node.left;
+    }
+}
+
+void SpatialIndex::query_radius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+    const float r2 = radius * radius;
+    uint32_t stack[128];   // depth is bounded by 30 code bits plus duplicate-code splits
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        if (distance2_to_box(center, node.bounds_min, node.bounds_max) > r2) {
+            continue;
+        }
+        if (node.left == kLeaf) {
+            for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                const glm::vec3 d = m_points[k] - center;
+                if (glm::dot(d, d) <= r2) {
+                    out.push_back(m_order[k]);
+                }
+            }
+            continue;
+        }
+        stack[top++] = node.left + 1;
+        stack[top++] = node.left;
+    }
+}
+
+void SpatialIndex::query_knn(const glm::vec3& point, size_t k, std::vector<uint32_t>& out) const {
+    out.clear();
+    if (m_nodes.empty() || k == 0) {
+        return;
+    }
+
+    // Best-first search: nodes ordered by box distance, results kept in a
+    // max-heap so the current k-th distance bounds the search
+    using Entry = std::pair<float, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+    std::priority_queue<Entry> best;
+
+    frontier.emplace(distance2_to_box(point, m_nodes[0].bounds_min, m_nodes[0].bounds_max), 0u);
+    while (!frontier.empty()) {
+        const auto [node_d2, node_id] = frontier.top();
+        frontier.pop();
+        if (best.size() == k && node_d2 > best.top().first) {
+            break;
+        }
+        const Node& node = m_nodes[node_id];
+        if (node.left == kLeaf) {
+            for (uint32_t s = node.first; s < node.first + node.count; ++s) {
+                const glm::vec3 d = m_points[s] - point;
+                const float d2 = glm::dot(d, d);
+                if (best.size() < k) {
+                    best.emplace(d2, m_order[s]);
+                } else if (d2 < best.top().first) {
+                    best.pop();
+                    best.emplace(d2, m_order[s]);
+                }
+            }
+            continue;
+        }
+        for (uint32_t child = node.left; child <= node.left + 1; ++child) {
+            const Node& c = m_nodes[child];
+            frontier.emplace(distance2_to_box(point, c.bounds_min, c.bounds_max), child);
+        }
+    }
+
+    out.resize(best.size());
+    for (size_t i = out.size(); i-- > 0;) {
+        out[i] = best.top().second;
+        best.pop();
+    }
+}
+
+}  // namespace sss
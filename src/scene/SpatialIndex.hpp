@@ -0,0 +1,134 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../core/Frustum.hpp"
+
+namespace sss {
+
+class Scene;
+class ThreadPool;
+
+/**
+ * Contiguous run of slots in a SpatialIndex (see SpatialIndex::order()).
+ */
+struct SpatialRange {
+    uint32_t first = 0;
+    uint32_t count = 0;
+    bool contained = false;   // every splat in the run passed the query's bounds test
+};
+
+/**
+ * Bounding volume hierarchy over a scene's gaussians.
+ *
+ * Built as a linear BVH: splats are radix-sorted by the Morton code of
+ * their mean, and nodes split on the highest differing code bit. Each node
+ * therefore covers a contiguous run of "slots" in that sorted order, and
+ * its box bounds the splats' 3-sigma spheres, not just their means.
+ *
+ * The index is a snapshot: it does not follow later edits to the scene
+ * until refit() is called, and gaussians added after the build stay
+ * outside it (scene indices size() and up).
+ */
+class SpatialIndex {
+public:
+    struct Node {
+        glm::vec3 bounds_min;
+        uint32_t first;          // first slot covered
+        glm::vec3 bounds_max;
+        uint32_t count;          // slots covered
+        uint32_t left;           // first child (right child is left + 1); kLeaf for leaves
+        uint32_t parent;         // kLeaf for the root
+    };
+
+    static constexpr uint32_t kLeaf = 0xFFFFFFFFu;
+    static constexpr uint32_t kMaxLeafSize = 64;
+
+    SpatialIndex() = default;
+
+    /**
+     * Build the hierarchy over every gaussian of `scene`.
+     *
+     * @param pool Optional pool for the per-splat passes and the sort
+     */
+    static SpatialIndex build(const Scene& scene, ThreadPool* pool);
+
+    /**
+     * Unique per build, so holders can tell a rebuilt index from the old one.
+     */
+    uint64_t id() const { return m_id; }
+
+    /**
+     * Shared by an index and its refits, which keep its slot order and node
+     * tree; holders of per-slot data can keep it across a refit.
+     */
+    uint64_t layout() const { return m_layout; }
+
+    /**
+     * Copy refitted to `scene` as it is now: the points and node bounds of
+     * the gaussians in `changed` (scene indices; all of them if null) are
+     * recomputed and the boxes above them regrown or shrunk, for edits made
+     * in place. Transparent splats no longer count toward the bounds.
+     * Slots and nodes stay where they are, so a refit only clusters as well
+     * as the build did; indices of size() and up are ignored.
+     *
+     * @param pool    Optional pool for refitting every node
+     * @param refitted If not null, receives the nodes whose bounds were
+     *                 recomputed, children before their parents
+     */
+    SpatialIndex refit(const Scene& scene, const std::vector<uint32_t>* changed, ThreadPool* pool,
+                       std::vector<uint32_t>* refitted = nullptr) const;
+
+    size_t size() const { return m_order.size(); }
+    bool empty() const { return m_order.empty(); }
+
+    const std::vector<Node>& nodes() const { return m_nodes; }
+
+    /**
+     * Scene gaussian index stored in each slot.
+     */
+    const std::vector<uint32_t>& order() const { return m_order; }
+
+    /**
+     * Slot holding scene gaussian `index` (inverse of order()).
+     */
+    uint32_t slot_of(uint32_t index) const { return m_slot[index]; }
+
+    /**
+     * Means in slot order.
+     */
+    const std::vector<glm::vec3>& points() const { return m_points; }
+
+    /**
+     * Collect slot runs whose node boxes touch the frustum. Runs fully
+     * inside it are marked contained; the rest are leaves whose splats
+     * still need individual tests.
+     */
+    void query_frustum(const Frustum& frustum, std::vector<SpatialRange>& out) const;
+
+    /**
+     * Append the scene indices of gaussians whose mean lies within
+     * `radius` of `center`, in no particular order.
+     */
+    void query_radius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+
+    /**
+     * Scene indices of the (up to) k gaussians whose means are nearest to
+     * `point`, nearest first. `out` is overwritten.
+     */
+    void query_knn(const glm::vec3& point, size_t k, std::vector<uint32_t>& out) const;
+
+private:
+    uint64_t m_id = 0;
+    uint64_t m_layout = 0;
+    std::vector<Node> m_nodes;        // root at 0 when non-empty
+    std::vector<uint32_t> m_order;    // slot -> scene index
+    std::vector<uint32_t> m_slot;     // scene index -> slot
+    std::vector<glm::vec3> m_points;  // slot -> mean
+
+    uint32_t leaf_of(uint32_t slot) const;
+};
+
+}  // namespace sss
@@ -0,0 +1,238 @@
+#include "TileResidency.hpp"
+#include "SceneIO.hpp"
+#include "../core/Log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace sss {
+
+namespace {
+
+Gaussian3D tombstone_gaussian() {
+    Gaussian3D g;
+    g.mean = glm::vec3(0.0f);
+    g.scale = glm::vec3(0.0f);
+    g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    g.opacity = 0.0f;
+    g.color = glm::vec3(0.0f);
+    return g;
+}
+
+float distance_to_box(const glm::vec3& p, const glm::vec3& lo, const glm::vec3& hi) {
+    return glm::length(glm::max(glm::max(lo - p, p - hi), glm::vec3(0.f)));
+}
+
+}  // namespace
+
+TileResidency::TileResidency(TileSet tiles, size_t budget_gaussians)
+    : m_tiles(std::move(tiles)),
+      m_state(m_tiles.tiles.size()),
+      m_pages(std::max<size_t>(1, budget_gaussians / kPageGaussians), -1),
+      m_io(kIoThreads) {
+    m_free_pages.resize(m_pages.size());
+    // Hand out low pages first
+    std::iota(m_free_pages.rbegin(), m_free_pages.rend(), 0u);
+}
+
+TileResidency::~TileResidency() = default;
+
+void TileResidency::init_scene(Scene& resident) const {
+    resident.clear();
+    resident.set_sh_layout(m_tiles.sh_degree, m_tiles.sh_precision);
+    resident.resize(capacity(), tombstone_gaussian());
+}
+
+void TileResidency::update(const glm::vec3& position, const glm::vec3& velocity, Scene& resident,
+                           std::vector<DirtyRange>& changed, std::pmr::memory_resource* scratch) {
+    changed.clear();
+    ++m_frame;
+
+    // Rank by distance from the camera or from where it is heading,
+    // whichever is nearer
+    const glm::vec3 predicted = position + velocity * m_prefetch_seconds;
+    m_order.resize(m_tiles.tiles.size());
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    for (size_t t = 0; t < m_state.size(); ++t) {
+        const TileInfo& info = m_tiles.tiles[t];
+        m_state[t].score = std::min(distance_to_box(position, info.lo, info.hi),
+                                    distance_to_box(predicted, info.lo, info.hi));
+    }
+    std::sort(m_order.begin(), m_order.end(),
+              [&](uint32_t a, uint32_t b) { return m_state[a].score < m_state[b].score; });
+
+    // Want the nearest tiles that fit the pool; start their loads nearest
+    // first
+    size_t budget = m_pages.size();
+    m_wanted = 0;
+    for (uint32_t t : m_order) {
+        Tile& tile = m_state[t];
+        const size_t need = pages_for(m_tiles.tiles[t].count);
+        if (tile.failed || need == 0 || need > budget) {
+            continue;
+        }
+        budget -= need;
+        tile.last_wanted = m_frame;
+        ++m_wanted;
+        if (tile.state == State::Absent && m_loading < kMaxLoadsInFlight) {
+            start_load(t);
+        }
+        if (budget == 0) {
+            break;
+        }
+    }
+
+    // Install finished loads, nearest first, a few per frame so a burst of
+    // arrivals doesn't stall one frame
+    std::pmr::vector<uint32_t> touched(scratch);
+    size_t installs = 0;
+    for (uint32_t t : m_order) {
+        if (installs >= kMaxInstallsPerFrame) {
+            break;
+        }
+        Tile& tile = m_state[t];
+        if (tile.state != State::Loading ||
+            tile.load.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            continue;
+        }
+        --m_loading;
+        tile.state = State::Absent;
+        std::unique_ptr<Scene> data;
+        try {
+            data = tile.load.get();
+        } catch (const std::exception& e) {
+            SSS_LOG_ERROR("[TileResidency] Failed to load %s: %s", m_tiles.tile_path(t).c_str(), e.what());
+            tile.failed = true;
+            continue;
+        }
+        if (install(t, *data, resident, touched)) {
+            ++installs;
+        }
+    }
+
+    if (touched.empty()) {
+        return;
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (uint32_t page : touched) {
+        const size_t begin = page * kPageGaussians;
+        if (!changed.empty() && changed.back().end == begin) {
+            changed.back().end += kPageGaussians;
+        } else {
+            changed.push_back(DirtyRange{begin, begin + kPageGaussians});
+        }
+    }
+    resident.bump_revision();
+}
+
+TileResidencyStats TileResidency::stats() const {
+    TileResidencyStats s;
+    s.tiles = m_tiles.tiles.size();
+    s.resident = m_resident;
+    s.loading = m_loading;
+    s.wanted = m_wanted;
+    s.pages = m_pages.size();
+    s.pages_used = m_pages.size() - m_free_pages.size();
+    s.page_gaussians = kPageGaussians;
+    s.loads = m_loads;
+    s.evictions = m_evictions;
+    return s;
+}
+
+void TileResidency::start_load(uint32_t t) {
+    Tile& tile = m_state[t];
+    tile.state = State::Loading;
+    ++m_loading;
+    // Conversion to the pool's SH layout happens here too, off the render
+    // thread
+    tile.load = m_io.submit([path = m_tiles.tile_path(t), degree = m_tiles.sh_degree,
+                             precision = m_tiles.sh_precision]() {
+        auto data = std::make_unique<Scene>(SceneIO::load_scene_binary(path));
+        data->set_sh_layout(degree, precision);
+        return data;
+    });
+}
+
+bool TileResidency::install(uint32_t t, const Scene& data, Scene& resident, std::pmr::vector<uint32_t>& touched) {
+    Tile& tile = m_state[t];
+    const size_t count = data.gaussian_count();
+    const size_t need = pages_for(count);
+    const bool wanted = tile.last_wanted == m_frame;
+
+    // Make room from the least recently wanted resident tiles, never from
+    // ones wanted this frame; a tile no longer wanted only takes free pages
+    while (wanted && m_free_pages.size() < need) {
+        int32_t victim = -1;
+        for (size_t v = 0; v < m_state.size(); ++v) {
+            const Tile& candidate = m_state[v];
+            if (candidate.state == State::Resident && candidate.last_wanted < m_frame &&
+                (victim < 0 || candidate.last_wanted < m_state[(size_t)victim].last_wanted)) {
+                victim = (int32_t)v;
+            }
+        }
+        if (victim < 0) {
+            break;
+        }
+        evict((uint32_t)victim, resident, touched);
+    }
+    if (m_free_pages.size() < need || data.sh_words() != resident.sh_words()) {
+        return false;
+    }
+
+    std::vector<glm::vec3>& means = resident.means_mut();
+    std::vector<glm::vec3>& scales = resident.scales_mut();
+    std::vector<glm::quat>& rotations = resident.rotations_mut();
+    std::vector<float>& opacities = resident.opacities_mut();
+    std::vector<glm::vec3>& colors = resident.colors_mut();
+    const Gaussian3D tombstone = tombstone_gaussian();
+
+    for (size_t k = 0; k < need; ++k) {
+        const uint32_t page = m_free_pages.back();
+        m_free_pages.pop_back();
+        m_pages[page] = (int32_t)t;
+        tile.pages.push_back(page);
+        touched.push_back(page);
+
+        const size_t src = k * kPageGaussians;
+        const size_t n = std::min(kPageGaussians, count - src);
+        const size_t dst = page * kPageGaussians;
+        std::copy_n(data.means().begin() + src, n, means.begin() + dst);
+        std::copy_n(data.scales().begin() + src, n, scales.begin() + dst);
+        std::copy_n(data.rotations().begin() + src, n, rotations.begin() + dst);
+        std::copy_n(data.opacities().begin() + src, n, opacities.begin() + dst);
+        std::copy_n(data.colors().begin() + src, n, colors.begin() + dst);
+        if (resident.sh_words() > 0) {
+            resident.write_sh_records(dst, data.sh_data().data() + src * data.sh_words(), n);
+        }
+        // The rest of a partial page may hold an evicted tile's splats
+        for (size_t i = dst + n; i < dst + kPageGaussians; ++i) {
+            opacities[i] = tombstone.opacity;
+            scales[i] = tombstone.scale;
+        }
+    }
+    tile.state = State::Resident;
+    ++m_resident;
+    ++m_loads;
+    return true;
+}
+
+void TileResidency::evict(uint32_t t, Scene& resident, std::pmr::vector<uint32_t>& touched) {
+    Tile& tile = m_state[t];
+    std::vector<float>& opacities = resident.opacities_mut();
+    std::vector<glm::vec3>& scales = resident.scales_mut();
+    for (uint32_t page : tile.pages) {
+        const size_t dst = page * kPageGaussians;
+        std::fill_n(opacities.begin() + dst, kPageGaussians, 0.f);
+        std::fill_n(scales.begin() + dst, kPageGaussians, glm::vec3(0.f));
+        m_pages[page] = -1;
+        m_free_pages.push_back(page);
+        touched.push_back(page);
+    }
+    tile.pages.clear();
+    tile.state = State::Absent;
+    --m_resident;
+    ++m_evictions;
+}
+
+}  // namespace sss
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include "Scene.hpp"
+#include "TileSet.hpp"
+#include "../core/ThreadPool.hpp"
+
+namespace sss {
+
+/**
+ * Snapshot of a TileResidency, for display.
+ */
+struct TileResidencyStats {
+    size_t tiles = 0;
+    size_t resident = 0;         // tiles installed in the page pool
+    size_t loading = 0;          // tiles being read by the I/O threads
+    size_t wanted = 0;           // tiles the last update() wanted resident
+    size_t pages = 0;            // pool size
+    size_t pages_used = 0;
+    size_t page_gaussians = 0;
+    size_t loads = 0;            // totals since creation
+    size_t evictions = 0;
+};
+
+/**
+ * Streams the tiles of a TileSet in and out of a fixed-size resident
+ * Scene, for maps larger than the GPU (or host) memory budget.
+ *
+ * The resident scene is a pool of pages of kPageGaussians slots each,
+ * sized once from the budget, so the renderer's buffers never reallocate;
+ * free slots hold zero-opacity tombstones that culling drops. A tile
+ * occupies as many pages as it needs, in any order.
+ *
+ * Each update() ranks tiles by distance from the camera and from where
+ * its velocity puts it prefetch_seconds ahead, and wants the nearest ones
+ * that fit the pool. Wanted tiles are read from disk on a dedicated I/O
+ * pool (so disk waits never occupy the shared render-side pool) and
+ * installed a few per frame. Pages are reclaimed from the least recently
+ * wanted tiles only when a wanted tile needs them, so tiles just behind
+ * the camera stay cached.
+ */
+class TileResidency {
+public:
+    static constexpr size_t kPageGaussians = size_t(1) << 14;
+    static constexpr size_t kIoThreads = 2;
+    static constexpr size_t kMaxLoadsInFlight = 4;
+    static constexpr size_t kMaxInstallsPerFrame = 2;
+
+    /**
+     * @param budget_gaussians Resident slots; rounded down to whole pages
+     *        (at least one)
+     */
+    TileResidency(TileSet tiles, size_t budget_gaussians);
+    ~TileResidency();
+
+    TileResidency(const TileResidency&) = delete;
+    TileResidency& operator=(const TileResidency&) = delete;
+
+    /**
+     * Size `resident` to the page pool, all tombstones, with the tile set's
+     * SH layout (marks everything dirty). Call once before update().
+     */
+    void init_scene(Scene& resident) const;
+
+    /**
+     * Rank tiles for the camera, start loads and install finished ones
+     * (render thread, once per frame). Installed and evicted pages are
+     * written without marking dirty and returned in `changed` for
+     * Renderer::upload_instance_ranges(). Per-call lists come from
+     * `scratch`, e.g. Renderer::frame_arena().
+     */
+    void update(const glm::vec3& position, const glm::vec3& velocity, Scene& resident,
+                std::vector<DirtyRange>& changed, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+    void set_prefetch_seconds(float seconds) { m_prefetch_seconds = seconds; }
+    float prefetch_seconds() const { return m_prefetch_seconds; }
+
+    const TileSet& tiles() const { return m_tiles; }
+    size_t capacity() const { return m_pages.size() * kPageGaussians; }
+    TileResidencyStats stats() const;
+
+private:
+    enum class State : uint8_t { Absent, Loading, Resident };
+
+    struct Tile {
+        State state = State::Absent;
+        bool failed = false;        // its file could not be read; never retried
+        std::future<std::unique_ptr<Scene>> load;
+        std::vector<uint32_t> pages;
+        uint64_t last_wanted = 0;   // frame
+        float score = 0.f;          // distance to the nearer camera position
+    };
+
+    TileSet m_tiles;
+    std::vector<Tile> m_state;
+    std::vector<int32_t> m_pages;       // owning tile per page, -1 if free
+    std::vector<uint32_t> m_free_pages;
+    std::vector<uint32_t> m_order;      // tile ranking, reused per frame
+    float m_prefetch_seconds = 1.f;
+    uint64_t m_frame = 0;
+    size_t m_wanted = 0;
+    size_t m_loading = 0;
+    size_t m_resident = 0;
+    size_t m_loads = 0;
+    size_t m_evictions = 0;
+    ThreadPool m_io;                    // destroyed first: joins pending loads
+
+    static size_t pages_for(size_t count) { return (count + kPageGaussians - 1) / kPageGaussians; }
+
+    void start_load(uint32_t tile);
+    bool install(uint32_t tile, const Scene& data, Scene& resident, std::pmr::vector<uint32_t>& touched);
+    void evict(uint32_t tile, Scene& resident, std::pmr::vector<uint32_t>& touched);
+};
+
+}  // namespace sss
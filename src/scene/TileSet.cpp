@@ -0,0 +1,166 @@
+#include "TileSet.hpp"
+#include "SceneIO.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+namespace sss {
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int kTileSetVersion = 1;
+constexpr const char* kIndexName = "tiles.json";
+constexpr float kSigmaExtent = 3.f;   // tile bounds cover 3-sigma splat extents
+
+std::filesystem::path index_path(const std::string& path) {
+    std::filesystem::path p(path);
+    std::error_code ec;
+    return std::filesystem::is_directory(p, ec) ? p / kIndexName : p;
+}
+
+glm::vec3 read_vec3(const json& j, const char* key) {
+    const json& v = j.at(key);
+    if (!v.is_array() || v.size() != 3) {
+        throw std::runtime_error(std::string("tile '") + key + "' must be [x, y, z]");
+    }
+    return glm::vec3(v[0].get<float>(), v[1].get<float>(), v[2].get<float>());
+}
+
+}  // namespace
+
+std::string TileSet::tile_path(size_t tile) const {
+    return (std::filesystem::path(directory) / tiles[tile].file).string();
+}
+
+size_t TileSet::gaussian_count() const {
+    size_t count = 0;
+    for (const TileInfo& t : tiles) {
+        count += t.count;
+    }
+    return count;
+}
+
+bool TileSet::is_tile_set(const std::string& path) {
+    const std::filesystem::path p = index_path(path);
+    std::error_code ec;
+    return p.filename() == kIndexName && std::filesystem::is_regular_file(p, ec);
+}
+
+TileSet TileSet::load(const std::string& path) {
+    const std::filesystem::path index = index_path(path);
+    std::ifstream in(index);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open tile set index: " + index.string());
+    }
+
+    TileSet set;
+    set.directory = index.parent_path().string();
+    try {
+        const json j = json::parse(in);
+        if (j.value("version", 0) != kTileSetVersion) {
+            throw std::runtime_error("unsupported version");
+        }
+        set.tile_size = j.at("tile_size").get<float>();
+        set.sh_degree = std::clamp(j.value("sh_degree", 0), 0, kMaxShDegree);
+        set.sh_precision = j.value("sh_precision", std::string("float")) == "half" ? ShPrecision::Half
+                                                                                  : ShPrecision::Float;
+        for (const json& t : j.at("tiles")) {
+            TileInfo info;
+            info.file = t.at("file").get<std::string>();
+            info.count = t.at("count").get<size_t>();
+            info.lo = read_vec3(t, "min");
+            info.hi = read_vec3(t, "max");
+            set.tiles.push_back(std::move(info));
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Malformed tile set index " + index.string() + ": " + e.what());
+    }
+    return set;
+}
+
+TileSet TileSet::write(const Scene& scene, const std::string& directory, float tile_size) {
+    if (!(tile_size > 0.f)) {
+        throw std::runtime_error("Tile size must be positive");
+    }
+    std::filesystem::create_directories(directory);
+
+    // Bucket gaussians by grid cell; the ordered map keeps file numbering
+    // deterministic
+    using Cell = std::tuple<int, int, int>;
+    std::map<Cell, std::vector<uint32_t>> cells;
+    const std::vector<glm::vec3>& means = scene.means();
+    for (size_t i = 0; i < means.size(); ++i) {
+        const glm::vec3& m = means[i];
+        const Cell cell{(int)std::floor(m.x / tile_size), (int)std::floor(m.y / tile_size),
+                        (int)std::floor(m.z / tile_size)};
+        cells[cell].push_back((uint32_t)i);
+    }
+
+    TileSet set;
+    set.directory = directory;
+    set.tile_size = tile_size;
+    set.sh_degree = scene.sh_degree();
+    set.sh_precision = scene.sh_precision();
+
+    const size_t sh_words = scene.sh_words();
+    json tiles = json::array();
+    for (const auto& [cell, indices] : cells) {
+        Scene tile;
+        tile.set_sh_layout(scene.sh_degree(), scene.sh_precision());
+        tile.resize(indices.size(), Gaussian3D{});
+        tile.set_instance_format(scene.instance_format());
+
+        TileInfo info;
+        info.count = indices.size();
+        info.lo = glm::vec3(std::numeric_limits<float>::max());
+        info.hi = glm::vec3(-std::numeric_limits<float>::max());
+        for (size_t k = 0; k < indices.size(); ++k) {
+            const Gaussian3D g = scene.gaussian(indices[k]);
+            tile.set_gaussian(k, g);
+            if (sh_words > 0) {
+                tile.write_sh_records(k, scene.sh_data().data() + indices[k] * sh_words, 1);
+            }
+            const glm::vec3 s = glm::abs(g.scale);
+            const float extent = kSigmaExtent * std::max(s.x, std::max(s.y, s.z));
+            info.lo = glm::min(info.lo, g.mean - glm::vec3(extent));
+            info.hi = glm::max(info.hi, g.mean + glm::vec3(extent));
+        }
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "tile_%05zu.sss", set.tiles.size());
+        info.file = name;
+        SceneIO::save_scene_binary((std::filesystem::path(directory) / name).string(), tile);
+
+        tiles.push_back({{"file", info.file},
+                         {"count", info.count},
+                         {"min", {info.lo.x, info.lo.y, info.lo.z}},
+                         {"max", {info.hi.x, info.hi.y, info.hi.z}}});
+        set.tiles.push_back(std::move(info));
+    }
+
+    json j;
+    j["version"] = kTileSetVersion;
+    j["tile_size"] = tile_size;
+    j["sh_degree"] = set.sh_degree;
+    j["sh_precision"] = sh_precision_name(set.sh_precision);
+    j["tiles"] = std::move(tiles);
+
+    const std::string index = (std::filesystem::path(directory) / kIndexName).string();
+    std::ofstream out(index);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + index);
+    }
+    out << j.dump(2);
+    return set;
+}
+
+}  // namespace sss
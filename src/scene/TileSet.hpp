@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Scene.hpp"
+
+namespace sss {
+
+/**
+ * One spatial tile of a tiled scene: a binary scene file plus the bounds
+ * of its gaussians' 3-sigma extents.
+ */
+struct TileInfo {
+    std::string file;            // relative to the tile set's directory
+    size_t count = 0;
+    glm::vec3 lo{0.f};
+    glm::vec3 hi{0.f};
+};
+
+/**
+ * A scene split into a grid of cubic tiles stored as separate binary
+ * (.sss) files, for maps too large to keep resident. The directory holds
+ * tiles.json, the index read here:
+ *
+ *   { "version": 1, "tile_size": 25.0, "sh_degree": 0, "sh_precision": "float",
+ *     "tiles": [ { "file": "tile_00000.sss", "count": N, "min": [x,y,z], "max": [x,y,z] } ] }
+ *
+ * Tiles are streamed in and out by TileResidency.
+ */
+struct TileSet {
+    std::string directory;
+    float tile_size = 0.f;
+    int sh_degree = 0;
+    ShPrecision sh_precision = ShPrecision::Float;
+    std::vector<TileInfo> tiles;
+
+    std::string tile_path(size_t tile) const;
+    size_t gaussian_count() const;
+
+    /**
+     * True if the path names a tile set directory or its tiles.json.
+     */
+    static bool is_tile_set(const std::string& path);
+
+    /**
+     * Read a tile set index (a directory or its tiles.json).
+     * Throws std::runtime_error if it is missing or malformed.
+     */
+    static TileSet load(const std::string& path);
+
+    /**
+     * Split a scene into tiles of `tile_size` world units by gaussian mean
+     * and write them, in the scene's instance format and SH layout, with
+     * their index into `directory` (created if needed).
+     */
+    static TileSet write(const Scene& scene, const std::string& directory, float tile_size);
+};
+
+}  // namespace sss
@@ -0,0 +1,188 @@
+#include "DatasetSource.hpp"
+#include "../core/Log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#include <stb_image.h>
+
+namespace sss {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Default intrinsics of each layout: the TUM ROS defaults (the
+// per-sequence calibration differs by a few pixels) and Replica's renders
+constexpr CameraIntrinsics kTumIntrinsics{525.f, 525.f, 319.5f, 239.5f};
+constexpr CameraIntrinsics kReplicaIntrinsics{600.f, 600.f, 599.5f, 339.5f};
+constexpr float kTumDepthScale = 1.f / 5000.f;
+constexpr float kReplicaDepthScale = 1.f / 6553.5f;
+
+struct Stamped {
+    double timestamp = 0.0;
+    std::string path;
+};
+
+// "timestamp path" lines of a TUM list; '#' starts a comment line
+std::vector<Stamped> read_list(const fs::path& file) {
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("Failed to open " + file.string());
+    }
+    std::vector<Stamped> entries;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        Stamped entry;
+        if (fields >> entry.timestamp >> entry.path) {
+            entries.push_back(std::move(entry));
+        }
+    }
+    return entries;
+}
+
+}  // namespace
+
+DatasetSource::DatasetSource(const std::string& directory) : m_directory(directory) {
+    const fs::path dir(directory);
+    if (fs::exists(dir / "rgb.txt") || fs::exists(dir / "associations.txt")) {
+        index_tum();
+    } else if (fs::is_directory(dir / "results")) {
+        index_replica();
+    } else {
+        throw std::runtime_error("Not a TUM or Replica dataset: " + directory);
+    }
+    if (m_frames.empty()) {
+        throw std::runtime_error("Dataset lists no frames: " + directory);
+    }
+}
+
+void DatasetSource::index_tum() {
+    m_layout = DatasetLayout::Tum;
+    m_intrinsics = kTumIntrinsics;
+    m_depth_scale = kTumDepthScale;
+    const fs::path dir(m_directory);
+
+    const fs::path associations = dir / "associations.txt";
+    if (fs::exists(associations)) {
+        std::ifstream in(associations);
+        if (!in) {
+            throw std::runtime_error("Failed to open " + associations.string());
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            Entry entry;
+            double depth_timestamp = 0.0;
+            if (fields >> entry.timestamp >> entry.rgb >> depth_timestamp >> entry.depth) {
+                m_frames.push_back(std::move(entry));
+            }
+        }
+        return;
+    }
+
+    const std::vector<Stamped> rgb = read_list(dir / "rgb.txt");
+    std::vector<Stamped> depth = read_list(dir / "depth.txt");
+    std::sort(depth.begin(), depth.end(),
+              [](const Stamped& a, const Stamped& b) { return a.timestamp < b.timestamp; });
+
+    size_t unmatched = 0;
+    for (const Stamped& color : rgb) {
+        // Nearest depth timestamp on either side
+        auto it = std::lower_bound(depth.begin(), depth.end(), color.timestamp,
+                                   [](const Stamped& d, double t) { return d.timestamp < t; });
+        const Stamped* best = nullptr;
+        if (it != depth.end()) {
+            best = &*it;
+        }
+        if (it != depth.begin() &&
+            (!best || color.timestamp - (it - 1)->timestamp < best->timestamp - color.timestamp)) {
+            best = &*(it - 1);
+        }
+        if (!best || std::abs(best->timestamp - color.timestamp) > kMaxAssociationGap) {
+            ++unmatched;
+            continue;
+        }
+        m_frames.push_back(Entry{color.timestamp, color.path, best->path});
+    }
+    if (unmatched > 0) {
+        SSS_LOG_WARN("[DatasetSource] %zu color frames have no depth within %.0f ms, skipped", unmatched,
+                     kMaxAssociationGap * 1000.0);
+    }
+}
+
+void DatasetSource::index_replica() {
+    m_layout = DatasetLayout::Replica;
+    m_intrinsics = kReplicaIntrinsics;
+    m_depth_scale = kReplicaDepthScale;
+
+    // frameNNNNNN.jpg with its depthNNNNNN.png, numbered from 0
+    const fs::path results = fs::path(m_directory) / "results";
+    char rgb_name[32];
+    char depth_name[32];
+    for (size_t i = 0;; ++i) {
+        std::snprintf(rgb_name, sizeof(rgb_name), "frame%06zu.jpg", i);
+        std::snprintf(depth_name, sizeof(depth_name), "depth%06zu.png", i);
+        if (!fs::exists(results / rgb_name)) {
+            break;
+        }
+        m_frames.push_back(Entry{(double)i / kReplicaHz, std::string("results/") + rgb_name,
+                                 fs::exists(results / depth_name) ? std::string("results/") + depth_name
+                                                                  : std::string()});
+    }
+}
+
+void DatasetSource::read(size_t index, RgbdFrame& out) {
+    if (index >= m_frames.size()) {
+        throw std::runtime_error("Frame " + std::to_string(index) + " is past the end of " + m_directory);
+    }
+    const Entry& entry = m_frames[index];
+    out.index = index;
+    out.timestamp = entry.timestamp;
+    out.depth_scale = m_depth_scale;
+
+    // assign() keeps the buffers' capacity, so steady-state reads don't
+    // grow the frame
+    const std::string rgb_path = (fs::path(m_directory) / entry.rgb).string();
+    int width = 0, height = 0, channels = 0;
+    stbi_uc* rgb = stbi_load(rgb_path.c_str(), &width, &height, &channels, 3);
+    if (!rgb) {
+        throw std::runtime_error("Failed to decode " + rgb_path + ": " + stbi_failure_reason());
+    }
+    out.width = width;
+    out.height = height;
+    out.rgb.assign(rgb, rgb + (size_t)width * height * 3);
+    stbi_image_free(rgb);
+
+    out.depth_width = 0;
+    out.depth_height = 0;
+    out.depth.clear();
+    if (entry.depth.empty()) {
+        return;
+    }
+    const std::string depth_path = (fs::path(m_directory) / entry.depth).string();
+    stbi_us* depth = stbi_load_16(depth_path.c_str(), &width, &height, &channels, 1);
+    if (!depth) {
+        throw std::runtime_error("Failed to decode " + depth_path + ": " + stbi_failure_reason());
+    }
+    out.depth_width = width;
+    out.depth_height = height;
+    out.depth.assign(depth, depth + (size_t)width * height);
+    stbi_image_free(depth);
+}
+
+}  // namespace sss
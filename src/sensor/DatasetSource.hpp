@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "FrameSource.hpp"
+
+namespace sss {
+
+enum class DatasetLayout {
+    Tum,       // rgb.txt + depth.txt (or associations.txt), 16-bit PNG depth at 5000 per meter
+    Replica,   // results/frameNNNNNN.jpg + results/depthNNNNNN.png at 6553.5 per meter
+};
+
+/**
+ * Recorded RGB-D sequence on disk, in the TUM RGB-D or the Replica
+ * (NICE-SLAM) layout. Color is PNG or JPEG, depth a 16-bit PNG.
+ *
+ * TUM color and depth are listed with their own timestamps. An
+ * associations.txt (timestamp rgb timestamp depth per line) is used as is.
+ * Otherwise each color image is paired with the nearest depth image
+ * within kMaxAssociationGap, as TUM's associate.py does, and color images
+ * without one are dropped. Replica frames have no timestamps and are
+ * numbered at kReplicaHz.
+ */
+class DatasetSource : public FrameSource {
+public:
+    static constexpr double kMaxAssociationGap = 0.02;   // seconds
+    static constexpr double kReplicaHz = 30.0;
+
+    /**
+     * Index the dataset in `directory`; images are read by read().
+     *
+     * @throws std::runtime_error if the directory matches neither layout or
+     *         lists no frames
+     */
+    explicit DatasetSource(const std::string& directory);
+
+    DatasetLayout layout() const { return m_layout; }
+    const std::string& directory() const { return m_directory; }
+
+    size_t frame_count() const override { return m_frames.size(); }
+    CameraIntrinsics intrinsics() const override { return m_intrinsics; }
+    void read(size_t index, RgbdFrame& out) override;
+
+private:
+    struct Entry {
+        double timestamp = 0.0;
+        std::string rgb;     // paths relative to m_directory
+        std::string depth;
+    };
+
+    std::string m_directory;
+    DatasetLayout m_layout = DatasetLayout::Tum;
+    std::vector<Entry> m_frames;
+    CameraIntrinsics m_intrinsics;
+    float m_depth_scale = 0.f;
+
+    void index_tum();
+    void index_replica();
+};
+
+}  // namespace sss
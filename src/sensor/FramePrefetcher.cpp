@@ -0,0 +1,120 @@
+#include "FramePrefetcher.hpp"
+#include "../core/Log.hpp"
+#include <algorithm>
+#include <exception>
+
+namespace sss {
+
+FramePrefetcher::FramePrefetcher(std::unique_ptr<FrameSource> source, size_t capacity, size_t decode_threads)
+    : m_source(std::move(source)),
+      m_count(m_source->frame_count()),
+      m_capacity(std::max(kMinCapacity, capacity)),
+      m_slots(std::make_unique<Slot[]>(m_capacity)),
+      m_decode(std::max<size_t>(1, decode_threads)) {
+    for (size_t i = 0; i < m_capacity; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for (size_t t = 0; t < m_decode.thread_count(); ++t) {
+        m_workers.push_back(m_decode.submit([this]() { decode_loop(); }));
+    }
+}
+
+FramePrefetcher::~FramePrefetcher() {
+    // Wake decoders waiting for a buffer; one mid-decode sees the flag
+    // when it finishes
+    m_stop.store(true, std::memory_order_release);
+    for (size_t i = 0; i < m_capacity; ++i) {
+        m_slots[i].sequence.store(kStopped, std::memory_order_release);
+        m_slots[i].sequence.notify_all();
+    }
+    for (std::future<void>& worker : m_workers) {
+        worker.wait();
+    }
+}
+
+void FramePrefetcher::decode_loop() {
+    for (;;) {
+        const size_t i = m_next_decode.fetch_add(1, std::memory_order_relaxed);
+        if (i >= m_count || m_stop.load(std::memory_order_acquire)) {
+            return;
+        }
+        Slot& slot = m_slots[i % m_capacity];
+
+        // Wait for the consumer to release frame i - capacity
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        while (sequence != i) {
+            if (sequence == kStopped) {
+                return;
+            }
+            slot.sequence.wait(sequence, std::memory_order_acquire);
+            sequence = slot.sequence.load(std::memory_order_acquire);
+        }
+
+        try {
+            m_source->read(i, slot.frame);
+            slot.ok = true;
+            m_decoded.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            SSS_LOG_WARN("[FramePrefetcher] Skipping frame %zu: %s", i, e.what());
+            slot.ok = false;
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Publish unless the destructor has stopped the ring meanwhile
+        uint64_t expected = i;
+        slot.sequence.compare_exchange_strong(expected, i + 1, std::memory_order_release, std::memory_order_relaxed);
+    }
+}
+
+const RgbdFrame* FramePrefetcher::try_acquire() {
+    while (m_read < m_count) {
+        Slot& slot = m_slots[m_read % m_capacity];
+        if (m_acquired) {
+            return &slot.frame;
+        }
+        if (slot.sequence.load(std::memory_order_acquire) != m_read + 1) {
+            ++m_empty_polls;
+            return nullptr;
+        }
+        if (slot.ok) {
+            m_acquired = true;
+            return &slot.frame;
+        }
+        // Failed frame: recycle its buffer and look at the next one
+        slot.sequence.store(m_read + m_capacity, std::memory_order_release);
+        slot.sequence.notify_all();
+        ++m_read;
+    }
+    return nullptr;
+}
+
+void FramePrefetcher::release() {
+    if (!m_acquired) {
+        return;
+    }
+    Slot& slot = m_slots[m_read % m_capacity];
+    m_acquired = false;
+    slot.sequence.store(m_read + m_capacity, std::memory_order_release);
+    slot.sequence.notify_all();
+    ++m_read;
+    ++m_consumed;
+}
+
+FramePrefetchStats FramePrefetcher::stats() const {
+    FramePrefetchStats s;
+    s.frames = m_count;
+    s.capacity = m_capacity;
+    for (size_t k = m_acquired ? 1 : 0; k < m_capacity && m_read + k < m_count; ++k) {
+        const uint64_t frame = m_read + k;
+        if (m_slots[frame % m_capacity].sequence.load(std::memory_order_acquire) != frame + 1) {
+            break;
+        }
+        ++s.ready;
+    }
+    s.decoded = m_decoded.load(std::memory_order_relaxed);
+    s.failed = m_failed.load(std::memory_order_relaxed);
+    s.consumed = m_consumed;
+    s.empty_polls = m_empty_polls;
+    return s;
+}
+
+}  // namespace sss
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+#include "FrameSource.hpp"
+#include "../core/ThreadPool.hpp"
+
+namespace sss {
+
+/**
+ * Snapshot of a FramePrefetcher (consumer thread only).
+ */
+struct FramePrefetchStats {
+    size_t frames = 0;        // in the sequence (FrameSource::kUnbounded if live)
+    size_t capacity = 0;      // frame buffers
+    size_t ready = 0;         // decoded, in order, waiting to be acquired
+    size_t decoded = 0;       // totals since creation
+    size_t failed = 0;        // frames that couldn't be read and were skipped
+    size_t consumed = 0;
+    size_t empty_polls = 0;   // try_acquire() calls that found the next frame not ready
+};
+
+/**
+ * Reads a FrameSource ahead of its consumer (the tracking thread), so it
+ * never waits on disk or image decoding.
+ *
+ * Frames are decoded on dedicated threads into a fixed ring of `capacity`
+ * reusable frame buffers. Frame i goes to buffer i % capacity once the
+ * consumer has released frame i - capacity. Each buffer carries a sequence
+ * number that hands it from decoder to consumer and back, as in a bounded
+ * MPMC queue, so neither side takes a lock. Decoders finish out of order,
+ * but the consumer sees frames in sequence order. Memory stays at
+ * `capacity` frames however long the sequence is.
+ *
+ * The ring has at least kMinCapacity buffers, and smaller capacities are
+ * raised to it. A single buffer would be overwritten while the consumer
+ * still holds its frame: "frame i ready" (i + 1) would equal "frame i + 1
+ * may be decoded" (i + capacity).
+ */
+class FramePrefetcher {
+public:
+    static constexpr size_t kMinCapacity = 2;
+    static constexpr size_t kDefaultCapacity = 8;
+    static constexpr size_t kDefaultDecodeThreads = 2;
+
+    FramePrefetcher(std::unique_ptr<FrameSource> source, size_t capacity = kDefaultCapacity,
+                    size_t decode_threads = kDefaultDecodeThreads);
+    ~FramePrefetcher();
+
+    FramePrefetcher(const FramePrefetcher&) = delete;
+    FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+    const FrameSource& source() const { return *m_source; }
+
+    /**
+     * The next frame in sequence order if it has been decoded, else nullptr;
+     * never waits. The frame stays valid until release(), and calling again
+     * before then returns the same frame. Frames that failed to decode are
+     * skipped.
+     */
+    const RgbdFrame* try_acquire();
+
+    /**
+     * Hand the acquired frame's buffer back for decoding a later frame.
+     */
+    void release();
+
+    // Every frame of a bounded source has been released or skipped
+    bool finished() const { return m_read >= m_count; }
+
+    FramePrefetchStats stats() const;
+
+private:
+    // Sequence value that tells decoders to exit
+    static constexpr uint64_t kStopped = UINT64_MAX;
+
+    struct Slot {
+        // Frame i may be decoded once this equals i, and acquired once it
+        // equals i + 1; release() sets it to i + capacity
+        std::atomic<uint64_t> sequence{0};
+        bool ok = false;
+        RgbdFrame frame;
+    };
+
+    std::unique_ptr<FrameSource> m_source;
+    size_t m_count = 0;
+    size_t m_capacity = 0;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<size_t> m_next_decode{0};
+    std::atomic<bool> m_stop{false};
+    std::atomic<size_t> m_decoded{0};
+    std::atomic<size_t> m_failed{0};
+
+    // Consumer only
+    size_t m_read = 0;
+    bool m_acquired = false;
+    size_t m_consumed = 0;
+    size_t m_empty_polls = 0;
+
+    ThreadPool m_decode;
+    std::vector<std::future<void>> m_workers;
+
+    void decode_loop();
+};
+
+}  // namespace sss
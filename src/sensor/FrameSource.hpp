@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sss {
+
+/**
+ * Pinhole intrinsics of a frame source's color camera, in pixels.
+ */
+struct CameraIntrinsics {
+    float fx = 0.f;
+    float fy = 0.f;
+    float cx = 0.f;
+    float cy = 0.f;
+};
+
+/**
+ * One decoded RGB-D frame. FramePrefetcher reuses its buffers for later
+ * frames, so consumers copy what they keep past release().
+ */
+struct RgbdFrame {
+    size_t index = 0;               // position in the sequence
+    double timestamp = 0.0;         // seconds
+    int width = 0;                  // color size
+    int height = 0;
+    std::vector<uint8_t> rgb;       // RGB8, rows top-down
+    int depth_width = 0;            // 0 if the frame has no depth
+    int depth_height = 0;
+    std::vector<uint16_t> depth;    // raw sensor units, 0 = no reading
+    float depth_scale = 0.f;        // meters per depth unit
+};
+
+/**
+ * A sequence of RGB-D frames: a recorded dataset, or a live camera.
+ */
+class FrameSource {
+public:
+    // frame_count() of a live source with no end
+    static constexpr size_t kUnbounded = SIZE_MAX;
+
+    virtual ~FrameSource() = default;
+
+    virtual size_t frame_count() const = 0;
+    virtual CameraIntrinsics intrinsics() const = 0;
+
+    /**
+     * Decode frame `index` into `out`, reusing its buffers. Called from
+     * decode threads, concurrently for different indices; a live source
+     * serializes internally and hands out frames in arrival order.
+     *
+     * @throws std::runtime_error if the frame can't be read
+     */
+    virtual void read(size_t index, RgbdFrame& out) = 0;
+};
+
+}  // namespace sss
@@ -3,8 +3,19 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <glfw/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
 #include "../core/Camera.hpp"
+#include "../core/FramePacer.hpp"
+#include "../core/Profiler.hpp"
 #include "../scene/Scene.hpp"
+#include "../scene/LodHierarchy.hpp"
+#include "../scene/SceneLoader.hpp"
+#include "../scene/SpatialIndex.hpp"
+#include "../scene/TileResidency.hpp"
+#include "../sensor/FramePrefetcher.hpp"
 #include "../render/Renderer.hpp"
 
 namespace sss {
@@ -28,7 +39,10 @@ void DebugUI::begin_frame() {
 }
 
 void DebugUI::render_debug_overlay(const Camera& camera, const Scene& scene,
-                                   const Renderer& renderer, const std::string& scene_path) {
+                                   Renderer& renderer, FramePacer& pacer,
+                                   const std::string& scene_path, const SceneLoadProgress& load,
+                                   const TileResidencyStats* residency,
+                                   const FramePrefetchStats* frames) {
     ImGui::Begin("Debug Overlay");
     
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
@@ -46,16 +60,191 @@ void DebugUI::render_debug_overlay(const Camera& camera, const Scene& scene,
     // Scene info
     ImGui::Text("Gaussians:  %zu", scene.gaussian_count());
     ImGui::Text("Scene:      %s", scene_path.c_str());
+    if (const SpatialIndex* index = scene.spatial_index()) {
+        if (index->size() < scene.gaussian_count()) {
+            ImGui::Text("BVH nodes:  %zu (%zu gaussians added since)", index->nodes().size(),
+                        scene.gaussian_count() - index->size());
+        } else {
+            ImGui::Text("BVH nodes:  %zu", index->nodes().size());
+        }
+    }
+
+    if (residency) {
+        ImGui::Text("Tiles:      %zu / %zu resident, %zu loading, %zu wanted", residency->resident, residency->tiles,
+                    residency->loading, residency->wanted);
+        const float used = residency->pages > 0 ? (float)residency->pages_used / (float)residency->pages : 0.f;
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "%zu / %zu pages", residency->pages_used, residency->pages);
+        ImGui::ProgressBar(used, ImVec2(-1.0f, 0.0f), overlay);
+        ImGui::Text("Paging:     %zu loads, %zu evictions (%zu per page)", residency->loads, residency->evictions,
+                    residency->page_gaussians);
+    }
+
+    if (frames) {
+        ImGui::Text("Frames:     %zu / %zu, %zu / %zu decoded ahead", frames->consumed, frames->frames, frames->ready,
+                    frames->capacity);
+        ImGui::Text("Decode:     %zu failed, %zu polls found nothing", frames->failed, frames->empty_polls);
+    }
+
+    if (load.failed) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Load failed: %s", load.error.c_str());
+    } else if (load.active && !load.done) {
+        char overlay[64];
+        if (load.total > 0) {
+            std::snprintf(overlay, sizeof(overlay), "%zu / %zu", load.loaded, load.total);
+        } else {
+            std::snprintf(overlay, sizeof(overlay), "%zu", load.loaded);
+        }
+        ImGui::Text("Loading:    %.1f s", load.seconds);
+        ImGui::ProgressBar(load.fraction, ImVec2(-1.0f, 0.0f), overlay);
+    } else if (load.done) {
+        ImGui::Text("Load time:  %.2f s", load.seconds);
+    }
 
     ImGui::Separator();
 
     // Renderer info
     ImGui::Text("Viewport:   %d x %d", renderer.viewport_width(), renderer.viewport_height());
+    if (renderer.backend() == RenderBackend::Tiles) {
+        ImGui::Text("Backend:    %s (%zu tile pairs)", render_backend_name(renderer.backend()),
+                    renderer.tile_pair_count());
+    } else {
+        ImGui::Text("Backend:    %s", render_backend_name(renderer.backend()));
+        ImGui::Text("Sorting:    %s", sort_mode_name(renderer.sort_mode()));
+    }
+    const InstanceFormat format = scene.instance_format();
+    ImGui::Text("Instances:  %s (%zu B each)", instance_format_name(format),
+                instance_stride(format) + (format == InstanceFormat::Full ? sizeof(GaussianCovarianceGPU) : 0));
+    const UploadRing& ring = renderer.upload_ring();
+    ImGui::Text("Uploads:    %.1f MB via %s ring, %llu stalls", (double)ring.bytes_uploaded() / (1024.0 * 1024.0),
+                ring.persistent() ? "persistent" : "orphaned", (unsigned long long)ring.stalls());
+    const FrameArenaStats arena = renderer.frame_arena_stats();
+    ImGui::Text("Arena:      %.1f KB last frame, %.1f KB peak, %.1f KB held", (double)arena.last_frame / 1024.0,
+                (double)arena.high_water / 1024.0, (double)arena.capacity / 1024.0);
+    if (renderer.culling_enabled()) {
+        ImGui::Text("Visible:    %zu / %zu (%s culling)", renderer.visible_count(), scene.gaussian_count(),
+                    cull_backend_name(SplatCuller::backend()));
+    } else {
+        ImGui::Text("Visible:    %zu (culling off)", renderer.visible_count());
+    }
+    if (renderer.culling_enabled() && renderer.lod_enabled() && scene.lod_hierarchy()) {
+        ImGui::Text("LOD:        %zu representatives (%.1f px error)", renderer.lod_count(), renderer.lod_error());
+    }
+    if (renderer.occlusion_available() && renderer.backend() == RenderBackend::Quads) {
+        bool occlusion = renderer.occlusion_enabled();
+        if (ImGui::Checkbox("Occlusion culling", &occlusion)) {
+            renderer.set_occlusion(occlusion);
+        }
+        const OcclusionStats occluded = renderer.occlusion_stats();
+        if (occlusion && occluded.chunks > 0) {
+            ImGui::Text("Occluded:   %zu / %zu chunks, %zu of %zu splats drawn", occluded.occluded_chunks,
+                        occluded.chunks, occluded.drawn, occluded.tested);
+        } else if (occlusion) {
+            ImGui::TextDisabled("Occluded:   needs a spatial index");
+        }
+    }
+    bool dynamic_resolution = renderer.dynamic_resolution();
+    if (ImGui::Checkbox("Dynamic resolution", &dynamic_resolution)) {
+        renderer.set_dynamic_resolution(dynamic_resolution);
+    }
+    if (dynamic_resolution) {
+        const float scale = renderer.render_scale();
+        ImGui::Text("Resolution: %.0f%% (%d x %d), %.2f ms GPU", scale * 100.f,
+                    (int)std::lround(renderer.viewport_width() * scale),
+                    (int)std::lround(renderer.viewport_height() * scale), renderer.scaled_frame_ms());
+        float target_ms = renderer.target_frame_ms();
+        if (ImGui::SliderFloat("Target GPU ms", &target_ms, 4.f, 33.f, "%.1f")) {
+            renderer.set_target_frame_ms(target_ms);
+        }
+    }
+    if (scene.sh_degree() > 0) {
+        const size_t sh_bytes = sh_word_count(renderer.sh_degree(), scene.sh_precision()) * sizeof(uint32_t);
+        ImGui::Text("SH:         degree %d of %d (%s, %zu B each)", renderer.sh_degree(), scene.sh_degree(),
+                    sh_precision_name(scene.sh_precision()), sh_bytes);
+        int max_degree = renderer.max_sh_degree();
+        if (ImGui::SliderInt("Max SH degree", &max_degree, 0, kMaxShDegree)) {
+            renderer.set_max_sh_degree(max_degree);
+        }
+    }
     ImGui::Text("Controls:   WASD, Q/E, hold RMB to look");
 
+    render_pacing(pacer);
+    render_profiler();
+
     ImGui::End();
 }
 
+void DebugUI::render_pacing(FramePacer& pacer) {
+    if (!ImGui::CollapsingHeader("Frame pacing")) {
+        return;
+    }
+    static const PresentMode modes[] = {PresentMode::Vsync, PresentMode::Uncapped, PresentMode::Fixed};
+    if (ImGui::BeginCombo("Present", present_mode_name(pacer.mode()))) {
+        for (PresentMode mode : modes) {
+            if (ImGui::Selectable(present_mode_name(mode), mode == pacer.mode())) {
+                pacer.set_mode(mode);
+            }
+        }
+        ImGui::EndCombo();
+    }
+    if (pacer.mode() == PresentMode::Fixed) {
+        float fps = pacer.target_fps();
+        if (ImGui::SliderFloat("Target FPS", &fps, 10.0f, 480.0f, "%.0f")) {
+            pacer.set_target_fps(fps);
+        }
+        ImGui::Text("Idle:       %.2f ms / frame", pacer.idle_ms());
+    }
+    ImGui::Text("Latency:    ~%.1f ms input to photon (%.1f ms to swap, %.0f Hz)",
+                pacer.latency_ms(), pacer.work_ms(), pacer.refresh_rate());
+}
+
+void DebugUI::render_profiler() {
+    Profiler& profiler = Profiler::instance();
+    if (!ImGui::CollapsingHeader("Profiler", ImGuiTreeNodeFlags_DefaultOpen)) {
+        return;
+    }
+    if (!SSS_PROFILER) {
+        ImGui::TextDisabled("Compiled out (SSS_ENABLE_PROFILER=OFF)");
+        return;
+    }
+    bool enabled = profiler.enabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        profiler.set_enabled(enabled);
+    }
+    if (!enabled) {
+        return;
+    }
+
+    const std::vector<float>& frames = profiler.frame_times();
+    char overlay[64];
+    std::snprintf(overlay, sizeof(overlay), "p50 %.2f ms  p99 %.2f ms", profiler.frame_p50(), profiler.frame_p99());
+    ImGui::PlotLines("##frame_times", frames.data(), (int)frames.size(), 0, overlay, 0.0f,
+                     std::max(33.3f, profiler.frame_p99() * 1.25f), ImVec2(-1.0f, 60.0f));
+
+    if (ImGui::BeginTable("passes", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        for (const Profiler::PassStats& pass : profiler.passes()) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", pass.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", pass.domain == Profiler::Domain::Gpu ? "GPU" : "CPU");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", pass.last_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", pass.p50_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", pass.p99_ms);
+        }
+        ImGui::EndTable();
+    }
+}
+
 void DebugUI::end_frame() {
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -8,6 +8,10 @@ namespace sss {
 class Scene;
 class Camera;
 class Renderer;
+class FramePacer;
+struct SceneLoadProgress;
+struct TileResidencyStats;
+struct FramePrefetchStats;
 
 class DebugUI {
 public:
@@ -28,10 +32,16 @@ public:
 
     /**
      * Render the debug overlay.
-     * Display camera info, scene stats, etc.
+     * Display camera info, scene stats, load progress, etc.
+     * The pacer's presentation mode and the renderer's SH degree cap can
+     * be changed from the overlay. `residency` is shown when a tile set is
+     * being streamed, `frames` when a dataset is playing.
      */
     void render_debug_overlay(const Camera& camera, const Scene& scene, 
-                             const Renderer& renderer, const std::string& scene_path);
+                             Renderer& renderer, FramePacer& pacer,
+                             const std::string& scene_path, const SceneLoadProgress& load,
+                             const TileResidencyStats* residency = nullptr,
+                             const FramePrefetchStats* frames = nullptr);
 
     /**
      * End the frame and submit UI to renderer.
@@ -46,6 +56,15 @@ public:
     void shutdown();
 
 private:
+    /**
+     * Presentation mode, frame-rate cap and latency estimate.
+     */
+    void render_pacing(FramePacer& pacer);
+
+    /**
+     * Frame-time graph and per-pass CPU/GPU breakdown.
+     */
+    void render_profiler();
 };
 
 }  // namespace sss
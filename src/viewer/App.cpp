@@ -2,21 +2,39 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
-#include <cstdio>
+#include <chrono>
 
 #include "../core/Camera.hpp"
+#include "../core/FramePacer.hpp"
 #include "../core/Time.hpp"
 #include "../core/Log.hpp"
+#include "../core/Profiler.hpp"
 #include "../scene/Scene.hpp"
-#include "../scene/SceneIO.hpp"
+#include "../scene/LodHierarchy.hpp"
+#include "../scene/SceneLoader.hpp"
+#include "../scene/SpatialIndex.hpp"
+#include "../scene/TileSet.hpp"
+#include "../core/ThreadPool.hpp"
 #include "../render/Renderer.hpp"
+#include "../sensor/DatasetSource.hpp"
 #include "../ui/DebugUI.hpp"
 
 namespace sss {
 
+// Mapped scenes are compacted at most this often
+static constexpr double kCompactionSeconds = 30.0;
+
 // GLFW error callback
 static void glfw_error_cb(int error, const char* desc) {
-    std::fprintf(stderr, "GLFW error %d: %s\n", error, desc ? desc : "(null)");
+    SSS_LOG_ERROR("GLFW error %d: %s", error, desc ? desc : "(null)");
+}
+
+// GLFW framebuffer resize callback; forwards to the owning App
+static void glfw_framebuffer_size_cb(GLFWwindow* window, int width, int height) {
+    auto* app = static_cast<App*>(glfwGetWindowUserPointer(window));
+    if (app) {
+        app->on_framebuffer_resize(width, height);
+    }
 }
 
 App::App() = default;
@@ -26,36 +44,44 @@ App::~App() {
 }
 
 bool App::init(int width, int height, const char* title) {
+    Log::init();
+
     // Initialize GLFW
     glfwSetErrorCallback(glfw_error_cb);
     if (!glfwInit()) {
-        std::fprintf(stderr, "Failed to initialize GLFW\n");
+        SSS_LOG_ERROR("Failed to initialize GLFW");
         return false;
     }
 
-    // Configure OpenGL context
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Configure OpenGL context. Prefer 4.3 core for compute shaders (GPU
+    // splat sorting); fall back to 3.3 core where that is unavailable.
+    const int gl_versions[][2] = {{4, 3}, {3, 3}};
+    for (const auto& version : gl_versions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #if __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
-    // Create window
-    m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+        // Create window
+        m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+        if (m_window) {
+            break;
+        }
+    }
     if (!m_window) {
-        std::fprintf(stderr, "Failed to create GLFW window\n");
+        SSS_LOG_ERROR("Failed to create GLFW window");
         glfwTerminate();
         return false;
     }
 
     glfwMakeContextCurrent(m_window);
-    glfwSwapInterval(1); // vsync
 
     // Load OpenGL functions
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::fprintf(stderr, "Failed to load OpenGL via GLAD\n");
+        SSS_LOG_ERROR("Failed to load OpenGL via GLAD");
         glfwDestroyWindow(m_window);
         glfwTerminate();
         return false;
@@ -64,52 +90,149 @@ bool App::init(int width, int height, const char* title) {
     // Initialize subsystems
     Time::init();
 
+    // Vsync until told otherwise; the swap interval is applied in run()
+    m_pacer = std::make_unique<FramePacer>();
+    if (const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor())) {
+        m_pacer->set_refresh_rate((float)mode->refreshRate);
+    }
+
     m_camera = std::make_unique<Camera>();
     m_scene = std::make_unique<Scene>();
+    m_loader = std::make_unique<SceneLoader>();
+    m_updates = std::make_unique<SceneUpdateQueue>();
+    m_compactor = std::make_unique<MapCompactor>();
+    m_rebuilder = std::make_unique<IndexRebuilder>();
+    // Size the renderer by framebuffer pixels, which differ from window
+    // coordinates on high-DPI displays
+    int fbw = width, fbh = height;
+    glfwGetFramebufferSize(m_window, &fbw, &fbh);
+
     m_renderer = std::make_unique<Renderer>();
-    m_renderer->init(width, height);
+    m_renderer->init(fbw, fbh);
+    // Trade resolution for frame rate on scenes too heavy for the GPU
+    m_renderer->set_dynamic_resolution(true);
     m_debug_ui = std::make_unique<DebugUI>();
     m_debug_ui->init(m_window);
 
-    std::fprintf(stdout, "[App] Initialization complete, GL version: %s\n", glGetString(GL_VERSION));
+    glfwSetWindowUserPointer(m_window, this);
+    glfwSetFramebufferSizeCallback(m_window, glfw_framebuffer_size_cb);
+
+    SSS_LOG_INFO("[App] Initialization complete, GL version: %s", (const char*)glGetString(GL_VERSION));
 
     return true;
 }
 
-bool App::load_scene(const std::string& filepath) {
+bool App::load_scene(const std::string& filepath, InstanceFormat format, ShPrecision sh_precision) {
+    if (TileSet::is_tile_set(filepath)) {
+        return load_tile_set(filepath, format, sh_precision);
+    }
     try {
-        *m_scene = SceneIO::load_scene_json(filepath);
+        // Opening and header checks happen here; decoding continues on
+        // worker threads and is picked up by poll_scene_loader()
+        m_loader->start(filepath, format);
+        m_tiles.reset();
+        m_scene->clear();
+        m_updates->reset(0);
+        m_compactor = std::make_unique<MapCompactor>();   // drops a plan for the old scene
+        m_rebuilder = std::make_unique<IndexRebuilder>();
+        m_compacted_batches = m_updates->stats().applied;
+        m_scene->set_sh_precision(sh_precision);
         m_scene_path = filepath;
-        std::fprintf(stdout, "[App] Loaded %zu gaussians from %s\n", m_scene->gaussian_count(), filepath.c_str());
+        m_load_reported = false;
+        SSS_LOG_INFO("[App] Loading %s in the background", filepath.c_str());
+        return true;
+    } catch (const std::exception& e) {
+        SSS_LOG_ERROR("[App] Scene load error: %s", e.what());
+        return false;
+    }
+}
+
+bool App::load_tile_set(const std::string& path, InstanceFormat format, ShPrecision sh_precision) {
+    try {
+        TileSet tiles = TileSet::load(path);
+        tiles.sh_precision = sh_precision;   // tiles are converted as they load
+
+        // Size the page pool from what one resident gaussian costs on the GPU
+        const size_t gaussian_bytes = instance_stride(format) +
+                                      (format == InstanceFormat::Full ? sizeof(GaussianCovarianceGPU) : 0) +
+                                      sh_word_count(tiles.sh_degree, sh_precision) * sizeof(uint32_t);
+        auto residency = std::make_unique<TileResidency>(std::move(tiles), m_vram_budget / gaussian_bytes);
+
+        m_loader->cancel();
+        m_updates->reset(0);
+        m_compactor = std::make_unique<MapCompactor>();
+        m_rebuilder = std::make_unique<IndexRebuilder>();
+        m_scene->set_instance_format(format);
+        residency->init_scene(*m_scene);
+        m_tiles = std::move(residency);
+        m_last_camera_position = m_camera->position;
+        m_scene_path = path;
+        m_load_reported = true;
+
+        const TileSet& set = m_tiles->tiles();
+        SSS_LOG_INFO("[App] Streaming %zu gaussians in %zu tiles from %s (%zu resident slots, %.0f MB)",
+                     set.gaussian_count(), set.tiles.size(), path.c_str(), m_tiles->capacity(),
+                     (double)(m_tiles->capacity() * gaussian_bytes) / (1024.0 * 1024.0));
+        return true;
+    } catch (const std::exception& e) {
+        SSS_LOG_ERROR("[App] Scene load error: %s", e.what());
+        return false;
+    }
+}
+
+bool App::open_dataset(const std::string& directory) {
+    try {
+        auto source = std::make_unique<DatasetSource>(directory);
+        SSS_LOG_INFO("[App] Playing %zu %s frames from %s", source->frame_count(),
+                     source->layout() == DatasetLayout::Tum ? "TUM" : "Replica", directory.c_str());
+        m_frames = std::make_unique<FramePrefetcher>(std::move(source));
         return true;
     } catch (const std::exception& e) {
-        std::fprintf(stderr, "[App] Scene load error: %s\n", e.what());
+        SSS_LOG_ERROR("[App] Dataset error: %s", e.what());
         return false;
     }
 }
 
 void App::run() {
-    std::fprintf(stdout, "[App] Entering render loop...\n");
+    SSS_LOG_INFO("[App] Entering render loop...");
 
     while (!should_close()) {
+        Profiler::instance().new_frame();
+
+        // The mode can change from the overlay; swap control follows it
+        if (m_pacer->swap_interval() != m_swap_interval) {
+            m_swap_interval = m_pacer->swap_interval();
+            glfwSwapInterval(m_swap_interval);
+        }
+
+        // Idle before sampling input, so a frame-rate cap delays the
+        // frame rather than the input it reacts to
+        {
+            SSS_PROFILE_SCOPE("Pacing");
+            m_pacer->wait();
+        }
+
         glfwPollEvents();
+        m_pacer->mark_input();
 
         Time::tick();
         float dt = Time::delta_time();
 
-        // Update viewport
-        int fbw = 1, fbh = 1;
-        glfwGetFramebufferSize(m_window, &fbw, &fbh);
-        m_renderer->init(fbw, fbh);
-
-        handle_input();
-        update(dt);
+        {
+            SSS_PROFILE_SCOPE("Update");
+            handle_input();
+            update(dt);
+        }
         render();
 
-        glfwSwapBuffers(m_window);
+        {
+            SSS_PROFILE_SCOPE("Swap");
+            glfwSwapBuffers(m_window);
+        }
+        m_pacer->mark_presented();
     }
 
-    std::fprintf(stdout, "[App] Exiting render loop\n");
+    SSS_LOG_INFO("[App] Exiting render loop");
 }
 
 void App::shutdown() {
@@ -117,17 +240,37 @@ void App::shutdown() {
         m_debug_ui->shutdown();
     }
 
+    // Stop loader threads before the scene they fill goes away
+    m_loader.reset();
+    m_tiles.reset();
+    m_frames.reset();
+
     m_renderer.reset();
+    m_compactor.reset();
+    m_rebuilder.reset();
+    m_updates.reset();
     m_scene.reset();
     m_camera.reset();
     m_debug_ui.reset();
+    m_pacer.reset();
 
     if (m_window) {
+        glfwSetFramebufferSizeCallback(m_window, nullptr);
+        glfwSetWindowUserPointer(m_window, nullptr);
         glfwDestroyWindow(m_window);
         m_window = nullptr;
     }
 
     glfwTerminate();
+    Log::shutdown();
+}
+
+void App::on_framebuffer_resize(int width, int height) {
+    // Minimized windows report a zero-sized framebuffer; keep the last size
+    if (width <= 0 || height <= 0 || !m_renderer) {
+        return;
+    }
+    m_renderer->resize(width, height);
 }
 
 bool App::should_close() const {
@@ -172,8 +315,116 @@ void App::handle_input() {
 }
 
 void App::update(float dt) {
-    // Game logic updates go here
-    (void)dt; // unused for now
+    poll_frames();
+    if (m_tiles) {
+        update_tiles(dt);
+        return;
+    }
+    poll_scene_loader();
+    apply_scene_updates();
+}
+
+void App::poll_frames() {
+    if (!m_frames) {
+        return;
+    }
+    // Tracking goes here; until then each frame is taken and handed back
+    if (m_frames->try_acquire()) {
+        m_frames->release();
+    }
+}
+
+void App::update_tiles(float dt) {
+    // Prefetch along the camera's current motion
+    const glm::vec3 velocity = dt > 0.f ? (m_camera->position - m_last_camera_position) / dt : glm::vec3(0.f);
+    m_last_camera_position = m_camera->position;
+
+    m_tiles->update(m_camera->position, velocity, *m_scene, m_tile_ranges, &m_renderer->frame_arena());
+    if (!m_tile_ranges.empty()) {
+        m_renderer->upload_instance_ranges(*m_scene, m_tile_ranges);
+    }
+}
+
+void App::poll_scene_loader() {
+    // Binary chunks arrive already packed and go straight to the GPU;
+    // everything else is marked dirty and packed by the renderer
+    m_packed_ranges.clear();
+    m_loader->poll(*m_scene, &m_packed_ranges);
+    for (const SceneLoader::PackedRange& range : m_packed_ranges) {
+        if (range.compact) {
+            m_renderer->upload_packed_instances(*m_scene, range.first, range.compact, range.count);
+        } else {
+            m_renderer->upload_packed_instances(*m_scene, range.first, range.instances, range.count);
+        }
+    }
+
+    if (m_load_reported) {
+        return;
+    }
+    const SceneLoadProgress progress = m_loader->progress();
+    if (progress.failed) {
+        SSS_LOG_ERROR("[App] Scene load error: %s", progress.error.c_str());
+        m_load_reported = true;
+    } else if (progress.done) {
+        SSS_LOG_INFO("[App] Loaded %zu gaussians from %s in %.2f s",
+                     progress.loaded, progress.filepath.c_str(), progress.seconds);
+        m_load_reported = true;
+
+        // Built once the scene is complete; culling switches to the
+        // hierarchy and the LOD cut on the next frame
+        auto start = std::chrono::steady_clock::now();
+        m_scene->build_spatial_index(&ThreadPool::shared());
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        SSS_LOG_INFO("[App] Built spatial index (%zu nodes) in %.0f ms",
+                     m_scene->spatial_index()->nodes().size(), ms);
+
+        start = std::chrono::steady_clock::now();
+        m_scene->build_lod_hierarchy(&ThreadPool::shared());
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        SSS_LOG_INFO("[App] Built LOD hierarchy (%zu representatives) in %.0f ms",
+                     m_scene->lod_hierarchy()->size(), ms);
+
+        // Mapping inserts go after the loaded gaussians
+        m_updates->reset(m_scene->gaussian_count());
+    }
+}
+
+void App::apply_scene_updates() {
+    // Loaded chunks land at fixed indices; edits wait until they are all in
+    if (m_loader->busy()) {
+        return;
+    }
+    if (m_updates->apply(*m_scene, m_update_ranges) > 0) {
+        m_renderer->upload_instance_ranges(*m_scene, m_update_ranges);
+    }
+
+    // Now and then, once mapping has added or changed something; the
+    // renderer uploads the compacted range with the next frame. Tile set
+    // slots are pages, and stay put.
+    if (m_compactor->ready()) {
+        m_compactor->commit(*m_scene);
+    } else if (!m_compactor->pending() && !m_tiles) {
+        const size_t applied = m_updates->stats().applied;
+        const double now = Time::now();
+        if (applied != m_compacted_batches && now - m_last_compaction >= kCompactionSeconds) {
+            m_compactor->start(*m_scene);
+            m_compacted_batches = applied;
+            m_last_compaction = now;
+        }
+    }
+
+    // Compaction moves slots, which leaves the index and LOD hierarchy
+    // stale, and inserts pile up outside the refitted index; either way,
+    // build fresh ones in the background as at load time and swap them in.
+    // A build the compaction overtook is dropped and started again. Tile
+    // set slots are pages of the resident pool, so they are never indexed
+    // or compacted.
+    if (m_rebuilder->ready()) {
+        m_rebuilder->commit(*m_scene);
+    }
+    if (!m_rebuilder->pending() && !m_tiles && IndexRebuilder::needed(*m_scene)) {
+        m_rebuilder->start(*m_scene);
+    }
 }
 
 void App::render() {
@@ -181,8 +432,13 @@ void App::render() {
     m_renderer->render_scene(*m_scene, m_camera->view(), m_camera->projection(m_renderer->aspect_ratio()));
 
     // UI overlay
+    SSS_PROFILE_SCOPE("UI");
+    SSS_GPU_SCOPE(m_renderer->gpu_timer(), "UI");
     m_debug_ui->begin_frame();
-    m_debug_ui->render_debug_overlay(*m_camera, *m_scene, *m_renderer, m_scene_path);
+    const TileResidencyStats residency = m_tiles ? m_tiles->stats() : TileResidencyStats{};
+    const FramePrefetchStats frames = m_frames ? m_frames->stats() : FramePrefetchStats{};
+    m_debug_ui->render_debug_overlay(*m_camera, *m_scene, *m_renderer, *m_pacer, m_scene_path, m_loader->progress(),
+                                     m_tiles ? &residency : nullptr, m_frames ? &frames : nullptr);
     m_debug_ui->end_frame();
 }
 
@@ -2,15 +2,22 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include "../scene/IndexRebuilder.hpp"
+#include "../scene/MapCompactor.hpp"
+#include "../scene/SceneLoader.hpp"
+#include "../scene/SceneUpdates.hpp"
+#include "../scene/TileResidency.hpp"
+#include "../sensor/FramePrefetcher.hpp"
 
 struct GLFWwindow;
 
 namespace sss {
 
 class Camera;
-class Scene;
 class Renderer;
 class DebugUI;
+class FramePacer;
 
 class App {
 public:
@@ -29,12 +36,36 @@ public:
     bool init(int width, int height, const char* title);
 
     /**
-     * Load a scene from a JSON file.
+     * Start loading a scene (JSON, binary .sss or 3DGS .ply) in the background.
+     * The render loop shows gaussians as their chunks arrive.
+     *
+     * A tile set (a directory written by TileSet::write(), or its
+     * tiles.json) is streamed instead: only the tiles around the camera
+     * are kept resident, within the VRAM budget.
      * 
-     * @param filepath Path to the scene JSON file
-     * @return true if load successful
+     * @param filepath Path to the scene file
+     * @param format Instance layout to draw the scene with
+     * @param sh_precision Storage precision of the scene's SH coefficients
+     * @return true if the file was opened and loading has started
      */
-    bool load_scene(const std::string& filepath);
+    bool load_scene(const std::string& filepath, InstanceFormat format = InstanceFormat::Full,
+                    ShPrecision sh_precision = ShPrecision::Float);
+
+    /**
+     * GPU memory for the resident tiles of a tile set, in bytes (instances,
+     * covariances and SH). Applies to the next load_scene().
+     */
+    void set_vram_budget(size_t bytes) { m_vram_budget = bytes; }
+    size_t vram_budget() const { return m_vram_budget; }
+
+    /**
+     * Open a TUM or Replica RGB-D dataset and start decoding it ahead of
+     * the frame loop, which takes one decoded frame per frame without
+     * waiting for it (a stand-in for the tracker).
+     *
+     * @return true if the dataset was indexed
+     */
+    bool open_dataset(const std::string& directory);
 
     /**
      * Run the main event loop.
@@ -53,13 +84,56 @@ public:
      */
     bool should_close() const;
 
+    /**
+     * Handle a framebuffer size change (called from the GLFW callback).
+     */
+    void on_framebuffer_resize(int width, int height);
+
+    /**
+     * Presentation mode and frame-rate limiter; valid after init().
+     */
+    FramePacer& pacer() { return *m_pacer; }
+
+    /**
+     * The scene renderer; valid after init().
+     */
+    Renderer& renderer() { return *m_renderer; }
+
+    /**
+     * Queue for mapping threads to publish scene edits into, drained at the
+     * start of every frame. Loading a scene resets it: batches published
+     * before the load completes are dropped, and inserts are numbered after
+     * the loaded gaussians. While edits arrive the map is compacted in the
+     * background every so often (MapCompactor); indices are scene IDs, so
+     * they survive that. The spatial index and LOD hierarchy are refitted
+     * to each batch and rebuilt in the background (IndexRebuilder) once
+     * enough inserts fall outside them. Valid after init().
+     */
+    SceneUpdateQueue& scene_updates() { return *m_updates; }
+
 private:
     GLFWwindow* m_window = nullptr;
     std::unique_ptr<Camera> m_camera;
     std::unique_ptr<Scene> m_scene;
     std::unique_ptr<Renderer> m_renderer;
     std::unique_ptr<DebugUI> m_debug_ui;
+    std::unique_ptr<SceneLoader> m_loader;
+    std::unique_ptr<SceneUpdateQueue> m_updates;
+    std::unique_ptr<MapCompactor> m_compactor;
+    std::unique_ptr<IndexRebuilder> m_rebuilder;
+    size_t m_compacted_batches = 0;    // update batches applied when the last compaction started
+    double m_last_compaction = 0.0;    // Time::now() then
+    std::unique_ptr<FramePacer> m_pacer;
+    std::unique_ptr<TileResidency> m_tiles;                  // set while streaming a tile set
+    std::unique_ptr<FramePrefetcher> m_frames;               // set while playing a dataset
+    int m_swap_interval = -1;   // last value applied to the context
+    std::vector<SceneLoader::PackedRange> m_packed_ranges;   // reused per frame
+    std::vector<DirtyRange> m_update_ranges;                 // reused per frame
+    std::vector<DirtyRange> m_tile_ranges;                   // reused per frame
+    glm::vec3 m_last_camera_position{0.f};
+    size_t m_vram_budget = size_t(1024) << 20;
     std::string m_scene_path;
+    bool m_load_reported = true;
 
     bool m_mouse_captured = false;
     double m_last_mouse_x = 0.0;
@@ -67,6 +141,11 @@ private:
 
     void handle_input();
     void update(float dt);
+    void poll_scene_loader();
+    void apply_scene_updates();
+    void update_tiles(float dt);
+    void poll_frames();
+    bool load_tile_set(const std::string& path, InstanceFormat format, ShPrecision sh_precision);
     void render();
 };
 
@@ -0,0 +1,33 @@
+#pragma once
+
+// Minimal assertion harness shared by the unit tests: CHECK() records a
+// failure and carries on, and main() returns check_report() so ctest sees
+// the outcome.
+#include <cstdio>
+
+namespace sss_test {
+
+inline int g_failures = 0;
+
+/**
+ * Print a summary for test `name`; returns its process exit code.
+ */
+inline int check_report(const char* name) {
+    if (g_failures) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, g_failures);
+        return 1;
+    }
+    std::printf("%s: ok\n", name);
+    return 0;
+}
+
+}  // namespace sss_test
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            ++sss_test::g_failures;                                        \
+        }                                                                  \
+    } while (0)
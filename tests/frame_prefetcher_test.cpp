@@ -0,0 +1,89 @@
+// A frame held by the consumer keeps its contents while the decoders run
+// ahead, down to the smallest ring.
+#include "sensor/FramePrefetcher.hpp"
+#include "sensor/FrameSource.hpp"
+#include "check.hpp"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Frames whose pixels and depth all carry their index
+class CountingSource : public sss::FrameSource {
+public:
+    explicit CountingSource(size_t frames) : m_frames(frames) {}
+
+    size_t frame_count() const override { return m_frames; }
+    sss::CameraIntrinsics intrinsics() const override { return {}; }
+
+    void read(size_t index, sss::RgbdFrame& out) override {
+        out.index = index;
+        out.timestamp = (double)index;
+        out.width = out.depth_width = 16;
+        out.height = out.depth_height = 8;
+        out.rgb.assign((size_t)out.width * out.height * 3, (uint8_t)index);
+        out.depth.assign((size_t)out.depth_width * out.depth_height, (uint16_t)index);
+    }
+
+private:
+    size_t m_frames;
+};
+
+bool holds(const sss::RgbdFrame& frame, size_t index) {
+    if (frame.index != index || frame.timestamp != (double)index) {
+        return false;
+    }
+    for (uint8_t v : frame.rgb) {
+        if (v != (uint8_t)index) {
+            return false;
+        }
+    }
+    for (uint16_t v : frame.depth) {
+        if (v != (uint16_t)index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const sss::RgbdFrame* acquire(sss::FramePrefetcher& frames) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    const sss::RgbdFrame* frame = frames.try_acquire();
+    while (!frame && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+        frame = frames.try_acquire();
+    }
+    return frame;
+}
+
+void test_held_frame_intact(size_t capacity) {
+    const size_t count = 32;
+    sss::FramePrefetcher frames(std::make_unique<CountingSource>(count), capacity, 2);
+    CHECK(frames.stats().capacity >= sss::FramePrefetcher::kMinCapacity);
+
+    for (size_t i = 0; i < count; ++i) {
+        const sss::RgbdFrame* frame = acquire(frames);
+        CHECK(frame != nullptr);
+        if (!frame) {
+            return;
+        }
+        // Give the decoders time to fill every free buffer
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        CHECK(holds(*frame, i));
+        CHECK(frames.try_acquire() == frame);
+        frames.release();
+    }
+    CHECK(frames.finished());
+    CHECK(frames.stats().consumed == count);
+}
+
+}  // namespace
+
+int main() {
+    test_held_frame_intact(1);
+    test_held_frame_intact(2);
+    test_held_frame_intact(sss::FramePrefetcher::kDefaultCapacity);
+    return sss_test::check_report("frame_prefetcher_test");
+}
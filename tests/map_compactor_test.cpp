@@ -0,0 +1,192 @@
+// Scene::compact() keeps every surviving gaussian under its ID, edits to
+// removed IDs bring them back, and MapCompactor re-checks its plan against
+// edits made after the snapshot.
+#include "scene/MapCompactor.hpp"
+#include "scene/Scene.hpp"
+#include "scene/SceneUpdates.hpp"
+#include "check.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Gaussian `i` sits at x = i, so its mean tells which one it is
+sss::Gaussian3D make_gaussian(float x, float opacity = 0.8f) {
+    sss::Gaussian3D g;
+    g.mean = glm::vec3(x, 0.0f, 0.0f);
+    g.scale = glm::vec3(0.05f);
+    g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    g.opacity = opacity;
+    g.color = glm::vec3(0.5f);
+    return g;
+}
+
+sss::Scene make_line(size_t count) {
+    std::vector<sss::Gaussian3D> gaussians;
+    for (size_t i = 0; i < count; ++i) {
+        gaussians.push_back(make_gaussian((float)i));
+    }
+    sss::Scene scene;
+    scene.set_gaussians(gaussians);
+    return scene;
+}
+
+// Every third gaussian, starting with the first
+std::vector<uint8_t> every_third(size_t count) {
+    std::vector<uint8_t> remove(count, 0);
+    for (size_t i = 0; i < count; i += 3) {
+        remove[i] = 1;
+    }
+    return remove;
+}
+
+void test_compact_keeps_ids() {
+    const size_t count = 100;
+    sss::Scene scene = make_line(count);
+    for (size_t slot = 0; slot < count; ++slot) {
+        CHECK(scene.id_of(slot) == slot);
+        CHECK(scene.slot_of((uint32_t)slot) == slot);
+    }
+
+    const std::vector<uint8_t> remove = every_third(count);
+    const size_t removed = scene.compact(remove);
+    CHECK(removed == 34);
+    CHECK(scene.gaussian_count() == count - removed);
+    CHECK(scene.id_count() == count);
+
+    // Slot -> ID -> slot, and each survivor is still the gaussian its ID named
+    for (size_t slot = 0; slot < scene.gaussian_count(); ++slot) {
+        const uint32_t id = scene.id_of(slot);
+        CHECK(id < count && !remove[id]);
+        CHECK(scene.slot_of(id) == slot);
+        CHECK(scene.means()[slot].x == (float)id);
+    }
+    for (uint32_t id = 0; id < count; ++id) {
+        CHECK((scene.slot_of(id) == sss::Scene::kNoSlot) == (remove[id] != 0));
+    }
+    CHECK(scene.slot_of((uint32_t)count) == sss::Scene::kNoSlot);
+
+    // New gaussians get new IDs, never a removed one
+    scene.add_gaussian(make_gaussian(1000.0f));
+    const size_t last = scene.gaussian_count() - 1;
+    CHECK(scene.id_of(last) == count);
+    CHECK(scene.slot_of((uint32_t)count) == last);
+    CHECK(scene.id_count() == count + 1);
+
+    // A second compaction keeps the mapping consistent
+    std::vector<uint8_t> again(scene.gaussian_count(), 0);
+    again[0] = 1;
+    const uint32_t gone = scene.id_of(0);
+    CHECK(scene.compact(again) == 1);
+    CHECK(scene.slot_of(gone) == sss::Scene::kNoSlot);
+    for (size_t slot = 0; slot < scene.gaussian_count(); ++slot) {
+        CHECK(scene.slot_of(scene.id_of(slot)) == slot);
+    }
+}
+
+void test_update_revives_removed_id() {
+    const size_t count = 30;
+    sss::Scene scene = make_line(count);
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+    scene.compact(every_third(count));
+    const size_t kept = scene.gaussian_count();
+
+    // ID 3 was compacted away; a mapper still holding it edits it
+    CHECK(scene.slot_of(3) == sss::Scene::kNoSlot);
+    sss::SceneUpdate update;
+    update.update(3, make_gaussian(-3.0f));
+    update.update(4, make_gaussian(-4.0f));
+    queue.publish(std::move(update));
+    std::vector<sss::DirtyRange> runs;
+    CHECK(queue.apply(scene, runs) == 1);
+
+    CHECK(queue.stats().revived == 1);
+    CHECK(scene.gaussian_count() == kept + 1);
+    CHECK(scene.id_count() == count);
+    const uint32_t slot = scene.slot_of(3);
+    CHECK(slot != sss::Scene::kNoSlot);
+    if (slot != sss::Scene::kNoSlot) {
+        CHECK(scene.id_of(slot) == 3);
+        CHECK(scene.means()[slot].x == -3.0f);
+    }
+    CHECK(scene.means()[scene.slot_of(4)].x == -4.0f);
+
+    // Pruning an ID that is already gone leaves the scene alone
+    sss::SceneUpdate prune;
+    prune.pruned.push_back(6);
+    queue.publish(std::move(prune));
+    CHECK(queue.apply(scene, runs) == 1);
+    CHECK(scene.gaussian_count() == kept + 1);
+    CHECK(scene.slot_of(6) == sss::Scene::kNoSlot);
+
+    // Inserts are numbered after every ID handed out, removed ones included
+    sss::SceneUpdate insert;
+    insert.inserted.push_back(make_gaussian(100.0f));
+    CHECK(queue.publish(std::move(insert)) == count);
+    CHECK(queue.apply(scene, runs) == 1);
+    CHECK(scene.slot_of((uint32_t)count) != sss::Scene::kNoSlot);
+    CHECK(scene.id_count() == count + 1);
+}
+
+void test_plan_rechecked_at_commit() {
+    const size_t count = 64;
+    sss::Scene scene = make_line(count);
+    // Four nearly transparent gaussians to prune
+    const uint32_t faint[] = {5, 17, 40, 63};
+    for (uint32_t id : faint) {
+        scene.set_gaussian(id, make_gaussian((float)id, 0.001f));
+    }
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+
+    sss::CompactionParams params;
+    params.merge_distance = 0.0f;   // pruning only, so the counts are exact
+    sss::MapCompactor compactor(params);
+    CHECK(compactor.start(scene));
+    CHECK(compactor.pending());
+
+    // After the snapshot: one candidate becomes opaque again, and a
+    // gaussian the plan never saw is pruned to a tombstone
+    sss::SceneUpdate update;
+    update.update(17, make_gaussian(17.0f));
+    update.pruned.push_back(30);
+    queue.publish(std::move(update));
+    std::vector<sss::DirtyRange> runs;
+    CHECK(queue.apply(scene, runs) == 1);
+
+    const sss::CompactionStats stats = compactor.commit(scene);
+    CHECK(!compactor.pending());
+    CHECK(stats.before == count);
+    CHECK(stats.pruned == 3);
+    CHECK(stats.skipped == 1);
+    CHECK(stats.merged == 0);
+    CHECK(stats.after == count - 3);
+    CHECK(scene.gaussian_count() == count - 3);
+
+    CHECK(scene.slot_of(5) == sss::Scene::kNoSlot);
+    CHECK(scene.slot_of(40) == sss::Scene::kNoSlot);
+    CHECK(scene.slot_of(63) == sss::Scene::kNoSlot);
+    const uint32_t kept = scene.slot_of(17);
+    CHECK(kept != sss::Scene::kNoSlot);
+    if (kept != sss::Scene::kNoSlot) {
+        CHECK(scene.opacities()[kept] > 0.5f);
+    }
+
+    // The tombstone was not in the plan; the next run removes it
+    const uint32_t tombstone = scene.slot_of(30);
+    CHECK(tombstone != sss::Scene::kNoSlot);
+    CHECK(compactor.start(scene));
+    const sss::CompactionStats next = compactor.commit(scene);
+    CHECK(next.pruned == 1);
+    CHECK(scene.slot_of(30) == sss::Scene::kNoSlot);
+}
+
+}  // namespace
+
+int main() {
+    test_compact_keeps_ids();
+    test_update_revives_removed_id();
+    test_plan_rechecked_at_commit();
+    return sss_test::check_report("map_compactor_test");
+}
@@ -0,0 +1,321 @@
+// SceneUpdateQueue applies batches from several producers in publish
+// order, fills placeholders and leaves tombstones, and keeps the scene's
+// spatial index and LOD hierarchy current while doing so.
+#include "scene/LodHierarchy.hpp"
+#include "scene/Scene.hpp"
+#include "scene/SceneUpdates.hpp"
+#include "scene/SpatialIndex.hpp"
+#include "core/ThreadPool.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+sss::Gaussian3D make_gaussian(const glm::vec3& mean) {
+    sss::Gaussian3D g;
+    g.mean = mean;
+    g.scale = glm::vec3(0.01f);
+    g.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    g.opacity = 0.8f;
+    g.color = glm::vec3(0.5f);
+    return g;
+}
+
+// The root's box holds `p`
+bool root_contains(const sss::SpatialIndex& index, const glm::vec3& p) {
+    const sss::SpatialIndex::Node& root = index.nodes().front();
+    return p.x >= root.bounds_min.x && p.y >= root.bounds_min.y && p.z >= root.bounds_min.z &&
+           p.x <= root.bounds_max.x && p.y <= root.bounds_max.y && p.z <= root.bounds_max.z;
+}
+
+// Every visible gaussian in the index lies in its leaf's box
+bool leaves_contain_means(const sss::SpatialIndex& index, const sss::Scene& scene) {
+    for (const sss::SpatialIndex::Node& node : index.nodes()) {
+        if (node.left != sss::SpatialIndex::kLeaf) {
+            continue;
+        }
+        for (uint32_t slot = node.first; slot < node.first + node.count; ++slot) {
+            const uint32_t i = index.order()[slot];
+            const glm::vec3& p = scene.means()[i];
+            if (scene.opacities()[i] <= 0.0f) {
+                continue;
+            }
+            if (p.x < node.bounds_min.x || p.y < node.bounds_min.y || p.z < node.bounds_min.z ||
+                p.x > node.bounds_max.x || p.y > node.bounds_max.y || p.z > node.bounds_max.z) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A 32^3 grid in the unit cube, enough for a few hundred leaves
+std::vector<sss::Gaussian3D> make_grid() {
+    std::vector<sss::Gaussian3D> gaussians;
+    const int n = 32;
+    for (int z = 0; z < n; ++z) {
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                gaussians.push_back(make_gaussian(glm::vec3(x, y, z) / (float)n));
+            }
+        }
+    }
+    return gaussians;
+}
+
+void test_refit_after_apply() {
+    sss::ThreadPool& pool = sss::ThreadPool::shared();
+    sss::Scene scene;
+    scene.set_gaussians(make_grid());
+    scene.build_lod_hierarchy(&pool);
+    CHECK(scene.spatial_index() != nullptr);
+    CHECK(scene.lod_hierarchy() != nullptr);
+    const size_t count = scene.gaussian_count();
+
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+    std::vector<sss::DirtyRange> runs;
+
+    // Move one gaussian well outside the grid, prune another
+    const glm::vec3 moved(4.0f, -3.0f, 2.0f);
+    sss::SceneUpdate update;
+    update.update(scene.id_of(7), make_gaussian(moved));
+    update.pruned.push_back(scene.id_of(11));
+    queue.publish(std::move(update));
+    CHECK(queue.apply(scene, runs) == 1);
+
+    const sss::SpatialIndex* index = scene.spatial_index();
+    CHECK(index != nullptr);
+    CHECK(scene.lod_hierarchy() != nullptr);
+    if (index) {
+        CHECK(index->size() == count);
+        CHECK(root_contains(*index, moved));
+        CHECK(leaves_contain_means(*index, scene));
+    }
+    if (scene.lod_hierarchy() && index) {
+        CHECK(&scene.lod_hierarchy()->index() == index);
+    }
+
+    // Inserts stay outside the index, which remains current
+    sss::SceneUpdate insert;
+    insert.inserted.push_back(make_gaussian(glm::vec3(0.5f)));
+    queue.publish(std::move(insert));
+    CHECK(queue.apply(scene, runs) == 1);
+    CHECK(scene.gaussian_count() == count + 1);
+    index = scene.spatial_index();
+    CHECK(index != nullptr);
+    CHECK(scene.lod_hierarchy() != nullptr);
+    if (index) {
+        CHECK(index->size() == count);
+    }
+
+    // Several batches in a row, as a mapper streams them
+    for (int batch = 0; batch < 8; ++batch) {
+        sss::SceneUpdate u;
+        for (uint32_t i = 0; i < 64; ++i) {
+            const size_t slot = (size_t)batch * 97 + i * 13;
+            u.update(scene.id_of(slot), make_gaussian(scene.means()[slot] + glm::vec3(0.0f, 0.0f, 0.01f)));
+        }
+        queue.publish(std::move(u));
+    }
+    CHECK(queue.apply(scene, runs) == 8);
+    index = scene.spatial_index();
+    CHECK(index != nullptr);
+    if (index) {
+        CHECK(leaves_contain_means(*index, scene));
+    }
+    CHECK(scene.lod_hierarchy() != nullptr);
+}
+
+void test_insert_only_keeps_lod() {
+    sss::ThreadPool& pool = sss::ThreadPool::shared();
+    sss::Scene scene;
+    scene.set_gaussians(make_grid());
+    scene.build_lod_hierarchy(&pool);
+    const std::shared_ptr<const sss::LodHierarchy> lod = scene.lod_hierarchy_shared();
+    CHECK(lod != nullptr);
+    const size_t count = scene.gaussian_count();
+
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+    std::vector<sss::DirtyRange> runs;
+    sss::SceneUpdate insert;
+    for (int i = 0; i < 5; ++i) {
+        insert.inserted.push_back(make_gaussian(glm::vec3(0.1f * (float)i)));
+    }
+    queue.publish(std::move(insert));
+    CHECK(queue.apply(scene, runs) == 1);
+
+    // The same hierarchy is still current, but the scene grew under it, so
+    // its representatives belong after the new last instance: the renderer
+    // has to key its upload on the base as well as the pointer
+    CHECK(scene.gaussian_count() == count + 5);
+    CHECK(scene.lod_hierarchy_shared() == lod);
+    if (lod && scene.spatial_index()) {
+        CHECK(&lod->index() == scene.spatial_index());
+        CHECK(scene.spatial_index()->size() == count);
+    }
+}
+
+bool is_tombstone(const sss::Scene& scene, size_t slot) {
+    return scene.opacities()[slot] == 0.0f && scene.scales()[slot] == glm::vec3(0.0f);
+}
+
+// Some run in `runs` covers `slot`
+bool runs_cover(const std::vector<sss::DirtyRange>& runs, size_t slot) {
+    for (const sss::DirtyRange& run : runs) {
+        if (slot >= run.begin && slot < run.end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void test_pruned_become_tombstones() {
+    sss::Scene scene;
+    scene.set_gaussians(make_grid());
+    const size_t count = scene.gaussian_count();
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+    std::vector<sss::DirtyRange> runs;
+
+    sss::SceneUpdate update;
+    update.pruned = {3, 500, (uint32_t)count - 1};
+    queue.publish(std::move(update));
+    CHECK(queue.apply(scene, runs) == 1);
+
+    // Pruned in place: the count and every other gaussian are unchanged
+    CHECK(scene.gaussian_count() == count);
+    CHECK(queue.stats().pruned == 3);
+    for (uint32_t id : {3u, 500u, (uint32_t)count - 1}) {
+        CHECK(is_tombstone(scene, scene.slot_of(id)));
+        CHECK(runs_cover(runs, scene.slot_of(id)));
+    }
+    CHECK(!is_tombstone(scene, 4));
+    CHECK(scene.opacities()[4] > 0.0f);
+
+    // A later update to a pruned ID overwrites the tombstone
+    sss::SceneUpdate revive;
+    revive.update(500, make_gaussian(glm::vec3(0.25f)));
+    queue.publish(std::move(revive));
+    CHECK(queue.apply(scene, runs) == 1);
+    CHECK(!is_tombstone(scene, scene.slot_of(500)));
+    CHECK(scene.means()[scene.slot_of(500)] == glm::vec3(0.25f));
+}
+
+// A batch that refers to IDs past the scene, as one applied before an
+// earlier-reserved insert does, grows it with placeholders; the inserts
+// for those IDs then fill them in place
+void test_placeholders_filled_in_place() {
+    sss::Scene scene;
+    std::vector<sss::Gaussian3D> gaussians;
+    for (int i = 0; i < 8; ++i) {
+        gaussians.push_back(make_gaussian(glm::vec3((float)i, 0.0f, 0.0f)));
+    }
+    scene.set_gaussians(gaussians);
+    const size_t count = scene.gaussian_count();
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+    std::vector<sss::DirtyRange> runs;
+
+    sss::SceneUpdate ahead;
+    ahead.update((uint32_t)count + 2, make_gaussian(glm::vec3(9.0f)));
+    queue.publish(std::move(ahead));
+    CHECK(queue.apply(scene, runs) == 1);
+    CHECK(scene.gaussian_count() == count + 3);
+    CHECK(is_tombstone(scene, count));
+    CHECK(is_tombstone(scene, count + 1));
+    CHECK(scene.means()[count + 2] == glm::vec3(9.0f));
+
+    // The inserts get the IDs the placeholders hold
+    sss::SceneUpdate insert;
+    for (int i = 0; i < 3; ++i) {
+        insert.inserted.push_back(make_gaussian(glm::vec3(0.0f, (float)i, 0.0f)));
+    }
+    CHECK(queue.publish(std::move(insert)) == count);
+    CHECK(queue.apply(scene, runs) == 1);
+    CHECK(scene.gaussian_count() == count + 3);
+    for (int i = 0; i < 3; ++i) {
+        CHECK(scene.means()[count + i] == glm::vec3(0.0f, (float)i, 0.0f));
+        CHECK(runs_cover(runs, count + i));
+    }
+}
+
+// Producers publish while the render thread drains; every batch lands, each
+// insert at the indices publish() returned, and one producer's batches in
+// its order
+void test_concurrent_publish() {
+    constexpr int kProducers = 4;
+    constexpr int kBatches = 200;
+    constexpr int kInserts = 3;
+
+    sss::Scene scene;
+    std::vector<sss::Gaussian3D> gaussians;
+    for (int i = 0; i < kProducers; ++i) {
+        gaussians.push_back(make_gaussian(glm::vec3(0.0f)));
+    }
+    scene.set_gaussians(gaussians);
+    const size_t count = scene.gaussian_count();
+    sss::SceneUpdateQueue queue;
+    queue.reset(scene.id_count());
+
+    std::vector<std::vector<size_t>> firsts(kProducers);
+    std::atomic<int> running{kProducers};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int b = 0; b < kBatches; ++b) {
+                sss::SceneUpdate u;
+                // Each producer keeps rewriting its own gaussian
+                u.update((uint32_t)p, make_gaussian(glm::vec3((float)p, (float)b, -1.0f)));
+                for (int i = 0; i < kInserts; ++i) {
+                    u.inserted.push_back(make_gaussian(glm::vec3((float)p, (float)b, (float)i)));
+                }
+                firsts[p].push_back(queue.publish(std::move(u)));
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    std::vector<sss::DirtyRange> runs;
+    size_t applied = 0;
+    while (running.load() > 0) {
+        applied += queue.apply(scene, runs);
+        std::this_thread::yield();
+    }
+    for (std::thread& t : producers) {
+        t.join();
+    }
+    applied += queue.apply(scene, runs);
+
+    const size_t batches = (size_t)kProducers * kBatches;
+    CHECK(applied == batches);
+    CHECK(queue.stats().published == batches);
+    CHECK(queue.stats().applied == batches);
+    CHECK(scene.gaussian_count() == count + batches * kInserts);
+    for (int p = 0; p < kProducers; ++p) {
+        CHECK(scene.means()[p] == glm::vec3((float)p, (float)(kBatches - 1), -1.0f));
+        for (int b = 0; b < kBatches && b < (int)firsts[p].size(); ++b) {
+            for (int i = 0; i < kInserts; ++i) {
+                const size_t slot = scene.slot_of((uint32_t)(firsts[p][b] + i));
+                CHECK(slot != sss::Scene::kNoSlot);
+                if (slot != sss::Scene::kNoSlot) {
+                    CHECK(scene.means()[slot] == glm::vec3((float)p, (float)b, (float)i));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    test_refit_after_apply();
+    test_insert_only_keeps_lod();
+    test_pruned_become_tombstones();
+    test_placeholders_filled_in_place();
+    test_concurrent_publish();
+    return sss_test::check_report("scene_updates_test");
+}